@@ -0,0 +1,272 @@
+#include <stddef.h>
+#include <string.h>
+#include "blink_sequencer.h"
+#include "pattern_vm.h"
+#include "patterns.h"
+#include "led_render.h"
+#include "pwm_engine.h"
+#include "hires_timer.h"
+#include "event_queue.h"
+#include "instrument.h"
+#include "trace.h"
+
+static hires_timer_t m_pause_timer;
+
+// Incremented by every stop, events queued before it carry an older value
+static uint8_t m_generation;
+static blink_sequencer_state_t m_state = BLINK_SEQUENCER_IDLE;
+static pattern_vm_t m_vm;
+static pattern_vm_action_t m_action;
+
+// Fade played by the PWM engine, EasyDMA reads it from RAM. Rendered again
+// only when the keyframes change, a repeated blink plays the same frames.
+static pwm_engine_frame_t m_frames[LED_RENDER_FRAMES_MAX];
+static uint16_t m_length;
+static uint32_t m_frame_us;
+static led_keyframe_t m_frames_keyframes[PATTERN_VM_CHANNELS][3];
+static uint8_t m_frames_counts[PATTERN_VM_CHANNELS];
+
+// Levels held by a wait with LEDs on, one frame repeated
+static pwm_engine_frame_t m_hold_frame;
+
+static uint8_t m_brightness = UINT8_MAX;
+static uint16_t m_speed = 100;
+
+static void fade_done_handler(void)
+{
+    if (m_state == BLINK_SEQUENCER_PAUSE)
+    {
+        TRACE(TRACE_PAUSE_END, 0, 0);
+        event_queue_put(EVENT_PAUSE_DONE, m_generation);
+    }
+    else
+    {
+        TRACE(TRACE_BLINK_END, 0, 0);
+        event_queue_put(EVENT_FADE_DONE, m_generation);
+    }
+}
+
+static void pause_timeout_handler(void * p_context)
+{
+    TRACE(TRACE_PAUSE_END, 0, 0);
+    event_queue_put(EVENT_PAUSE_DONE, m_generation);
+}
+
+// Brightness and speed, on the keyframes so the frame cache sees them
+static void action_adjust(void)
+{
+    for (int i = 0; i < PATTERN_VM_CHANNELS; i++)
+    {
+        for (int k = 0; k < m_action.timelines[i].count; k++)
+        {
+            led_keyframe_t * p_keyframe = &m_action.keyframes[i][k];
+            uint32_t time_ms = p_keyframe->time_ms * 100UL / m_speed;
+
+            p_keyframe->level = p_keyframe->level * m_brightness / UINT8_MAX;
+            if (m_action.type == PATTERN_VM_ACTION_FADE)
+            {
+                p_keyframe->time_ms = time_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)time_ms;
+            }
+        }
+    }
+
+    if (m_action.type == PATTERN_VM_ACTION_FADE)
+    {
+        uint32_t duration_ms = m_action.duration_ms * 100UL / m_speed;
+        m_action.duration_ms = duration_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)duration_ms;
+    }
+}
+
+static void frames_render(void)
+{
+    led_timeline_t const * timelines[LED_RENDER_CHANNELS];
+    bool changed = memcmp(m_frames_keyframes, m_action.keyframes, sizeof(m_frames_keyframes)) != 0;
+
+    for (int i = 0; i < LED_RENDER_CHANNELS; i++)
+    {
+        timelines[i] = &m_action.timelines[i];
+        changed |= m_frames_counts[i] != m_action.timelines[i].count;
+        m_frames_counts[i] = m_action.timelines[i].count;
+    }
+
+    if (changed || m_length == 0)
+    {
+        memcpy(m_frames_keyframes, m_action.keyframes, sizeof(m_frames_keyframes));
+        m_frame_us = BLINK_SEQUENCER_FRAME_US;
+        m_length = led_render_fill(m_frames, timelines, &m_frame_us);
+    }
+}
+
+static void wait_begin(void)
+{
+    m_state = BLINK_SEQUENCER_PAUSE;
+    TRACE(TRACE_PAUSE_BEGIN, 0, 0);
+
+    if (m_action.lit_mask == 0)
+    {
+        hires_timer_start(&m_pause_timer, m_action.duration_ms * 1000UL, pause_timeout_handler, NULL);
+        return;
+    }
+
+    // LEDs stay on: the PWM engine repeats their levels for the wait
+    led_timeline_t const * timelines[LED_RENDER_CHANNELS];
+    uint32_t frame_us = BLINK_SEQUENCER_FRAME_US;
+
+    for (int i = 0; i < LED_RENDER_CHANNELS; i++)
+    {
+        timelines[i] = &m_action.timelines[i];
+    }
+    led_render_fill(&m_hold_frame, timelines, &frame_us);
+
+    uint32_t frame_ns = pwm_engine_frame_ns(frame_us);
+    uint32_t count = (uint32_t)((m_action.duration_ms * 1000000ULL + frame_ns / 2) / frame_ns);
+    pwm_engine_play(&m_hold_frame, 1, frame_us, count != 0 ? (uint16_t)count : 1);
+}
+
+// Run the pattern VM to its next action and start it. One fade per PWM
+// sequence, so a stop always knows which blinks were shown.
+static void action_begin(void)
+{
+    INSTRUMENT_BEGIN(FADE_BEGIN);
+
+    pattern_vm_step(&m_vm, &m_action);
+    action_adjust();
+    switch (m_action.type)
+    {
+        case PATTERN_VM_ACTION_FADE:
+            frames_render();
+            m_state = BLINK_SEQUENCER_FADE;
+            TRACE(TRACE_BLINK_BEGIN, 0, m_action.lit_mask);
+            pwm_engine_play(m_frames, m_length, m_frame_us, 1);
+            break;
+
+        case PATTERN_VM_ACTION_WAIT:
+            wait_begin();
+            break;
+
+        default:
+            m_state = BLINK_SEQUENCER_IDLE;
+            break;
+    }
+
+    INSTRUMENT_END(FADE_BEGIN);
+}
+
+void blink_sequencer_init(uint32_t const * p_pins, uint8_t const * p_digits, uint8_t mode)
+{
+    uint16_t length;
+    uint8_t const * p_code = patterns_device_id(mode, &length);
+
+    for (uint8_t i = 0; i < LED_RENDER_CHANNELS; i++)
+    {
+        pattern_vm_var_set(&m_vm, PATTERNS_VAR_DIGIT(i), p_digits[i]);
+    }
+    pattern_vm_load(&m_vm, p_code, length);
+    pwm_engine_init(p_pins, fade_done_handler);
+}
+
+bool blink_sequencer_pattern_set(uint8_t const * p_code, uint16_t length)
+{
+    blink_sequencer_stop();
+
+    return pattern_vm_load(&m_vm, p_code, length);
+}
+
+void blink_sequencer_event_post(uint8_t event)
+{
+    pattern_vm_event_post(&m_vm, event);
+}
+
+void blink_sequencer_digits_set(uint8_t const * p_digits)
+{
+    bool running = m_state != BLINK_SEQUENCER_IDLE;
+
+    blink_sequencer_reset();
+    for (uint8_t i = 0; i < PATTERN_VM_CHANNELS; i++)
+    {
+        pattern_vm_var_set(&m_vm, PATTERNS_VAR_DIGIT(i), p_digits[i]);
+    }
+    if (running)
+    {
+        blink_sequencer_start();
+    }
+}
+
+void blink_sequencer_brightness_set(uint8_t brightness)
+{
+    m_brightness = brightness;
+}
+
+void blink_sequencer_speed_set(uint16_t percent)
+{
+    if (percent < BLINK_SEQUENCER_SPEED_MIN)
+    {
+        percent = BLINK_SEQUENCER_SPEED_MIN;
+    }
+    m_speed = percent > BLINK_SEQUENCER_SPEED_MAX ? BLINK_SEQUENCER_SPEED_MAX : percent;
+}
+
+void blink_sequencer_settings_get(blink_sequencer_settings_t * p_settings)
+{
+    for (uint8_t i = 0; i < PATTERN_VM_CHANNELS; i++)
+    {
+        p_settings->digits[i] = m_vm.vars[PATTERNS_VAR_DIGIT(i)];
+    }
+    p_settings->brightness = m_brightness;
+    p_settings->speed = m_speed;
+}
+
+void blink_sequencer_start(void)
+{
+    if (m_state == BLINK_SEQUENCER_IDLE)
+    {
+        action_begin();
+    }
+}
+
+void blink_sequencer_stop(void)
+{
+    // The interrupted blink or pause ends here, its handler does not run
+    if (m_state == BLINK_SEQUENCER_FADE)
+    {
+        TRACE(TRACE_BLINK_END, 0, 0);
+    }
+    else if (m_state == BLINK_SEQUENCER_PAUSE)
+    {
+        TRACE(TRACE_PAUSE_END, 0, 0);
+    }
+
+    pwm_engine_stop();
+    hires_timer_stop(&m_pause_timer);
+    m_generation++;
+    if (m_state != BLINK_SEQUENCER_IDLE)
+    {
+        pattern_vm_interrupt(&m_vm);
+    }
+    m_state = BLINK_SEQUENCER_IDLE;
+}
+
+void blink_sequencer_reset(void)
+{
+    blink_sequencer_stop();
+    pattern_vm_restart(&m_vm);
+}
+
+void blink_sequencer_event_handle(event_t const * p_event)
+{
+    if (p_event->arg != m_generation)
+    {
+        return;
+    }
+
+    if ((p_event->type == EVENT_FADE_DONE && m_state == BLINK_SEQUENCER_FADE) ||
+        (p_event->type == EVENT_PAUSE_DONE && m_state == BLINK_SEQUENCER_PAUSE))
+    {
+        action_begin();
+    }
+}
+
+blink_sequencer_state_t blink_sequencer_state(void)
+{
+    return m_state;
+}
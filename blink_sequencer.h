@@ -0,0 +1,69 @@
+#ifndef BLINK_SEQUENCER_H
+#define BLINK_SEQUENCER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "event_queue.h"
+#include "pattern_vm.h"
+
+// Non-blocking LED patterns, the device_id blinks by default. The sequencer
+// plays the actions of a pattern_vm program and is a state machine fed by
+// PWM engine and timer events; interrupts only queue the events and
+// blink_sequencer_event_handle() runs the transitions from the main loop.
+
+// Blink = fade in and out over BLINK_FADE_MS each, rendered in 6 ms frames
+#define BLINK_SEQUENCER_FRAME_US 6000
+
+// Fade speed in percent of the pattern timing, 100: as written
+#define BLINK_SEQUENCER_SPEED_MIN 25
+#define BLINK_SEQUENCER_SPEED_MAX 400
+
+typedef struct
+{
+    uint8_t  digits[PATTERN_VM_CHANNELS];   // device_id, blinks per LED
+    uint8_t  brightness;                    // scales every level, 255: full
+    uint16_t speed;                         // percent
+} blink_sequencer_settings_t;
+
+typedef enum
+{
+    BLINK_SEQUENCER_IDLE,   // stopped, the position in the pattern is kept
+    BLINK_SEQUENCER_FADE,   // a fade or blink is being played by the PWM engine
+    BLINK_SEQUENCER_PAUSE   // a wait of the pattern, LEDs off or held
+} blink_sequencer_state_t;
+
+// p_digits: blinks per LED, mode: LED_RENDER_MODE_SEQUENTIAL or _CONCURRENT
+void blink_sequencer_init(uint32_t const * p_pins, uint8_t const * p_digits, uint8_t mode);
+
+// Stop and play another pattern program from its start, false (and nothing
+// to play) if pattern_vm_load() rejects it. The code must stay valid.
+bool blink_sequencer_pattern_set(uint8_t const * p_code, uint16_t length);
+
+// Set an event bit for the BRANCH_EVENT ops of the pattern
+void blink_sequencer_event_post(uint8_t event);
+
+// New device_id digits: the pattern starts over, and keeps playing if it was
+void blink_sequencer_digits_set(uint8_t const * p_digits);
+
+// Take effect with the next fade
+void blink_sequencer_brightness_set(uint8_t brightness);
+void blink_sequencer_speed_set(uint16_t percent);
+
+void blink_sequencer_settings_get(blink_sequencer_settings_t * p_settings);
+
+// Resume the pattern at the fade that was interrupted by the last stop
+void blink_sequencer_start(void);
+
+// Switch the LEDs off at once and keep the position for the next start
+void blink_sequencer_stop(void);
+
+// Forget the position, the next start begins with the first LED
+void blink_sequencer_reset(void);
+
+// Handle EVENT_FADE_DONE and EVENT_PAUSE_DONE taken from the event queue,
+// events queued before the last stop are ignored
+void blink_sequencer_event_handle(event_t const * p_event);
+
+blink_sequencer_state_t blink_sequencer_state(void);
+
+#endif
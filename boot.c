@@ -0,0 +1,68 @@
+#include <string.h>
+#include "boot.h"
+#include "nrf.h"
+#include "nrfx_power.h"
+#include "usb_link.h"
+
+static boot_report_t m_report;
+
+// BOOT_CTRL has no payload, the report is the answer
+static void ctrl_handler(uint8_t const * p_payload, uint16_t length)
+{
+    usb_link_send(USB_LINK_MSG_BOOT_REPORT, &m_report, sizeof(m_report));
+}
+
+void boot_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(&m_report, 0, sizeof(m_report));
+    m_report.core_hz = SystemCoreClock;
+    boot_stamp(BOOT_STAGE_MAIN);
+}
+
+void boot_stamp(boot_stage_t stage)
+{
+    m_report.cycles[stage] = DWT->CYCCNT;
+    m_report.done |= 1 << stage;
+}
+
+bool boot_deferred_due(bool idle)
+{
+    if (m_report.trigger != BOOT_TRIGGER_NONE)
+    {
+        return false;
+    }
+
+    if (nrfx_power_usbstatus_get() != NRFX_POWER_USB_STATE_DISCONNECTED)
+    {
+        m_report.trigger = BOOT_TRIGGER_VBUS;
+    }
+    else if (idle)
+    {
+        m_report.trigger = BOOT_TRIGGER_IDLE;
+    }
+    return m_report.trigger != BOOT_TRIGGER_NONE;
+}
+
+bool boot_is_complete(void)
+{
+    return (m_report.done & (1 << BOOT_STAGE_DIAGNOSTICS)) != 0;
+}
+
+uint32_t boot_stage_us(boot_stage_t stage)
+{
+    return (uint32_t)((uint64_t)m_report.cycles[stage] * 1000000 / m_report.core_hz);
+}
+
+void boot_link_init(void)
+{
+    usb_link_handler_set(USB_LINK_MSG_BOOT_CTRL, ctrl_handler);
+}
+
+void boot_report_get(boot_report_t * p_report)
+{
+    *p_report = m_report;
+}
@@ -0,0 +1,73 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Staged start-up. main() brings up what the user sees first, the LEDs show
+// the state restored from flash and the button works before anything else;
+// the USB stack and the diagnostics come later, on the first loop pass that
+// sees VBUS or, without a host, the first time the main loop would go to
+// sleep.
+//
+// Every stage is stamped with the DWT cycle counter, started by boot_init()
+// at the top of main(). The RTC cannot time them: it does not count before
+// the 32 kHz crystal runs, a quarter of a second after reset, later than
+// every stage. The CPU does not sleep before the deferred stages are done,
+// so the cycle counter is the time since main() up to the last stage. The
+// report is read over the USB link (BOOT_CTRL, answered with BOOT_REPORT,
+// tools/boot_report.py).
+
+typedef enum
+{
+    BOOT_STAGE_MAIN,            // main() entered
+    BOOT_STAGE_CLOCK,           // clock driver up, the crystal starting
+    BOOT_STAGE_LEDS,            // LED pins driven, off
+    BOOT_STAGE_TIMERS,          // app_timer, hires timer, settings loaded
+    BOOT_STAGE_BUTTON,          // button interrupt, debouncer, gestures
+    BOOT_STAGE_FIRST_LIGHT,     // the blinking state of the settings on the LEDs
+    BOOT_STAGE_USB,             // USB stack, commands and LED stream on the link
+    BOOT_STAGE_DIAGNOSTICS,     // profiler, instrumentation, PWM self-test
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+// What started the deferred stages
+typedef enum
+{
+    BOOT_TRIGGER_NONE,          // not yet
+    BOOT_TRIGGER_VBUS,          // a host powers the bus
+    BOOT_TRIGGER_IDLE           // the main loop had nothing to do
+} boot_trigger_t;
+
+// USB_LINK_MSG_BOOT_REPORT payload
+typedef struct
+{
+    uint32_t core_hz;                       // cycles per second
+    uint32_t cycles[BOOT_STAGE_COUNT];      // since boot_init()
+    uint16_t done;                          // stages reached, bit per boot_stage_t
+    uint8_t  trigger;                       // boot_trigger_t
+    uint8_t  reserved;
+} boot_report_t;
+
+// First thing in main(), starts the cycle counter
+void boot_init(void);
+
+void boot_stamp(boot_stage_t stage);
+
+// Whether the deferred stages are due: VBUS is there, or idle is set (the
+// main loop is about to sleep). True once, the trigger goes into the report.
+bool boot_deferred_due(bool idle);
+
+// The deferred stages are done
+bool boot_is_complete(void);
+
+// Microseconds from boot_init() to the stage
+uint32_t boot_stage_us(boot_stage_t stage);
+
+// Answer BOOT_CTRL on the USB link, after usb_link_init()
+void boot_link_init(void);
+
+void boot_report_get(boot_report_t * p_report);
+
+#endif
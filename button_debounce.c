@@ -0,0 +1,190 @@
+#include <string.h>
+#include "button_debounce.h"
+
+#define TICKS_HALF ((BUTTON_DEBOUNCE_TICK_MASK + 1) / 2)
+
+static uint32_t ticks_diff(uint32_t later, uint32_t earlier)
+{
+    return (later - earlier) & BUTTON_DEBOUNCE_TICK_MASK;
+}
+
+static bool ticks_reached(uint32_t now, uint32_t deadline)
+{
+    return ticks_diff(now, deadline) < TICKS_HALF;
+}
+
+static void window_open(button_debounce_t * p, uint32_t timestamp)
+{
+    p->window_open = true;
+    p->window_start = timestamp;
+    p->deadline = (timestamp + p->window_ticks) & BUTTON_DEBOUNCE_TICK_MASK;
+    p->samples = 0;
+    p->votes = 0;
+}
+
+static bool change(button_debounce_t * p, bool pressed, uint32_t timestamp,
+                   button_debounce_event_t * p_event)
+{
+    if (pressed == p->stable)
+    {
+        return false;
+    }
+
+    p->stable = pressed;
+    if (pressed)
+    {
+        p->stats.presses++;
+    }
+    else
+    {
+        p->stats.releases++;
+    }
+
+    p_event->pressed = pressed;
+    p_event->timestamp = timestamp;
+    return true;
+}
+
+// Majority samples due before elapsed ticks into the window read the current raw level
+static void samples_take(button_debounce_t * p, uint32_t elapsed)
+{
+    while (p->samples < BUTTON_DEBOUNCE_MAJORITY_SAMPLES &&
+           ((p->samples + 1) * p->window_ticks) / BUTTON_DEBOUNCE_MAJORITY_SAMPLES < elapsed)
+    {
+        p->samples++;
+        p->votes += p->raw;
+    }
+}
+
+static void stats_edge(button_debounce_t * p, uint32_t timestamp)
+{
+    button_debounce_stats_t * p_stats = &p->stats;
+
+    if (p_stats->edges == 0 || ticks_diff(timestamp, p->last_edge) > p->window_ticks)
+    {
+        p_stats->bursts++;
+        p->burst_start = timestamp;
+        p->burst_edges = 0;
+    }
+    else
+    {
+        p_stats->bounces++;
+    }
+
+    p_stats->edges++;
+    p->burst_edges++;
+    if (p->burst_edges > p_stats->max_burst_edges)
+    {
+        p_stats->max_burst_edges = p->burst_edges;
+    }
+    if (ticks_diff(timestamp, p->burst_start) > p_stats->max_burst_ticks)
+    {
+        p_stats->max_burst_ticks = ticks_diff(timestamp, p->burst_start);
+    }
+    p->last_edge = timestamp;
+}
+
+void button_debounce_init(button_debounce_t * p_debounce, uint8_t policy,
+                          uint32_t window_ticks, bool pressed)
+{
+    memset(p_debounce, 0, sizeof(*p_debounce));
+    p_debounce->policy = policy;
+    p_debounce->window_ticks = window_ticks;
+    p_debounce->raw = pressed;
+    p_debounce->stable = pressed;
+}
+
+bool button_debounce_edge(button_debounce_t * p_debounce, bool pressed, uint32_t timestamp,
+                          button_debounce_event_t * p_event)
+{
+    button_debounce_t * p = p_debounce;
+    bool changed = false;
+
+    stats_edge(p, timestamp);
+
+    switch (p->policy)
+    {
+        case BUTTON_DEBOUNCE_LOCKOUT:
+            p->raw = pressed;
+            if (!p->window_open)
+            {
+                changed = change(p, pressed, timestamp, p_event);
+                if (changed)
+                {
+                    window_open(p, timestamp);
+                }
+            }
+            break;
+
+        case BUTTON_DEBOUNCE_MAJORITY:
+            if (!p->window_open)
+            {
+                window_open(p, timestamp);
+            }
+            samples_take(p, ticks_diff(timestamp, p->window_start));
+            p->raw = pressed;
+            break;
+
+        default:
+            // Integrator: every edge restarts the quiet window
+            if (!p->window_open)
+            {
+                window_open(p, timestamp);
+            }
+            p->deadline = (timestamp + p->window_ticks) & BUTTON_DEBOUNCE_TICK_MASK;
+            p->raw = pressed;
+            break;
+    }
+
+    return changed;
+}
+
+bool button_debounce_deadline(button_debounce_t const * p_debounce, uint32_t * p_deadline)
+{
+    *p_deadline = p_debounce->deadline;
+    return p_debounce->window_open;
+}
+
+bool button_debounce_timeout(button_debounce_t * p_debounce, uint32_t timestamp,
+                             button_debounce_event_t * p_event)
+{
+    button_debounce_t * p = p_debounce;
+    bool changed = false;
+
+    if (!p->window_open || !ticks_reached(timestamp, p->deadline))
+    {
+        return false;
+    }
+
+    uint32_t deadline = p->deadline;
+    p->window_open = false;
+
+    switch (p->policy)
+    {
+        case BUTTON_DEBOUNCE_LOCKOUT:
+            // The level changed back during the lockout, count that edge now
+            // and lock out its bounce as well
+            changed = change(p, p->raw, p->last_edge, p_event);
+            if (changed)
+            {
+                window_open(p, deadline);
+            }
+            break;
+
+        case BUTTON_DEBOUNCE_MAJORITY:
+            samples_take(p, p->window_ticks + 1);
+            changed = change(p, p->votes * 2 > BUTTON_DEBOUNCE_MAJORITY_SAMPLES,
+                             p->window_start, p_event);
+            if (p->raw != p->stable)
+            {
+                window_open(p, deadline);
+            }
+            break;
+
+        default:
+            changed = change(p, p->raw, p->window_start, p_event);
+            break;
+    }
+
+    return changed;
+}
@@ -0,0 +1,76 @@
+#ifndef BUTTON_DEBOUNCE_H
+#define BUTTON_DEBOUNCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Debouncer fed with timestamped raw edges instead of periodic polling. The
+// timestamps are RTC ticks (24-bit, wrapping) taken when the edge interrupt
+// ran, so a press is reported with the time of its first edge even when the
+// policy decides later. Hardware independent, the host build replays traces.
+//
+// Policies, all with the same window:
+//  - integrator: the level counts once it has been stable for the window,
+//  - lockout:    the first edge counts at once, edges inside the window after
+//                it are ignored and the level is checked again at its end,
+//  - majority:   the level is sampled BUTTON_DEBOUNCE_MAJORITY_SAMPLES times
+//                over the window after the first edge and the majority counts.
+
+#define BUTTON_DEBOUNCE_TICK_MASK        0x00FFFFFFUL
+#define BUTTON_DEBOUNCE_MAJORITY_SAMPLES 5
+
+// Values of BUTTON_DEBOUNCE_POLICY (see app_config.h)
+#define BUTTON_DEBOUNCE_INTEGRATOR 0
+#define BUTTON_DEBOUNCE_LOCKOUT    1
+#define BUTTON_DEBOUNCE_MAJORITY   2
+
+typedef struct
+{
+    uint32_t edges;            // raw edges
+    uint32_t bursts;           // groups of edges less than a window apart
+    uint32_t bounces;          // edges after the first of a burst
+    uint32_t presses;
+    uint32_t releases;
+    uint32_t max_burst_edges;
+    uint32_t max_burst_ticks;  // first to last edge of the longest burst
+} button_debounce_stats_t;
+
+typedef struct
+{
+    bool     pressed;
+    uint32_t timestamp;        // first edge of the change
+} button_debounce_event_t;
+
+typedef struct
+{
+    uint8_t  policy;
+    uint32_t window_ticks;
+    bool     raw;              // level after the last edge
+    bool     stable;           // debounced level
+    bool     window_open;
+    uint32_t window_start;
+    uint32_t deadline;
+    uint32_t last_edge;
+    uint8_t  samples;          // majority: samples taken in this window
+    uint8_t  votes;            // majority: samples that read pressed
+    uint32_t burst_start;
+    uint32_t burst_edges;
+    button_debounce_stats_t stats;
+} button_debounce_t;
+
+void button_debounce_init(button_debounce_t * p_debounce, uint8_t policy,
+                          uint32_t window_ticks, bool pressed);
+
+// Raw edge, pressed is the level read after it. Call button_debounce_timeout()
+// with the same timestamp first, a window may have ended before this edge.
+bool button_debounce_edge(button_debounce_t * p_debounce, bool pressed, uint32_t timestamp,
+                          button_debounce_event_t * p_event);
+
+// When button_debounce_timeout() has to be called next, false if not needed
+bool button_debounce_deadline(button_debounce_t const * p_debounce, uint32_t * p_deadline);
+
+// Close the window if its deadline has been reached at timestamp
+bool button_debounce_timeout(button_debounce_t * p_debounce, uint32_t timestamp,
+                             button_debounce_event_t * p_event);
+
+#endif
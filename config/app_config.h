@@ -127,4 +127,353 @@
 
 // </e>
 
+// <h> LED PWM engine
+//==========================================================
+// <o> PWM_ENGINE_BACKEND  - Backend that drives the LED channels
+ 
+// <0=> Software (hires_timer callbacks) 
+// <1=> PWM peripheral (EasyDMA) 
+// <2=> TIMER + PPI + GPIOTE 
+
+#ifndef PWM_ENGINE_BACKEND
+#define PWM_ENGINE_BACKEND 1
+#endif
+
+// <o> PWM_ENGINE_INSTANCE - PWM peripheral instance used by the EasyDMA backend  <0-3> 
+#ifndef PWM_ENGINE_INSTANCE
+#define PWM_ENGINE_INSTANCE 0
+#endif
+
+// <o> PWM_ENGINE_TIMER_INSTANCE - TIMER counting the PWM period in the PPI backend  <3-4> 
+// <i> Needs six compare channels, the instance must be enabled in sdk_config.h
+#ifndef PWM_ENGINE_TIMER_INSTANCE
+#define PWM_ENGINE_TIMER_INSTANCE 3
+#endif
+
+// <o> PWM_ENGINE_FRAME_TIMER_INSTANCE - TIMER counting periods per frame in the PPI backend  <1-4> 
+#ifndef PWM_ENGINE_FRAME_TIMER_INSTANCE
+#define PWM_ENGINE_FRAME_TIMER_INSTANCE 4
+#endif
+
+// <o> PWM_ENGINE_FREQUENCY - PWM frequency in Hz 
+// <i> The EasyDMA and PPI backends use the slowest clock that still reaches this frequency.
+#ifndef PWM_ENGINE_FREQUENCY
+#define PWM_ENGINE_FREQUENCY 1000
+#endif
+
+// <o> PWM_ENGINE_RESOLUTION_BITS  - Resolution of the channel levels
+ 
+// <8=> 8 bit 
+// <10=> 10 bit 
+// <15=> 15 bit 
+
+#ifndef PWM_ENGINE_RESOLUTION_BITS
+#define PWM_ENGINE_RESOLUTION_BITS 10
+#endif
+
+// <o> FADE_CURVE  - Brightness curve of the LED fades
+ 
+// <0=> Linear 
+// <1=> Gamma 2.2 
+// <2=> Perceptual (CIE1931) 
+
+#ifndef FADE_CURVE
+#define FADE_CURVE 2
+#endif
+
+// <o> LED_RENDER_MODE  - How the device_id digits are shown
+ 
+// <0=> Sequential (one LED after the other) 
+// <1=> Concurrent (all LEDs at once) 
+
+#ifndef LED_RENDER_MODE
+#define LED_RENDER_MODE 0
+#endif
+
+// <o> BLINK_FADE_MS - Fade in time of one blink, fade out takes as long 
+// <i> Independent of PWM_ENGINE_FREQUENCY
+#ifndef BLINK_FADE_MS
+#define BLINK_FADE_MS 600
+#endif
+
+// <o> BLINK_EASING  - Easing of the blink fades, on top of FADE_CURVE
+ 
+// <0=> Linear 
+// <1=> Ease in 
+// <2=> Ease out 
+// <3=> Ease in and out 
+// <4=> Cubic 
+// <5=> Step 
+
+#ifndef BLINK_EASING
+#define BLINK_EASING 0
+#endif
+
+// </h>
+
+// <h> High-resolution timer
+//==========================================================
+// <o> HIRES_TIMER_RTC_INSTANCE - RTC used for long waits  <2-2> 
+// <i> RTC1 belongs to app_timer, RTC0 to the SoftDevice
+#ifndef HIRES_TIMER_RTC_INSTANCE
+#define HIRES_TIMER_RTC_INSTANCE 2
+#endif
+
+// <o> HIRES_TIMER_TIMER_INSTANCE - TIMER counting the sub-tick remainder  <0-4> 
+#ifndef HIRES_TIMER_TIMER_INSTANCE
+#define HIRES_TIMER_TIMER_INSTANCE 1
+#endif
+
+// <o> HIRES_TIMER_FINE_WINDOW_US - Keep the TIMER running for deadlines closer than this 
+// <i> Shorter windows release the HFCLK sooner, longer ones avoid restarts between close deadlines.
+#ifndef HIRES_TIMER_FINE_WINDOW_US
+#define HIRES_TIMER_FINE_WINDOW_US 1000
+#endif
+
+// </h>
+
+// <h> Event queue
+//==========================================================
+// <o> EVENT_QUEUE_SIZE - Events that can wait for the main loop 
+// <i> A full queue drops new events and counts them, see event_queue_overflows().
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 16
+#endif
+
+// </h>
+
+// <h> Button debounce
+//==========================================================
+// <o> BUTTON_DEBOUNCE_POLICY  - How contact bounce is filtered
+ 
+// <0=> Integrator (level stable for the window) 
+// <1=> Lockout (first edge, then ignore the window) 
+// <2=> Majority of samples over the window 
+
+#ifndef BUTTON_DEBOUNCE_POLICY
+#define BUTTON_DEBOUNCE_POLICY 1
+#endif
+
+// <o> BUTTON_DEBOUNCE_MS - Debounce window in milliseconds 
+#ifndef BUTTON_DEBOUNCE_MS
+#define BUTTON_DEBOUNCE_MS 20
+#endif
+
+// </h>
+
+// <h> Button gestures
+//==========================================================
+// <o> GESTURE_CLICK_GAP_MS - Longest release between the clicks of a double or triple click 
+#ifndef GESTURE_CLICK_GAP_MS
+#define GESTURE_CLICK_GAP_MS 300
+#endif
+
+// <o> GESTURE_LONG_PRESS_MS - Shortest press reported as a long press instead of a click 
+#ifndef GESTURE_LONG_PRESS_MS
+#define GESTURE_LONG_PRESS_MS 800
+#endif
+
+// <o> GESTURE_REPEAT_MS - Hold-to-repeat interval after a long press 
+#ifndef GESTURE_REPEAT_MS
+#define GESTURE_REPEAT_MS 200
+#endif
+
+// </h>
+
+// <e> USB_LINK_ENABLED - Framed messages to and from the host over a CDC ACM port
+//==========================================================
+#ifndef USB_LINK_ENABLED
+#define USB_LINK_ENABLED 1
+#endif
+
+// <o> USB_LINK_CDC_ACM_COMM_INTERFACE - CDC ACM COMM Interface number 
+// <i> Move the port to interfaces 2/3 and endpoints 3/4 when the USB log backend is enabled as well
+#ifndef USB_LINK_CDC_ACM_COMM_INTERFACE
+#define USB_LINK_CDC_ACM_COMM_INTERFACE 0
+#endif
+
+// <o> USB_LINK_CDC_ACM_DATA_INTERFACE - CDC ACM Data Interface number 
+#ifndef USB_LINK_CDC_ACM_DATA_INTERFACE
+#define USB_LINK_CDC_ACM_DATA_INTERFACE 1
+#endif
+
+// <o> USB_LINK_CDC_ACM_COMM_EPIN - CDC ACM COMM IN endpoint number 
+#ifndef USB_LINK_CDC_ACM_COMM_EPIN
+#define USB_LINK_CDC_ACM_COMM_EPIN 2
+#endif
+
+// <o> USB_LINK_CDC_ACM_DATA_EPIN - CDC ACM DATA IN endpoint number 
+#ifndef USB_LINK_CDC_ACM_DATA_EPIN
+#define USB_LINK_CDC_ACM_DATA_EPIN 1
+#endif
+
+// <o> USB_LINK_CDC_ACM_DATA_EPOUT - CDC ACM DATA OUT endpoint number 
+#ifndef USB_LINK_CDC_ACM_DATA_EPOUT
+#define USB_LINK_CDC_ACM_DATA_EPOUT 1
+#endif
+
+// <o> USB_LINK_TX_BUFFER_SIZE - Frames waiting for the host, in bytes 
+#ifndef USB_LINK_TX_BUFFER_SIZE
+#define USB_LINK_TX_BUFFER_SIZE 2048
+#endif
+
+// </e>
+
+// <e> PROFILER_ENABLED - TIMER2 PC-sampling profiler, started and read out over the USB link
+//==========================================================
+// <i> Sampling only runs while started by the host, a stopped profiler costs RAM only
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// <o> PROFILER_RATE_HZ - Sampling rate 
+// <i> A rate that is not a multiple of the PWM or app_timer rates avoids sampling in lock step with them
+#ifndef PROFILER_RATE_HZ
+#define PROFILER_RATE_HZ 997
+#endif
+
+// <o> PROFILER_BUCKET_SHIFT - Code bytes per histogram bucket, log2 
+#ifndef PROFILER_BUCKET_SHIFT
+#define PROFILER_BUCKET_SHIFT 4
+#endif
+
+// <o> PROFILER_BUCKETS - Histogram buckets, 4 bytes of RAM each 
+// <i> The histogram covers PROFILER_BUCKETS << PROFILER_BUCKET_SHIFT bytes of code from the vector table on
+#ifndef PROFILER_BUCKETS
+#define PROFILER_BUCKETS 4096
+#endif
+
+// <o> PROFILER_IRQ_PRIORITY - Sampling interrupt priority 
+// <i> Above every other interrupt, so samples are taken inside them as well
+#ifndef PROFILER_IRQ_PRIORITY
+#define PROFILER_IRQ_PRIORITY 1
+#endif
+
+// </e>
+
+// <e> INSTRUMENT_ENABLED - DWT cycle counts of code regions, read out over the USB link
+//==========================================================
+// <i> Disabled, INSTRUMENT_BEGIN/END compile to nothing
+#ifndef INSTRUMENT_ENABLED
+#define INSTRUMENT_ENABLED 1
+#endif
+
+// <o> INSTRUMENT_BUCKETS - Histogram buckets per region, 4 bytes of RAM each <8-255>
+// <i> 4 buckets per power of two, 96 reach 2^25 cycles (0.5 s at 64 MHz)
+#ifndef INSTRUMENT_BUCKETS
+#define INSTRUMENT_BUCKETS 96
+#endif
+
+// </e>
+
+// <e> TRACE_ENABLED - Binary trace records, sent to the host over the USB link
+//==========================================================
+// <i> Disabled, TRACE() compiles to nothing
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// <o> TRACE_BUFFER_RECORDS - Records waiting for the host, 12 bytes of RAM each 
+// <i> A full buffer drops new records and counts them
+#ifndef TRACE_BUFFER_RECORDS
+#define TRACE_BUFFER_RECORDS 256
+#endif
+
+// </e>
+
+// <e> DLOG_ENABLED - Dictionary logging, format strings stay out of the image
+//==========================================================
+// <i> Disabled, the DLOG macros compile to nothing
+#ifndef DLOG_ENABLED
+#define DLOG_ENABLED 1
+#endif
+
+// <o> DLOG_LEVEL  - Highest level compiled in
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL 3
+#endif
+
+// <o> DLOG_BUFFER_RECORDS - Records waiting for the host, 24 bytes of RAM each 
+// <i> A full buffer drops new records and counts them
+#ifndef DLOG_BUFFER_RECORDS
+#define DLOG_BUFFER_RECORDS 32
+#endif
+
+// </e>
+
+// <e> PWM_SELFTEST_ENABLED - PWM edge timing from TIMER captures of a looped back LED pin
+//==========================================================
+#ifndef PWM_SELFTEST_ENABLED
+#define PWM_SELFTEST_ENABLED 1
+#endif
+
+// <o> PWM_SELFTEST_TIMER_INSTANCE - Free-running TIMER taking the edge captures  <0-4> 
+#ifndef PWM_SELFTEST_TIMER_INSTANCE
+#define PWM_SELFTEST_TIMER_INSTANCE 0
+#endif
+
+// <o> PWM_SELFTEST_CAPTURE_PIN - Input wired to the LED pin under test 
+// <i> P1.10 by default. Not an LED pin: a GPIOTE event channel takes its pin as an input
+#ifndef PWM_SELFTEST_CAPTURE_PIN
+#define PWM_SELFTEST_CAPTURE_PIN 42
+#endif
+
+// </e>
+
+// <e> LED_STREAM_ENABLED - LED levels streamed by the host, played with a fixed latency
+//==========================================================
+#ifndef LED_STREAM_ENABLED
+#define LED_STREAM_ENABLED 1
+#endif
+
+// <o> LED_STREAM_FRAME_US - Shortest presentation period of a streamed frame, 1000: 1 kHz 
+// <i> The host picks its period on start. Rounded to whole PWM periods, the host paces its frames to the reported frame_ns
+#ifndef LED_STREAM_FRAME_US
+#define LED_STREAM_FRAME_US 1000
+#endif
+
+// <o> LED_STREAM_LATENCY_FRAMES - Frames between the arrival of the first frame and its presentation 
+// <i> Arrival jitter up to this many frames is absorbed without underruns
+#ifndef LED_STREAM_LATENCY_FRAMES
+#define LED_STREAM_LATENCY_FRAMES 4
+#endif
+
+// <o> LED_STREAM_DEPTH - Frames buffered ahead of the one presented, a power of 2 
+// <i> 10 bytes of RAM each. Must be larger than LED_STREAM_LATENCY_FRAMES
+#ifndef LED_STREAM_DEPTH
+#define LED_STREAM_DEPTH 16
+#endif
+
+// <o> LED_STREAM_TIMEOUT_FRAMES - Missing frames in a row after which the stream ends 
+#ifndef LED_STREAM_TIMEOUT_FRAMES
+#define LED_STREAM_TIMEOUT_FRAMES 500
+#endif
+
+// </e>
+
+// <h> Settings
+//==========================================================
+// <o> SETTINGS_FLASH_START - First page of the settings area 
+// <i> Page aligned and outside the FLASH region of the linker script, which ends at 0x80000
+#ifndef SETTINGS_FLASH_START
+#define SETTINGS_FLASH_START 0x80000
+#endif
+
+// <o> SETTINGS_FLASH_PAGES - Pages used in turn, 128 records of 32 bytes each  <2-8> 
+// <i> A page is erased once per 128 * pages changes
+#ifndef SETTINGS_FLASH_PAGES
+#define SETTINGS_FLASH_PAGES 2
+#endif
+
+// <o> SETTINGS_WRITE_DELAY_MS - Changes are written this long after the last one 
+#ifndef SETTINGS_WRITE_DELAY_MS
+#define SETTINGS_WRITE_DELAY_MS 2000
+#endif
+
+// </h>
+
 #endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <string.h>
+#include "dlog.h"
+
+#if DLOG_ENABLED
+
+#include "nrf_atfifo.h"
+#include "nrf_atomic.h"
+#include "hires_timer.h"
+#include "usb_link.h"
+
+// Size of a record on the link
+#define RECORD_HEADER_SIZE (2 * sizeof(uint32_t))
+#define RECORD_SIZE(nargs) (RECORD_HEADER_SIZE + (nargs) * sizeof(uint32_t))
+
+NRF_ATFIFO_DEF(m_fifo, dlog_record_t, DLOG_BUFFER_RECORDS);
+
+static nrf_atomic_u32_t m_dropped;
+
+// Record taken from the FIFO that did not fit into the last frame
+static dlog_record_t m_pending;
+static bool m_pending_valid;
+
+void dlog_init(void)
+{
+    NRF_ATFIFO_INIT(m_fifo);
+    m_dropped = 0;
+    m_pending_valid = false;
+}
+
+void dlog_put(uint32_t id, uint32_t nargs, uint32_t const * p_args)
+{
+    dlog_record_t record;
+
+    record.timestamp = (uint32_t)hires_timer_now_us();
+    record.header = (id & DLOG_ID_MASK) | (nargs << DLOG_NARGS_POS);
+    memcpy(record.args, p_args, nargs * sizeof(uint32_t));
+
+    if (nrf_atfifo_alloc_put(m_fifo, &record, sizeof(record), NULL) != NRF_SUCCESS)
+    {
+        nrf_atomic_u32_add(&m_dropped, 1);
+    }
+}
+
+bool dlog_get(dlog_record_t * p_record)
+{
+    return nrf_atfifo_get_free(m_fifo, p_record, sizeof(*p_record), NULL) == NRF_SUCCESS;
+}
+
+uint32_t dlog_dropped(void)
+{
+    return m_dropped;
+}
+
+void dlog_process(void)
+{
+    if (!usb_link_is_open())
+    {
+        return;
+    }
+
+    // Full frames only, the rest stays queued until the link has room
+    while (usb_link_send_space() == USB_LINK_MAX_PAYLOAD)
+    {
+        uint8_t frame[USB_LINK_MAX_PAYLOAD];
+        uint32_t length = sizeof(dlog_data_t);
+
+        while (m_pending_valid || dlog_get(&m_pending))
+        {
+            uint32_t size = RECORD_SIZE(m_pending.header >> DLOG_NARGS_POS);
+
+            m_pending_valid = true;
+            if (length + size > sizeof(frame))
+            {
+                break;
+            }
+            memcpy(&frame[length], &m_pending, size);
+            length += size;
+            m_pending_valid = false;
+        }
+        if (length == sizeof(dlog_data_t))
+        {
+            return;
+        }
+
+        dlog_data_t header = {.dropped = m_dropped};
+        memcpy(frame, &header, sizeof(header));
+        usb_link_send(USB_LINK_MSG_DLOG_DATA, frame, (uint16_t)length);
+    }
+}
+
+#endif // DLOG_ENABLED
@@ -0,0 +1,99 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Dictionary logging: the format string of every DLOG_*() call goes into the
+// dlog_str section, which the linker script keeps out of the image (INFO).
+// The device only queues the offset of the string and up to DLOG_MAX_ARGS raw
+// 32-bit arguments, no formatting. tools/dlog_dict.py extracts the strings
+// from the .out file into a dictionary next to it, tools/dlog.py formats the
+// records the device sends over the USB link.
+//
+// Arguments are integers or characters (%d %i %u %x %X %o %c %p, length
+// modifiers ignored), pointers cast to uint32_t. Strings (%s) and floats
+// cannot be sent.
+// Queueing is lock-free from any context; a full buffer drops and counts.
+
+#define DLOG_LEVEL_ERROR   1
+#define DLOG_LEVEL_WARNING 2
+#define DLOG_LEVEL_INFO    3
+#define DLOG_LEVEL_DEBUG   4
+
+#define DLOG_MAX_ARGS 4
+
+// Dictionary entry: level, file:line and format, separated by DLOG_SEPARATOR
+#define DLOG_SEPARATOR "\x1f"
+
+// Record as queued; sent as timestamp, header and nargs arguments only
+typedef struct
+{
+    uint32_t timestamp;              // hires_timer_now_us(), low 32 bits
+    uint32_t header;                 // string offset | nargs << DLOG_NARGS_POS
+    uint32_t args[DLOG_MAX_ARGS];
+} dlog_record_t;
+
+#define DLOG_NARGS_POS 24
+#define DLOG_ID_MASK   ((1UL << DLOG_NARGS_POS) - 1)
+
+// USB_LINK_MSG_DLOG_DATA payload, followed by the records, each 8 + 4 * nargs bytes
+typedef struct
+{
+    uint32_t dropped;    // records lost since init
+} dlog_data_t;
+
+#if DLOG_ENABLED
+
+#define DLOG_STR_(x) #x
+#define DLOG_STR(x)  DLOG_STR_(x)
+
+extern char const __start_dlog_str[];
+
+#define DLOG(level, fmt, ...)                                                                \
+    do                                                                                       \
+    {                                                                                        \
+        if ((level) <= DLOG_LEVEL)                                                           \
+        {                                                                                    \
+            static char const dlog_string[] __attribute__((section("dlog_str"), used)) =     \
+                DLOG_STR(level) DLOG_SEPARATOR __FILE__ ":" DLOG_STR(__LINE__)               \
+                DLOG_SEPARATOR fmt;                                                          \
+            uint32_t const dlog_args[] = {0, ##__VA_ARGS__};                                 \
+            _Static_assert(sizeof(dlog_args) / sizeof(uint32_t) - 1 <= DLOG_MAX_ARGS,        \
+                           "too many DLOG arguments");                                       \
+            dlog_put((uint32_t)(dlog_string - __start_dlog_str),                             \
+                     sizeof(dlog_args) / sizeof(uint32_t) - 1, &dlog_args[1]);               \
+        }                                                                                    \
+    } while (0)
+
+void dlog_init(void);
+
+// Any context, called by the DLOG() macros
+void dlog_put(uint32_t id, uint32_t nargs, uint32_t const * p_args);
+
+// Oldest record, false if there is none. Main loop only.
+bool dlog_get(dlog_record_t * p_record);
+
+uint32_t dlog_dropped(void);
+
+// Send queued records while the host has the port open, main loop
+void dlog_process(void);
+
+#else
+
+#define DLOG(level, fmt, ...) (void)0
+
+static inline void dlog_init(void) {}
+static inline bool dlog_get(dlog_record_t * p_record) { return false; }
+static inline uint32_t dlog_dropped(void) { return 0; }
+static inline void dlog_process(void) {}
+
+#endif // DLOG_ENABLED
+
+#define DLOG_ERROR(...)   DLOG(DLOG_LEVEL_ERROR, __VA_ARGS__)
+#define DLOG_WARNING(...) DLOG(DLOG_LEVEL_WARNING, __VA_ARGS__)
+#define DLOG_INFO(...)    DLOG(DLOG_LEVEL_INFO, __VA_ARGS__)
+#define DLOG_DEBUG(...)   DLOG(DLOG_LEVEL_DEBUG, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,108 @@
+#include <string.h>
+#include "edge_stats.h"
+
+static uint32_t jitter_bucket(uint32_t deviation)
+{
+    uint32_t bucket = 0;
+
+    while (deviation != 0 && bucket < EDGE_STATS_JITTER_BUCKETS - 1)
+    {
+        deviation >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void period_add(edge_stats_result_t * p, uint32_t period)
+{
+    uint32_t deviation = period > p->nominal ? period - p->nominal : p->nominal - period;
+
+    if (period < p->period_min)
+    {
+        p->period_min = period;
+    }
+    if (period > p->period_max)
+    {
+        p->period_max = period;
+    }
+    p->periods++;
+    p->period_sum += period;
+    p->jitter_square_sum += (uint64_t)deviation * deviation;
+    p->jitter_histogram[jitter_bucket(deviation)]++;
+}
+
+void edge_stats_init(edge_stats_t * p_stats, uint32_t tick_hz, uint32_t nominal_ticks)
+{
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->result.tick_hz = tick_hz;
+    p_stats->result.nominal = nominal_ticks;
+    p_stats->result.period_min = UINT32_MAX;
+    p_stats->result.pulse_min = UINT32_MAX;
+}
+
+void edge_stats_edge(edge_stats_t * p_stats, uint32_t timestamp, bool on)
+{
+    edge_stats_result_t * p = &p_stats->result;
+
+    if (on)
+    {
+        if (p_stats->on_valid)
+        {
+            uint32_t period = timestamp - p_stats->last_on;
+
+            if (period <= p->nominal + p->nominal / 2)
+            {
+                period_add(p, period);
+            }
+            else
+            {
+                p->gaps++;
+            }
+        }
+        p_stats->last_on = timestamp;
+        p_stats->on_valid = true;
+    }
+    else if (p_stats->on_valid && p_stats->level_on)
+    {
+        uint32_t pulse = timestamp - p_stats->last_on;
+
+        // On through whole periods at 100 % is not a PWM pulse
+        if (pulse < p->nominal)
+        {
+            if (pulse < p->pulse_min)
+            {
+                p->pulse_min = pulse;
+            }
+            if (pulse > p->pulse_max)
+            {
+                p->pulse_max = pulse;
+            }
+            p->pulses++;
+        }
+    }
+
+    p_stats->level_on = on;
+}
+
+void edge_stats_lost(edge_stats_t * p_stats)
+{
+    if (p_stats->on_valid)
+    {
+        p_stats->result.gaps++;
+    }
+    p_stats->result.lost++;
+    p_stats->on_valid = false;
+}
+
+uint32_t edge_stats_jitter_max(edge_stats_result_t const * p_result)
+{
+    if (p_result->periods == 0)
+    {
+        return 0;
+    }
+
+    uint32_t below = p_result->period_min < p_result->nominal ? p_result->nominal - p_result->period_min : 0;
+    uint32_t above = p_result->period_max > p_result->nominal ? p_result->period_max - p_result->nominal : 0;
+
+    return below > above ? below : above;
+}
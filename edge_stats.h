@@ -0,0 +1,56 @@
+#ifndef EDGE_STATS_H
+#define EDGE_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Period and pulse width statistics of a PWM output from timestamped edges.
+// A period runs from one LED-on edge to the next, the pulse from the on edge
+// to the following off edge. Jitter is the distance of a period from the
+// nominal one. Hardware independent: the self-test feeds it TIMER captures,
+// the host simulator the edges of the GPIO model.
+//
+// Periods longer than 1.5 nominal periods (a frame at 0 % or 100 % has no
+// edges), periods across lost edges and pulses of a period or more are not
+// counted.
+
+#define EDGE_STATS_JITTER_BUCKETS 16
+
+typedef struct
+{
+    uint32_t tick_hz;          // timestamp clock
+    uint32_t nominal;          // expected period, ticks
+    uint32_t periods;
+    uint32_t pulses;
+    uint32_t gaps;             // periods not counted: too long or across lost edges
+    uint32_t lost;             // times edges were missed
+    uint32_t period_min;
+    uint32_t period_max;
+    uint64_t period_sum;
+    uint64_t jitter_square_sum;    // sum of (period - nominal)^2
+    uint32_t pulse_min;
+    uint32_t pulse_max;
+    // Periods by |period - nominal|: bucket 0 exact, bucket n in [2^(n-1), 2^n)
+    uint32_t jitter_histogram[EDGE_STATS_JITTER_BUCKETS];
+} edge_stats_result_t;
+
+typedef struct
+{
+    edge_stats_result_t result;
+    bool                on_valid;     // last_on belongs to the current run of edges
+    bool                level_on;
+    uint32_t            last_on;
+} edge_stats_t;
+
+void edge_stats_init(edge_stats_t * p_stats, uint32_t tick_hz, uint32_t nominal_ticks);
+
+// Edge at timestamp (ticks, wrapping), on: the LED switched on
+void edge_stats_edge(edge_stats_t * p_stats, uint32_t timestamp, bool on);
+
+// Edges were missed, the next period starts at the next on edge
+void edge_stats_lost(edge_stats_t * p_stats);
+
+// Largest |period - nominal| seen, from the shortest and longest period
+uint32_t edge_stats_jitter_max(edge_stats_result_t const * p_result);
+
+#endif
@@ -0,0 +1,44 @@
+#include "event_queue.h"
+#include "sdk_config.h"
+#include "nrf_atfifo.h"
+#include "nrf_atomic.h"
+#include "app_timer.h"
+#include "dlog.h"
+
+NRF_ATFIFO_DEF(m_fifo, event_t, EVENT_QUEUE_SIZE);
+
+static nrf_atomic_u32_t m_overflows;
+
+void event_queue_init(void)
+{
+    NRF_ATFIFO_INIT(m_fifo);
+    m_overflows = 0;
+}
+
+bool event_queue_put(event_type_t type, uint8_t arg)
+{
+    event_t const event =
+    {
+        .timestamp = app_timer_cnt_get(),
+        .type      = (uint8_t)type,
+        .arg       = arg
+    };
+
+    if (nrf_atfifo_alloc_put(m_fifo, &event, sizeof(event), NULL) != NRF_SUCCESS)
+    {
+        nrf_atomic_u32_add(&m_overflows, 1);
+        DLOG_WARNING("event queue full, event %u at %u lost", type, event.timestamp);
+        return false;
+    }
+    return true;
+}
+
+bool event_queue_get(event_t * p_event)
+{
+    return nrf_atfifo_get_free(m_fifo, p_event, sizeof(*p_event), NULL) == NRF_SUCCESS;
+}
+
+uint32_t event_queue_overflows(void)
+{
+    return m_overflows;
+}
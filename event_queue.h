@@ -0,0 +1,38 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Events from interrupt handlers to the main loop. ISRs only queue an event,
+// the main loop takes them out in the order they were queued and does the work.
+// Built on nrf_atfifo, so queueing is lock-free and safe from any priority.
+
+typedef enum
+{
+    EVENT_BUTTON_EDGE,            // arg: 1 pressed, 0 released (raw, not debounced)
+    EVENT_DEBOUNCE_TIMEOUT,
+    EVENT_GESTURE_TIMEOUT,
+    EVENT_FADE_DONE,              // arg: sequencer generation
+    EVENT_PAUSE_DONE              // arg: sequencer generation
+} event_type_t;
+
+typedef struct
+{
+    uint32_t timestamp;  // RTC ticks (app_timer_cnt_get) when the event was queued
+    uint8_t  type;       // event_type_t
+    uint8_t  arg;
+} event_t;
+
+void event_queue_init(void);
+
+// Queue an event from any context, false (and counted) if the queue is full
+bool event_queue_put(event_type_t type, uint8_t arg);
+
+// Oldest queued event, false if there is none. Main loop only.
+bool event_queue_get(event_t * p_event);
+
+// Events dropped because the queue was full, since init
+uint32_t event_queue_overflows(void);
+
+#endif
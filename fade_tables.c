@@ -0,0 +1,17 @@
+#include <stddef.h>
+#include "fade_tables.h"
+
+uint16_t const * fade_table_get(fade_curve_t curve, uint8_t bits)
+{
+    int column;
+
+    switch (bits)
+    {
+        case 8:  column = 0; break;
+        case 10: column = 1; break;
+        case 15: column = 2; break;
+        default: return NULL;
+    }
+
+    return curve < FADE_CURVE_COUNT ? fade_tables[curve][column] : NULL;
+}
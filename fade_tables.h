@@ -0,0 +1,28 @@
+#ifndef FADE_TABLES_H
+#define FADE_TABLES_H
+
+#include <stdint.h>
+
+// Fade curves generated at build time by tools/gen_fade_tables.py. Each table
+// holds FADE_TABLE_STEPS PWM compare values from off to full scale.
+
+#define FADE_TABLE_STEPS 101
+
+// Values of FADE_CURVE (see app_config.h)
+typedef enum
+{
+    FADE_CURVE_LINEAR,
+    FADE_CURVE_GAMMA22,
+    FADE_CURVE_CIE1931,
+    FADE_CURVE_COUNT
+} fade_curve_t;
+
+// Table columns: 8, 10 and 15 bit full scale
+#define FADE_RESOLUTION_COUNT 3
+
+extern uint16_t const * const fade_tables[FADE_CURVE_COUNT][FADE_RESOLUTION_COUNT];
+
+// NULL for a resolution that has no table
+uint16_t const * fade_table_get(fade_curve_t curve, uint8_t bits);
+
+#endif
@@ -0,0 +1,187 @@
+#include <string.h>
+#include "gesture.h"
+
+#define TICK_MASK  0x00FFFFFFUL
+#define TICKS_HALF ((TICK_MASK + 1) / 2)
+
+typedef enum
+{
+    STATE_IDLE,
+    STATE_DOWN,    // pressed, not yet long
+    STATE_UP,      // released after a click, waiting for the next one
+    STATE_HELD,    // long press, repeating
+    STATE_COUNT
+} state_t;
+
+typedef enum
+{
+    INPUT_PRESS,
+    INPUT_RELEASE,
+    INPUT_TIMEOUT,
+    INPUT_COUNT
+} input_t;
+
+typedef enum
+{
+    ACTION_NONE,
+    ACTION_CLICK_PRESS,    // count the press, deadline for a long press
+    ACTION_CLICK_RELEASE,  // resolve at once if unambiguous, else wait for the gap
+    ACTION_CLICKS_RESOLVE, // gap expired, report the click sequence
+    ACTION_LONG,           // report the long press, deadline for the first repeat
+    ACTION_REPEAT          // report a repeat, deadline for the next one
+} action_t;
+
+typedef struct
+{
+    uint8_t next;
+    uint8_t action;
+} transition_t;
+
+static const transition_t m_table[STATE_COUNT][INPUT_COUNT] =
+{
+    //               INPUT_PRESS                        INPUT_RELEASE                       INPUT_TIMEOUT
+    [STATE_IDLE] = { {STATE_DOWN, ACTION_CLICK_PRESS}, {STATE_IDLE, ACTION_NONE},          {STATE_IDLE, ACTION_NONE}           },
+    [STATE_DOWN] = { {STATE_DOWN, ACTION_NONE},        {STATE_UP,   ACTION_CLICK_RELEASE}, {STATE_HELD, ACTION_LONG}           },
+    [STATE_UP]   = { {STATE_DOWN, ACTION_CLICK_PRESS}, {STATE_UP,   ACTION_NONE},          {STATE_IDLE, ACTION_CLICKS_RESOLVE} },
+    [STATE_HELD] = { {STATE_HELD, ACTION_NONE},        {STATE_IDLE, ACTION_NONE},          {STATE_HELD, ACTION_REPEAT}         },
+};
+
+static bool report(gesture_t * p, gesture_type_t type, uint8_t count, uint32_t timestamp,
+                   gesture_event_t * p_event)
+{
+    if ((p->enabled & GESTURE_MASK(type)) == 0)
+    {
+        return false;
+    }
+
+    p_event->type = (uint8_t)type;
+    p_event->count = count;
+    p_event->timestamp = timestamp;
+    return true;
+}
+
+static bool clicks_report(gesture_t * p, gesture_event_t * p_event)
+{
+    uint8_t clicks = p->clicks;
+
+    p->clicks = 0;
+    return report(p, (gesture_type_t)(GESTURE_SINGLE_CLICK + clicks - 1), 0, p->start, p_event);
+}
+
+static void deadline_set(gesture_t * p, uint32_t timestamp)
+{
+    p->deadline = timestamp & TICK_MASK;
+    p->deadline_set = true;
+}
+
+static bool input_handle(gesture_t * p, input_t input, uint32_t timestamp,
+                         gesture_event_t * p_event)
+{
+    transition_t const * p_transition = &m_table[p->state][input];
+    bool reported = false;
+
+    p->state = p_transition->next;
+
+    switch (p_transition->action)
+    {
+        case ACTION_CLICK_PRESS:
+            if (p->clicks == 0)
+            {
+                p->start = timestamp;
+            }
+            p->clicks++;
+            p->last_press = timestamp;
+            deadline_set(p, timestamp + p->config.long_press_ticks);
+            break;
+
+        case ACTION_CLICK_RELEASE:
+            if (p->clicks >= p->max_clicks)
+            {
+                reported = clicks_report(p, p_event);
+                p->state = STATE_IDLE;
+            }
+            else
+            {
+                deadline_set(p, timestamp + p->config.click_gap_ticks);
+            }
+            break;
+
+        case ACTION_CLICKS_RESOLVE:
+            reported = clicks_report(p, p_event);
+            break;
+
+        case ACTION_LONG:
+            p->clicks = 0;
+            p->repeats = 0;
+            reported = report(p, GESTURE_LONG_PRESS, 0, p->last_press, p_event);
+            deadline_set(p, timestamp + p->config.repeat_ticks);
+            break;
+
+        case ACTION_REPEAT:
+            if (p->repeats < UINT8_MAX)
+            {
+                p->repeats++;
+            }
+            reported = report(p, GESTURE_HOLD_REPEAT, p->repeats, timestamp, p_event);
+            deadline_set(p, timestamp + p->config.repeat_ticks);
+            break;
+
+        default:
+            break;
+    }
+
+    // Other inputs keep the pending deadline, a finished gesture has none
+    if (p->state == STATE_IDLE)
+    {
+        p->deadline_set = false;
+    }
+
+    return reported;
+}
+
+void gesture_init(gesture_t * p_gesture, gesture_config_t const * p_config, uint32_t enabled)
+{
+    memset(p_gesture, 0, sizeof(*p_gesture));
+    p_gesture->config = *p_config;
+    p_gesture->enabled = enabled;
+    p_gesture->state = STATE_IDLE;
+
+    // Clicks beyond the longest enabled sequence cannot change the outcome
+    p_gesture->max_clicks = 1;
+    for (uint8_t clicks = 1; clicks <= GESTURE_MAX_CLICKS; clicks++)
+    {
+        if (enabled & GESTURE_MASK(GESTURE_SINGLE_CLICK + clicks - 1))
+        {
+            p_gesture->max_clicks = clicks;
+        }
+    }
+}
+
+void gesture_config_set(gesture_t * p_gesture, gesture_config_t const * p_config)
+{
+    p_gesture->config = *p_config;
+}
+
+bool gesture_edge(gesture_t * p_gesture, bool pressed, uint32_t timestamp,
+                  gesture_event_t * p_event)
+{
+    return input_handle(p_gesture, pressed ? INPUT_PRESS : INPUT_RELEASE, timestamp, p_event);
+}
+
+bool gesture_deadline(gesture_t const * p_gesture, uint32_t * p_deadline)
+{
+    *p_deadline = p_gesture->deadline;
+    return p_gesture->deadline_set;
+}
+
+bool gesture_timeout(gesture_t * p_gesture, uint32_t timestamp, gesture_event_t * p_event)
+{
+    if (!p_gesture->deadline_set ||
+        ((timestamp - p_gesture->deadline) & TICK_MASK) >= TICKS_HALF)
+    {
+        return false;
+    }
+
+    // Chained deadlines (repeats) keep their own time base, not the late caller's
+    return input_handle(p_gesture, INPUT_TIMEOUT, p_gesture->deadline, p_event);
+}
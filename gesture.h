@@ -0,0 +1,72 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Button gestures from debounced, timestamped press and release edges. The
+// recognizer is a transition table over (state, input), the inputs being
+// press, release and timeout. Times are RTC ticks (24-bit, wrapping) like the
+// debouncer output; hardware independent, the host build runs it on scripts.
+//
+// A click sequence is resolved at the release that makes it unambiguous: when
+// no longer sequence is enabled, the gesture is reported at once, otherwise
+// after click_gap_ticks without a new press. A deadline reached exactly at the
+// time of a press counts as expired, the press starts a new gesture.
+
+typedef enum
+{
+    GESTURE_SINGLE_CLICK,
+    GESTURE_DOUBLE_CLICK,
+    GESTURE_TRIPLE_CLICK,
+    GESTURE_LONG_PRESS,    // held for long_press_ticks
+    GESTURE_HOLD_REPEAT,   // every repeat_ticks while still held after a long press
+    GESTURE_COUNT
+} gesture_type_t;
+
+#define GESTURE_MASK(type) (1U << (type))
+#define GESTURE_MAX_CLICKS 3
+
+typedef struct
+{
+    uint32_t click_gap_ticks;   // longest release between clicks of one gesture
+    uint32_t long_press_ticks;  // shortest press that is not a click
+    uint32_t repeat_ticks;      // hold-repeat interval
+} gesture_config_t;
+
+typedef struct
+{
+    uint8_t  type;       // gesture_type_t
+    uint8_t  count;      // GESTURE_HOLD_REPEAT: 1, 2, ...
+    uint32_t timestamp;  // first press (clicks), the long press, or the repeat deadline
+} gesture_event_t;
+
+typedef struct
+{
+    gesture_config_t config;
+    uint32_t enabled;        // GESTURE_MASK() of the gestures to report
+    uint8_t  max_clicks;     // longest enabled click sequence
+    uint8_t  state;
+    uint8_t  clicks;
+    uint8_t  repeats;
+    bool     deadline_set;
+    uint32_t deadline;
+    uint32_t start;          // first press of the gesture
+    uint32_t last_press;
+} gesture_t;
+
+void gesture_init(gesture_t * p_gesture, gesture_config_t const * p_config, uint32_t enabled);
+
+// New times, from the next deadline on: one already set stays
+void gesture_config_set(gesture_t * p_gesture, gesture_config_t const * p_config);
+
+// Debounced edge. Call gesture_timeout() with the same timestamp first.
+bool gesture_edge(gesture_t * p_gesture, bool pressed, uint32_t timestamp,
+                  gesture_event_t * p_event);
+
+// When gesture_timeout() has to be called next, false if not needed
+bool gesture_deadline(gesture_t const * p_gesture, uint32_t * p_deadline);
+
+bool gesture_timeout(gesture_t * p_gesture, uint32_t timestamp, gesture_event_t * p_event);
+
+#endif
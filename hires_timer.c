@@ -0,0 +1,380 @@
+#include <stddef.h>
+#include "hires_timer.h"
+#include "sdk_config.h"
+#include "nrfx_rtc.h"
+#include "nrfx_timer.h"
+#include "nrfx_ppi.h"
+#include "app_util_platform.h"
+
+// Time base: RTC ticks extended to 64 bit with an overflow count. It is the
+// only clock that is counted: the fine TIMER (1 MHz on the HFCLK, which may be
+// the 1.5 % HFINT) only refines the current tick and times the wait to the
+// next deadline, so its clock error never adds up. A deadline d is split into
+// the last RTC tick k before d and a remainder of 1..31 us:
+//  - RTC CC0 = k, its COMPARE event starts the fine TIMER through PPI,
+//  - the fine TIMER (1 MHz, cleared) interrupts on CC0 = d - time(k).
+// While it runs, every RTC TICK event captures its count into TICK_CC through
+// PPI, and the microseconds counted since refine the tick. While the next
+// deadline is closer than HIRES_TIMER_FINE_WINDOW_US the fine TIMER keeps
+// running and the next compare is set from the refined time, otherwise it is
+// shut down and the HFCLK is released until the RTC starts it again.
+
+#define RTC_COUNTER_BITS 24
+#define RTC_COUNTER_MASK ((1UL << RTC_COUNTER_BITS) - 1)
+
+// A compare value less than two ticks ahead of the counter may be missed
+#define RTC_MIN_TICKS_AHEAD 3
+
+// Farther deadlines are approached in steps of half the counter range, so
+// that a compare value is never mistaken for one in the previous round
+#define RTC_MAX_TICKS_AHEAD (1UL << (RTC_COUNTER_BITS - 1))
+
+// Closest the wake compare is set ahead of the fine TIMER count
+#define FINE_MIN_AHEAD_US 2
+
+#define RTC_START_CC 0
+#define WAKE_CC      NRF_TIMER_CC_CHANNEL0
+#define NOW_CC       NRF_TIMER_CC_CHANNEL1
+#define TICK_CC      NRF_TIMER_CC_CHANNEL2
+
+static const nrfx_rtc_t m_rtc = NRFX_RTC_INSTANCE(HIRES_TIMER_RTC_INSTANCE);
+static const nrfx_timer_t m_timer = NRFX_TIMER_INSTANCE(HIRES_TIMER_TIMER_INSTANCE);
+static nrf_ppi_channel_t m_ppi_start;  // RTC COMPARE -> TIMER START
+static nrf_ppi_channel_t m_ppi_tick;   // RTC TICK -> TIMER CAPTURE[TICK_CC]
+
+static hires_timer_t * mp_head;        // Pending timers, earliest first
+static volatile uint32_t m_overflows;
+static uint64_t m_start_ticks;         // Tick on which the armed fine TIMER starts
+static uint64_t m_floor_us;            // Time read when the fine TIMER last stopped
+static bool m_fine_running;
+static bool m_fine_armed;              // Waiting for the RTC to start it
+
+// 1 tick = 1000000 / 32768 us = 15625 / 512 us
+static uint64_t ticks_to_us(uint64_t ticks)
+{
+    return (ticks * 15625) >> 9;
+}
+
+static uint64_t us_to_ticks(uint64_t us)
+{
+    return (us << 9) / 15625;
+}
+
+static uint64_t rtc_ticks(void)
+{
+    uint32_t overflows;
+    uint32_t counter;
+
+    do
+    {
+        overflows = m_overflows;
+        counter = nrfx_rtc_counter_get(&m_rtc);
+    } while (overflows != m_overflows);
+
+    // Wrapped, but the overflow interrupt is masked by the caller
+    if (nrf_rtc_event_pending(m_rtc.p_reg, NRF_RTC_EVENT_OVERFLOW) && counter < RTC_MAX_TICKS_AHEAD)
+    {
+        overflows++;
+    }
+
+    return ((uint64_t)overflows << RTC_COUNTER_BITS) | counter;
+}
+
+// Current time and, while the fine TIMER runs, its count at that time. The
+// RTC alone lags by up to a tick, so after the fine TIMER stops the time
+// holds at the last refined reading until the RTC has caught up with it.
+static uint64_t now_us(uint32_t * p_count)
+{
+    uint64_t now;
+
+    if (m_fine_running)
+    {
+        uint64_t ticks;
+        uint32_t count;
+        uint32_t tick_count;
+
+        do
+        {
+            ticks = rtc_ticks();
+            tick_count = nrfx_timer_capture_get(&m_timer, TICK_CC);
+            count = nrfx_timer_capture(&m_timer, NOW_CC);
+        } while (ticks != rtc_ticks());
+
+        uint64_t tick_us = ticks_to_us(ticks);
+        uint32_t tick_length = (uint32_t)(ticks_to_us(ticks + 1) - tick_us);
+        uint32_t since_tick = count - tick_count;
+
+        // A fast TIMER does not run into the next tick
+        now = tick_us + (since_tick < tick_length ? since_tick : tick_length - 1);
+        if (p_count != NULL)
+        {
+            *p_count = count;
+        }
+    }
+    else
+    {
+        now = ticks_to_us(rtc_ticks());
+    }
+
+    return now > m_floor_us ? now : m_floor_us;
+}
+
+// Route the RTC ticks to the fine TIMER, which counted tick_count on the last one
+static void fine_tick_start(uint32_t tick_count)
+{
+    nrfx_timer_compare(&m_timer, TICK_CC, tick_count, false);
+    nrfx_rtc_tick_enable(&m_rtc, false);
+    nrfx_ppi_channel_enable(m_ppi_tick);
+    m_fine_running = true;
+}
+
+static void fine_stop(void)
+{
+    if (m_fine_running)
+    {
+        m_floor_us = now_us(NULL);
+    }
+    nrfx_ppi_channel_disable(m_ppi_start);
+    nrfx_ppi_channel_disable(m_ppi_tick);
+    nrfx_rtc_tick_disable(&m_rtc);
+    nrfx_rtc_cc_disable(&m_rtc, RTC_START_CC);
+    nrfx_timer_compare_int_disable(&m_timer, WAKE_CC);
+    nrfx_timer_disable(&m_timer);
+    nrfx_timer_clear(&m_timer);
+    m_fine_running = false;
+    m_fine_armed = false;
+}
+
+static void fine_compare_set(uint64_t deadline_us)
+{
+    uint32_t count = 0;
+    uint64_t now = now_us(&count);
+
+    // A deadline that has already passed fires right away instead of after a
+    // wrap; the TIMER count itself wraps with the compare value
+    uint32_t ahead = deadline_us > now + FINE_MIN_AHEAD_US ? (uint32_t)(deadline_us - now) : FINE_MIN_AHEAD_US;
+
+    nrfx_timer_compare(&m_timer, WAKE_CC, count + ahead, true);
+}
+
+// Program the hardware for the earliest pending deadline
+static void schedule(void)
+{
+    if (mp_head == NULL)
+    {
+        fine_stop();
+        return;
+    }
+
+    uint64_t deadline_us = mp_head->deadline_us;
+
+    if (m_fine_running)
+    {
+        if (deadline_us < now_us(NULL) + HIRES_TIMER_FINE_WINDOW_US)
+        {
+            fine_compare_set(deadline_us);
+            return;
+        }
+    }
+    fine_stop();
+
+    uint64_t now_ticks = rtc_ticks();
+    uint64_t start_ticks = us_to_ticks(deadline_us > 0 ? deadline_us - 1 : 0);
+
+    if (start_ticks < now_ticks + RTC_MIN_TICKS_AHEAD)
+    {
+        // Too close for the RTC, count from now. The current tick has passed
+        // at least up to the time read last, which the TIMER continues from.
+        uint64_t tick_us = ticks_to_us(now_ticks);
+        uint32_t tick_length = (uint32_t)(ticks_to_us(now_ticks + 1) - tick_us);
+        uint32_t into_tick = m_floor_us > tick_us ? (uint32_t)(m_floor_us - tick_us) : 0;
+
+        if (into_tick >= tick_length)
+        {
+            into_tick = tick_length - 1;
+        }
+        nrfx_timer_enable(&m_timer);
+        fine_tick_start(0 - into_tick);
+        fine_compare_set(deadline_us);
+    }
+    else if (start_ticks - now_ticks < RTC_MAX_TICKS_AHEAD)
+    {
+        nrfx_timer_compare(&m_timer, WAKE_CC, (uint32_t)(deadline_us - ticks_to_us(start_ticks)), true);
+        nrfx_rtc_cc_set(&m_rtc, RTC_START_CC, (uint32_t)start_ticks & RTC_COUNTER_MASK, false);
+        nrfx_ppi_channel_enable(m_ppi_start);
+        m_start_ticks = start_ticks;
+        m_fine_armed = true;
+    }
+    else
+    {
+        nrfx_rtc_cc_set(&m_rtc, RTC_START_CC, (uint32_t)(now_ticks + RTC_MAX_TICKS_AHEAD) & RTC_COUNTER_MASK, true);
+    }
+}
+
+static void list_remove(hires_timer_t * p_timer)
+{
+    hires_timer_t ** pp = &mp_head;
+
+    while (*pp != NULL && *pp != p_timer)
+    {
+        pp = &(*pp)->p_next;
+    }
+    if (*pp != NULL)
+    {
+        *pp = p_timer->p_next;
+    }
+    p_timer->active = false;
+}
+
+static void timers_expire(void)
+{
+    while (true)
+    {
+        hires_timer_t * p_timer = NULL;
+
+        CRITICAL_REGION_ENTER();
+        if (mp_head != NULL && mp_head->deadline_us <= now_us(NULL))
+        {
+            p_timer = mp_head;
+            mp_head = p_timer->p_next;
+            p_timer->active = false;
+        }
+        CRITICAL_REGION_EXIT();
+
+        if (p_timer == NULL)
+        {
+            break;
+        }
+        p_timer->handler(p_timer->p_context);
+    }
+
+    CRITICAL_REGION_ENTER();
+    schedule();
+    CRITICAL_REGION_EXIT();
+}
+
+static void timer_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    if (event_type != NRF_TIMER_EVENT_COMPARE0)
+    {
+        return;
+    }
+
+    if (m_fine_armed)
+    {
+        // Started by the RTC on m_start_ticks, and the wake compare may come
+        // a tick later: the TIMER passed that one after its duration in us
+        nrfx_ppi_channel_disable(m_ppi_start);
+        nrfx_rtc_cc_disable(&m_rtc, RTC_START_CC);
+        m_fine_armed = false;
+        fine_tick_start((uint32_t)(ticks_to_us(rtc_ticks()) - ticks_to_us(m_start_ticks)));
+    }
+    timers_expire();
+}
+
+static void rtc_handler(nrfx_rtc_int_type_t int_type)
+{
+    if (int_type == NRFX_RTC_INT_OVERFLOW)
+    {
+        m_overflows++;
+    }
+    else if (int_type == NRFX_RTC_INT_COMPARE0 && !m_fine_armed)
+    {
+        // Half way to a deadline that was too far for the compare register
+        CRITICAL_REGION_ENTER();
+        schedule();
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+void hires_timer_init(void)
+{
+    nrfx_rtc_config_t rtc_config = NRFX_RTC_DEFAULT_CONFIG;
+    nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+
+    rtc_config.prescaler = 0;
+    nrfx_rtc_init(&m_rtc, &rtc_config, rtc_handler);
+    nrfx_rtc_overflow_enable(&m_rtc, true);
+
+    timer_config.frequency = NRF_TIMER_FREQ_1MHz;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+    nrfx_timer_init(&m_timer, &timer_config, timer_handler);
+
+    nrfx_ppi_channel_alloc(&m_ppi_start);
+    nrfx_ppi_channel_assign(m_ppi_start,
+                            nrfx_rtc_event_address_get(&m_rtc, NRF_RTC_EVENT_COMPARE_0),
+                            nrfx_timer_task_address_get(&m_timer, NRF_TIMER_TASK_START));
+    nrfx_ppi_channel_alloc(&m_ppi_tick);
+    nrfx_ppi_channel_assign(m_ppi_tick,
+                            nrfx_rtc_event_address_get(&m_rtc, NRF_RTC_EVENT_TICK),
+                            nrfx_timer_capture_task_address_get(&m_timer, TICK_CC));
+
+    nrfx_rtc_enable(&m_rtc);
+}
+
+uint64_t hires_timer_now_us(void)
+{
+    uint64_t now;
+
+    CRITICAL_REGION_ENTER();
+    now = now_us(NULL);
+    CRITICAL_REGION_EXIT();
+
+    return now;
+}
+
+void hires_timer_start_at(hires_timer_t * p_timer, uint64_t deadline_us,
+                          hires_timer_handler_t handler, void * p_context)
+{
+    CRITICAL_REGION_ENTER();
+
+    if (p_timer->active)
+    {
+        list_remove(p_timer);
+    }
+
+    p_timer->deadline_us = deadline_us;
+    p_timer->handler = handler;
+    p_timer->p_context = p_context;
+    p_timer->active = true;
+
+    // Behind the timers with the same deadline, so they fire in start order
+    hires_timer_t ** pp = &mp_head;
+    while (*pp != NULL && (*pp)->deadline_us <= deadline_us)
+    {
+        pp = &(*pp)->p_next;
+    }
+    p_timer->p_next = *pp;
+    *pp = p_timer;
+
+    if (mp_head == p_timer)
+    {
+        schedule();
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+void hires_timer_start(hires_timer_t * p_timer, uint32_t delay_us,
+                       hires_timer_handler_t handler, void * p_context)
+{
+    hires_timer_start_at(p_timer, hires_timer_now_us() + delay_us, handler, p_context);
+}
+
+void hires_timer_stop(hires_timer_t * p_timer)
+{
+    CRITICAL_REGION_ENTER();
+
+    if (p_timer->active)
+    {
+        bool was_head = (mp_head == p_timer);
+
+        list_remove(p_timer);
+        if (was_head)
+        {
+            schedule();
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+}
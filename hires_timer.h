@@ -0,0 +1,46 @@
+#ifndef HIRES_TIMER_H
+#define HIRES_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// One-shot callbacks with microsecond resolution that let the CPU sleep.
+// Long waits run on the RTC (32.768 kHz, LFCLK only). The RTC compare event
+// starts a 1 MHz TIMER through PPI exactly on the last tick before the
+// deadline, and the TIMER covers the remaining sub-tick part. Deadlines that
+// follow each other within HIRES_TIMER_FINE_WINDOW_US keep the TIMER running.
+// Time is counted on the RTC alone, the TIMER needs no HFXO: its clock error
+// only applies to the part of a tick and to one wait of at most
+// HIRES_TIMER_FINE_WINDOW_US.
+//
+// Handlers run in interrupt context (TIMER/RTC IRQ priority).
+
+typedef void (*hires_timer_handler_t)(void * p_context);
+
+typedef struct hires_timer_s
+{
+    struct hires_timer_s * p_next;
+    uint64_t               deadline_us;
+    hires_timer_handler_t  handler;
+    void *                 p_context;
+    bool                   active;
+} hires_timer_t;
+
+void hires_timer_init(void);
+
+// Microseconds since hires_timer_init(), to the microsecond while the TIMER
+// runs and with RTC tick resolution (30.5 us) otherwise. Never steps back.
+uint64_t hires_timer_now_us(void);
+
+// Fire at an absolute time on the hires_timer_now_us() time base. Chaining
+// deadlines (deadline += period) does not accumulate drift.
+void hires_timer_start_at(hires_timer_t * p_timer, uint64_t deadline_us,
+                          hires_timer_handler_t handler, void * p_context);
+
+// Fire delay_us from now
+void hires_timer_start(hires_timer_t * p_timer, uint32_t delay_us,
+                       hires_timer_handler_t handler, void * p_context);
+
+void hires_timer_stop(hires_timer_t * p_timer);
+
+#endif
@@ -0,0 +1,139 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "led_animation.h"
+
+// Checks the Q16 keyframe evaluation against floating point:
+//  - every easing from 0 to full scale, monotonic, within 2 LSB of the curve,
+//  - a timeline through all easings sampled every 0.1 ms, within 4 LSB: the
+//    progress is Q16 as well, and the steepest easing (cubic) triples its error,
+//  - levels before the first and after the last keyframe.
+
+#define Q16 65536.0
+
+static const led_keyframe_t m_keyframes[] =
+{
+    {100,  LED_EASING_LINEAR,      0},
+    {350,  LED_EASING_EASE_IN,     LED_ANIMATION_FULL},
+    {351,  LED_EASING_EASE_OUT,    LED_ANIMATION_FULL / 4},
+    {1000, LED_EASING_EASE_IN_OUT, 3 * LED_ANIMATION_FULL / 4},
+    {1700, LED_EASING_CUBIC,       LED_ANIMATION_FULL / 8},
+    {2300, LED_EASING_STEP,        LED_ANIMATION_FULL},
+    {2400, LED_EASING_LINEAR,      LED_ANIMATION_FULL / 2},
+};
+
+static const led_timeline_t m_timeline = {m_keyframes, sizeof(m_keyframes) / sizeof(m_keyframes[0])};
+
+static char const * const m_names[LED_EASING_COUNT] =
+{
+    "linear", "ease_in", "ease_out", "ease_in_out", "cubic", "step"
+};
+
+static double easing_reference(led_easing_t easing, double u)
+{
+    switch (easing)
+    {
+        case LED_EASING_EASE_IN:     return u * u;
+        case LED_EASING_EASE_OUT:    return 1 - (1 - u) * (1 - u);
+        case LED_EASING_EASE_IN_OUT: return u < 0.5 ? 2 * u * u : 1 - 2 * (1 - u) * (1 - u);
+        case LED_EASING_CUBIC:       return u < 0.5 ? 4 * u * u * u : 1 - 4 * (1 - u) * (1 - u) * (1 - u);
+        case LED_EASING_STEP:        return 0;
+        default:                     return u;
+    }
+}
+
+static double level_reference(double time_ms)
+{
+    uint8_t count = m_timeline.count;
+
+    if (time_ms <= m_keyframes[0].time_ms)
+    {
+        return m_keyframes[0].level;
+    }
+    for (uint8_t i = 0; i + 1 < count; i++)
+    {
+        led_keyframe_t const * p_from = &m_keyframes[i];
+        led_keyframe_t const * p_to = &m_keyframes[i + 1];
+        if (time_ms < p_to->time_ms)
+        {
+            double u = (time_ms - p_from->time_ms) / (p_to->time_ms - p_from->time_ms);
+            double e = easing_reference((led_easing_t)p_from->easing, u);
+            return p_from->level + (double)((int32_t)p_to->level - (int32_t)p_from->level) * e;
+        }
+    }
+    return m_keyframes[count - 1].level;
+}
+
+static bool easings_check(void)
+{
+    bool ok = true;
+
+    for (int easing = 0; easing < LED_EASING_COUNT; easing++)
+    {
+        uint32_t previous = 0;
+        double error_max = 0;
+        bool monotonic = true;
+
+        for (uint32_t u = 0; u <= LED_ANIMATION_FULL; u += 16)
+        {
+            uint32_t e = led_easing((led_easing_t)easing, u);
+            double error = fabs(e - easing_reference((led_easing_t)easing, u / Q16) * Q16);
+
+            error_max = error > error_max ? error : error_max;
+            monotonic &= e >= previous;
+            previous = e;
+        }
+
+        bool ends = led_easing((led_easing_t)easing, 0) == 0 &&
+                    (easing == LED_EASING_STEP ||
+                     led_easing((led_easing_t)easing, LED_ANIMATION_FULL) == LED_ANIMATION_FULL);
+        bool pass = ends && monotonic && error_max <= 2;
+
+        printf("%s %-12s error max %.1f LSB%s%s\n", pass ? "ok  " : "FAIL", m_names[easing], error_max,
+               ends ? "" : ", wrong end points", monotonic ? "" : ", not monotonic");
+        ok &= pass;
+    }
+
+    return ok;
+}
+
+static bool timeline_check(void)
+{
+    led_animation_t animation;
+    double error_max = 0;
+    uint32_t samples = 0;
+
+    led_animation_init(&animation, &m_timeline);
+
+    // 0.1 ms steps from before the first to after the last keyframe
+    for (uint32_t tenth = 0; tenth <= 25000; tenth++)
+    {
+        uint32_t time = (uint32_t)(((uint64_t)tenth << 16) / 10);
+        uint32_t level = led_animation_level(&animation, time);
+        double error = fabs(level - level_reference(time / Q16));
+
+        error_max = error > error_max ? error : error_max;
+        samples++;
+    }
+
+    bool before = led_animation_level(&animation, LED_ANIMATION_MS(3000)) == LED_ANIMATION_FULL / 2;
+    led_animation_init(&animation, &m_timeline);
+    before &= led_animation_level(&animation, 0) == 0;
+
+    bool pass = error_max <= 4 && before;
+    printf("%s timeline     %u samples, error max %.1f LSB, %u ms%s\n", pass ? "ok  " : "FAIL",
+           samples, error_max, led_timeline_duration_ms(&m_timeline),
+           before ? "" : ", wrong level outside the keyframes");
+
+    return pass;
+}
+
+int main(void)
+{
+    bool ok = easings_check();
+
+    ok &= timeline_check();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
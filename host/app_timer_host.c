@@ -0,0 +1,84 @@
+#include <stddef.h>
+#include "app_timer.h"
+#include "sim.h"
+
+#define RTC_HZ APP_TIMER_CLOCK_FREQ
+
+static uint64_t ticks_now(void)
+{
+    return (sim_time_ns() * RTC_HZ) / 1000000000ULL;
+}
+
+// Virtual time at which the RTC counter reaches ticks
+static uint64_t ticks_to_ns(uint64_t ticks)
+{
+    return (ticks * 1000000000ULL + RTC_HZ - 1) / RTC_HZ;
+}
+
+static void timer_expired(void * p_context)
+{
+    app_timer_t * p_timer = p_context;
+
+    if (p_timer->mode == APP_TIMER_MODE_REPEATED)
+    {
+        sim_schedule(ticks_to_ns(ticks_now() + p_timer->ticks), timer_expired, p_timer);
+    }
+    else
+    {
+        p_timer->active = false;
+    }
+    p_timer->handler(p_timer->p_context);
+}
+
+ret_code_t app_timer_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler)
+{
+    app_timer_t * p_timer = *p_timer_id;
+
+    p_timer->handler = timeout_handler;
+    p_timer->mode = mode;
+    p_timer->active = false;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Like app_timer2, starting a running timer has no effect
+    if (timer_id->active)
+    {
+        return NRF_SUCCESS;
+    }
+
+    timer_id->ticks = timeout_ticks;
+    timer_id->p_context = p_context;
+    timer_id->active = true;
+    sim_schedule(ticks_to_ns(ticks_now() + timeout_ticks), timer_expired, timer_id);
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+    sim_cancel(timer_expired, timer_id);
+    timer_id->active = false;
+    return NRF_SUCCESS;
+}
+
+uint32_t app_timer_cnt_get(void)
+{
+    return (uint32_t)ticks_now() & APP_TIMER_MAX_CNT_VAL;
+}
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+    return (ticks_to - ticks_from) & APP_TIMER_MAX_CNT_VAL;
+}
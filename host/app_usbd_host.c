@@ -0,0 +1,316 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "app_usbd.h"
+#include "app_usbd_cdc_acm.h"
+#include "nrfx_power.h"
+#include "sim.h"
+
+// app_usbd and its CDC ACM class on a pseudo terminal, see app_usbd_cdc_acm.h.
+// The stack only runs the one class instance; control transfers, descriptors
+// and suspend are not modelled. Opening and closing of the slave side are
+// seen by host_cdc_acm_poll(), which cdc_pty calls all along.
+
+#define QUEUE_SIZE  32
+#define FRAME_NS    1000000ULL
+#define PACKET_NS   (FRAME_NS / HOST_CDC_ACM_PACKETS_PER_FRAME)
+
+#define HANGUP_TIMEOUT_MS 1000
+
+typedef struct
+{
+    bool    state;                  // app_usbd_event_type_t, else a CDC ACM event
+    uint8_t type;
+} queued_event_t;
+
+static app_usbd_config_t m_config;
+static app_usbd_cdc_acm_t const * mp_cdc_acm;
+static bool m_enabled;
+static bool m_started;
+
+static queued_event_t m_queue[QUEUE_SIZE];
+static uint32_t m_queue_head;
+static uint32_t m_queue_count;
+
+static int m_fd = -1;
+static bool m_dtr;
+static uint32_t m_session;          // counts the opens of the port
+
+// The IN transfer in flight, read from the caller's buffer like the EasyDMA
+static uint8_t const * mp_tx;
+static size_t m_tx_length;
+static size_t m_tx_sent;
+static uint32_t m_tx_session;
+static bool m_tx_busy;
+
+// The buffer given to read_any, waiting for OUT data
+static uint8_t * mp_rx;
+static size_t m_rx_length;
+static size_t m_rx_size;
+static bool m_rx_pending;
+
+static host_cdc_acm_stats_t m_stats;
+
+static void event_put(bool state, uint8_t type)
+{
+    if (m_queue_count == QUEUE_SIZE)
+    {
+        fprintf(stderr, "app_usbd: event queue full\n");
+        abort();
+    }
+    m_queue[(m_queue_head + m_queue_count++) % QUEUE_SIZE] = (queued_event_t){state, type};
+}
+
+bool nrf_drv_usbd_is_enabled(void)
+{
+    return m_enabled;
+}
+
+ret_code_t app_usbd_init(app_usbd_config_t const * p_config)
+{
+    m_config = *p_config;
+    return NRF_SUCCESS;
+}
+
+void app_usbd_enable(void)
+{
+    m_enabled = true;
+}
+
+void app_usbd_disable(void)
+{
+    m_enabled = false;
+}
+
+void app_usbd_start(void)
+{
+    m_started = m_enabled;
+}
+
+void app_usbd_stop(void)
+{
+    m_started = false;
+}
+
+ret_code_t app_usbd_class_append(app_usbd_class_inst_t const * p_instance)
+{
+    mp_cdc_acm = app_usbd_cdc_acm_class_get(p_instance);
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_usbd_power_events_enable(void)
+{
+    if (nrfx_power_usbstatus_get() != NRFX_POWER_USB_STATE_DISCONNECTED)
+    {
+        event_put(true, APP_USBD_EVT_POWER_DETECTED);
+        event_put(true, APP_USBD_EVT_POWER_READY);
+    }
+    return NRF_SUCCESS;
+}
+
+bool app_usbd_event_queue_process(void)
+{
+    if (m_queue_count == 0)
+    {
+        return false;
+    }
+
+    queued_event_t event = m_queue[m_queue_head];
+    m_queue_head = (m_queue_head + 1) % QUEUE_SIZE;
+    m_queue_count--;
+
+    if (event.state)
+    {
+        if (m_config.ev_state_proc != NULL)
+        {
+            m_config.ev_state_proc((app_usbd_event_type_t)event.type);
+        }
+    }
+    else if (mp_cdc_acm != NULL)
+    {
+        mp_cdc_acm->user_ev_handler(&mp_cdc_acm->base, (app_usbd_cdc_acm_user_event_t)event.type);
+    }
+    return true;
+}
+
+// The host has read the packets of the transfer. Bytes the pty does not take
+// yet are NAKed and go in the next frame.
+static void tx_done(void * p_context)
+{
+    if (m_tx_session == m_session && m_dtr)
+    {
+        ssize_t written = write(m_fd, &mp_tx[m_tx_sent], m_tx_length - m_tx_sent);
+
+        if (written > 0)
+        {
+            m_tx_sent += written;
+            m_stats.bytes_in += written;
+        }
+        if (m_tx_sent < m_tx_length)
+        {
+            sim_schedule(sim_time_ns() + FRAME_NS, tx_done, NULL);
+            return;
+        }
+    }
+    else
+    {
+        m_stats.stale++;
+    }
+
+    m_tx_busy = false;
+    event_put(false, APP_USBD_CDC_ACM_USER_EVT_TX_DONE);
+}
+
+ret_code_t app_usbd_cdc_acm_write(app_usbd_cdc_acm_t const * p_cdc_acm, void const * p_buf, size_t length)
+{
+    if (!m_dtr)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (m_tx_busy)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    size_t packets = length / NRF_DRV_USBD_EPSIZE + 1;   // the last one short or empty
+
+    mp_tx = p_buf;
+    m_tx_length = length;
+    m_tx_sent = 0;
+    m_tx_session = m_session;
+    m_tx_busy = true;
+    m_stats.transfers++;
+    sim_schedule(sim_time_ns() + packets * PACKET_NS, tx_done, NULL);
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_usbd_cdc_acm_read_any(app_usbd_cdc_acm_t const * p_cdc_acm, void * p_buf, size_t length)
+{
+    ssize_t size = -1;
+
+    if (!m_rx_pending && m_fd >= 0)
+    {
+        size = read(m_fd, p_buf, length < NRF_DRV_USBD_EPSIZE ? length : NRF_DRV_USBD_EPSIZE);
+    }
+    if (size > 0)
+    {
+        m_rx_size = size;
+        m_stats.bytes_out += size;
+        return NRF_SUCCESS;
+    }
+
+    mp_rx = p_buf;
+    m_rx_length = length < NRF_DRV_USBD_EPSIZE ? length : NRF_DRV_USBD_EPSIZE;
+    m_rx_pending = true;
+    return NRF_ERROR_IO_PENDING;
+}
+
+size_t app_usbd_cdc_acm_rx_size(app_usbd_cdc_acm_t const * p_cdc_acm)
+{
+    return m_rx_size;
+}
+
+bool host_cdc_acm_open(char * p_path, uint32_t size)
+{
+    struct termios attrs;
+
+    m_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (m_fd < 0 || grantpt(m_fd) != 0 || unlockpt(m_fd) != 0 ||
+        ptsname_r(m_fd, p_path, size) != 0)
+    {
+        host_cdc_acm_close();
+        return false;
+    }
+
+    // Raw both ways until the tool sets the slave up itself
+    if (tcgetattr(m_fd, &attrs) == 0)
+    {
+        cfmakeraw(&attrs);
+        tcsetattr(m_fd, TCSANOW, &attrs);
+    }
+
+    // The master only reports a hang-up once the slave has been open, and
+    // a moment after it was closed
+    int slave = open(p_path, O_RDWR | O_NOCTTY);
+    if (slave >= 0)
+    {
+        struct pollfd fd = {m_fd, 0, 0};
+
+        close(slave);
+        poll(&fd, 1, HANGUP_TIMEOUT_MS);
+    }
+    return true;
+}
+
+void host_cdc_acm_close(void)
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+    m_fd = -1;
+}
+
+bool host_cdc_acm_poll(void)
+{
+    struct pollfd fd = {m_fd, POLLIN, 0};
+    uint32_t queued = m_queue_count;
+
+    if (m_fd < 0 || !m_started || poll(&fd, 1, 0) < 0)
+    {
+        return false;
+    }
+
+    bool readable = fd.revents & POLLIN;
+    bool open = !(fd.revents & POLLHUP);
+
+    if (open && !m_dtr)
+    {
+        m_dtr = true;
+        m_session++;
+        m_stats.opens++;
+        event_put(false, APP_USBD_CDC_ACM_USER_EVT_PORT_OPEN);
+    }
+
+    // What the tool wrote before it closed the port comes first
+    if (m_dtr && readable && m_rx_pending)
+    {
+        ssize_t size = read(m_fd, mp_rx, m_rx_length);
+
+        if (size > 0)
+        {
+            m_rx_pending = false;
+            m_rx_size = size;
+            m_stats.bytes_out += size;
+            event_put(false, APP_USBD_CDC_ACM_USER_EVT_RX_DONE);
+        }
+    }
+
+    if (!open && m_dtr && !readable)
+    {
+        m_dtr = false;
+        event_put(false, APP_USBD_CDC_ACM_USER_EVT_PORT_CLOSE);
+    }
+
+    return m_queue_count != queued;
+}
+
+bool host_cdc_acm_port_open(void)
+{
+    return m_dtr;
+}
+
+bool host_cdc_acm_tx_busy(void)
+{
+    return m_tx_busy;
+}
+
+void host_cdc_acm_stats_get(host_cdc_acm_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
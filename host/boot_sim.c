@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "nrfx_power.h"
+#include "nrfx_pwm.h"
+#include "pwm_engine.h"
+#include "led_pins.h"
+#include "nrf_fstorage.h"
+#include "settings.h"
+#include "boot.h"
+#include "sim.h"
+#include "button_script.h"
+
+// Boots the firmware with blinking on in flash, as a device power-cycled
+// while its pattern ran, without a host or (argument vbus) with VBUS there
+// from reset. Checks that
+//  - the LED pins are driven off before anything but the clock is set up,
+//  - the restored pattern plays from reset, before time moves on,
+//  - every stage is reached in turn, the deferred ones by the trigger of the
+//    case: the first loop pass with VBUS, the first idle without,
+//  - a double click 50 ms after reset stops the pattern.
+// Code takes no time on the host, so the cycle stamps say nothing here; the
+// device reports them with tools/boot_report.py.
+
+#define BUTTON_PIN   NRF_GPIO_PIN_MAP(1,6)
+#define MS           1000000ULL
+
+int firmware_main(void);
+
+static const char * const m_stage_names[BOOT_STAGE_COUNT] =
+{
+    "main", "clock", "leds", "timers", "button", "first light", "usb", "diagnostics"
+};
+
+static uint16_t m_done_at_leds_off = 0xFFFF;    // stages reached at the first LED pin write
+static uint64_t m_first_pwm_ns = UINT64_MAX;
+static bool m_lit;
+static bool m_dark;                             // all levels 0 after the pattern played
+
+static void gpio_observer(uint32_t pin_number, uint32_t value, uint64_t time_ns)
+{
+    boot_report_t report;
+    bool led = pin_number == YELLOW_LED_PIN || pin_number == RED_LED_PIN ||
+               pin_number == GREEN_LED_PIN || pin_number == BLUE_LED_PIN;
+
+    if (led && m_done_at_leds_off == 0xFFFF)
+    {
+        boot_report_get(&report);
+        m_done_at_leds_off = report.done;
+    }
+}
+
+static void pwm_observer(uint8_t instance, uint8_t const * p_pins,
+                         uint16_t const * p_levels, uint16_t top)
+{
+    bool lit = false;
+
+    if (m_first_pwm_ns == UINT64_MAX)
+    {
+        m_first_pwm_ns = sim_time_ns();
+    }
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        lit |= p_levels[i] != 0;
+    }
+    m_dark = m_lit && !lit;
+    m_lit |= lit;
+}
+
+// What the last run left in flash: blinking on
+static void flash_blinking_set(void)
+{
+    settings_t settings = {.digits = {7, 2, 1, 4}, .brightness = 255, .speed = 100, .click_gap_ms = 300};
+
+    host_flash_blank();
+    settings_init(&settings, NULL);
+    settings.blinking = 1;
+    settings_update(&settings);
+    settings_flush();
+}
+
+int main(int argc, char ** argv)
+{
+    bool vbus = argc > 1 && strcmp(argv[1], "vbus") == 0;
+    boot_trigger_t trigger = vbus ? BOOT_TRIGGER_VBUS : BOOT_TRIGGER_IDLE;
+    boot_report_t report;
+    bool ok = true;
+
+    sim_reset();
+    flash_blinking_set();
+    sim_reset();
+    host_power_vbus_set(vbus);
+    host_gpio_observer_set(gpio_observer);
+    host_pwm_observer_set(pwm_observer);
+    host_gpio_input_set(BUTTON_PIN, 1);
+    button_script_double_click(BUTTON_PIN, 50 * MS);
+
+    host_cpu_run(firmware_main, 1000 * MS);
+    boot_report_get(&report);
+
+    printf("boot %s: trigger %s, first PWM step at %llu ns\n", vbus ? "with VBUS" : "without VBUS",
+           report.trigger == BOOT_TRIGGER_VBUS ? "vbus" : report.trigger == BOOT_TRIGGER_IDLE ? "idle" : "none",
+           (unsigned long long)m_first_pwm_ns);
+
+    uint16_t early = (1 << BOOT_STAGE_MAIN) | (1 << BOOT_STAGE_CLOCK);
+    if (m_done_at_leds_off != early)
+    {
+        printf("FAIL: LED pins first written with stages 0x%04x reached, expected 0x%04x\n",
+               m_done_at_leds_off, early);
+        ok = false;
+    }
+    if (m_first_pwm_ns != 0 || !m_lit)
+    {
+        printf("FAIL: the restored pattern did not start at reset\n");
+        ok = false;
+    }
+    for (int stage = 0; stage < BOOT_STAGE_COUNT; stage++)
+    {
+        if ((report.done & (1 << stage)) == 0)
+        {
+            printf("FAIL: stage %s not reached\n", m_stage_names[stage]);
+            ok = false;
+        }
+    }
+    if (report.trigger != trigger)
+    {
+        printf("FAIL: deferred stages started by trigger %u, expected %u\n", report.trigger, trigger);
+        ok = false;
+    }
+    if (!m_dark || settings_get()->blinking != 0)
+    {
+        printf("FAIL: double click after boot did not stop the pattern\n");
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
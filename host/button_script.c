@@ -0,0 +1,35 @@
+#include <stddef.h>
+#include "button_script.h"
+#include "nrf_gpio.h"
+#include "sim.h"
+
+#define MS 1000000ULL
+
+static void input_set(void * p_context)
+{
+    uint32_t packed = (uint32_t)(uintptr_t)p_context;
+
+    host_gpio_input_set(packed >> 1, packed & 1);
+}
+
+void button_script_edge(uint32_t pin, uint64_t time_ns, bool pressed)
+{
+    static const uint32_t bounce_us[] = {0, 150, 400, 900, 1500};
+    uint32_t level = !pressed;
+
+    // Odd entries bounce back, the last one settles on the new level
+    for (size_t i = 0; i < sizeof(bounce_us) / sizeof(bounce_us[0]); i++)
+    {
+        uint32_t bounced = (i & 1) ? !level : level;
+        sim_schedule(time_ns + bounce_us[i] * 1000ULL, input_set,
+                     (void *)(uintptr_t)((pin << 1) | bounced));
+    }
+}
+
+void button_script_double_click(uint32_t pin, uint64_t time_ns)
+{
+    button_script_edge(pin, time_ns, true);
+    button_script_edge(pin, time_ns + 100 * MS, false);
+    button_script_edge(pin, time_ns + 250 * MS, true);
+    button_script_edge(pin, time_ns + 350 * MS, false);
+}
@@ -0,0 +1,15 @@
+#ifndef BUTTON_SCRIPT_H
+#define BUTTON_SCRIPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Scripted presses of an active low button, scheduled as simulator events.
+// Every edge comes with a short contact bounce, like the real button.
+
+void button_script_edge(uint32_t pin, uint64_t time_ns, bool pressed);
+
+// Two 100 ms clicks 250 ms apart
+void button_script_double_click(uint32_t pin, uint64_t time_ns);
+
+#endif
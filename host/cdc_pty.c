@@ -0,0 +1,357 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "nrfx_power.h"
+#include "sim.h"
+#include "usb_link.h"
+#include "usb_frame.h"
+#include "led_command.h"
+#include "app_usbd_cdc_acm.h"
+
+// The USB link without USB: runs the unmodified firmware main() and
+// usb_link.c, built with the link enabled, on the host shim with the CDC ACM
+// class on a pseudo terminal (app_usbd_host.c), and starts the given command
+// with "PTY" in its arguments replaced by the slave path, e.g.
+//
+//   cdc_pty python3 tools/led_ctrl.py --port PTY device-id 1 2 3 4 status
+//
+// Virtual time follows wall time while the command runs. The exit status is
+// that of the command. With --reopen instead of a command, cdc_pty opens the
+// port itself, closes and reopens it while an IN transfer is in flight, and
+// checks that the answers to the requests after it arrive intact. Before
+// either, usb_frame.c is checked on its own:
+//  - frames that lie in one packet are handed over in place, several per packet,
+//  - the same frames split at every byte position are put together,
+//  - noise, a bad CRC and a bad length are counted and skipped.
+
+#define BUTTON_PIN  NRF_GPIO_PIN_MAP(1,6)
+#define POLL_US     100
+#define TIMEOUT_S   30
+#define REOPEN_REQUESTS 3
+#define REOPEN_RUN_NS   (50 * 1000000ULL)
+
+int firmware_main(void);
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t payload[8];
+    uint16_t length;
+} frame_t;
+
+static const frame_t m_frames[] =
+{
+    {0x04, {0}, 0},
+    {0x04, {3, 1, 2, 3, 4}, 5},
+    {0x02, {USB_LINK_SYNC, USB_LINK_SYNC, 0}, 3},
+    {0x01, {1, 2, 3, 4, 5, 6, 7, 8}, 8},
+};
+
+#define FRAME_COUNT (sizeof(m_frames) / sizeof(m_frames[0]))
+
+static uint32_t m_received;
+static bool m_match;
+static uint32_t m_statuses;
+
+static size_t frame_put(uint8_t * p, frame_t const * p_frame)
+{
+    uint16_t crc = usb_frame_crc(p_frame->type, p_frame->payload, p_frame->length);
+
+    p[0] = USB_LINK_SYNC;
+    p[1] = p_frame->type;
+    p[2] = (uint8_t)p_frame->length;
+    p[3] = (uint8_t)(p_frame->length >> 8);
+    memcpy(&p[4], p_frame->payload, p_frame->length);
+    p[4 + p_frame->length] = (uint8_t)crc;
+    p[5 + p_frame->length] = (uint8_t)(crc >> 8);
+    return USB_LINK_OVERHEAD + p_frame->length;
+}
+
+static void frame_handler(uint8_t type, uint8_t const * p_payload, uint16_t length)
+{
+    frame_t const * p_expected = &m_frames[m_received++ % FRAME_COUNT];
+
+    m_match &= type == p_expected->type && length == p_expected->length &&
+               memcmp(p_payload, p_expected->payload, length) == 0;
+}
+
+static bool frame_check(void)
+{
+    uint8_t stream[256];
+    size_t size = 0;
+    usb_frame_rx_t rx;
+    bool ok = true;
+
+    for (size_t i = 0; i < FRAME_COUNT; i++)
+    {
+        size += frame_put(&stream[size], &m_frames[i]);
+    }
+
+    // All in one packet
+    usb_frame_rx_init(&rx);
+    m_received = 0;
+    m_match = true;
+    usb_frame_rx(&rx, stream, size, frame_handler);
+    bool pass = m_match && m_received == FRAME_COUNT && rx.in_place == FRAME_COUNT && rx.errors == 0;
+    printf("%s frames       %u in one packet, %u in place\n", pass ? "ok  " : "FAIL", m_received, rx.in_place);
+    ok &= pass;
+
+    // Two packets, split at every position
+    uint32_t copied = 0;
+    pass = true;
+    for (size_t split = 1; split < size; split++)
+    {
+        usb_frame_rx_init(&rx);
+        m_received = 0;
+        m_match = true;
+        usb_frame_rx(&rx, stream, split, frame_handler);
+        usb_frame_rx(&rx, &stream[split], size - split, frame_handler);
+        pass &= m_match && m_received == FRAME_COUNT && rx.errors == 0 && rx.in_place >= FRAME_COUNT - 1;
+        copied += FRAME_COUNT - rx.in_place;
+    }
+    printf("%s split        %zu positions, %u frames put together\n", pass ? "ok  " : "FAIL", size - 1, copied);
+    ok &= pass;
+
+    // Noise, a frame with a bad CRC, one too long, then the good ones
+    uint8_t bad[sizeof(stream) + 32] = {0x00, 0x13, 0x37};
+    size_t bad_size = 3;
+    bad_size += frame_put(&bad[bad_size], &m_frames[1]);
+    bad[bad_size - 1] ^= 0x40;
+    bad[bad_size++] = USB_LINK_SYNC;
+    bad[bad_size++] = 0x04;
+    bad[bad_size++] = 0xFF;
+    bad[bad_size++] = 0xFF;
+    memcpy(&bad[bad_size], stream, size);
+    bad_size += size;
+
+    usb_frame_rx_init(&rx);
+    m_received = 0;
+    m_match = true;
+    for (size_t i = 0; i < bad_size; i += 7)
+    {
+        usb_frame_rx(&rx, &bad[i], bad_size - i < 7 ? bad_size - i : 7, frame_handler);
+    }
+    pass = m_match && m_received == FRAME_COUNT && rx.errors == 2;
+    printf("%s resync       %u frames after noise, %u errors\n", pass ? "ok  " : "FAIL", m_received, rx.errors);
+    ok &= pass;
+
+    return ok;
+}
+
+// The USB interrupt: the firmware wakes up and reads the port in its main loop
+static void usbd_irq(void * p_context)
+{
+}
+
+static double wall_s(void);
+
+// Look at the port, then let the firmware run for duration_ns
+static void step(uint64_t duration_ns)
+{
+    if (host_cdc_acm_poll())
+    {
+        sim_schedule(sim_time_ns(), usbd_irq, NULL);
+    }
+    host_cpu_resume(sim_time_ns() + duration_ns);
+}
+
+// Until the port is seen open or closed, false after the timeout
+static bool port_wait(bool open)
+{
+    double start = wall_s();
+
+    while (host_cdc_acm_port_open() != open)
+    {
+        if (wall_s() - start > 1.0)
+        {
+            return false;
+        }
+        usleep(POLL_US);
+        step(0);
+    }
+    return true;
+}
+
+static int slave_open(char const * p_path)
+{
+    struct termios attrs;
+    int fd = open(p_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (fd >= 0 && tcgetattr(fd, &attrs) == 0)
+    {
+        cfmakeraw(&attrs);
+        tcsetattr(fd, TCSANOW, &attrs);
+        tcflush(fd, TCIOFLUSH);
+    }
+    return fd;
+}
+
+static void status_handler(uint8_t type, uint8_t const * p_payload, uint16_t length)
+{
+    led_command_status_t status;
+
+    if (type == USB_LINK_MSG_LED_STATUS && length == sizeof(status))
+    {
+        memcpy(&status, p_payload, sizeof(status));
+        m_statuses += status.op == LED_COMMAND_STATUS && status.result == LED_COMMAND_OK;
+    }
+}
+
+static bool reopen_check(char const * p_path)
+{
+    static const frame_t request = {USB_LINK_MSG_LED_COMMAND, {LED_COMMAND_STATUS}, 1};
+    uint8_t bytes[64];
+    size_t size = frame_put(bytes, &request);
+    host_cdc_acm_stats_t stats;
+    usb_frame_rx_t rx;
+
+    // First session: a request, and the port closed with the answer on the way
+    int fd = slave_open(p_path);
+    bool seen = port_wait(true);
+    write(fd, bytes, size);
+    for (int i = 0; i < 1000 && !host_cdc_acm_tx_busy(); i++)
+    {
+        step(1000);
+    }
+    bool in_flight = host_cdc_acm_tx_busy();
+    close(fd);
+    seen &= port_wait(false);
+
+    // Second session, the transfer still in flight
+    fd = slave_open(p_path);
+    seen &= port_wait(true);
+    in_flight &= host_cdc_acm_tx_busy();
+    for (int i = 0; i < REOPEN_REQUESTS; i++)
+    {
+        write(fd, bytes, size);
+    }
+
+    usb_frame_rx_init(&rx);
+    m_statuses = 0;
+    for (uint64_t end = sim_time_ns() + REOPEN_RUN_NS; sim_time_ns() < end; )
+    {
+        ssize_t received;
+
+        step(POLL_US * 1000);
+        while ((received = read(fd, bytes, sizeof(bytes))) > 0)
+        {
+            usb_frame_rx(&rx, bytes, received, status_handler);
+        }
+    }
+    close(fd);
+    seen &= port_wait(false);
+
+    host_cdc_acm_stats_get(&stats);
+    bool pass = seen && in_flight && stats.stale > 0 && m_statuses == REOPEN_REQUESTS && rx.errors == 0;
+    printf("%s reopen       %s, %u stale transfers, %u of %u answers, %u frames, %u errors\n",
+           pass ? "ok  " : "FAIL", in_flight ? "closed in a transfer" : "no transfer in flight",
+           stats.stale, m_statuses, REOPEN_REQUESTS, rx.frames, rx.errors);
+    return pass;
+}
+
+static double wall_s(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static pid_t command_start(char ** argv, char const * p_path)
+{
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        for (int i = 0; argv[i] != NULL; i++)
+        {
+            char * p_at = strstr(argv[i], "PTY");
+            if (p_at != NULL)
+            {
+                char * p_arg = malloc(strlen(argv[i]) + strlen(p_path) + 1);
+                sprintf(p_arg, "%.*s%s%s", (int)(p_at - argv[i]), argv[i], p_path, p_at + 3);
+                argv[i] = p_arg;
+            }
+        }
+        execvp(argv[0], argv);
+        perror("cdc_pty: exec");
+        _exit(127);
+    }
+    return pid;
+}
+
+int main(int argc, char ** argv)
+{
+    char path[64];
+    int status = 0;
+    bool ok = frame_check();
+    bool reopen = argc == 2 && strcmp(argv[1], "--reopen") == 0;
+    host_cdc_acm_stats_t stats;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: cdc_pty command [args] | --reopen, PTY in an argument is the port\n");
+        return 2;
+    }
+    if (!host_cdc_acm_open(path, sizeof(path)))
+    {
+        perror("cdc_pty: pty");
+        return 1;
+    }
+
+    sim_reset();
+    host_gpio_input_set(BUTTON_PIN, 1);
+    host_power_vbus_set(true);
+    host_cpu_run(firmware_main, 0);
+
+    if (reopen)
+    {
+        ok &= reopen_check(path);
+    }
+    else
+    {
+        fflush(stdout);
+        pid_t pid = command_start(&argv[1], path);
+        double start = wall_s();
+        uint64_t start_ns = sim_time_ns();
+
+        while (waitpid(pid, &status, WNOHANG) == 0)
+        {
+            if (wall_s() - start > TIMEOUT_S)
+            {
+                fprintf(stderr, "cdc_pty: %s still running after %d s\n", argv[1], TIMEOUT_S);
+                kill(pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                ok = false;
+                break;
+            }
+            if (host_cdc_acm_poll())
+            {
+                sim_schedule(sim_time_ns(), usbd_irq, NULL);
+            }
+            else
+            {
+                usleep(POLL_US);
+            }
+
+            uint64_t now_ns = start_ns + (uint64_t)((wall_s() - start) * 1e9);
+            host_cpu_resume(now_ns > sim_time_ns() ? now_ns : sim_time_ns());
+        }
+        ok &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    host_cdc_acm_stats_get(&stats);
+    printf("link: %u opens, %u transfers, %u bytes in, %u bytes out, %u rx errors, %.1f s\n",
+           stats.opens, stats.transfers, stats.bytes_in, stats.bytes_out, usb_link_rx_errors(),
+           sim_time_ns() / 1e9);
+    host_cdc_acm_close();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include "nrf.h"
+#include "sim.h"
+
+// Cortex-M sleep model. WFE returns at once if the event register is set,
+// otherwise the simulator runs the next interrupt, whose exception entry sets
+// the register, and WFE returns with the register cleared again.
+//
+// The firmware main loop never returns, so it runs as a coroutine on its own
+// stack. When it wants to sleep past the end of the current run, the WFE
+// switches back to the host, host_cpu_resume() continues from that WFE.
+
+#define FIRMWARE_STACK_SIZE (256 * 1024)
+
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+uint32_t SystemCoreClock = 64000000;
+
+static bool m_event;
+static uint64_t m_until_ns;
+static ucontext_t m_host;
+static ucontext_t m_firmware;
+static int (*m_entry)(void);
+
+static void cpu_sleep(void)
+{
+    uint64_t next_ns;
+
+    while (!sim_next_time(&next_ns) || next_ns > m_until_ns)
+    {
+        sim_run_until(m_until_ns);
+        swapcontext(&m_firmware, &m_host);
+    }
+
+    sim_run_next();
+}
+
+void host_cpu_wfe(void)
+{
+    if (m_event)
+    {
+        m_event = false;
+        return;
+    }
+    cpu_sleep();
+}
+
+void host_cpu_sev(void)
+{
+    m_event = true;
+}
+
+static void firmware_entry(void)
+{
+    m_entry();
+    fprintf(stderr, "cpu: firmware main returned\n");
+    abort();
+}
+
+void host_cpu_run(int (*entry)(void), uint64_t until_ns)
+{
+    static char * p_stack;
+
+    if (p_stack == NULL)
+    {
+        p_stack = malloc(FIRMWARE_STACK_SIZE);
+    }
+
+    m_entry = entry;
+    m_event = false;
+    getcontext(&m_firmware);
+    m_firmware.uc_stack.ss_sp = p_stack;
+    m_firmware.uc_stack.ss_size = FIRMWARE_STACK_SIZE;
+    m_firmware.uc_link = NULL;
+    makecontext(&m_firmware, firmware_entry, 0);
+
+    host_cpu_resume(until_ns);
+}
+
+void host_cpu_resume(uint64_t until_ns)
+{
+    m_until_ns = until_ns;
+    swapcontext(&m_host, &m_firmware);
+}
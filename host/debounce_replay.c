@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "button_debounce.h"
+
+// Replays button edge traces through every debounce policy and checks the
+// number of decoded presses against the expectation in the trace.
+//
+// Trace format, one edge per line, times in microseconds from the start:
+//   # presses integrator=N lockout=N majority=N
+//   <time_us> <level, 1 = pressed>
+// The button starts released. Every trace is replayed twice, the second time
+// with the RTC counter just before its 24-bit wrap.
+
+#define RTC_HZ       32768ULL
+#define WINDOW_MS    20
+#define MAX_EDGES    1024
+#define WRAP_OFFSET  (BUTTON_DEBOUNCE_TICK_MASK - 1000)
+
+typedef struct
+{
+    uint64_t time_us;
+    bool     pressed;
+} edge_t;
+
+static const char * const m_policy_names[] = {"integrator", "lockout", "majority"};
+
+static edge_t m_edges[MAX_EDGES];
+static int m_edge_count;
+static int m_expected[3];
+static bool m_verbose;
+
+static bool trace_load(char const * p_path)
+{
+    FILE * p_file = fopen(p_path, "r");
+    char line[256];
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        return false;
+    }
+
+    m_edge_count = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        m_expected[i] = -1;
+    }
+
+    while (fgets(line, sizeof(line), p_file) != NULL)
+    {
+        unsigned long long time_us;
+        int level;
+
+        if (strncmp(line, "# presses", 9) == 0)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                char const * p_value = strstr(line, m_policy_names[i]);
+                if (p_value != NULL)
+                {
+                    m_expected[i] = atoi(p_value + strlen(m_policy_names[i]) + 1);
+                }
+            }
+        }
+        else if (line[0] != '#' && sscanf(line, "%llu %d", &time_us, &level) == 2 &&
+                 m_edge_count < MAX_EDGES)
+        {
+            m_edges[m_edge_count].time_us = time_us;
+            m_edges[m_edge_count].pressed = level != 0;
+            m_edge_count++;
+        }
+    }
+
+    fclose(p_file);
+    return true;
+}
+
+static uint32_t ticks(uint64_t time_us, uint32_t offset)
+{
+    return (uint32_t)(offset + (time_us * RTC_HZ) / 1000000) & BUTTON_DEBOUNCE_TICK_MASK;
+}
+
+static void output(button_debounce_event_t const * p_event, uint32_t offset)
+{
+    if (m_verbose)
+    {
+        uint32_t t = (p_event->timestamp - offset) & BUTTON_DEBOUNCE_TICK_MASK;
+        printf("    %9.3f ms %s\n", t * 1000.0 / RTC_HZ, p_event->pressed ? "press" : "release");
+    }
+}
+
+// Timeouts the firmware timer would have delivered before timestamp
+static void timeouts_run(button_debounce_t * p_debounce, uint32_t timestamp, bool all, uint32_t offset)
+{
+    button_debounce_event_t event;
+    uint32_t deadline;
+
+    while (button_debounce_deadline(p_debounce, &deadline) &&
+           (all || ((timestamp - deadline) & BUTTON_DEBOUNCE_TICK_MASK) < (BUTTON_DEBOUNCE_TICK_MASK / 2)))
+    {
+        if (button_debounce_timeout(p_debounce, deadline, &event))
+        {
+            output(&event, offset);
+        }
+    }
+}
+
+static bool replay(uint8_t policy, uint32_t offset)
+{
+    button_debounce_t debounce;
+    button_debounce_event_t event;
+
+    button_debounce_init(&debounce, policy, (WINDOW_MS * RTC_HZ) / 1000, false);
+
+    for (int i = 0; i < m_edge_count; i++)
+    {
+        uint32_t timestamp = ticks(m_edges[i].time_us, offset);
+
+        timeouts_run(&debounce, timestamp, false, offset);
+        if (button_debounce_edge(&debounce, m_edges[i].pressed, timestamp, &event))
+        {
+            output(&event, offset);
+        }
+    }
+    timeouts_run(&debounce, 0, true, offset);
+
+    button_debounce_stats_t const * p_stats = &debounce.stats;
+    bool ok = m_expected[policy] < 0 || (int)p_stats->presses == m_expected[policy];
+
+    printf("  %-10s %s presses %u/%d releases %u, edges %u bursts %u bounces %u, "
+           "longest burst %u edges %.2f ms\n",
+           m_policy_names[policy], offset == 0 ? "      " : "(wrap)",
+           p_stats->presses, m_expected[policy], p_stats->releases,
+           p_stats->edges, p_stats->bursts, p_stats->bounces,
+           p_stats->max_burst_edges, p_stats->max_burst_ticks * 1000.0 / RTC_HZ);
+    if (!ok)
+    {
+        printf("  FAIL: expected %d presses\n", m_expected[policy]);
+    }
+    return ok;
+}
+
+int main(int argc, char ** argv)
+{
+    int failures = 0;
+
+    for (int a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "-v") == 0)
+        {
+            m_verbose = true;
+            continue;
+        }
+        if (!trace_load(argv[a]))
+        {
+            failures++;
+            continue;
+        }
+
+        printf("%s: %d edges, %d ms window\n", argv[a], m_edge_count, WINDOW_MS);
+        for (uint8_t policy = 0; policy < 3; policy++)
+        {
+            failures += !replay(policy, 0);
+            failures += !replay(policy, WRAP_OFFSET);
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
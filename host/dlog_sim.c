@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "dlog.h"
+#include "sim.h"
+#include "button_script.h"
+
+// Runs the firmware with a double click on and one off, then logs a line with
+// every supported conversion and overfills the buffer. The records go to a
+// file in the format the device sends, for tools/dlog.py to format with the
+// dictionary taken from this executable.
+
+#define BUTTON_PIN   NRF_GPIO_PIN_MAP(1,6)
+#define S            1000000000ULL
+
+int firmware_main(void);
+
+static FILE * mp_file;
+static uint32_t m_count;
+
+static void drain(void)
+{
+    dlog_record_t record;
+
+    while (dlog_get(&record))
+    {
+        uint32_t nargs = record.header >> DLOG_NARGS_POS;
+
+        fwrite(&record, sizeof(uint32_t), 2 + nargs, mp_file);
+        m_count++;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    bool ok = true;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: dlog_sim records.bin\n");
+        return 2;
+    }
+    mp_file = fopen(argv[1], "wb");
+    if (mp_file == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    sim_reset();
+    host_gpio_input_set(BUTTON_PIN, 1);
+    button_script_double_click(BUTTON_PIN, 1 * S);
+    button_script_double_click(BUTTON_PIN, 10 * S);
+    host_cpu_run(firmware_main, 15 * S);
+    drain();
+
+    DLOG_INFO("conversions %d %u 0x%08x %X", -5, 7, 0xBEEF, 0xAB);
+    DLOG_INFO("conversions %c %o %5d%%", 'x', 8, 42);
+    DLOG_DEBUG("above DLOG_LEVEL, not queued");
+    drain();
+
+    // One more than fits is dropped and counted
+    for (int i = 0; i <= DLOG_BUFFER_RECORDS; i++)
+    {
+        DLOG_ERROR("fill %d", i);
+    }
+    uint32_t dropped = dlog_dropped();
+    drain();
+    fclose(mp_file);
+
+    printf("%u records, %u dropped\n", m_count, dropped);
+    if (dropped != 1)
+    {
+        printf("FAIL: expected exactly one record dropped\n");
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "nrfx_pwm.h"
+#include "pwm_engine.h"
+#include "event_queue.h"
+#include "idle.h"
+#include "sim.h"
+#include "button_script.h"
+
+// Runs the unmodified firmware main() on the host shim. A scripted button
+// (with contact bounce) double-clicks blinking on after one second and off
+// again shortly before the end; the run reports the blinks every LED showed
+// and how fast virtual time went compared to wall time.
+
+#define BUTTON_PIN   NRF_GPIO_PIN_MAP(1,6)
+#define S            1000000000ULL
+
+int firmware_main(void);
+
+static const uint8_t m_digits[PWM_ENGINE_CHANNELS] = {7, 2, 1, 4};
+static uint32_t m_blinks[PWM_ENGINE_CHANNELS];
+static uint16_t m_levels[PWM_ENGINE_CHANNELS];
+
+// A blink is a channel leaving level 0
+static void pwm_observer(uint8_t instance, uint8_t const * p_pins,
+                         uint16_t const * p_levels, uint16_t top)
+{
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (m_levels[i] == 0 && p_levels[i] != 0)
+        {
+            m_blinks[i]++;
+        }
+        m_levels[i] = p_levels[i];
+    }
+}
+
+static double wall_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+int main(int argc, char ** argv)
+{
+    uint64_t seconds = argc > 1 ? strtoull(argv[1], NULL, 10) : 3600;
+    uint64_t end_ns = seconds * S;
+    bool ok = true;
+
+    if (seconds < 60)
+    {
+        fprintf(stderr, "usage: firmware_sim [seconds >= 60]\n");
+        return 2;
+    }
+
+    sim_reset();
+    host_pwm_observer_set(pwm_observer);
+    host_gpio_input_set(BUTTON_PIN, 1);
+    button_script_double_click(BUTTON_PIN, 1 * S);
+    button_script_double_click(BUTTON_PIN, end_ns - 5 * S);
+
+    double start = wall_ms();
+    host_cpu_run(firmware_main, end_ns);
+    double elapsed = wall_ms() - start;
+
+    printf("%llu s of virtual time in %.1f ms (%.0fx)\n", (unsigned long long)seconds, elapsed,
+           seconds * 1000.0 / (elapsed > 0 ? elapsed : 1));
+
+    uint32_t min_cycles = UINT32_MAX;
+    uint32_t max_cycles = 0;
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        uint32_t cycles = (m_blinks[i] + m_digits[i] - 1) / m_digits[i];
+        printf("LED %d: %u blinks (%u per cycle)\n", i, m_blinks[i], m_digits[i]);
+        min_cycles = cycles < min_cycles ? cycles : min_cycles;
+        max_cycles = cycles > max_cycles ? cycles : max_cycles;
+    }
+    printf("idle %u/1000, event queue overflows %u\n",
+           idle_sleep_permille(), event_queue_overflows());
+
+    // The last cycle may have been cut short by the double click
+    if (min_cycles == 0 || max_cycles - min_cycles > 1)
+    {
+        printf("FAIL: LEDs did not blink the device_id pattern\n");
+        ok = false;
+    }
+    if (pwm_engine_is_busy() || m_levels[0] || m_levels[1] || m_levels[2] || m_levels[3])
+    {
+        printf("FAIL: LEDs still on after the second double click\n");
+        ok = false;
+    }
+    if (event_queue_overflows() != 0)
+    {
+        printf("FAIL: events lost\n");
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gesture.h"
+
+// Scripted press/release timings around the gesture thresholds. Every
+// scenario checks the reported gestures and the time they were reported,
+// and runs a second time with the RTC counter just before its 24-bit wrap.
+
+#define RTC_HZ       32768ULL
+#define TICK_MASK    0x00FFFFFFUL
+#define WRAP_OFFSET  (TICK_MASK - 3000)
+#define HORIZON_MS   2000
+#define END          UINT32_MAX
+
+// Multiples of 125 ms are whole RTC ticks, so expected times add up exactly
+#define GAP_MS       250
+#define LONG_MS      625
+#define REPEAT_MS    250
+
+#define ALL_CLICKS   (GESTURE_MASK(GESTURE_SINGLE_CLICK) | GESTURE_MASK(GESTURE_DOUBLE_CLICK) | \
+                      GESTURE_MASK(GESTURE_TRIPLE_CLICK))
+#define ALL          (ALL_CLICKS | GESTURE_MASK(GESTURE_LONG_PRESS) | GESTURE_MASK(GESTURE_HOLD_REPEAT))
+
+typedef struct
+{
+    uint32_t time_ms;
+    bool     pressed;
+} step_t;
+
+typedef struct
+{
+    uint8_t  type;
+    uint8_t  count;
+    uint32_t time_ms;   // when the gesture is reported
+} expect_t;
+
+typedef struct
+{
+    char const * p_name;
+    uint32_t     enabled;
+    step_t       steps[16];
+    expect_t     expect[8];
+} scenario_t;
+
+static const char * const m_names[GESTURE_COUNT] =
+{
+    "single", "double", "triple", "long", "repeat"
+};
+
+static const scenario_t m_scenarios[] =
+{
+    {"single click waits for the gap", ALL,
+     {{0, 1}, {100, 0}, {END}},
+     {{GESTURE_SINGLE_CLICK, 0, 100 + GAP_MS}, {GESTURE_COUNT}}},
+
+    {"single click alone resolves on release", GESTURE_MASK(GESTURE_SINGLE_CLICK),
+     {{0, 1}, {100, 0}, {END}},
+     {{GESTURE_SINGLE_CLICK, 0, 100}, {GESTURE_COUNT}}},
+
+    {"double click waits for a third", ALL,
+     {{0, 1}, {100, 0}, {200, 1}, {350, 0}, {END}},
+     {{GESTURE_DOUBLE_CLICK, 0, 350 + GAP_MS}, {GESTURE_COUNT}}},
+
+    {"double click without triple resolves on release",
+     GESTURE_MASK(GESTURE_SINGLE_CLICK) | GESTURE_MASK(GESTURE_DOUBLE_CLICK),
+     {{0, 1}, {100, 0}, {250, 1}, {350, 0}, {END}},
+     {{GESTURE_DOUBLE_CLICK, 0, 350}, {GESTURE_COUNT}}},
+
+    {"triple click resolves on the third release", ALL,
+     {{0, 1}, {100, 0}, {200, 1}, {300, 0}, {400, 1}, {480, 0}, {END}},
+     {{GESTURE_TRIPLE_CLICK, 0, 480}, {GESTURE_COUNT}}},
+
+    {"press exactly at the gap deadline starts a new gesture", ALL,
+     {{0, 1}, {100, 0}, {100 + GAP_MS, 1}, {450, 0}, {END}},
+     {{GESTURE_SINGLE_CLICK, 0, 100 + GAP_MS}, {GESTURE_SINGLE_CLICK, 0, 450 + GAP_MS}, {GESTURE_COUNT}}},
+
+    {"press just inside the gap continues the gesture", ALL,
+     {{0, 1}, {100, 0}, {100 + GAP_MS - 1, 1}, {420, 0}, {END}},
+     {{GESTURE_DOUBLE_CLICK, 0, 420 + GAP_MS}, {GESTURE_COUNT}}},
+
+    {"release just before the long press threshold is a click", ALL,
+     {{0, 1}, {LONG_MS - 1, 0}, {END}},
+     {{GESTURE_SINGLE_CLICK, 0, LONG_MS - 1 + GAP_MS}, {GESTURE_COUNT}}},
+
+    {"release at the long press threshold is a long press", ALL,
+     {{0, 1}, {LONG_MS, 0}, {END}},
+     {{GESTURE_LONG_PRESS, 0, LONG_MS}, {GESTURE_COUNT}}},
+
+    {"hold repeats until release", ALL,
+     {{0, 1}, {LONG_MS + 2 * REPEAT_MS + 50, 0}, {END}},
+     {{GESTURE_LONG_PRESS, 0, LONG_MS}, {GESTURE_HOLD_REPEAT, 1, LONG_MS + REPEAT_MS},
+      {GESTURE_HOLD_REPEAT, 2, LONG_MS + 2 * REPEAT_MS}, {GESTURE_COUNT}}},
+
+    {"click then hold is a long press", ALL,
+     {{0, 1}, {100, 0}, {200, 1}, {200 + LONG_MS + 10, 0}, {END}},
+     {{GESTURE_LONG_PRESS, 0, 200 + LONG_MS}, {GESTURE_COUNT}}},
+
+    {"disabled single click is not reported", GESTURE_MASK(GESTURE_DOUBLE_CLICK),
+     {{0, 1}, {100, 0}, {1000, 1}, {1100, 0}, {1200, 1}, {1300, 0}, {END}},
+     {{GESTURE_DOUBLE_CLICK, 0, 1300}, {GESTURE_COUNT}}},
+};
+
+static gesture_event_t m_events[16];
+static uint32_t m_event_ticks[16];
+static int m_event_count;
+
+static uint32_t ms_to_ticks(uint32_t ms)
+{
+    return (uint32_t)((ms * RTC_HZ) / 1000);
+}
+
+static void record(gesture_event_t const * p_event, uint32_t timestamp)
+{
+    if (m_event_count < 16)
+    {
+        m_events[m_event_count] = *p_event;
+        m_event_ticks[m_event_count] = timestamp;
+        m_event_count++;
+    }
+}
+
+static void timeouts_run(gesture_t * p_gesture, uint32_t until)
+{
+    gesture_event_t event;
+    uint32_t deadline;
+
+    while (gesture_deadline(p_gesture, &deadline) &&
+           ((until - deadline) & TICK_MASK) < (TICK_MASK / 2))
+    {
+        if (gesture_timeout(p_gesture, deadline, &event))
+        {
+            record(&event, deadline);
+        }
+    }
+}
+
+static bool scenario_run(scenario_t const * p_scenario, uint32_t offset)
+{
+    gesture_config_t const config =
+    {
+        .click_gap_ticks  = ms_to_ticks(GAP_MS),
+        .long_press_ticks = ms_to_ticks(LONG_MS),
+        .repeat_ticks     = ms_to_ticks(REPEAT_MS)
+    };
+    gesture_t gesture;
+    gesture_event_t event;
+    uint32_t last_ms = 0;
+    bool ok = true;
+
+    m_event_count = 0;
+    gesture_init(&gesture, &config, p_scenario->enabled);
+
+    for (step_t const * p_step = p_scenario->steps; p_step->time_ms != END; p_step++)
+    {
+        uint32_t t = (offset + ms_to_ticks(p_step->time_ms)) & TICK_MASK;
+
+        timeouts_run(&gesture, t);
+        if (gesture_edge(&gesture, p_step->pressed, t, &event))
+        {
+            record(&event, t);
+        }
+        last_ms = p_step->time_ms;
+    }
+    timeouts_run(&gesture, (offset + ms_to_ticks(last_ms + HORIZON_MS)) & TICK_MASK);
+
+    int expected = 0;
+    while (p_scenario->expect[expected].type != GESTURE_COUNT)
+    {
+        expected++;
+    }
+    if (expected != m_event_count)
+    {
+        ok = false;
+    }
+
+    for (int i = 0; i < m_event_count && i < expected; i++)
+    {
+        expect_t const * p_expect = &p_scenario->expect[i];
+        uint32_t t = (m_event_ticks[i] - offset) & TICK_MASK;
+
+        if (m_events[i].type != p_expect->type || m_events[i].count != p_expect->count ||
+            t != ms_to_ticks(p_expect->time_ms))
+        {
+            ok = false;
+        }
+    }
+
+    printf("%s %s%s\n", ok ? "ok  " : "FAIL", p_scenario->p_name, offset == 0 ? "" : " (wrap)");
+    if (!ok)
+    {
+        for (int i = 0; i < m_event_count; i++)
+        {
+            uint32_t t = (m_event_ticks[i] - offset) & TICK_MASK;
+            printf("     got %s %u at %.1f ms\n", m_names[m_events[i].type], m_events[i].count,
+                   t * 1000.0 / RTC_HZ);
+        }
+        for (int i = 0; i < expected; i++)
+        {
+            printf("     expected %s %u at %u ms\n", m_names[p_scenario->expect[i].type],
+                   p_scenario->expect[i].count, p_scenario->expect[i].time_ms);
+        }
+    }
+    return ok;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    printf("gap %u ms, long press %u ms, repeat %u ms\n", GAP_MS, LONG_MS, REPEAT_MS);
+    for (size_t i = 0; i < sizeof(m_scenarios) / sizeof(m_scenarios[0]); i++)
+    {
+        failures += !scenario_run(&m_scenarios[i], 0);
+        failures += !scenario_run(&m_scenarios[i], WRAP_OFFSET);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
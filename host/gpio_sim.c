@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "nrf_gpio.h"
+#include "led_pins.h"
+#include "sim.h"
+
+// Checks the compile-time LED pin masks and compares the two ways of
+// writing an LED frame (every channel on or off, as the software PWM does at
+// the start of a period): one nrf_gpio_pin_write() per channel against the
+// port masks of led_pins.h. Reports GPIO register writes per frame, the skew
+// between the first and the last LED to change (in register writes) and the
+// host time per frame on the GPIO model.
+
+#define FRAMES 1000000
+
+_Static_assert(LED_PINS_PORT_MASK(LED_PINS_ALL, 0) == ((1UL << 6) | (1UL << 8) | (1UL << 12)),
+               "P0 LED mask");
+_Static_assert(LED_PINS_PORT_MASK(LED_PINS_ALL, 1) == (1UL << 9), "P1 LED mask");
+
+static const uint32_t m_pins[LEDS_NUMBER] = {YELLOW_LED_PIN, RED_LED_PIN, GREEN_LED_PIN, BLUE_LED_PIN};
+
+// Register write during which every pin last changed
+static uint32_t m_changed_at[HOST_GPIO_PIN_COUNT];
+static uint32_t m_first;
+static uint32_t m_last;
+
+static void gpio_observer(uint32_t pin_number, uint32_t value, uint64_t time_ns)
+{
+    uint32_t write = host_gpio_writes();
+
+    m_changed_at[pin_number] = write;
+    m_first = write < m_first ? write : m_first;
+    m_last = write > m_last ? write : m_last;
+}
+
+// The LED frame path before the port masks
+static void frame_write_per_pin(uint8_t on_mask)
+{
+    for (int i = 0; i < LEDS_NUMBER; i++)
+    {
+        nrf_gpio_pin_write(m_pins[i], !(on_mask & (1 << i)));
+    }
+}
+
+static void frame_write_masks(uint8_t on_mask)
+{
+    led_pins_clear(LED_PINS_MASKS(on_mask));
+    led_pins_set(LED_PINS_MASKS(~on_mask & LED_PINS_ALL));
+}
+
+static bool masks_check(void)
+{
+    bool ok = true;
+
+    for (uint8_t mask = 0; mask <= LED_PINS_ALL; mask++)
+    {
+        led_pins_masks_t masks = LED_PINS_MASKS(mask);
+        led_pins_masks_t expected = {{0}};
+
+        for (int i = 0; i < LEDS_NUMBER; i++)
+        {
+            if (mask & (1 << i))
+            {
+                led_pins_masks_t pin = led_pins_masks_of(m_pins[i]);
+                expected.port[0] |= pin.port[0];
+                expected.port[1] |= pin.port[1];
+            }
+        }
+        ok &= masks.port[0] == expected.port[0] && masks.port[1] == expected.port[1];
+    }
+
+    // All off from all on: one OUTSET per port
+    frame_write_per_pin(LED_PINS_ALL);
+    uint32_t writes = host_gpio_writes();
+    led_pins_set(LED_PINS_MASKS(LED_PINS_ALL));
+    writes = host_gpio_writes() - writes;
+    for (int i = 0; i < LEDS_NUMBER; i++)
+    {
+        ok &= nrf_gpio_pin_out_read(m_pins[i]) == 1;
+    }
+    ok &= writes == LED_PINS_PORTS;
+
+    printf("%s masks        16 channel sets, all LEDs off in %u register writes\n",
+           ok ? "ok  " : "FAIL", writes);
+    return ok;
+}
+
+static bool frames_bench(char const * p_name, void (*write)(uint8_t), uint32_t max_writes)
+{
+    struct timespec start;
+    struct timespec end;
+    uint32_t writes = host_gpio_writes();
+    uint32_t skew_max = 0;
+    uint32_t seed = 1;
+    bool ok = true;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < FRAMES; n++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint8_t on_mask = (seed >> 16) & LED_PINS_ALL;
+
+        m_first = UINT32_MAX;
+        m_last = 0;
+        write(on_mask);
+        if (m_last >= m_first && m_last - m_first > skew_max)
+        {
+            skew_max = m_last - m_first;
+        }
+        for (int i = 0; i < LEDS_NUMBER; i++)
+        {
+            ok &= nrf_gpio_pin_out_read(m_pins[i]) == !(on_mask & (1 << i));
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    double per_frame = (double)(host_gpio_writes() - writes) / FRAMES;
+
+    ok &= per_frame <= max_writes;
+    printf("%s %-12s %.2f register writes/frame, skew up to %u writes, %.1f ns/frame (host GPIO model)\n",
+           ok ? "ok  " : "FAIL", p_name, per_frame, skew_max, ns / FRAMES);
+    return ok;
+}
+
+int main(void)
+{
+    sim_reset();
+    for (int i = 0; i < LEDS_NUMBER; i++)
+    {
+        nrf_gpio_cfg_output(m_pins[i]);
+        nrf_gpio_pin_write(m_pins[i], 1);
+    }
+    host_gpio_observer_set(gpio_observer);
+
+    bool ok = masks_check();
+    ok &= frames_bench("per pin", frame_write_per_pin, LEDS_NUMBER);
+    // On and off sets, two ports each
+    ok &= frames_bench("port masks", frame_write_masks, 2 * LED_PINS_PORTS);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "nrf_rtc.h"
+#include "nrfx_timer.h"
+#include "hires_timer.h"
+#include "sim.h"
+
+// Runs the firmware's hires_timer.c on the RTC, TIMER and PPI models, with
+// the TIMER (HFINT) off by a clock error and the RTC started just before its
+// overflow. Fires chained and single deadlines on all the paths: fine TIMER
+// kept running, RTC started, too close for the RTC and too far for the
+// compare register, and checks each against the true time of the RTC. A
+// sampler reads hires_timer_now_us() all along and checks that it never steps
+// back and stays within a tick of the true time.
+
+#define US            1000ULL
+#define S             1000000000ULL
+#define CHAIN_US      250
+#define CHAIN_COUNT   20000
+#define SAMPLE_NS     13721             // away from the tick and the us grid
+#define SAMPLE_FAR_NS (10 * 1000 * US + 7)
+
+// The RTC starts 16 ticks before it wraps
+#define RTC_START_COUNTER (NRF_RTC_COUNTER_MAX - 0xF)
+
+typedef struct
+{
+    char const * p_name;
+    uint32_t     count;
+    double       early_us;              // most ahead of the deadline
+    double       late_us;               // most behind it
+} firing_t;
+
+static hires_timer_t m_timer;
+static firing_t * mp_firing;
+static uint32_t m_chain_left;
+static bool m_fired;
+
+static uint32_t m_sample_ns = SAMPLE_NS;
+static uint64_t m_samples;
+static uint64_t m_last_now_us;
+static uint32_t m_backwards;
+static double m_sample_ahead_us;
+static double m_sample_behind_us;
+
+// hires_timer_now_us() should read, exactly
+static double true_us(void)
+{
+    return RTC_START_COUNTER * (1e6 / RTC_INPUT_FREQ) + sim_time_ns() / 1e3;
+}
+
+static void sample(void * p_context)
+{
+    uint64_t now = hires_timer_now_us();
+    double error = now - true_us();
+
+    if (now < m_last_now_us)
+    {
+        m_backwards++;
+    }
+    m_last_now_us = now;
+    m_sample_ahead_us = error > m_sample_ahead_us ? error : m_sample_ahead_us;
+    m_sample_behind_us = -error > m_sample_behind_us ? -error : m_sample_behind_us;
+    m_samples++;
+
+    sim_schedule(sim_time_ns() + m_sample_ns, sample, NULL);
+}
+
+static void fired(void * p_context)
+{
+    double error = true_us() - m_timer.deadline_us;
+
+    mp_firing->count++;
+    mp_firing->early_us = -error > mp_firing->early_us ? -error : mp_firing->early_us;
+    mp_firing->late_us = error > mp_firing->late_us ? error : mp_firing->late_us;
+
+    if (m_chain_left > 0)
+    {
+        m_chain_left--;
+        hires_timer_start_at(&m_timer, m_timer.deadline_us + CHAIN_US, fired, NULL);
+    }
+    else
+    {
+        m_fired = true;
+    }
+}
+
+static void fire(firing_t * p_firing, uint32_t delay_us)
+{
+    mp_firing = p_firing;
+    m_fired = false;
+    hires_timer_start(&m_timer, delay_us, fired, NULL);
+    while (!m_fired && sim_run_next())
+    {
+    }
+}
+
+// Away from the RTC ticks, with the fine TIMER stopped
+static void idle(uint64_t duration_ns)
+{
+    sim_run_until(sim_time_ns() + duration_ns);
+}
+
+static bool firing_check(firing_t const * p_firing, uint32_t count, double late_us)
+{
+    bool pass = p_firing->count == count && p_firing->early_us <= 1.0 && p_firing->late_us <= late_us;
+
+    printf("%s %-10s %5u fired, up to %.3f us early, %.3f us late (%.1f allowed)\n", pass ? "ok  " : "FAIL",
+           p_firing->p_name, p_firing->count, p_firing->early_us, p_firing->late_us, late_us);
+    return pass;
+}
+
+int main(int argc, char ** argv)
+{
+    int32_t error_ppm = argc > 1 ? atoi(argv[1]) : -5000;
+    bool ok = true;
+
+    firing_t chain = {"chained"};
+    firing_t armed = {"rtc start"};
+    firing_t close = {"too close"};
+    firing_t close_armed = {"rtc start"};
+    firing_t far = {"far"};
+
+    host_timer_clock_error_set(error_ppm);
+    hires_timer_init();
+    nrf_rtc_task_trigger(NRF_RTC2, NRF_RTC_TASK_TRIGGER_OVERFLOW);
+    m_last_now_us = hires_timer_now_us();
+    sim_schedule(SAMPLE_NS, sample, NULL);
+
+    // 5 s on the fine TIMER alone, across the RTC overflow
+    m_chain_left = CHAIN_COUNT - 1;
+    fire(&chain, CHAIN_US);
+    ok &= firing_check(&chain, CHAIN_COUNT, 4.0);
+
+    // The RTC starts the TIMER on the tick before the deadline
+    fire(&armed, 5000);
+    ok &= firing_check(&armed, 1, 2.0);
+
+    // From the RTC alone, mid-tick: counted from the time read last
+    idle(12345 * US + 17);
+    fire(&close, 10);
+    idle(7 * US + 501);
+    fire(&close, 70);
+    idle(3 * US + 999);
+    fire(&close, 1);
+    ok &= firing_check(&close, 3, 31.0);
+
+    idle(5 * US + 123);
+    fire(&close_armed, 100);
+    ok &= firing_check(&close_armed, 1, 2.0);
+
+    // Beyond half the counter range, then across its wrap
+    m_sample_ns = SAMPLE_FAR_NS;
+    fire(&far, 300000000);
+    fire(&far, 400000000);
+    ok &= firing_check(&far, 2, 2.0);
+
+    bool pass = m_backwards == 0 && m_sample_ahead_us <= 2.0 && m_sample_behind_us <= 32.0;
+    printf("%s now        %llu reads, %u backwards, %.3f us ahead to %.3f us behind of the RTC\n",
+           pass ? "ok  " : "FAIL", (unsigned long long)m_samples, m_backwards, m_sample_ahead_us,
+           m_sample_behind_us);
+    printf("TIMER clock error %+d ppm, %.1f s\n", error_ppm, sim_time_ns() / (double)S);
+
+    return ok && pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,50 @@
+#include <stddef.h>
+#include "hires_timer.h"
+#include "sim.h"
+
+// hires_timer on virtual time: every pending timer is a simulator event, the
+// RTC/TIMER split of the firmware version only matters for power
+
+static void timer_expired(void * p_context)
+{
+    hires_timer_t * p_timer = p_context;
+
+    p_timer->active = false;
+    p_timer->handler(p_timer->p_context);
+}
+
+void hires_timer_init(void)
+{
+}
+
+uint64_t hires_timer_now_us(void)
+{
+    return sim_time_ns() / 1000;
+}
+
+void hires_timer_start_at(hires_timer_t * p_timer, uint64_t deadline_us,
+                          hires_timer_handler_t handler, void * p_context)
+{
+    hires_timer_stop(p_timer);
+
+    p_timer->deadline_us = deadline_us;
+    p_timer->handler = handler;
+    p_timer->p_context = p_context;
+    p_timer->active = true;
+    sim_schedule(deadline_us * 1000, timer_expired, p_timer);
+}
+
+void hires_timer_start(hires_timer_t * p_timer, uint32_t delay_us,
+                       hires_timer_handler_t handler, void * p_context)
+{
+    hires_timer_start_at(p_timer, hires_timer_now_us() + delay_us, handler, p_context);
+}
+
+void hires_timer_stop(hires_timer_t * p_timer)
+{
+    if (p_timer->active)
+    {
+        sim_cancel(timer_expired, p_timer);
+        p_timer->active = false;
+    }
+}
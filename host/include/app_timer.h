@@ -0,0 +1,55 @@
+#ifndef APP_TIMER_H__
+#define APP_TIMER_H__
+
+// Host stand-in for app_timer: a 32768 Hz, 24-bit RTC counter derived from
+// virtual time, timeouts are simulator events on RTC tick boundaries
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "sdk_config.h"
+
+#define APP_TIMER_CLOCK_FREQ        32768
+#define APP_TIMER_MIN_TIMEOUT_TICKS 5
+#define APP_TIMER_MAX_CNT_VAL       0x00FFFFFF
+
+#define APP_TIMER_TICKS(MS) \
+    ((uint32_t)((((uint64_t)(MS) * APP_TIMER_CLOCK_FREQ) + 500) / (1000 * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1))))
+
+typedef void (*app_timer_timeout_handler_t)(void * p_context);
+
+typedef enum
+{
+    APP_TIMER_MODE_SINGLE_SHOT,
+    APP_TIMER_MODE_REPEATED
+} app_timer_mode_t;
+
+typedef struct
+{
+    app_timer_timeout_handler_t handler;
+    app_timer_mode_t            mode;
+    uint32_t                    ticks;
+    void *                      p_context;
+    bool                        active;
+} app_timer_t;
+
+typedef app_timer_t * app_timer_id_t;
+
+#define APP_TIMER_DEF(timer_id)                      \
+    static app_timer_t CONCAT_2(timer_id, _data);    \
+    static app_timer_id_t const timer_id = &CONCAT_2(timer_id, _data)
+
+#ifndef CONCAT_2
+#define CONCAT_2(p1, p2)      CONCAT_2_(p1, p2)
+#define CONCAT_2_(p1, p2)     p1##p2
+#endif
+
+ret_code_t app_timer_init(void);
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler);
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context);
+ret_code_t app_timer_stop(app_timer_id_t timer_id);
+uint32_t app_timer_cnt_get(void);
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef APP_USBD_H__
+#define APP_USBD_H__
+
+// Host stand-in for app_usbd: the stack states and its event queue, with one
+// class instance, the CDC ACM port of app_usbd_cdc_acm.h. Events are queued by
+// the models and run from app_usbd_event_queue_process(), as with
+// APP_USBD_CONFIG_EVENT_QUEUE_ENABLE.
+
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+typedef enum
+{
+    APP_USBD_EVT_POWER_DETECTED,
+    APP_USBD_EVT_POWER_REMOVED,
+    APP_USBD_EVT_POWER_READY
+} app_usbd_event_type_t;
+
+typedef struct
+{
+    void (*ev_state_proc)(app_usbd_event_type_t event);
+} app_usbd_config_t;
+
+// Base of every class instance
+typedef struct
+{
+    char const * p_name;
+} app_usbd_class_inst_t;
+
+ret_code_t app_usbd_init(app_usbd_config_t const * p_config);
+void app_usbd_enable(void);
+void app_usbd_disable(void);
+void app_usbd_start(void);
+void app_usbd_stop(void);
+ret_code_t app_usbd_class_append(app_usbd_class_inst_t const * p_instance);
+
+// VBUS as nrfx_power reports it when called, the model sees no later change
+ret_code_t app_usbd_power_events_enable(void);
+
+// Run one queued event, false if there was none
+bool app_usbd_event_queue_process(void);
+
+#endif
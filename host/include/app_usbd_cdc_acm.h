@@ -0,0 +1,91 @@
+#ifndef APP_USBD_CDC_ACM_H__
+#define APP_USBD_CDC_ACM_H__
+
+// Host stand-in for the CDC ACM class of app_usbd. The port is the master
+// side of a pseudo terminal, tools open the slave side as they would
+// /dev/ttyACM0: opening it raises DTR (PORT_OPEN), closing it drops it
+// (PORT_CLOSE). An IN transfer takes the time of its packets on the bus and
+// ends with TX_DONE, also when the port was closed in between; its bytes
+// only reach the session it was started in. OUT data is read in packets of
+// the endpoint size.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "app_usbd.h"
+#include "nrf_drv_usbd.h"
+
+// Full speed bulk IN, packets the host reads per 1 ms frame
+#define HOST_CDC_ACM_PACKETS_PER_FRAME 8
+
+typedef enum
+{
+    APP_USBD_CDC_ACM_USER_EVT_RX_DONE,
+    APP_USBD_CDC_ACM_USER_EVT_TX_DONE,
+    APP_USBD_CDC_ACM_USER_EVT_PORT_OPEN,
+    APP_USBD_CDC_ACM_USER_EVT_PORT_CLOSE
+} app_usbd_cdc_acm_user_event_t;
+
+#define APP_USBD_CDC_COMM_PROTOCOL_NONE 0
+
+typedef void (*app_usbd_cdc_acm_user_ev_handler_t)(app_usbd_class_inst_t const * p_inst,
+                                                   app_usbd_cdc_acm_user_event_t event);
+
+typedef struct
+{
+    app_usbd_class_inst_t              base;
+    app_usbd_cdc_acm_user_ev_handler_t user_ev_handler;
+} app_usbd_cdc_acm_t;
+
+#define APP_USBD_CDC_ACM_GLOBAL_DEF(name, ev_handler, comm_ifc, data_ifc, comm_ein, data_ein, data_eout, \
+                                    cdc_protocol)                                                     \
+    app_usbd_cdc_acm_t const name = {.base = {.p_name = #name}, .user_ev_handler = ev_handler}
+
+static inline app_usbd_class_inst_t const * app_usbd_cdc_acm_class_inst_get(app_usbd_cdc_acm_t const * p_cdc_acm)
+{
+    return &p_cdc_acm->base;
+}
+
+static inline app_usbd_cdc_acm_t const * app_usbd_cdc_acm_class_get(app_usbd_class_inst_t const * p_inst)
+{
+    return (app_usbd_cdc_acm_t const *)p_inst;
+}
+
+// NRF_ERROR_INVALID_STATE while the port is closed, NRF_ERROR_BUSY while a
+// transfer is in flight
+ret_code_t app_usbd_cdc_acm_write(app_usbd_cdc_acm_t const * p_cdc_acm, void const * p_buf, size_t length);
+
+// NRF_SUCCESS with data there already, NRF_ERROR_IO_PENDING when the buffer
+// waits for RX_DONE
+ret_code_t app_usbd_cdc_acm_read_any(app_usbd_cdc_acm_t const * p_cdc_acm, void * p_buf, size_t length);
+
+size_t app_usbd_cdc_acm_rx_size(app_usbd_cdc_acm_t const * p_cdc_acm);
+
+typedef struct
+{
+    uint32_t opens;
+    uint32_t transfers;             // IN transfers
+    uint32_t stale;                 // of them ended after the port was closed
+    uint32_t bytes_in;              // to the host
+    uint32_t bytes_out;             // from the host
+} host_cdc_acm_stats_t;
+
+// Host only: create the pseudo terminal, false on error. The slave path is in p_path.
+bool host_cdc_acm_open(char * p_path, uint32_t size);
+
+void host_cdc_acm_close(void);
+
+// Host only: look at the pseudo terminal, true if that queued an event. The
+// pty reports a close of the slave side a moment later.
+bool host_cdc_acm_poll(void);
+
+// Host only: DTR as the last poll saw it
+bool host_cdc_acm_port_open(void);
+
+// Host only: an IN transfer is in flight
+bool host_cdc_acm_tx_busy(void);
+
+void host_cdc_acm_stats_get(host_cdc_acm_stats_t * p_stats);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef APP_USBD_CORE_H__
+#define APP_USBD_CORE_H__
+
+// Host stand-in, the device descriptors are not modelled
+
+#include "app_usbd.h"
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef APP_USBD_SERIAL_NUM_H__
+#define APP_USBD_SERIAL_NUM_H__
+
+// Host stand-in, there is no serial number string to fill in
+
+static inline void app_usbd_serial_num_generate(void) {}
+
+#endif
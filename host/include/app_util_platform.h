@@ -0,0 +1,10 @@
+#ifndef APP_UTIL_PLATFORM_H
+#define APP_UTIL_PLATFORM_H
+
+// Host stand-in: interrupts are simulator events that only run while the
+// firmware sleeps, so there is nothing to lock out
+
+#define CRITICAL_REGION_ENTER() {
+#define CRITICAL_REGION_EXIT()  }
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef CRC16_H__
+#define CRC16_H__
+
+// Host stand-in for the SDK CRC-16/CCITT, same algorithm
+
+#include <stdint.h>
+
+// CRC over p_data, continuing from *p_crc or from 0xFFFF if p_crc is NULL
+uint16_t crc16_compute(uint8_t const * p_data, uint32_t size, uint16_t const * p_crc);
+
+#endif
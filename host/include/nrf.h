@@ -0,0 +1,49 @@
+#ifndef NRF_H
+#define NRF_H
+
+// Host stand-in for the CMSIS device header. The CPU sleeps in virtual time:
+// __WFE() runs the simulator up to the next event, interrupts are simulator
+// events and set the event register like exception entry does on the core.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define __FPU_USED 0
+
+void host_cpu_wfe(void);
+void host_cpu_sev(void);
+
+#define __WFE() host_cpu_wfe()
+#define __SEV() host_cpu_sev()
+
+// Debug registers. Code takes no cycles in virtual time, so CYCCNT only moves
+// when a simulator writes it.
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+#define DWT       (&host_dwt)
+#define CoreDebug (&host_core_debug)
+
+extern uint32_t SystemCoreClock;
+
+// Host only: start entry() (the firmware main) and run it up to virtual time
+// until_ns, returns when the firmware sleeps past that time
+void host_cpu_run(int (*entry)(void), uint64_t until_ns);
+
+// Host only: let the firmware started by host_cpu_run() continue up to until_ns
+void host_cpu_resume(uint64_t until_ns);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef NRF_ATFIFO_H__
+#define NRF_ATFIFO_H__
+
+// Host stand-in for the lock-free FIFO, same API and capacity, a plain ring
+// buffer is enough on the single simulator thread
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdk_errors.h"
+
+typedef struct
+{
+    uint8_t * p_buf;
+    uint16_t  buf_size;
+    uint16_t  item_size;
+    uint16_t  head;   // next read, in bytes
+    uint16_t  tail;   // next write, in bytes
+} nrf_atfifo_t;
+
+#define NRF_ATFIFO_BUF_NAME(fifo_id)  fifo_id##_data
+#define NRF_ATFIFO_INST_NAME(fifo_id) fifo_id##_inst
+
+// One item more than requested, a full ring keeps one slot free
+#define NRF_ATFIFO_DEF(fifo_id, storage_type, item_cnt)                   \
+    static storage_type NRF_ATFIFO_BUF_NAME(fifo_id)[(item_cnt) + 1];     \
+    static nrf_atfifo_t NRF_ATFIFO_INST_NAME(fifo_id);                     \
+    static nrf_atfifo_t * const fifo_id = &NRF_ATFIFO_INST_NAME(fifo_id)
+
+#define NRF_ATFIFO_INIT(fifo_id)                                          \
+    nrf_atfifo_init(fifo_id, NRF_ATFIFO_BUF_NAME(fifo_id),                \
+                    sizeof(NRF_ATFIFO_BUF_NAME(fifo_id)),                  \
+                    sizeof(NRF_ATFIFO_BUF_NAME(fifo_id)[0]))
+
+ret_code_t nrf_atfifo_init(nrf_atfifo_t * const p_fifo, void * p_buf, uint16_t buf_size,
+                           uint16_t item_size);
+
+ret_code_t nrf_atfifo_alloc_put(nrf_atfifo_t * const p_fifo, void const * p_var, size_t size,
+                                bool * const p_visible);
+
+ret_code_t nrf_atfifo_get_free(nrf_atfifo_t * const p_fifo, void * const p_var, size_t size,
+                               bool * p_released);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef NRF_ATOMIC_H__
+#define NRF_ATOMIC_H__
+
+// Host stand-in: the simulator runs interrupts one at a time on one thread,
+// plain read-modify-write is atomic there
+
+#include <stdint.h>
+
+typedef volatile uint32_t nrf_atomic_u32_t;
+typedef volatile uint32_t nrf_atomic_flag_t;
+
+static inline uint32_t nrf_atomic_u32_fetch_store(nrf_atomic_u32_t * p_data, uint32_t value)
+{
+    uint32_t old = *p_data;
+    *p_data = value;
+    return old;
+}
+
+static inline uint32_t nrf_atomic_u32_or(nrf_atomic_u32_t * p_data, uint32_t value)
+{
+    return *p_data |= value;
+}
+
+static inline uint32_t nrf_atomic_u32_and(nrf_atomic_u32_t * p_data, uint32_t value)
+{
+    return *p_data &= value;
+}
+
+static inline uint32_t nrf_atomic_u32_add(nrf_atomic_u32_t * p_data, uint32_t value)
+{
+    return *p_data += value;
+}
+
+static inline uint32_t nrf_atomic_u32_sub(nrf_atomic_u32_t * p_data, uint32_t value)
+{
+    return *p_data -= value;
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef NRF_DRV_CLOCK_H__
+#define NRF_DRV_CLOCK_H__
+
+// Host stand-in: the clocks are always running in virtual time
+
+#include <stddef.h>
+#include "sdk_errors.h"
+
+typedef struct nrf_drv_clock_handler_item_s nrf_drv_clock_handler_item_t;
+
+static inline ret_code_t nrf_drv_clock_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+static inline void nrf_drv_clock_lfclk_request(nrf_drv_clock_handler_item_t * p_handler_item)
+{
+    (void)p_handler_item;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef NRF_DRV_USBD_H__
+#define NRF_DRV_USBD_H__
+
+// Host stand-in for the USBD driver: endpoint addresses and the enable state,
+// transfers are modelled by the CDC ACM class in app_usbd_host.c
+
+#include <stdbool.h>
+
+#define NRF_DRV_USBD_EPIN(n)  (0x80 | (n))
+#define NRF_DRV_USBD_EPOUT(n) (n)
+#define NRF_DRV_USBD_EPSIZE   64
+
+bool nrf_drv_usbd_is_enabled(void);
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef NRF_FSTORAGE_H__
+#define NRF_FSTORAGE_H__
+
+// Host stand-in for nrf_fstorage with the NVMC backend: the flash area is a
+// RAM image that behaves like NOR flash. Programming only clears bits, an
+// erase sets a whole page to 0xFF, operations complete before the call
+// returns and their event is sent from within it, as nrf_fstorage_nvmc does.
+//
+// nrf_fstorage_init() moves start_addr and end_addr to the image, so the
+// area can be read through pointers as the firmware reads memory mapped
+// flash. The image survives a sim_reset(), like flash survives a reset.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_errors.h"
+
+#define HOST_FLASH_PAGE_SIZE 4096
+#define HOST_FLASH_PAGES     8
+
+typedef enum
+{
+    NRF_FSTORAGE_EVT_READ_RESULT,
+    NRF_FSTORAGE_EVT_WRITE_RESULT,
+    NRF_FSTORAGE_EVT_ERASE_RESULT
+} nrf_fstorage_evt_id_t;
+
+typedef struct
+{
+    nrf_fstorage_evt_id_t id;
+    ret_code_t            result;
+    uintptr_t             addr;
+    void const *          p_src;
+    uint32_t              len;
+    void *                p_param;
+} nrf_fstorage_evt_t;
+
+typedef void (*nrf_fstorage_evt_handler_t)(nrf_fstorage_evt_t * p_evt);
+
+typedef struct
+{
+    uint32_t erase_unit;
+    uint32_t program_unit;
+    bool     rmap;
+    bool     wmap;
+} nrf_fstorage_info_t;
+
+typedef struct
+{
+    int unused;
+} nrf_fstorage_api_t;
+
+typedef struct
+{
+    nrf_fstorage_api_t const *  p_api;
+    nrf_fstorage_info_t const * p_flash_info;
+    nrf_fstorage_evt_handler_t  evt_handler;
+    uintptr_t                   start_addr;
+    uintptr_t                   end_addr;
+} nrf_fstorage_t;
+
+// No section of instances on the host
+#define NRF_FSTORAGE_DEF(inst) inst
+
+ret_code_t nrf_fstorage_init(nrf_fstorage_t * p_fs, nrf_fstorage_api_t * p_api, void * p_param);
+
+ret_code_t nrf_fstorage_read(nrf_fstorage_t const * p_fs, uintptr_t src, void * p_dest, uint32_t len);
+
+// len a multiple of 4, dest word aligned
+ret_code_t nrf_fstorage_write(nrf_fstorage_t const * p_fs, uintptr_t dest, void const * p_src,
+                              uint32_t len, void * p_param);
+
+// len pages from page_addr
+ret_code_t nrf_fstorage_erase(nrf_fstorage_t const * p_fs, uintptr_t page_addr, uint32_t len,
+                              void * p_param);
+
+bool nrf_fstorage_is_busy(nrf_fstorage_t const * p_fs);
+
+// Host only: back to a blank part, every page erased, counters cleared
+void host_flash_blank(void);
+
+// Host only: p points into the image
+bool host_flash_contains(void const * p);
+
+// Host only: power fails in the op-th word operation from now (1: the next
+// word programmed or erased), 0: never. A word being programmed gets part of
+// its bits, an erase stops with the words before it erased and the rest as
+// they were. Every operation after it is ignored, and sends no event, until
+// host_flash_power_on().
+void host_flash_power_loss_at(uint32_t op);
+
+bool host_flash_power_lost(void);
+
+void host_flash_power_on(void);
+
+typedef struct
+{
+    uint32_t words;                     // programmed
+    uint32_t erases[HOST_FLASH_PAGES];  // per page of the image
+    uint32_t overwrites;                // words programmed with a 1 over a 0, a bug
+    uint32_t ops;                       // word operations, an erase counts 1 per word
+} host_flash_stats_t;
+
+void host_flash_stats_get(host_flash_stats_t * p_stats);
+
+#endif
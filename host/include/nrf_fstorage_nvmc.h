@@ -0,0 +1,10 @@
+#ifndef NRF_FSTORAGE_NVMC_H__
+#define NRF_FSTORAGE_NVMC_H__
+
+// Host stand-in: the NVMC backend is nrf_fstorage_host.c
+
+#include "nrf_fstorage.h"
+
+extern nrf_fstorage_api_t nrf_fstorage_nvmc;
+
+#endif
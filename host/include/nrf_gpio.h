@@ -0,0 +1,55 @@
+#ifndef NRF_GPIO_H__
+#define NRF_GPIO_H__
+
+// Host stand-in for the GPIO HAL. Pin levels live in the model, outputs
+// report every change with its virtual time to an optional observer.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NRF_GPIO_PIN_MAP(port, pin) (((port) << 5) | ((pin) & 0x1F))
+#define HOST_GPIO_PIN_COUNT         48
+
+typedef enum
+{
+    NRF_GPIO_PIN_NOPULL   = 0,
+    NRF_GPIO_PIN_PULLDOWN = 1,
+    NRF_GPIO_PIN_PULLUP   = 3
+} nrf_gpio_pin_pull_t;
+
+void nrf_gpio_cfg_output(uint32_t pin_number);
+void nrf_gpio_cfg_input(uint32_t pin_number, nrf_gpio_pin_pull_t pull_config);
+void nrf_gpio_pin_write(uint32_t pin_number, uint32_t value);
+void nrf_gpio_pin_set(uint32_t pin_number);
+void nrf_gpio_pin_clear(uint32_t pin_number);
+void nrf_gpio_pin_toggle(uint32_t pin_number);
+uint32_t nrf_gpio_pin_read(uint32_t pin_number);
+uint32_t nrf_gpio_pin_out_read(uint32_t pin_number);
+
+// Port registers, OUTSET/OUTCLR write every pin of a mask at once
+typedef struct
+{
+    uint32_t port;
+} NRF_GPIO_Type;
+
+extern NRF_GPIO_Type host_gpio_p0;
+extern NRF_GPIO_Type host_gpio_p1;
+#define NRF_P0 (&host_gpio_p0)
+#define NRF_P1 (&host_gpio_p1)
+
+void nrf_gpio_port_out_set(NRF_GPIO_Type * p_reg, uint32_t set_mask);
+void nrf_gpio_port_out_clear(NRF_GPIO_Type * p_reg, uint32_t clr_mask);
+
+// Host only: GPIO register writes so far, a pin write is one
+uint32_t host_gpio_writes(void);
+
+// Host only: every change of an output level
+typedef void (* host_gpio_observer_t)(uint32_t pin_number, uint32_t value, uint64_t time_ns);
+
+void host_gpio_observer_set(host_gpio_observer_t observer);
+
+// Host only: drive an input pin from outside (button), raises the GPIOTE
+// interrupt if the pin is sensed
+void host_gpio_input_set(uint32_t pin_number, uint32_t value);
+
+#endif
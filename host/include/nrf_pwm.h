@@ -0,0 +1,100 @@
+#ifndef NRF_PWM_H__
+#define NRF_PWM_H__
+
+// Host model of the PWM peripheral registers. The mocked nrfx_pwm driver
+// programs these exactly like the real one, and the playback model in
+// nrfx_pwm_host.c fetches sequence values through SEQ[n].PTR the way EasyDMA does.
+
+#include <stdint.h>
+
+#define NRF_PWM_CHANNEL_COUNT 4
+
+typedef struct
+{
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_SEQSTART[2];
+    volatile uint32_t EVENTS_STOPPED;
+    volatile uint32_t EVENTS_SEQEND[2];
+    volatile uint32_t EVENTS_LOOPSDONE;
+    volatile uint32_t SHORTS;
+    volatile uint32_t INTEN;
+    volatile uint32_t ENABLE;
+    volatile uint32_t MODE;
+    volatile uint32_t COUNTERTOP;
+    volatile uint32_t PRESCALER;
+    volatile uint32_t DECODER;
+    volatile uint32_t LOOP;
+    struct
+    {
+        volatile uintptr_t PTR;      // a host pointer does not fit the real 32-bit register
+        volatile uint32_t  CNT;
+        volatile uint32_t  REFRESH;
+        volatile uint32_t  ENDDELAY;
+    } SEQ[2];
+    volatile uint32_t PSEL_OUT[NRF_PWM_CHANNEL_COUNT];
+} NRF_PWM_Type;
+
+extern NRF_PWM_Type host_pwm_registers[4];
+
+#define NRF_PWM0 (&host_pwm_registers[0])
+#define NRF_PWM1 (&host_pwm_registers[1])
+#define NRF_PWM2 (&host_pwm_registers[2])
+#define NRF_PWM3 (&host_pwm_registers[3])
+
+#define NRF_PWM_VALUES_LENGTH(array) (sizeof(array) / sizeof(uint16_t))
+
+typedef enum
+{
+    NRF_PWM_CLK_16MHz  = 0,
+    NRF_PWM_CLK_8MHz   = 1,
+    NRF_PWM_CLK_4MHz   = 2,
+    NRF_PWM_CLK_2MHz   = 3,
+    NRF_PWM_CLK_1MHz   = 4,
+    NRF_PWM_CLK_500kHz = 5,
+    NRF_PWM_CLK_250kHz = 6,
+    NRF_PWM_CLK_125kHz = 7
+} nrf_pwm_clk_t;
+
+typedef enum
+{
+    NRF_PWM_MODE_UP          = 0,
+    NRF_PWM_MODE_UP_AND_DOWN = 1
+} nrf_pwm_mode_t;
+
+typedef enum
+{
+    NRF_PWM_LOAD_COMMON     = 0,
+    NRF_PWM_LOAD_GROUPED    = 1,
+    NRF_PWM_LOAD_INDIVIDUAL = 2,
+    NRF_PWM_LOAD_WAVE_FORM  = 3
+} nrf_pwm_dec_load_t;
+
+typedef enum
+{
+    NRF_PWM_STEP_AUTO      = 0,
+    NRF_PWM_STEP_TRIGGERED = 1
+} nrf_pwm_dec_step_t;
+
+typedef struct
+{
+    uint16_t channel_0;
+    uint16_t channel_1;
+    uint16_t channel_2;
+    uint16_t channel_3;
+} nrf_pwm_values_individual_t;
+
+typedef union
+{
+    uint16_t const *                    p_raw;
+    nrf_pwm_values_individual_t const * p_individual;
+} nrf_pwm_values_t;
+
+typedef struct
+{
+    nrf_pwm_values_t values;
+    uint16_t         length;
+    uint32_t         repeats;
+    uint32_t         end_delay;
+} nrf_pwm_sequence_t;
+
+#endif
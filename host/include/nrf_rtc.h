@@ -0,0 +1,84 @@
+#ifndef NRF_RTC_H__
+#define NRF_RTC_H__
+
+// Host model of the RTC registers, laid out like the chip so that tasks and
+// events sit at their real offsets. The nrfx_rtc stand-in programs them and
+// the model in nrfx_rtc_host.c ticks them in virtual time at 32768 Hz.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NRF_RTC_CC_CHANNEL_COUNT 4      // RTC1 and RTC2, RTC0 has 3
+#define NRF_RTC_COUNTER_MAX      0xFFFFFFUL
+#define RTC_INPUT_FREQ           32768
+
+typedef struct
+{
+    volatile uint32_t TASKS_START;
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_CLEAR;
+    volatile uint32_t TASKS_TRIGOVRFLW;
+    volatile uint32_t RESERVED0[60];
+    volatile uint32_t EVENTS_TICK;
+    volatile uint32_t EVENTS_OVRFLW;
+    volatile uint32_t RESERVED1[14];
+    volatile uint32_t EVENTS_COMPARE[NRF_RTC_CC_CHANNEL_COUNT];
+    volatile uint32_t RESERVED2[109];
+    volatile uint32_t INTENSET;         // reads as INTEN, the model keeps it here
+    volatile uint32_t INTENCLR;
+    volatile uint32_t RESERVED3[13];
+    volatile uint32_t EVTEN;
+    volatile uint32_t EVTENSET;
+    volatile uint32_t EVTENCLR;
+    volatile uint32_t RESERVED4[110];
+    volatile uint32_t COUNTER;          // up to date after nrf_rtc_counter_get()
+    volatile uint32_t PRESCALER;
+    volatile uint32_t RESERVED5[13];
+    volatile uint32_t CC[NRF_RTC_CC_CHANNEL_COUNT];
+} NRF_RTC_Type;
+
+#define NRF_RTC_INSTANCE_COUNT 3
+
+extern NRF_RTC_Type host_rtc_registers[NRF_RTC_INSTANCE_COUNT];
+
+#define NRF_RTC0 (&host_rtc_registers[0])
+#define NRF_RTC1 (&host_rtc_registers[1])
+#define NRF_RTC2 (&host_rtc_registers[2])
+
+typedef enum
+{
+    NRF_RTC_TASK_START            = 0x000,
+    NRF_RTC_TASK_STOP             = 0x004,
+    NRF_RTC_TASK_CLEAR            = 0x008,
+    NRF_RTC_TASK_TRIGGER_OVERFLOW = 0x00C
+} nrf_rtc_task_t;
+
+typedef enum
+{
+    NRF_RTC_EVENT_TICK      = 0x100,
+    NRF_RTC_EVENT_OVERFLOW  = 0x104,
+    NRF_RTC_EVENT_COMPARE_0 = 0x140,
+    NRF_RTC_EVENT_COMPARE_1 = 0x144,
+    NRF_RTC_EVENT_COMPARE_2 = 0x148,
+    NRF_RTC_EVENT_COMPARE_3 = 0x14C
+} nrf_rtc_event_t;
+
+// INTEN and EVTEN bits
+#define NRF_RTC_INT_TICK_MASK      (1UL << 0)
+#define NRF_RTC_INT_OVERFLOW_MASK  (1UL << 1)
+#define NRF_RTC_INT_COMPARE0_MASK  (1UL << 16)
+
+static inline bool nrf_rtc_event_pending(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+    return *(volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event) != 0;
+}
+
+static inline void nrf_rtc_event_clear(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+    *(volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event) = 0;
+}
+
+uint32_t nrf_rtc_counter_get(NRF_RTC_Type * p_reg);
+void nrf_rtc_task_trigger(NRF_RTC_Type * p_reg, nrf_rtc_task_t task);
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef NRF_TIMER_H__
+#define NRF_TIMER_H__
+
+// Host model of the TIMER registers, laid out like the chip so that tasks and
+// events sit at their real offsets. The nrfx_timer stand-in programs them and
+// the model in nrfx_timer_host.c counts in virtual time from them.
+
+#include <stdint.h>
+
+#define NRF_TIMER_CC_CHANNEL_COUNT 6    // TIMER3 and TIMER4, the others have 4
+
+typedef struct
+{
+    volatile uint32_t TASKS_START;
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_COUNT;
+    volatile uint32_t TASKS_CLEAR;
+    volatile uint32_t TASKS_SHUTDOWN;
+    volatile uint32_t RESERVED0[11];
+    volatile uint32_t TASKS_CAPTURE[NRF_TIMER_CC_CHANNEL_COUNT];
+    volatile uint32_t RESERVED1[58];
+    volatile uint32_t EVENTS_COMPARE[NRF_TIMER_CC_CHANNEL_COUNT];
+    volatile uint32_t RESERVED2[42];
+    volatile uint32_t SHORTS;
+    volatile uint32_t RESERVED3[64];
+    volatile uint32_t INTENSET;         // reads as INTEN, the model keeps it here
+    volatile uint32_t INTENCLR;
+    volatile uint32_t RESERVED4[126];
+    volatile uint32_t MODE;
+    volatile uint32_t BITMODE;
+    volatile uint32_t RESERVED5;
+    volatile uint32_t PRESCALER;
+    volatile uint32_t RESERVED6[11];
+    volatile uint32_t CC[NRF_TIMER_CC_CHANNEL_COUNT];
+} NRF_TIMER_Type;
+
+#define NRF_TIMER_INSTANCE_COUNT 5
+
+extern NRF_TIMER_Type host_timer_registers[NRF_TIMER_INSTANCE_COUNT];
+
+#define NRF_TIMER0 (&host_timer_registers[0])
+#define NRF_TIMER1 (&host_timer_registers[1])
+#define NRF_TIMER2 (&host_timer_registers[2])
+#define NRF_TIMER3 (&host_timer_registers[3])
+#define NRF_TIMER4 (&host_timer_registers[4])
+
+typedef enum
+{
+    NRF_TIMER_TASK_START    = 0x000,
+    NRF_TIMER_TASK_STOP     = 0x004,
+    NRF_TIMER_TASK_COUNT    = 0x008,
+    NRF_TIMER_TASK_CLEAR    = 0x00C,
+    NRF_TIMER_TASK_SHUTDOWN = 0x010,
+    NRF_TIMER_TASK_CAPTURE0 = 0x040,
+    NRF_TIMER_TASK_CAPTURE1 = 0x044,
+    NRF_TIMER_TASK_CAPTURE2 = 0x048,
+    NRF_TIMER_TASK_CAPTURE3 = 0x04C,
+    NRF_TIMER_TASK_CAPTURE4 = 0x050,
+    NRF_TIMER_TASK_CAPTURE5 = 0x054
+} nrf_timer_task_t;
+
+typedef enum
+{
+    NRF_TIMER_EVENT_COMPARE0 = 0x140,
+    NRF_TIMER_EVENT_COMPARE1 = 0x144,
+    NRF_TIMER_EVENT_COMPARE2 = 0x148,
+    NRF_TIMER_EVENT_COMPARE3 = 0x14C,
+    NRF_TIMER_EVENT_COMPARE4 = 0x150,
+    NRF_TIMER_EVENT_COMPARE5 = 0x154
+} nrf_timer_event_t;
+
+typedef enum
+{
+    NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK = 1 << 0,
+    NRF_TIMER_SHORT_COMPARE1_CLEAR_MASK = 1 << 1,
+    NRF_TIMER_SHORT_COMPARE2_CLEAR_MASK = 1 << 2,
+    NRF_TIMER_SHORT_COMPARE3_CLEAR_MASK = 1 << 3,
+    NRF_TIMER_SHORT_COMPARE4_CLEAR_MASK = 1 << 4,
+    NRF_TIMER_SHORT_COMPARE5_CLEAR_MASK = 1 << 5,
+    NRF_TIMER_SHORT_COMPARE0_STOP_MASK  = 1 << 8,
+    NRF_TIMER_SHORT_COMPARE1_STOP_MASK  = 1 << 9,
+    NRF_TIMER_SHORT_COMPARE2_STOP_MASK  = 1 << 10,
+    NRF_TIMER_SHORT_COMPARE3_STOP_MASK  = 1 << 11,
+    NRF_TIMER_SHORT_COMPARE4_STOP_MASK  = 1 << 12,
+    NRF_TIMER_SHORT_COMPARE5_STOP_MASK  = 1 << 13
+} nrf_timer_short_mask_t;
+
+typedef enum
+{
+    NRF_TIMER_MODE_TIMER             = 0,
+    NRF_TIMER_MODE_COUNTER           = 1,
+    NRF_TIMER_MODE_LOW_POWER_COUNTER = 2
+} nrf_timer_mode_t;
+
+typedef enum
+{
+    NRF_TIMER_BIT_WIDTH_16 = 0,
+    NRF_TIMER_BIT_WIDTH_8  = 1,
+    NRF_TIMER_BIT_WIDTH_24 = 2,
+    NRF_TIMER_BIT_WIDTH_32 = 3
+} nrf_timer_bit_width_t;
+
+typedef enum
+{
+    NRF_TIMER_FREQ_16MHz   = 0,
+    NRF_TIMER_FREQ_8MHz    = 1,
+    NRF_TIMER_FREQ_4MHz    = 2,
+    NRF_TIMER_FREQ_2MHz    = 3,
+    NRF_TIMER_FREQ_1MHz    = 4,
+    NRF_TIMER_FREQ_500kHz  = 5,
+    NRF_TIMER_FREQ_250kHz  = 6,
+    NRF_TIMER_FREQ_125kHz  = 7,
+    NRF_TIMER_FREQ_62500Hz = 8,
+    NRF_TIMER_FREQ_31250Hz = 9
+} nrf_timer_frequency_t;
+
+typedef enum
+{
+    NRF_TIMER_CC_CHANNEL0 = 0,
+    NRF_TIMER_CC_CHANNEL1,
+    NRF_TIMER_CC_CHANNEL2,
+    NRF_TIMER_CC_CHANNEL3,
+    NRF_TIMER_CC_CHANNEL4,
+    NRF_TIMER_CC_CHANNEL5
+} nrf_timer_cc_channel_t;
+
+#endif
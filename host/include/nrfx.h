@@ -0,0 +1,25 @@
+#ifndef NRFX_H__
+#define NRFX_H__
+
+// Host stand-in for the parts of nrfx.h the application modules rely on
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+#define NRFX_STATIC_ASSERT(expression) _Static_assert(expression, "unspecified message")
+
+#define NRFX_CHECK(module_enabled) (module_enabled)
+
+typedef enum
+{
+    NRFX_SUCCESS                = 0x0BAD0000,
+    NRFX_ERROR_INTERNAL         = 0x0BAD0001,
+    NRFX_ERROR_NO_MEM           = 0x0BAD0002,
+    NRFX_ERROR_INVALID_STATE    = 0x0BAD0008,
+    NRFX_ERROR_INVALID_PARAM    = 0x0BAD0007,
+    NRFX_ERROR_BUSY             = 0x0BAD000B,
+} nrfx_err_t;
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef NRFX_GPIOTE_H__
+#define NRFX_GPIOTE_H__
+
+// Host stand-in for the GPIOTE driver: IN events, and OUT tasks for PPI. The
+// task addresses are those of the chip's GPIOTE channels.
+
+#include "nrfx.h"
+#include "nrf_gpio.h"
+
+typedef uint32_t nrfx_gpiote_pin_t;
+
+typedef enum
+{
+    NRF_GPIOTE_POLARITY_LOTOHI = 1,
+    NRF_GPIOTE_POLARITY_HITOLO = 2,
+    NRF_GPIOTE_POLARITY_TOGGLE = 3
+} nrf_gpiote_polarity_t;
+
+typedef struct
+{
+    nrf_gpiote_polarity_t sense;
+    nrf_gpio_pin_pull_t   pull;
+    bool                  is_watcher;
+    bool                  hi_accuracy;
+    bool                  skip_gpio_setup;
+} nrfx_gpiote_in_config_t;
+
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_LOTOHI(hi_accu) \
+    { .sense = NRF_GPIOTE_POLARITY_LOTOHI, .pull = NRF_GPIO_PIN_NOPULL, .hi_accuracy = hi_accu }
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(hi_accu) \
+    { .sense = NRF_GPIOTE_POLARITY_HITOLO, .pull = NRF_GPIO_PIN_NOPULL, .hi_accuracy = hi_accu }
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(hi_accu) \
+    { .sense = NRF_GPIOTE_POLARITY_TOGGLE, .pull = NRF_GPIO_PIN_NOPULL, .hi_accuracy = hi_accu }
+
+typedef enum
+{
+    NRF_GPIOTE_INITIAL_VALUE_LOW  = 0,
+    NRF_GPIOTE_INITIAL_VALUE_HIGH = 1
+} nrf_gpiote_outinit_t;
+
+typedef struct
+{
+    nrf_gpiote_polarity_t action;
+    nrf_gpiote_outinit_t  init_state;
+    bool                  task_pin;
+} nrfx_gpiote_out_config_t;
+
+#define NRFX_GPIOTE_CONFIG_OUT_SIMPLE(init_high) \
+    { .init_state = init_high ? NRF_GPIOTE_INITIAL_VALUE_HIGH : NRF_GPIOTE_INITIAL_VALUE_LOW, .task_pin = false }
+#define NRFX_GPIOTE_CONFIG_OUT_TASK_LOW \
+    { .action = NRF_GPIOTE_POLARITY_HITOLO, .init_state = NRF_GPIOTE_INITIAL_VALUE_HIGH, .task_pin = true }
+#define NRFX_GPIOTE_CONFIG_OUT_TASK_HIGH \
+    { .action = NRF_GPIOTE_POLARITY_LOTOHI, .init_state = NRF_GPIOTE_INITIAL_VALUE_LOW, .task_pin = true }
+#define NRFX_GPIOTE_CONFIG_OUT_TASK_TOGGLE(init_high) \
+    { .action = NRF_GPIOTE_POLARITY_TOGGLE, \
+      .init_state = init_high ? NRF_GPIOTE_INITIAL_VALUE_HIGH : NRF_GPIOTE_INITIAL_VALUE_LOW, .task_pin = true }
+
+typedef void (*nrfx_gpiote_evt_handler_t)(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+
+nrfx_err_t nrfx_gpiote_init(void);
+bool nrfx_gpiote_is_init(void);
+nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t pin, nrfx_gpiote_in_config_t const * p_config,
+                               nrfx_gpiote_evt_handler_t evt_handler);
+void nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable);
+void nrfx_gpiote_in_event_disable(nrfx_gpiote_pin_t pin);
+bool nrfx_gpiote_in_is_set(nrfx_gpiote_pin_t pin);
+
+nrfx_err_t nrfx_gpiote_out_init(nrfx_gpiote_pin_t pin, nrfx_gpiote_out_config_t const * p_config);
+void nrfx_gpiote_out_uninit(nrfx_gpiote_pin_t pin);
+void nrfx_gpiote_out_task_enable(nrfx_gpiote_pin_t pin);
+void nrfx_gpiote_out_task_disable(nrfx_gpiote_pin_t pin);
+void nrfx_gpiote_out_task_trigger(nrfx_gpiote_pin_t pin);
+void nrfx_gpiote_set_task_trigger(nrfx_gpiote_pin_t pin);
+void nrfx_gpiote_clr_task_trigger(nrfx_gpiote_pin_t pin);
+uint32_t nrfx_gpiote_out_task_addr_get(nrfx_gpiote_pin_t pin);
+uint32_t nrfx_gpiote_set_task_addr_get(nrfx_gpiote_pin_t pin);
+uint32_t nrfx_gpiote_clr_task_addr_get(nrfx_gpiote_pin_t pin);
+
+// Host only: trigger the task at bus address (for PPI), false if GPIOTE does not own it
+bool host_gpiote_task(uint32_t address);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef NRFX_POWER_H__
+#define NRFX_POWER_H__
+
+// Host stand-in for the USB supply detection of the POWER peripheral. VBUS is
+// absent unless a simulator sets it.
+
+#include <stdbool.h>
+
+typedef enum
+{
+    NRFX_POWER_USB_STATE_DISCONNECTED,
+    NRFX_POWER_USB_STATE_CONNECTED,
+    NRFX_POWER_USB_STATE_READY
+} nrfx_power_usb_state_t;
+
+nrfx_power_usb_state_t nrfx_power_usbstatus_get(void);
+
+// VBUS there, the USB regulator ready with it
+void host_power_vbus_set(bool present);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef NRFX_PWM_H__
+#define NRFX_PWM_H__
+
+// Host stand-in for nrfx_pwm.h, implemented on top of the register model in nrf_pwm.h
+
+#include "nrfx.h"
+#include "nrf_pwm.h"
+
+typedef struct
+{
+    NRF_PWM_Type * p_registers;
+    uint8_t        drv_inst_idx;
+} nrfx_pwm_t;
+
+#define NRFX_PWM_INSTANCE(id)                    \
+{                                                \
+    .p_registers  = &host_pwm_registers[id],     \
+    .drv_inst_idx = id,                          \
+}
+
+#define NRFX_PWM_PIN_NOT_USED 0xFF
+#define NRFX_PWM_PIN_INVERTED 0x80
+
+typedef struct
+{
+    uint8_t            output_pins[NRF_PWM_CHANNEL_COUNT];
+    uint8_t            irq_priority;
+    nrf_pwm_clk_t      base_clock;
+    nrf_pwm_mode_t     count_mode;
+    uint16_t           top_value;
+    nrf_pwm_dec_load_t load_mode;
+    nrf_pwm_dec_step_t step_mode;
+} nrfx_pwm_config_t;
+
+typedef enum
+{
+    NRFX_PWM_FLAG_STOP            = 0x01,
+    NRFX_PWM_FLAG_LOOP            = 0x02,
+    NRFX_PWM_FLAG_SIGNAL_END_SEQ0 = 0x04,
+    NRFX_PWM_FLAG_SIGNAL_END_SEQ1 = 0x08,
+    NRFX_PWM_FLAG_NO_EVT_FINISHED = 0x10,
+    NRFX_PWM_FLAG_START_VIA_TASK  = 0x80,
+} nrfx_pwm_flag_t;
+
+typedef enum
+{
+    NRFX_PWM_EVT_FINISHED,
+    NRFX_PWM_EVT_END_SEQ0,
+    NRFX_PWM_EVT_END_SEQ1,
+    NRFX_PWM_EVT_STOPPED,
+} nrfx_pwm_evt_type_t;
+
+typedef void (* nrfx_pwm_handler_t)(nrfx_pwm_evt_type_t event_type);
+
+nrfx_err_t nrfx_pwm_init(nrfx_pwm_t const * const p_instance,
+                         nrfx_pwm_config_t const * p_config,
+                         nrfx_pwm_handler_t        handler);
+
+void nrfx_pwm_uninit(nrfx_pwm_t const * const p_instance);
+
+uint32_t nrfx_pwm_simple_playback(nrfx_pwm_t const * const p_instance,
+                                  nrf_pwm_sequence_t const * p_sequence,
+                                  uint16_t                   playback_count,
+                                  uint32_t                   flags);
+
+uint32_t nrfx_pwm_complex_playback(nrfx_pwm_t const * const p_instance,
+                                   nrf_pwm_sequence_t const * p_sequence_0,
+                                   nrf_pwm_sequence_t const * p_sequence_1,
+                                   uint16_t                   playback_count,
+                                   uint32_t                   flags);
+
+bool nrfx_pwm_stop(nrfx_pwm_t const * const p_instance, bool wait_until_stopped);
+
+bool nrfx_pwm_is_stopped(nrfx_pwm_t const * const p_instance);
+
+// Host only: observe the levels the model latches from the sequence, one call per step
+typedef void (* host_pwm_observer_t)(uint8_t instance, uint8_t const * p_pins,
+                                     uint16_t const * p_levels, uint16_t top);
+
+void host_pwm_observer_set(host_pwm_observer_t observer);
+
+// Host only: delay from a PWM event to its interrupt handler, 0 after
+// nrfx_pwm_init(). Playback goes on meanwhile, as on the chip.
+void host_pwm_irq_latency_set(uint8_t instance, uint64_t latency_ns);
+
+// Host only: PWM period in ns from COUNTERTOP and PRESCALER
+uint64_t host_pwm_period_ns(uint8_t instance);
+
+// Host only: number of 16-bit values fetched through SEQ[n].PTR since init
+uint32_t host_pwm_dma_reads(uint8_t instance);
+
+#endif
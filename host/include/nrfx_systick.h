@@ -0,0 +1,24 @@
+#ifndef NRFX_SYSTICK_H__
+#define NRFX_SYSTICK_H__
+
+// Host stand-in for the SysTick driver on virtual time. A busy-wait is a run
+// of the simulator, so interrupts keep firing while the CPU spins.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint64_t time_ns;
+} nrfx_systick_state_t;
+
+void nrfx_systick_init(void);
+void nrfx_systick_get(nrfx_systick_state_t * p_state);
+
+// Each call lets one microsecond of spinning pass
+bool nrfx_systick_test(nrfx_systick_state_t const * p_state, uint32_t us);
+
+void nrfx_systick_delay_us(uint32_t us);
+void nrfx_systick_delay_ms(uint32_t ms);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef NRFX_TIMER_H__
+#define NRFX_TIMER_H__
+
+// Host stand-in for nrfx_timer.h, implemented on top of the register model in nrf_timer.h
+
+#include "nrfx.h"
+#include "nrf_timer.h"
+
+typedef struct
+{
+    NRF_TIMER_Type * p_reg;
+    uint8_t          instance_id;
+    uint8_t          cc_channel_count;
+} nrfx_timer_t;
+
+#define NRFX_TIMER_INSTANCE(id)                      \
+{                                                    \
+    .p_reg            = &host_timer_registers[id],   \
+    .instance_id      = id,                          \
+    .cc_channel_count = NRF_TIMER_CC_CHANNEL_COUNT,  \
+}
+
+typedef struct
+{
+    nrf_timer_frequency_t frequency;
+    nrf_timer_mode_t      mode;
+    nrf_timer_bit_width_t bit_width;
+    uint8_t               interrupt_priority;
+    void *                p_context;
+} nrfx_timer_config_t;
+
+#define NRFX_TIMER_DEFAULT_CONFIG                                                      \
+{                                                                                      \
+    .frequency          = (nrf_timer_frequency_t)NRFX_TIMER_DEFAULT_CONFIG_FREQUENCY,  \
+    .mode               = (nrf_timer_mode_t)NRFX_TIMER_DEFAULT_CONFIG_MODE,            \
+    .bit_width          = (nrf_timer_bit_width_t)NRFX_TIMER_DEFAULT_CONFIG_BIT_WIDTH,  \
+    .interrupt_priority = NRFX_TIMER_DEFAULT_CONFIG_IRQ_PRIORITY,                      \
+    .p_context          = NULL,                                                        \
+}
+
+typedef void (* nrfx_timer_event_handler_t)(nrf_timer_event_t event_type, void * p_context);
+
+nrfx_err_t nrfx_timer_init(nrfx_timer_t const * const  p_instance,
+                           nrfx_timer_config_t const * p_config,
+                           nrfx_timer_event_handler_t  timer_event_handler);
+void nrfx_timer_enable(nrfx_timer_t const * const p_instance);
+void nrfx_timer_disable(nrfx_timer_t const * const p_instance);
+void nrfx_timer_clear(nrfx_timer_t const * const p_instance);
+void nrfx_timer_increment(nrfx_timer_t const * const p_instance);
+uint32_t nrfx_timer_capture(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel);
+uint32_t nrfx_timer_capture_get(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel);
+void nrfx_timer_compare(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel,
+                        uint32_t cc_value, bool enable_int);
+void nrfx_timer_extended_compare(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel,
+                                 uint32_t cc_value, nrf_timer_short_mask_t timer_short_mask,
+                                 bool enable_int);
+void nrfx_timer_compare_int_enable(nrfx_timer_t const * const p_instance, uint32_t channel);
+void nrfx_timer_compare_int_disable(nrfx_timer_t const * const p_instance, uint32_t channel);
+uint32_t nrfx_timer_task_address_get(nrfx_timer_t const * const p_instance, nrf_timer_task_t timer_task);
+uint32_t nrfx_timer_capture_task_address_get(nrfx_timer_t const * const p_instance, uint32_t channel);
+uint32_t nrfx_timer_event_address_get(nrfx_timer_t const * const p_instance, nrf_timer_event_t timer_event);
+uint32_t nrfx_timer_compare_event_address_get(nrfx_timer_t const * const p_instance, uint32_t channel);
+
+// Host only: error of the clock the timers count, in ppm. HFINT is off by up
+// to 1.5 % (15000 ppm) on the chip, the model runs exact unless told so.
+void host_timer_clock_error_set(int32_t ppm);
+
+// Host only: trigger the task at bus address (for PPI), false if no TIMER owns it
+bool host_timer_task(uint32_t address);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SDK_ERRORS_H__
+#define SDK_ERRORS_H__
+
+// Host stand-in for the SDK error codes the application modules use
+
+#include <stdint.h>
+
+typedef uint32_t ret_code_t;
+
+#define NRF_SUCCESS             0
+#define NRF_ERROR_NO_MEM        4
+#define NRF_ERROR_NOT_FOUND     5
+#define NRF_ERROR_INVALID_PARAM 7
+#define NRF_ERROR_INVALID_STATE 8
+#define NRF_ERROR_INVALID_ADDR  16
+#define NRF_ERROR_BUSY          17
+#define NRF_ERROR_IO_PENDING    0x8012
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf.h"
+#include "instrument.h"
+
+// Checks the log-linear histogram buckets over the whole 32-bit range and
+// records regions through INSTRUMENT_BEGIN/END with the cycle counter set by
+// hand, across its wrap as well
+
+static int m_failures;
+
+static void check(bool ok, char const * p_what)
+{
+    printf("%s %s\n", ok ? "ok  " : "FAIL", p_what);
+    m_failures += !ok;
+}
+
+static bool buckets_check(void)
+{
+    uint32_t last = INSTRUMENT_BUCKETS - 1;
+    uint32_t previous = 0;
+    uint64_t v = 0;
+
+    // Every value below 2^16, then 0.1 % steps up to 2^32
+    while (v <= UINT32_MAX)
+    {
+        uint32_t bucket = instrument_bucket((uint32_t)v);
+        uint32_t floor = instrument_bucket_floor(bucket);
+
+        if (bucket < previous || bucket > last || floor > v ||
+            (bucket < last && v >= instrument_bucket_floor(bucket + 1)))
+        {
+            printf("     %llu in bucket %u [%u, %u)\n", (unsigned long long)v, bucket, floor,
+                   instrument_bucket_floor(bucket + 1));
+            return false;
+        }
+        if (bucket >= INSTRUMENT_SUB_BUCKETS && bucket < last &&
+            (instrument_bucket_floor(bucket + 1) - floor) * 4 > floor)
+        {
+            printf("     bucket %u wider than 25 %%\n", bucket);
+            return false;
+        }
+
+        previous = bucket;
+        v += v < 65536 ? 1 : v / 1000;
+    }
+
+    return true;
+}
+
+static void region_run(uint32_t start, uint32_t cycles)
+{
+    host_dwt.CYCCNT = start;
+    INSTRUMENT_BEGIN(FADE_BEGIN);
+    host_dwt.CYCCNT += cycles;
+    INSTRUMENT_END(FADE_BEGIN);
+}
+
+static bool stats_check(void)
+{
+    static const uint32_t cycles[] = {120, 3, 0, 7000, 95, 123456789};
+    instrument_stats_t stats;
+    uint32_t histogram[INSTRUMENT_BUCKETS];
+    uint64_t sum = 0;
+
+    instrument_reset();
+    for (size_t i = 0; i < sizeof(cycles) / sizeof(cycles[0]); i++)
+    {
+        // Half of them across the counter wrap
+        region_run(i % 2 ? UINT32_MAX - cycles[i] / 2 : 1000, cycles[i]);
+        sum += cycles[i];
+    }
+    instrument_get(INSTRUMENT_REGION_FADE_BEGIN, &stats, histogram);
+
+    uint64_t histogram_count = 0;
+    for (int i = 0; i < INSTRUMENT_BUCKETS; i++)
+    {
+        histogram_count += histogram[i];
+    }
+
+    printf("     %s: %u samples, min %u, max %u, mean %.1f cycles\n", stats.name, stats.count,
+           stats.min, stats.max, stats.count ? (double)stats.sum / stats.count : 0.0);
+
+    return stats.count == 6 && stats.min == 0 && stats.max == 123456789 && stats.sum == sum &&
+           histogram_count == 6 && histogram[instrument_bucket(7000)] == 1 &&
+           histogram[instrument_bucket(123456789)] == 1 &&
+           strcmp(stats.name, "fade_begin") == 0;
+}
+
+static bool reset_check(void)
+{
+    instrument_stats_t stats;
+    uint32_t histogram[INSTRUMENT_BUCKETS];
+
+    instrument_reset();
+    instrument_get(INSTRUMENT_REGION_FADE_BEGIN, &stats, histogram);
+    for (int i = 0; i < INSTRUMENT_BUCKETS; i++)
+    {
+        if (histogram[i] != 0)
+        {
+            return false;
+        }
+    }
+
+    return stats.count == 0 && stats.min == 0 && stats.max == 0 && stats.sum == 0;
+}
+
+int main(void)
+{
+    instrument_init();
+
+    printf("%u buckets, %lu per power of two, last from %u cycles\n", INSTRUMENT_BUCKETS,
+           INSTRUMENT_SUB_BUCKETS, instrument_bucket_floor(INSTRUMENT_BUCKETS - 1));
+    check(buckets_check(), "bucket bounds and width");
+    check(stats_check(), "region statistics across the CYCCNT wrap");
+    check(reset_check(), "reset");
+
+    return m_failures == 0 ? 0 : 1;
+}
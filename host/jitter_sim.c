@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "pwm_engine.h"
+#include "edge_stats.h"
+#include "sim.h"
+#include "button_script.h"
+
+// The analysis of the PWM self-test (pwm_selftest.h) on the host:
+//  - synthetic edges with known jitter, lost edges, a frame without edges and
+//    a wrapping timestamp, checked against a straight computation,
+//  - the firmware with the software PWM backend, the yellow LED edges of the
+//    GPIO model turned into 16 MHz ticks like the TIMER captures. The host
+//    timer model is exact, so every period must be nominal.
+
+#define YELLOW_LED_PIN NRF_GPIO_PIN_MAP(0,6)
+#define BUTTON_PIN     NRF_GPIO_PIN_MAP(1,6)
+
+#define S        1000000000ULL
+#define TICK_HZ  16000000UL
+#define NOMINAL  16000UL          // 1 kHz
+#define JITTER   40               // ticks, either way
+#define PERIODS  10000
+
+int firmware_main(void);
+
+static edge_stats_t m_firmware_stats;
+static uint32_t m_level = 1;
+
+static bool check(bool condition, char const * p_what)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", p_what);
+    }
+    return condition;
+}
+
+static void print(char const * p_name, edge_stats_result_t const * p)
+{
+    printf("%-10s %u periods, %u pulses, %u gaps, %u lost, period %u..%u ticks, "
+           "pulse %u..%u ticks, jitter max %u ticks\n",
+           p_name, p->periods, p->pulses, p->gaps, p->lost, p->period_min, p->period_max,
+           p->pulse_min, p->pulse_max, edge_stats_jitter_max(p));
+}
+
+// Linear congruential, reproducible across hosts
+static int32_t jitter_next(void)
+{
+    static uint32_t state = 12345;
+
+    state = state * 1103515245UL + 12345UL;
+    return (int32_t)((state >> 16) % (2 * JITTER + 1)) - JITTER;
+}
+
+static bool synthetic_run(void)
+{
+    edge_stats_t stats;
+    uint32_t start = UINT32_MAX - 50 * NOMINAL;    // wraps after 50 periods
+    int32_t previous = 0;
+    uint32_t periods = 0;
+    uint64_t square_sum = 0;
+    uint32_t deviation_max = 0;
+    bool ok = true;
+
+    edge_stats_init(&stats, TICK_HZ, NOMINAL);
+
+    for (uint32_t i = 0; i < PERIODS; i++)
+    {
+        int32_t jitter = jitter_next();
+        uint32_t on = start + i * NOMINAL + jitter;
+
+        // Three periods at 100 %: no edges, the period across them is a gap
+        if (i >= 5000 && i < 5003)
+        {
+            continue;
+        }
+        // Missed edges, the period across them is a gap as well
+        if (i == 7000)
+        {
+            edge_stats_lost(&stats);
+        }
+
+        edge_stats_edge(&stats, on, true);
+        edge_stats_edge(&stats, on + NOMINAL * 3 / 10, false);
+
+        if (i > 0 && i != 5003 && i != 7000)
+        {
+            uint32_t deviation = (uint32_t)abs(jitter - previous);
+
+            periods++;
+            square_sum += (uint64_t)deviation * deviation;
+            deviation_max = deviation > deviation_max ? deviation : deviation_max;
+        }
+        previous = jitter;
+    }
+
+    edge_stats_result_t const * p = &stats.result;
+    uint32_t histogram_sum = 0;
+
+    for (int i = 0; i < EDGE_STATS_JITTER_BUCKETS; i++)
+    {
+        histogram_sum += p->jitter_histogram[i];
+    }
+    print("synthetic", p);
+
+    ok &= check(p->periods == periods, "period count");
+    ok &= check(p->gaps == 2, "gap count");
+    ok &= check(p->lost == 1, "lost count");
+    ok &= check(p->pulses == PERIODS - 3, "pulse count");
+    ok &= check(p->pulse_min == NOMINAL * 3 / 10 && p->pulse_max == NOMINAL * 3 / 10, "pulse width");
+    ok &= check(edge_stats_jitter_max(p) == deviation_max, "largest jitter");
+    ok &= check(deviation_max <= 2 * JITTER, "jitter within what was injected");
+    ok &= check(p->jitter_square_sum == square_sum, "jitter square sum");
+    ok &= check(histogram_sum == p->periods, "histogram total");
+
+    return ok;
+}
+
+// Every LED transition, ns to capture ticks
+static void gpio_observer(uint32_t pin_number, uint32_t value, uint64_t time_ns)
+{
+    if (pin_number != YELLOW_LED_PIN || value == m_level)
+    {
+        return;
+    }
+    m_level = value;
+    edge_stats_edge(&m_firmware_stats, (uint32_t)((time_ns * (TICK_HZ / 1000000UL)) / 1000UL), value == 0);
+}
+
+static bool firmware_run(void)
+{
+    uint32_t nominal = (uint32_t)(((uint64_t)pwm_engine_period_ns() * (TICK_HZ / 1000000UL)) / 1000UL);
+    bool ok = true;
+
+    edge_stats_init(&m_firmware_stats, TICK_HZ, nominal);
+
+    sim_reset();
+    host_gpio_observer_set(gpio_observer);
+    host_gpio_input_set(BUTTON_PIN, 1);
+    button_script_double_click(BUTTON_PIN, 1 * S);
+    host_cpu_run(firmware_main, 10 * S);
+    host_gpio_observer_set(NULL);
+
+    edge_stats_result_t const * p = &m_firmware_stats.result;
+    print("firmware", p);
+
+    ok &= check(p->periods > 1000, "PWM periods seen");
+    ok &= check(p->period_min == nominal && p->period_max == nominal, "every period nominal");
+    ok &= check(p->jitter_histogram[0] == p->periods, "no jitter");
+    ok &= check(p->lost == 0, "no lost edges");
+    ok &= check(p->pulse_max < nominal, "pulses shorter than a period");
+
+    return ok;
+}
+
+int main(void)
+{
+    bool ok = synthetic_run();
+
+    ok &= firmware_run();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include <string.h>
+#include "nrf_atfifo.h"
+
+ret_code_t nrf_atfifo_init(nrf_atfifo_t * const p_fifo, void * p_buf, uint16_t buf_size,
+                           uint16_t item_size)
+{
+    p_fifo->p_buf = p_buf;
+    p_fifo->buf_size = buf_size;
+    p_fifo->item_size = item_size;
+    p_fifo->head = 0;
+    p_fifo->tail = 0;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_atfifo_alloc_put(nrf_atfifo_t * const p_fifo, void const * p_var, size_t size,
+                                bool * const p_visible)
+{
+    uint16_t next = (uint16_t)((p_fifo->tail + p_fifo->item_size) % p_fifo->buf_size);
+
+    if (next == p_fifo->head)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memcpy(&p_fifo->p_buf[p_fifo->tail], p_var, size);
+    p_fifo->tail = next;
+    if (p_visible != NULL)
+    {
+        *p_visible = true;
+    }
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_atfifo_get_free(nrf_atfifo_t * const p_fifo, void * const p_var, size_t size,
+                               bool * p_released)
+{
+    if (p_fifo->head == p_fifo->tail)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    memcpy(p_var, &p_fifo->p_buf[p_fifo->head], size);
+    p_fifo->head = (uint16_t)((p_fifo->head + p_fifo->item_size) % p_fifo->buf_size);
+    if (p_released != NULL)
+    {
+        *p_released = true;
+    }
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,229 @@
+#include <stddef.h>
+#include <string.h>
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_nvmc.h"
+
+#define IMAGE_SIZE (HOST_FLASH_PAGES * HOST_FLASH_PAGE_SIZE)
+#define WORD_SIZE  4
+
+nrf_fstorage_api_t nrf_fstorage_nvmc;
+
+static const nrf_fstorage_info_t m_info =
+{
+    .erase_unit   = HOST_FLASH_PAGE_SIZE,
+    .program_unit = WORD_SIZE,
+    .rmap         = true,
+    .wmap         = false
+};
+
+static uint32_t m_image[IMAGE_SIZE / WORD_SIZE];
+static bool m_blank_done;
+static host_flash_stats_t m_stats;
+static uint32_t m_loss_after;       // word operations up to the one the power fails in, 0: never
+static bool m_power_lost;
+
+static void blank_once(void)
+{
+    if (!m_blank_done)
+    {
+        host_flash_blank();
+    }
+}
+
+static bool in_image(nrf_fstorage_t const * p_fs, uintptr_t addr, uint32_t len)
+{
+    return addr >= p_fs->start_addr && addr + len <= p_fs->end_addr && len <= p_fs->end_addr - addr;
+}
+
+// One word operation, false once the power is gone. The operation the power
+// fails in runs in part: p_partial is set and the caller leaves it half done.
+static bool op_begin(bool * p_partial)
+{
+    *p_partial = false;
+    if (m_power_lost)
+    {
+        return false;
+    }
+    m_stats.ops++;
+    if (m_loss_after != 0 && --m_loss_after == 0)
+    {
+        m_power_lost = true;
+        *p_partial = true;
+    }
+    return true;
+}
+
+static void evt_send(nrf_fstorage_t const * p_fs, nrf_fstorage_evt_id_t id, uintptr_t addr,
+                     void const * p_src, uint32_t len, void * p_param)
+{
+    // Nobody is left to see the result of an operation the power failed in
+    if (m_power_lost || p_fs->evt_handler == NULL)
+    {
+        return;
+    }
+
+    nrf_fstorage_evt_t evt =
+    {
+        .id      = id,
+        .result  = NRF_SUCCESS,
+        .addr    = addr,
+        .p_src   = p_src,
+        .len     = len,
+        .p_param = p_param
+    };
+    p_fs->evt_handler(&evt);
+}
+
+ret_code_t nrf_fstorage_init(nrf_fstorage_t * p_fs, nrf_fstorage_api_t * p_api, void * p_param)
+{
+    uintptr_t size = p_fs->end_addr - p_fs->start_addr;
+    uintptr_t image = (uintptr_t)m_image;
+
+    blank_once();
+    if (size == 0 || size > IMAGE_SIZE || size % HOST_FLASH_PAGE_SIZE != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Firmware addresses to the image, once: the instance keeps them over resets
+    if (p_fs->start_addr != image)
+    {
+        p_fs->start_addr = image;
+        p_fs->end_addr = image + size;
+    }
+    p_fs->p_api = p_api;
+    p_fs->p_flash_info = &m_info;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_fstorage_read(nrf_fstorage_t const * p_fs, uintptr_t src, void * p_dest, uint32_t len)
+{
+    if (!in_image(p_fs, src, len))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    memcpy(p_dest, (void const *)src, len);
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_fstorage_write(nrf_fstorage_t const * p_fs, uintptr_t dest, void const * p_src,
+                              uint32_t len, void * p_param)
+{
+    if (len == 0 || len % WORD_SIZE != 0 || dest % WORD_SIZE != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (!in_image(p_fs, dest, len))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    uint32_t * p_word = (uint32_t *)dest;
+    uint8_t const * p_bytes = p_src;
+
+    // Word by word, in address order like the NVMC
+    for (uint32_t i = 0; i < len / WORD_SIZE; i++)
+    {
+        uint32_t value;
+        bool partial;
+
+        memcpy(&value, p_bytes + i * WORD_SIZE, WORD_SIZE);
+        if (!op_begin(&partial))
+        {
+            break;
+        }
+        if (partial)
+        {
+            // Only the low half of the bits made it
+            value |= 0xFFFF0000;
+        }
+        if ((value & ~p_word[i]) != 0)
+        {
+            m_stats.overwrites++;
+        }
+        p_word[i] &= value;
+        m_stats.words++;
+    }
+
+    evt_send(p_fs, NRF_FSTORAGE_EVT_WRITE_RESULT, dest, p_src, len, p_param);
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_fstorage_erase(nrf_fstorage_t const * p_fs, uintptr_t page_addr, uint32_t len,
+                              void * p_param)
+{
+    if (len == 0 || (page_addr - p_fs->start_addr) % HOST_FLASH_PAGE_SIZE != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (!in_image(p_fs, page_addr, len * HOST_FLASH_PAGE_SIZE))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    uint32_t * p_word = (uint32_t *)page_addr;
+    uint32_t first_page = (page_addr - (uintptr_t)m_image) / HOST_FLASH_PAGE_SIZE;
+    bool lost = false;
+
+    // A power failure leaves the words erased so far erased, the rest as they were
+    for (uint32_t page = 0; page < len && !lost; page++)
+    {
+        m_stats.erases[first_page + page]++;
+        for (uint32_t i = 0; i < HOST_FLASH_PAGE_SIZE / WORD_SIZE; i++)
+        {
+            bool partial;
+
+            if (!op_begin(&partial) || partial)
+            {
+                lost = true;
+                break;
+            }
+            p_word[page * HOST_FLASH_PAGE_SIZE / WORD_SIZE + i] = 0xFFFFFFFF;
+        }
+    }
+
+    evt_send(p_fs, NRF_FSTORAGE_EVT_ERASE_RESULT, page_addr, NULL, len, p_param);
+    return NRF_SUCCESS;
+}
+
+bool nrf_fstorage_is_busy(nrf_fstorage_t const * p_fs)
+{
+    return false;
+}
+
+void host_flash_blank(void)
+{
+    memset(m_image, 0xFF, sizeof(m_image));
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_loss_after = 0;
+    m_power_lost = false;
+    m_blank_done = true;
+}
+
+bool host_flash_contains(void const * p)
+{
+    uint8_t const * p_image = (uint8_t const *)m_image;
+
+    return (uint8_t const *)p >= p_image && (uint8_t const *)p < p_image + IMAGE_SIZE;
+}
+
+void host_flash_power_loss_at(uint32_t op)
+{
+    m_loss_after = op;
+}
+
+bool host_flash_power_lost(void)
+{
+    return m_power_lost;
+}
+
+void host_flash_power_on(void)
+{
+    m_power_lost = false;
+    m_loss_after = 0;
+}
+
+void host_flash_stats_get(host_flash_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
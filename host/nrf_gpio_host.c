@@ -0,0 +1,371 @@
+#include <stddef.h>
+#include "nrf_gpio.h"
+#include "nrfx_gpiote.h"
+#include "sim.h"
+
+// GPIO and GPIOTE model. Inputs are driven with host_gpio_input_set(), a
+// sensed edge queues the GPIOTE interrupt as a simulator event at the same
+// time, so the handler reads the pin like the interrupt on the chip would.
+// OUT tasks drive their pin at the virtual time they are triggered, from the
+// CPU or through PPI. Task pins and high accuracy IN events share the
+// GPIOTE_CH_NUM channels like on the chip.
+
+#define GPIOTE_CH_NUM      8
+#define GPIOTE_BUS_ADDRESS 0x40006000
+#define GPIOTE_TASKS_OUT   0x000
+#define GPIOTE_TASKS_SET   0x030
+#define GPIOTE_TASKS_CLR   0x060
+
+typedef struct
+{
+    uint8_t                   out;
+    uint8_t                   in;
+    bool                      output;
+    bool                      sensed;
+    nrf_gpiote_polarity_t     sense;
+    nrfx_gpiote_evt_handler_t handler;
+} host_pin_t;
+
+typedef struct
+{
+    bool                  used;
+    bool                  task_enabled;
+    uint32_t              pin;
+    nrf_gpiote_polarity_t action;
+    uint8_t               init;
+} gpiote_channel_t;
+
+static host_pin_t m_pins[HOST_GPIO_PIN_COUNT];
+static gpiote_channel_t m_channels[GPIOTE_CH_NUM];
+static host_gpio_observer_t m_observer;
+static bool m_gpiote_init;
+static uint32_t m_writes;
+
+NRF_GPIO_Type host_gpio_p0 = {0};
+NRF_GPIO_Type host_gpio_p1 = {1};
+
+void host_gpio_observer_set(host_gpio_observer_t observer)
+{
+    m_observer = observer;
+}
+
+void nrf_gpio_cfg_output(uint32_t pin_number)
+{
+    m_pins[pin_number].output = true;
+}
+
+void nrf_gpio_cfg_input(uint32_t pin_number, nrf_gpio_pin_pull_t pull_config)
+{
+    m_pins[pin_number].output = false;
+    m_pins[pin_number].in = (pull_config == NRF_GPIO_PIN_PULLUP);
+}
+
+uint32_t host_gpio_writes(void)
+{
+    return m_writes;
+}
+
+static void pin_out(uint32_t pin_number, uint8_t level)
+{
+    host_pin_t * p_pin = &m_pins[pin_number];
+
+    if (p_pin->out != level)
+    {
+        p_pin->out = level;
+        if (m_observer != NULL)
+        {
+            m_observer(pin_number, level, sim_time_ns());
+        }
+    }
+}
+
+void nrf_gpio_pin_write(uint32_t pin_number, uint32_t value)
+{
+    m_writes++;
+    pin_out(pin_number, value != 0);
+}
+
+// All pins of the mask change at the same virtual time
+static void port_out(NRF_GPIO_Type * p_reg, uint32_t mask, uint8_t level)
+{
+    m_writes++;
+    for (; mask != 0; mask &= mask - 1)
+    {
+        uint32_t pin_number = p_reg->port * 32 + __builtin_ctz(mask);
+
+        if (pin_number < HOST_GPIO_PIN_COUNT)
+        {
+            pin_out(pin_number, level);
+        }
+    }
+}
+
+void nrf_gpio_port_out_set(NRF_GPIO_Type * p_reg, uint32_t set_mask)
+{
+    port_out(p_reg, set_mask, 1);
+}
+
+void nrf_gpio_port_out_clear(NRF_GPIO_Type * p_reg, uint32_t clr_mask)
+{
+    port_out(p_reg, clr_mask, 0);
+}
+
+void nrf_gpio_pin_set(uint32_t pin_number)
+{
+    nrf_gpio_pin_write(pin_number, 1);
+}
+
+void nrf_gpio_pin_clear(uint32_t pin_number)
+{
+    nrf_gpio_pin_write(pin_number, 0);
+}
+
+void nrf_gpio_pin_toggle(uint32_t pin_number)
+{
+    nrf_gpio_pin_write(pin_number, !m_pins[pin_number].out);
+}
+
+uint32_t nrf_gpio_pin_read(uint32_t pin_number)
+{
+    return m_pins[pin_number].output ? m_pins[pin_number].out : m_pins[pin_number].in;
+}
+
+uint32_t nrf_gpio_pin_out_read(uint32_t pin_number)
+{
+    return m_pins[pin_number].out;
+}
+
+static void gpiote_irq(void * p_context)
+{
+    uint32_t pin = (uint32_t)(uintptr_t)p_context;
+    host_pin_t * p_pin = &m_pins[pin];
+
+    if (p_pin->sensed && p_pin->handler != NULL)
+    {
+        p_pin->handler(pin, p_pin->sense);
+    }
+}
+
+void host_gpio_input_set(uint32_t pin_number, uint32_t value)
+{
+    host_pin_t * p_pin = &m_pins[pin_number];
+    uint8_t level = value != 0;
+
+    if (p_pin->in == level)
+    {
+        return;
+    }
+    p_pin->in = level;
+
+    if (p_pin->sensed &&
+        ((level && (p_pin->sense & NRF_GPIOTE_POLARITY_LOTOHI)) ||
+         (!level && (p_pin->sense & NRF_GPIOTE_POLARITY_HITOLO))))
+    {
+        sim_schedule(sim_time_ns(), gpiote_irq, (void *)(uintptr_t)pin_number);
+    }
+}
+
+nrfx_err_t nrfx_gpiote_init(void)
+{
+    m_gpiote_init = true;
+    return NRFX_SUCCESS;
+}
+
+bool nrfx_gpiote_is_init(void)
+{
+    return m_gpiote_init;
+}
+
+// GPIOTE channel of pin, -1 if it has none
+static int channel_of(uint32_t pin)
+{
+    for (int i = 0; i < GPIOTE_CH_NUM; i++)
+    {
+        if (m_channels[i].used && m_channels[i].pin == pin)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int channel_alloc(uint32_t pin)
+{
+    for (int i = 0; i < GPIOTE_CH_NUM; i++)
+    {
+        if (!m_channels[i].used)
+        {
+            m_channels[i] = (gpiote_channel_t){.used = true, .pin = pin};
+            return i;
+        }
+    }
+    return -1;
+}
+
+nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t pin, nrfx_gpiote_in_config_t const * p_config,
+                               nrfx_gpiote_evt_handler_t evt_handler)
+{
+    host_pin_t * p_pin = &m_pins[pin];
+
+    if (p_config->hi_accuracy && channel_of(pin) < 0 && channel_alloc(pin) < 0)
+    {
+        return NRFX_ERROR_NO_MEM;
+    }
+
+    if (!p_config->skip_gpio_setup)
+    {
+        nrf_gpio_cfg_input(pin, p_config->pull);
+    }
+    p_pin->sense = p_config->sense;
+    p_pin->handler = evt_handler;
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable)
+{
+    m_pins[pin].sensed = int_enable;
+}
+
+void nrfx_gpiote_in_event_disable(nrfx_gpiote_pin_t pin)
+{
+    m_pins[pin].sensed = false;
+}
+
+bool nrfx_gpiote_in_is_set(nrfx_gpiote_pin_t pin)
+{
+    return nrf_gpio_pin_read(pin) != 0;
+}
+
+nrfx_err_t nrfx_gpiote_out_init(nrfx_gpiote_pin_t pin, nrfx_gpiote_out_config_t const * p_config)
+{
+    if (p_config->task_pin)
+    {
+        int channel = channel_of(pin) >= 0 ? channel_of(pin) : channel_alloc(pin);
+
+        if (channel < 0)
+        {
+            return NRFX_ERROR_NO_MEM;
+        }
+        m_channels[channel].action = p_config->action;
+        m_channels[channel].init = p_config->init_state == NRF_GPIOTE_INITIAL_VALUE_HIGH;
+    }
+    nrf_gpio_cfg_output(pin);
+    nrf_gpio_pin_write(pin, p_config->init_state == NRF_GPIOTE_INITIAL_VALUE_HIGH);
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_gpiote_out_uninit(nrfx_gpiote_pin_t pin)
+{
+    int channel = channel_of(pin);
+
+    if (channel >= 0)
+    {
+        m_channels[channel] = (gpiote_channel_t){0};
+    }
+}
+
+void nrfx_gpiote_out_task_enable(nrfx_gpiote_pin_t pin)
+{
+    int channel = channel_of(pin);
+
+    if (channel >= 0)
+    {
+        // In task mode the channel drives the pin, from OUTINIT
+        m_channels[channel].task_enabled = true;
+        pin_out(pin, m_channels[channel].init);
+    }
+}
+
+void nrfx_gpiote_out_task_disable(nrfx_gpiote_pin_t pin)
+{
+    int channel = channel_of(pin);
+
+    if (channel >= 0)
+    {
+        m_channels[channel].task_enabled = false;
+    }
+}
+
+static void task_run(int channel, uint32_t task)
+{
+    gpiote_channel_t const * p_channel = &m_channels[channel];
+
+    if (!p_channel->task_enabled)
+    {
+        return;
+    }
+
+    uint8_t level = m_pins[p_channel->pin].out;
+    switch (task)
+    {
+        case GPIOTE_TASKS_SET:
+            level = 1;
+            break;
+
+        case GPIOTE_TASKS_CLR:
+            level = 0;
+            break;
+
+        default:
+            level = p_channel->action == NRF_GPIOTE_POLARITY_LOTOHI ? 1 :
+                    p_channel->action == NRF_GPIOTE_POLARITY_HITOLO ? 0 : !level;
+            break;
+    }
+    pin_out(p_channel->pin, level);
+}
+
+bool host_gpiote_task(uint32_t address)
+{
+    static const uint32_t tasks[] = {GPIOTE_TASKS_OUT, GPIOTE_TASKS_SET, GPIOTE_TASKS_CLR};
+
+    for (size_t i = 0; i < sizeof(tasks) / sizeof(tasks[0]); i++)
+    {
+        uint32_t base = GPIOTE_BUS_ADDRESS + tasks[i];
+
+        if (address >= base && address < base + 4 * GPIOTE_CH_NUM)
+        {
+            task_run((address - base) / 4, tasks[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t task_address(uint32_t pin, uint32_t task)
+{
+    int channel = channel_of(pin);
+
+    return channel < 0 ? 0 : GPIOTE_BUS_ADDRESS + task + 4 * channel;
+}
+
+uint32_t nrfx_gpiote_out_task_addr_get(nrfx_gpiote_pin_t pin)
+{
+    return task_address(pin, GPIOTE_TASKS_OUT);
+}
+
+uint32_t nrfx_gpiote_set_task_addr_get(nrfx_gpiote_pin_t pin)
+{
+    return task_address(pin, GPIOTE_TASKS_SET);
+}
+
+uint32_t nrfx_gpiote_clr_task_addr_get(nrfx_gpiote_pin_t pin)
+{
+    return task_address(pin, GPIOTE_TASKS_CLR);
+}
+
+void nrfx_gpiote_out_task_trigger(nrfx_gpiote_pin_t pin)
+{
+    host_gpiote_task(task_address(pin, GPIOTE_TASKS_OUT));
+}
+
+void nrfx_gpiote_set_task_trigger(nrfx_gpiote_pin_t pin)
+{
+    host_gpiote_task(task_address(pin, GPIOTE_TASKS_SET));
+}
+
+void nrfx_gpiote_clr_task_trigger(nrfx_gpiote_pin_t pin)
+{
+    host_gpiote_task(task_address(pin, GPIOTE_TASKS_CLR));
+}
@@ -0,0 +1,13 @@
+#include "nrfx_power.h"
+
+static bool m_vbus;
+
+nrfx_power_usb_state_t nrfx_power_usbstatus_get(void)
+{
+    return m_vbus ? NRFX_POWER_USB_STATE_READY : NRFX_POWER_USB_STATE_DISCONNECTED;
+}
+
+void host_power_vbus_set(bool present)
+{
+    m_vbus = present;
+}
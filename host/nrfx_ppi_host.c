@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "nrfx_ppi.h"
+#include "nrfx_timer.h"
+#include "nrfx_rtc.h"
+#include "nrfx_gpiote.h"
+
+// PPI model: channels connect an event address to one task address and a
+// fork. The tasks run inside the event's simulator callback, before anything
+// else happens at that virtual time, like the few clock cycles PPI takes.
+
+typedef struct
+{
+    bool     allocated;
+    bool     enabled;
+    uint32_t eep;
+    uint32_t tep;
+    uint32_t fork_tep;
+} host_ppi_channel_t;
+
+static host_ppi_channel_t m_channels[NRF_PPI_CHANNEL_COUNT];
+
+nrfx_err_t nrfx_ppi_channel_alloc(nrf_ppi_channel_t * p_channel)
+{
+    for (int i = 0; i < NRF_PPI_CHANNEL_COUNT; i++)
+    {
+        if (!m_channels[i].allocated)
+        {
+            m_channels[i] = (host_ppi_channel_t){.allocated = true};
+            *p_channel = (nrf_ppi_channel_t)i;
+            return NRFX_SUCCESS;
+        }
+    }
+    return NRFX_ERROR_NO_MEM;
+}
+
+nrfx_err_t nrfx_ppi_channel_free(nrf_ppi_channel_t channel)
+{
+    if (!m_channels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    m_channels[channel] = (host_ppi_channel_t){0};
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep)
+{
+    if (!m_channels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    m_channels[channel].eep = eep;
+    m_channels[channel].tep = tep;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep)
+{
+    if (!m_channels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    m_channels[channel].fork_tep = fork_tep;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_enable(nrf_ppi_channel_t channel)
+{
+    if (!m_channels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    m_channels[channel].enabled = true;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_disable(nrf_ppi_channel_t channel)
+{
+    if (!m_channels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    m_channels[channel].enabled = false;
+    return NRFX_SUCCESS;
+}
+
+static void task_run(uint32_t address)
+{
+    if (address != 0 && !host_timer_task(address) && !host_rtc_task(address) &&
+        !host_gpiote_task(address))
+    {
+        fprintf(stderr, "ppi: no task at 0x%08x\n", address);
+        abort();
+    }
+}
+
+void host_ppi_event(uint32_t event_address)
+{
+    for (int i = 0; i < NRF_PPI_CHANNEL_COUNT; i++)
+    {
+        host_ppi_channel_t const * p_channel = &m_channels[i];
+
+        if (p_channel->enabled && p_channel->eep == event_address)
+        {
+            task_run(p_channel->tep);
+            task_run(p_channel->fork_tep);
+        }
+    }
+}
@@ -0,0 +1,295 @@
+#include <string.h>
+#include "nrfx_pwm.h"
+#include "sim.h"
+
+#define HOST_PWM_INSTANCES 4
+
+NRF_PWM_Type host_pwm_registers[HOST_PWM_INSTANCES];
+
+typedef struct
+{
+    nrfx_pwm_handler_t handler;
+    uint8_t            pins[NRF_PWM_CHANNEL_COUNT];
+    uint8_t            seq;          // sequence being played, 0 or 1
+    uint32_t           seq_left;     // sequences left including the current one
+    uint32_t           step;         // step within the current sequence
+    uint32_t           dma_reads;
+    uint64_t           irq_latency_ns;
+    bool               running;
+} host_pwm_t;
+
+static host_pwm_t m_pwm[HOST_PWM_INSTANCES];
+static host_pwm_observer_t m_observer;
+
+void host_pwm_observer_set(host_pwm_observer_t observer)
+{
+    m_observer = observer;
+}
+
+uint32_t host_pwm_dma_reads(uint8_t instance)
+{
+    return m_pwm[instance].dma_reads;
+}
+
+void host_pwm_irq_latency_set(uint8_t instance, uint64_t latency_ns)
+{
+    m_pwm[instance].irq_latency_ns = latency_ns;
+}
+
+static uint8_t instance_of(NRF_PWM_Type const * p_reg)
+{
+    return (uint8_t)(p_reg - host_pwm_registers);
+}
+
+static uint64_t period_ns(NRF_PWM_Type const * p_reg)
+{
+    uint64_t clock_hz = 16000000ULL >> p_reg->PRESCALER;
+    return (p_reg->COUNTERTOP * 1000000000ULL) / clock_hz;
+}
+
+uint64_t host_pwm_period_ns(uint8_t instance)
+{
+    return period_ns(&host_pwm_registers[instance]);
+}
+
+static void notify(uint8_t instance, uint16_t const * p_levels)
+{
+    if (m_observer != NULL)
+    {
+        m_observer(instance, m_pwm[instance].pins, p_levels,
+                   (uint16_t)host_pwm_registers[instance].COUNTERTOP);
+    }
+}
+
+// Interrupt: the only events the model raises are SEQEND, LOOPSDONE and STOPPED
+static void pwm_irq(void * p_context)
+{
+    uint8_t instance = (uint8_t)(uintptr_t)p_context;
+    NRF_PWM_Type * p_reg = &host_pwm_registers[instance];
+    host_pwm_t * p_pwm = &m_pwm[instance];
+
+    for (int seq = 0; seq < 2; seq++)
+    {
+        if (p_reg->EVENTS_SEQEND[seq])
+        {
+            p_reg->EVENTS_SEQEND[seq] = 0;
+            if ((p_reg->INTEN & (0x10 << seq)) && p_pwm->handler != NULL)
+            {
+                p_pwm->handler(seq == 0 ? NRFX_PWM_EVT_END_SEQ0 : NRFX_PWM_EVT_END_SEQ1);
+            }
+        }
+    }
+    if (p_reg->EVENTS_LOOPSDONE)
+    {
+        p_reg->EVENTS_LOOPSDONE = 0;
+        if ((p_reg->INTEN & 0x80) && p_pwm->handler != NULL)
+        {
+            p_pwm->handler(NRFX_PWM_EVT_FINISHED);
+        }
+    }
+    if (p_reg->EVENTS_STOPPED)
+    {
+        p_reg->EVENTS_STOPPED = 0;
+        if (p_pwm->handler != NULL)
+        {
+            p_pwm->handler(NRFX_PWM_EVT_STOPPED);
+        }
+    }
+}
+
+// The handler runs irq_latency_ns after the event, the model does not wait for it
+static void irq_raise(uint8_t instance)
+{
+    sim_schedule(sim_time_ns() + m_pwm[instance].irq_latency_ns, pwm_irq, (void *)(uintptr_t)instance);
+}
+
+static void model_stop(uint8_t instance)
+{
+    static const uint16_t idle[NRF_PWM_CHANNEL_COUNT];
+
+    m_pwm[instance].running = false;
+    host_pwm_registers[instance].EVENTS_STOPPED = 1;
+    notify(instance, idle);
+    irq_raise(instance);
+}
+
+// EasyDMA fetch of one step, then hold it for REFRESH + 1 periods. SEQEND
+// comes with the last value of a sequence, as on the chip: its RAM is free
+// from then on, while the value still plays.
+static void model_step(void * p_context)
+{
+    uint8_t instance = (uint8_t)(uintptr_t)p_context;
+    NRF_PWM_Type * p_reg = &host_pwm_registers[instance];
+    host_pwm_t * p_pwm = &m_pwm[instance];
+
+    if (p_pwm->step * NRF_PWM_CHANNEL_COUNT >= p_reg->SEQ[p_pwm->seq].CNT)
+    {
+        p_pwm->seq ^= 1;
+        p_pwm->step = 0;
+        if (--p_pwm->seq_left == 0)
+        {
+            p_reg->EVENTS_LOOPSDONE = 1;
+            if (!(p_reg->SHORTS & 0x08))
+            {
+                model_stop(instance);   // LOOPSDONE_STOP short
+                return;
+            }
+            // LOOPSDONE_SEQSTART0 short, both sequences again without a gap
+            p_pwm->seq = 0;
+            p_pwm->seq_left = 2 * p_reg->LOOP;
+            if (p_reg->INTEN & 0x80)
+            {
+                irq_raise(instance);
+            }
+        }
+    }
+
+    uint16_t const * p_values = (uint16_t const *)p_reg->SEQ[p_pwm->seq].PTR;
+    uint16_t levels[NRF_PWM_CHANNEL_COUNT];
+    memcpy(levels, &p_values[p_pwm->step * NRF_PWM_CHANNEL_COUNT], sizeof(levels));
+    p_pwm->dma_reads += NRF_PWM_CHANNEL_COUNT;
+    p_pwm->step++;
+
+    if (p_pwm->step * NRF_PWM_CHANNEL_COUNT >= p_reg->SEQ[p_pwm->seq].CNT)
+    {
+        p_reg->EVENTS_SEQEND[p_pwm->seq] = 1;
+        if (p_reg->INTEN & (0x10 << p_pwm->seq))
+        {
+            irq_raise(instance);
+        }
+    }
+
+    notify(instance, levels);
+    sim_schedule(sim_time_ns() + period_ns(p_reg) * (p_reg->SEQ[p_pwm->seq].REFRESH + 1),
+                 model_step, p_context);
+}
+
+nrfx_err_t nrfx_pwm_init(nrfx_pwm_t const * const p_instance,
+                         nrfx_pwm_config_t const * p_config,
+                         nrfx_pwm_handler_t        handler)
+{
+    NRF_PWM_Type * p_reg = p_instance->p_registers;
+    host_pwm_t * p_pwm = &m_pwm[instance_of(p_reg)];
+
+    memset(p_pwm, 0, sizeof(*p_pwm));
+    memset((void *)p_reg, 0, sizeof(*p_reg));
+    p_pwm->handler = handler;
+
+    for (int i = 0; i < NRF_PWM_CHANNEL_COUNT; i++)
+    {
+        p_pwm->pins[i] = p_config->output_pins[i] & ~NRFX_PWM_PIN_INVERTED;
+        p_reg->PSEL_OUT[i] = p_pwm->pins[i];
+    }
+    p_reg->ENABLE     = 1;
+    p_reg->MODE       = p_config->count_mode;
+    p_reg->COUNTERTOP = p_config->top_value;
+    p_reg->PRESCALER  = p_config->base_clock;
+    p_reg->DECODER    = p_config->load_mode | (p_config->step_mode << 8);
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_pwm_uninit(nrfx_pwm_t const * const p_instance)
+{
+    uint8_t instance = instance_of(p_instance->p_registers);
+
+    sim_cancel(model_step, (void *)(uintptr_t)instance);
+    m_pwm[instance].running = false;
+    p_instance->p_registers->ENABLE = 0;
+}
+
+// As the driver does, events left from before do not reach the new playback
+static void playback_start(uint8_t instance)
+{
+    NRF_PWM_Type * p_reg = &host_pwm_registers[instance];
+    host_pwm_t * p_pwm = &m_pwm[instance];
+
+    p_reg->EVENTS_STOPPED = 0;
+    p_reg->EVENTS_SEQEND[0] = 0;
+    p_reg->EVENTS_SEQEND[1] = 0;
+    p_reg->EVENTS_LOOPSDONE = 0;
+    p_pwm->step    = 0;
+    p_pwm->running = true;
+    p_reg->TASKS_SEQSTART[p_pwm->seq] = 1;
+
+    sim_cancel(model_step, (void *)(uintptr_t)instance);
+    model_step((void *)(uintptr_t)instance);
+}
+
+uint32_t nrfx_pwm_simple_playback(nrfx_pwm_t const * const p_instance,
+                                  nrf_pwm_sequence_t const * p_sequence,
+                                  uint16_t                   playback_count,
+                                  uint32_t                   flags)
+{
+    NRF_PWM_Type * p_reg = p_instance->p_registers;
+    uint8_t instance = instance_of(p_reg);
+    host_pwm_t * p_pwm = &m_pwm[instance];
+
+    // Both sequence registers point to the same values, an odd count starts from SEQ1
+    for (int i = 0; i < 2; i++)
+    {
+        p_reg->SEQ[i].PTR      = (uintptr_t)p_sequence->values.p_raw;
+        p_reg->SEQ[i].CNT      = p_sequence->length;
+        p_reg->SEQ[i].REFRESH  = p_sequence->repeats;
+        p_reg->SEQ[i].ENDDELAY = p_sequence->end_delay;
+    }
+    p_reg->LOOP   = playback_count / 2;
+    p_reg->SHORTS = (flags & NRFX_PWM_FLAG_STOP) ? 0x04 : 0;
+    p_reg->INTEN  = 0x02 | ((flags & NRFX_PWM_FLAG_NO_EVT_FINISHED) ? 0 : 0x80);
+
+    p_pwm->seq      = playback_count & 1;
+    p_pwm->seq_left = playback_count;
+    playback_start(instance);
+
+    return 0;
+}
+
+uint32_t nrfx_pwm_complex_playback(nrfx_pwm_t const * const p_instance,
+                                   nrf_pwm_sequence_t const * p_sequence_0,
+                                   nrf_pwm_sequence_t const * p_sequence_1,
+                                   uint16_t                   playback_count,
+                                   uint32_t                   flags)
+{
+    NRF_PWM_Type * p_reg = p_instance->p_registers;
+    uint8_t instance = instance_of(p_reg);
+    host_pwm_t * p_pwm = &m_pwm[instance];
+    nrf_pwm_sequence_t const * p_sequences[2] = {p_sequence_0, p_sequence_1};
+
+    for (int i = 0; i < 2; i++)
+    {
+        p_reg->SEQ[i].PTR      = (uintptr_t)p_sequences[i]->values.p_raw;
+        p_reg->SEQ[i].CNT      = p_sequences[i]->length;
+        p_reg->SEQ[i].REFRESH  = p_sequences[i]->repeats;
+        p_reg->SEQ[i].ENDDELAY = p_sequences[i]->end_delay;
+    }
+    p_reg->LOOP   = playback_count;
+    p_reg->SHORTS = (flags & NRFX_PWM_FLAG_LOOP) ? 0x08 : (flags & NRFX_PWM_FLAG_STOP) ? 0x04 : 0;
+    p_reg->INTEN  = 0x02 | ((flags & NRFX_PWM_FLAG_NO_EVT_FINISHED) ? 0 : 0x80) |
+                    ((flags & NRFX_PWM_FLAG_SIGNAL_END_SEQ0) ? 0x10 : 0) |
+                    ((flags & NRFX_PWM_FLAG_SIGNAL_END_SEQ1) ? 0x20 : 0);
+
+    p_pwm->seq      = 0;
+    p_pwm->seq_left = 2 * playback_count;
+    playback_start(instance);
+
+    return 0;
+}
+
+bool nrfx_pwm_stop(nrfx_pwm_t const * const p_instance, bool wait_until_stopped)
+{
+    uint8_t instance = instance_of(p_instance->p_registers);
+
+    p_instance->p_registers->TASKS_STOP = 1;
+    if (m_pwm[instance].running)
+    {
+        sim_cancel(model_step, (void *)(uintptr_t)instance);
+        model_stop(instance);
+    }
+
+    return !m_pwm[instance].running;
+}
+
+bool nrfx_pwm_is_stopped(nrfx_pwm_t const * const p_instance)
+{
+    return !m_pwm[instance_of(p_instance->p_registers)].running;
+}
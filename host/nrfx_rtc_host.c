@@ -0,0 +1,384 @@
+#include <stddef.h>
+#include "nrfx_rtc.h"
+#include "nrfx_ppi.h"
+#include "sim.h"
+
+// RTC model. A running RTC ticks at 32768 Hz / (PRESCALER + 1) exactly, the
+// LFCLK is the reference of the simulation. Only ticks with an enabled event
+// (TICK, OVRFLW or a COMPARE) are simulator events; COUNTER reads between
+// them are computed from the virtual time, and the counter of such a tick
+// changes together with its events. A CC written to N or N + 1 while the
+// counter is N does not match until the counter comes round again, the
+// chip only may miss it.
+
+#define RTC_BUS_SIZE 0x1000
+
+typedef struct
+{
+    nrfx_rtc_handler_t handler;
+    bool               running;
+    uint64_t           origin_ns;       // tick 0 of the running RTC
+    uint32_t           offset;          // COUNTER = ticks since origin_ns + offset
+    uint64_t           event_tick;      // tick of the pending simulator event
+    uint64_t           armed_from[NRF_RTC_CC_CHANNEL_COUNT];   // first tick a CC may match
+} host_rtc_t;
+
+NRF_RTC_Type host_rtc_registers[NRF_RTC_INSTANCE_COUNT];
+
+static const uint32_t m_bus_address[NRF_RTC_INSTANCE_COUNT] = {0x4000B000, 0x40011000, 0x40024000};
+
+static host_rtc_t m_rtcs[NRF_RTC_INSTANCE_COUNT];
+
+static uint64_t tick_ns_num(int instance)
+{
+    return (host_rtc_registers[instance].PRESCALER + 1) * 1000000000ULL;
+}
+
+static uint64_t ticks_at(int instance, uint64_t time_ns)
+{
+    return (uint64_t)((unsigned __int128)(time_ns - m_rtcs[instance].origin_ns) * RTC_INPUT_FREQ /
+                      tick_ns_num(instance));
+}
+
+static uint64_t tick_time(int instance, uint64_t ticks)
+{
+    return m_rtcs[instance].origin_ns +
+           (uint64_t)(((unsigned __int128)ticks * tick_ns_num(instance) + RTC_INPUT_FREQ - 1) / RTC_INPUT_FREQ);
+}
+
+static uint64_t ticks_now(int instance)
+{
+    host_rtc_t const * p_rtc = &m_rtcs[instance];
+    uint64_t ticks = ticks_at(instance, sim_time_ns());
+
+    // The tick whose events are still to run has not happened yet
+    if (ticks != 0 && ticks == p_rtc->event_tick && sim_time_ns() == tick_time(instance, ticks))
+    {
+        ticks--;
+    }
+    return ticks;
+}
+
+static uint32_t counter_at(int instance, uint64_t ticks)
+{
+    return (uint32_t)(ticks + m_rtcs[instance].offset) & NRF_RTC_COUNTER_MAX;
+}
+
+static uint32_t counter_now(int instance)
+{
+    NRF_RTC_Type * p_reg = &host_rtc_registers[instance];
+
+    if (m_rtcs[instance].running)
+    {
+        p_reg->COUNTER = counter_at(instance, ticks_now(instance));
+    }
+    return p_reg->COUNTER;
+}
+
+static void counter_set(int instance, uint32_t value)
+{
+    host_rtc_t * p_rtc = &m_rtcs[instance];
+
+    host_rtc_registers[instance].COUNTER = value & NRF_RTC_COUNTER_MAX;
+    if (p_rtc->running)
+    {
+        p_rtc->offset = value - (uint32_t)ticks_now(instance);
+    }
+}
+
+static uint64_t earlier(uint64_t a, uint64_t b)
+{
+    return a < b ? a : b;
+}
+
+static uint32_t enabled(NRF_RTC_Type const * p_reg)
+{
+    return p_reg->EVTEN | p_reg->INTENSET;
+}
+
+static void rtc_event(void * p_context);
+
+static void schedule(int instance)
+{
+    host_rtc_t * p_rtc = &m_rtcs[instance];
+    NRF_RTC_Type const * p_reg = &host_rtc_registers[instance];
+
+    sim_cancel(rtc_event, (void *)(uintptr_t)instance);
+    p_rtc->event_tick = 0;
+    if (!p_rtc->running)
+    {
+        return;
+    }
+
+    uint64_t now = ticks_now(instance);
+    uint64_t next = UINT64_MAX;
+
+    if (enabled(p_reg) & NRF_RTC_INT_TICK_MASK)
+    {
+        next = now + 1;
+    }
+    if (enabled(p_reg) & NRF_RTC_INT_OVERFLOW_MASK)
+    {
+        uint64_t distance = (0 - counter_at(instance, now)) & NRF_RTC_COUNTER_MAX;
+
+        next = earlier(next, now + (distance ? distance : NRF_RTC_COUNTER_MAX + 1));
+    }
+    for (int i = 0; i < NRF_RTC_CC_CHANNEL_COUNT; i++)
+    {
+        if (enabled(p_reg) & (NRF_RTC_INT_COMPARE0_MASK << i))
+        {
+            uint64_t from = now + 1 > p_rtc->armed_from[i] ? now + 1 : p_rtc->armed_from[i];
+
+            next = earlier(next, from + ((p_reg->CC[i] - counter_at(instance, from)) & NRF_RTC_COUNTER_MAX));
+        }
+    }
+
+    if (next != UINT64_MAX)
+    {
+        p_rtc->event_tick = next;
+        sim_schedule(tick_time(instance, next), rtc_event, (void *)(uintptr_t)instance);
+    }
+}
+
+static void rtc_irq(void * p_context)
+{
+    int instance = (int)(uintptr_t)p_context;
+    host_rtc_t const * p_rtc = &m_rtcs[instance];
+    NRF_RTC_Type * p_reg = &host_rtc_registers[instance];
+
+    // nrfx_rtc turns a compare off once it has fired
+    for (int i = 0; i < NRF_RTC_CC_CHANNEL_COUNT; i++)
+    {
+        uint32_t mask = NRF_RTC_INT_COMPARE0_MASK << i;
+
+        if ((p_reg->INTENSET & mask) && p_reg->EVENTS_COMPARE[i])
+        {
+            p_reg->INTENSET &= ~mask;
+            p_reg->EVTEN &= ~mask;
+            p_reg->EVENTS_COMPARE[i] = 0;
+            schedule(instance);
+            p_rtc->handler((nrfx_rtc_int_type_t)i);
+        }
+    }
+    if ((p_reg->INTENSET & NRF_RTC_INT_TICK_MASK) && p_reg->EVENTS_TICK)
+    {
+        p_reg->EVENTS_TICK = 0;
+        p_rtc->handler(NRFX_RTC_INT_TICK);
+    }
+    if ((p_reg->INTENSET & NRF_RTC_INT_OVERFLOW_MASK) && p_reg->EVENTS_OVRFLW)
+    {
+        p_reg->EVENTS_OVRFLW = 0;
+        p_rtc->handler(NRFX_RTC_INT_OVERFLOW);
+    }
+}
+
+static void rtc_event(void * p_context)
+{
+    int instance = (int)(uintptr_t)p_context;
+    host_rtc_t * p_rtc = &m_rtcs[instance];
+    NRF_RTC_Type * p_reg = &host_rtc_registers[instance];
+    uint64_t tick = p_rtc->event_tick;
+    uint32_t counter = counter_at(instance, tick);
+    uint32_t fired = 0;
+
+    p_rtc->event_tick = 0;
+    p_reg->COUNTER = counter;
+
+    if (enabled(p_reg) & NRF_RTC_INT_TICK_MASK)
+    {
+        fired |= NRF_RTC_INT_TICK_MASK;
+        p_reg->EVENTS_TICK = 1;
+        host_ppi_event(m_bus_address[instance] + NRF_RTC_EVENT_TICK);
+    }
+    if ((enabled(p_reg) & NRF_RTC_INT_OVERFLOW_MASK) && counter == 0)
+    {
+        fired |= NRF_RTC_INT_OVERFLOW_MASK;
+        p_reg->EVENTS_OVRFLW = 1;
+        host_ppi_event(m_bus_address[instance] + NRF_RTC_EVENT_OVERFLOW);
+    }
+    for (int i = 0; i < NRF_RTC_CC_CHANNEL_COUNT; i++)
+    {
+        uint32_t mask = NRF_RTC_INT_COMPARE0_MASK << i;
+
+        if ((enabled(p_reg) & mask) && p_reg->CC[i] == counter && tick >= p_rtc->armed_from[i])
+        {
+            fired |= mask;
+            p_reg->EVENTS_COMPARE[i] = 1;
+            host_ppi_event(m_bus_address[instance] + NRF_RTC_EVENT_COMPARE_0 + 4 * i);
+        }
+    }
+
+    if (p_reg->INTENSET & fired)
+    {
+        sim_schedule(sim_time_ns(), rtc_irq, (void *)(uintptr_t)instance);
+    }
+    schedule(instance);
+}
+
+static int instance_of(NRF_RTC_Type const * p_reg)
+{
+    return (int)(p_reg - host_rtc_registers);
+}
+
+static void task_run(int instance, uint32_t task)
+{
+    host_rtc_t * p_rtc = &m_rtcs[instance];
+
+    switch (task)
+    {
+        case NRF_RTC_TASK_START:
+            if (!p_rtc->running)
+            {
+                p_rtc->running = true;
+                p_rtc->origin_ns = sim_time_ns();
+                p_rtc->offset = host_rtc_registers[instance].COUNTER;
+                for (int i = 0; i < NRF_RTC_CC_CHANNEL_COUNT; i++)
+                {
+                    p_rtc->armed_from[i] = 0;
+                }
+            }
+            break;
+
+        case NRF_RTC_TASK_STOP:
+            counter_now(instance);
+            p_rtc->running = false;
+            break;
+
+        case NRF_RTC_TASK_CLEAR:
+            counter_set(instance, 0);
+            break;
+
+        case NRF_RTC_TASK_TRIGGER_OVERFLOW:
+            counter_set(instance, NRF_RTC_COUNTER_MAX - 0xF);
+            break;
+
+        default:
+            break;
+    }
+    schedule(instance);
+}
+
+bool host_rtc_task(uint32_t address)
+{
+    for (int i = 0; i < NRF_RTC_INSTANCE_COUNT; i++)
+    {
+        if (address >= m_bus_address[i] && address < m_bus_address[i] + RTC_BUS_SIZE)
+        {
+            task_run(i, address - m_bus_address[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t nrf_rtc_counter_get(NRF_RTC_Type * p_reg)
+{
+    return counter_now(instance_of(p_reg));
+}
+
+void nrf_rtc_task_trigger(NRF_RTC_Type * p_reg, nrf_rtc_task_t task)
+{
+    task_run(instance_of(p_reg), task);
+}
+
+nrfx_err_t nrfx_rtc_init(nrfx_rtc_t const * const  p_instance,
+                         nrfx_rtc_config_t const * p_config,
+                         nrfx_rtc_handler_t        handler)
+{
+    m_rtcs[p_instance->instance_id].handler = handler;
+    p_instance->p_reg->PRESCALER = p_config->prescaler;
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_rtc_enable(nrfx_rtc_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_RTC_TASK_START);
+}
+
+void nrfx_rtc_disable(nrfx_rtc_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_RTC_TASK_STOP);
+}
+
+nrfx_err_t nrfx_rtc_cc_set(nrfx_rtc_t const * const p_instance, uint32_t channel,
+                           uint32_t val, bool enable_irq)
+{
+    int instance = p_instance->instance_id;
+    NRF_RTC_Type * p_reg = p_instance->p_reg;
+    uint32_t mask = NRF_RTC_INT_COMPARE0_MASK << channel;
+
+    p_reg->INTENSET &= ~mask;
+    p_reg->EVTEN &= ~mask;
+    p_reg->CC[channel] = val & NRF_RTC_COUNTER_MAX;
+    p_reg->EVENTS_COMPARE[channel] = 0;
+    m_rtcs[instance].armed_from[channel] = m_rtcs[instance].running ? ticks_now(instance) + 2 : 0;
+    p_reg->EVTEN |= mask;
+    if (enable_irq)
+    {
+        p_reg->INTENSET |= mask;
+    }
+    schedule(instance);
+
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_rtc_cc_disable(nrfx_rtc_t const * const p_instance, uint32_t channel)
+{
+    uint32_t mask = NRF_RTC_INT_COMPARE0_MASK << channel;
+
+    p_instance->p_reg->INTENSET &= ~mask;
+    p_instance->p_reg->EVTEN &= ~mask;
+    p_instance->p_reg->EVENTS_COMPARE[channel] = 0;
+    schedule(p_instance->instance_id);
+
+    return NRFX_SUCCESS;
+}
+
+static void event_enable(nrfx_rtc_t const * const p_instance, uint32_t mask, bool enable, bool enable_irq)
+{
+    p_instance->p_reg->EVTEN = enable ? p_instance->p_reg->EVTEN | mask : p_instance->p_reg->EVTEN & ~mask;
+    p_instance->p_reg->INTENSET = enable && enable_irq ? p_instance->p_reg->INTENSET | mask
+                                                       : p_instance->p_reg->INTENSET & ~mask;
+    schedule(p_instance->instance_id);
+}
+
+void nrfx_rtc_tick_enable(nrfx_rtc_t const * const p_instance, bool enable_irq)
+{
+    event_enable(p_instance, NRF_RTC_INT_TICK_MASK, true, enable_irq);
+}
+
+void nrfx_rtc_tick_disable(nrfx_rtc_t const * const p_instance)
+{
+    event_enable(p_instance, NRF_RTC_INT_TICK_MASK, false, false);
+}
+
+void nrfx_rtc_overflow_enable(nrfx_rtc_t const * const p_instance, bool enable_irq)
+{
+    event_enable(p_instance, NRF_RTC_INT_OVERFLOW_MASK, true, enable_irq);
+}
+
+void nrfx_rtc_overflow_disable(nrfx_rtc_t const * const p_instance)
+{
+    event_enable(p_instance, NRF_RTC_INT_OVERFLOW_MASK, false, false);
+}
+
+uint32_t nrfx_rtc_counter_get(nrfx_rtc_t const * const p_instance)
+{
+    return counter_now(p_instance->instance_id);
+}
+
+void nrfx_rtc_counter_clear(nrfx_rtc_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_RTC_TASK_CLEAR);
+}
+
+uint32_t nrfx_rtc_event_address_get(nrfx_rtc_t const * const p_instance, nrf_rtc_event_t event)
+{
+    return m_bus_address[p_instance->instance_id] + event;
+}
+
+uint32_t nrfx_rtc_task_address_get(nrfx_rtc_t const * const p_instance, nrf_rtc_task_t task)
+{
+    return m_bus_address[p_instance->instance_id] + task;
+}
@@ -0,0 +1,27 @@
+#include "nrfx_systick.h"
+#include "sim.h"
+
+void nrfx_systick_init(void)
+{
+}
+
+void nrfx_systick_get(nrfx_systick_state_t * p_state)
+{
+    p_state->time_ns = sim_time_ns();
+}
+
+bool nrfx_systick_test(nrfx_systick_state_t const * p_state, uint32_t us)
+{
+    sim_run_until(sim_time_ns() + 1000);
+    return sim_time_ns() - p_state->time_ns >= us * 1000ULL;
+}
+
+void nrfx_systick_delay_us(uint32_t us)
+{
+    sim_run_until(sim_time_ns() + us * 1000ULL);
+}
+
+void nrfx_systick_delay_ms(uint32_t ms)
+{
+    sim_run_until(sim_time_ns() + ms * 1000000ULL);
+}
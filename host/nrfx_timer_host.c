@@ -0,0 +1,375 @@
+#include <stddef.h>
+#include "nrfx_timer.h"
+#include "nrfx_ppi.h"
+#include "sim.h"
+
+// TIMER model. A running timer counts ticks of 16 MHz >> PRESCALER from the
+// virtual time it was started, off by the clock error if one is set. Only the
+// next compare match is a simulator event: it sets the COMPARE event, applies
+// the shorts, publishes the event to PPI and queues the interrupt. In counter
+// mode the COUNT task steps the counter and matches at once.
+
+#define TIMER_BUS_SIZE 0x1000
+
+typedef struct
+{
+    nrfx_timer_event_handler_t handler;
+    void *                     p_context;
+    bool                       running;
+    uint64_t                   origin_ns;   // tick 0 of the running timer
+    uint32_t                   offset;      // counter = ticks since origin_ns + offset
+    uint32_t                   count;       // counter while stopped, or in counter mode
+    bool                       match_pending;
+    uint64_t                   match_ticks; // tick of the pending compare event
+} host_timer_t;
+
+NRF_TIMER_Type host_timer_registers[NRF_TIMER_INSTANCE_COUNT];
+
+static const uint32_t m_bus_address[NRF_TIMER_INSTANCE_COUNT] =
+{
+    0x40008000, 0x40009000, 0x4000A000, 0x4001A000, 0x4001B000
+};
+
+static host_timer_t m_timers[NRF_TIMER_INSTANCE_COUNT];
+static int32_t m_error_ppm;
+
+void host_timer_clock_error_set(int32_t ppm)
+{
+    m_error_ppm = ppm;
+}
+
+static uint32_t counter_mask(NRF_TIMER_Type const * p_reg)
+{
+    static const uint32_t masks[] = {0xFFFF, 0xFF, 0xFFFFFF, 0xFFFFFFFF};
+
+    return masks[p_reg->BITMODE & 3];
+}
+
+static bool counts_time(NRF_TIMER_Type const * p_reg)
+{
+    return p_reg->MODE == NRF_TIMER_MODE_TIMER;
+}
+
+// Ticks per 10^15 ns, the clock error included
+static unsigned __int128 tick_rate(NRF_TIMER_Type const * p_reg)
+{
+    return (unsigned __int128)(16000000UL >> p_reg->PRESCALER) * (uint64_t)(1000000 + m_error_ppm);
+}
+
+static uint64_t ticks_at(int instance, uint64_t time_ns)
+{
+    NRF_TIMER_Type const * p_reg = &host_timer_registers[instance];
+
+    return (uint64_t)((time_ns - m_timers[instance].origin_ns) * tick_rate(p_reg) / 1000000000000000ULL);
+}
+
+// Virtual time at which the running timer has counted ticks
+static uint64_t tick_time(int instance, uint64_t ticks)
+{
+    NRF_TIMER_Type const * p_reg = &host_timer_registers[instance];
+    unsigned __int128 rate = tick_rate(p_reg);
+
+    return m_timers[instance].origin_ns + (uint64_t)((ticks * (unsigned __int128)1000000000000000ULL + rate - 1) / rate);
+}
+
+static uint32_t counter_now(int instance)
+{
+    host_timer_t const * p_timer = &m_timers[instance];
+    NRF_TIMER_Type const * p_reg = &host_timer_registers[instance];
+
+    if (p_timer->running && counts_time(p_reg))
+    {
+        return (uint32_t)(ticks_at(instance, sim_time_ns()) + p_timer->offset) & counter_mask(p_reg);
+    }
+    return p_timer->count & counter_mask(p_reg);
+}
+
+static void counter_set(int instance, uint32_t value)
+{
+    host_timer_t * p_timer = &m_timers[instance];
+
+    p_timer->count = value;
+    if (p_timer->running)
+    {
+        p_timer->offset = value - (uint32_t)ticks_at(instance, sim_time_ns());
+    }
+}
+
+static void compare_event(void * p_context);
+
+// The simulator event for the next match of the running timer, if any
+static void schedule(int instance)
+{
+    host_timer_t * p_timer = &m_timers[instance];
+    NRF_TIMER_Type const * p_reg = &host_timer_registers[instance];
+    uint64_t ticks = ticks_at(instance, sim_time_ns());
+
+    // A match due now, with its event still to run, stays due
+    if (p_timer->match_pending && p_timer->match_ticks == ticks)
+    {
+        ticks--;
+    }
+
+    sim_cancel(compare_event, (void *)(uintptr_t)instance);
+    p_timer->match_pending = false;
+    if (!p_timer->running || !counts_time(p_reg))
+    {
+        return;
+    }
+
+    uint32_t mask = counter_mask(p_reg);
+    uint32_t count = (uint32_t)(ticks + p_timer->offset) & mask;
+    uint64_t ahead = (uint64_t)mask + 1;
+
+    // A CC equal to the counter matches again after a wrap
+    for (int i = 0; i < NRF_TIMER_CC_CHANNEL_COUNT; i++)
+    {
+        uint64_t distance = (p_reg->CC[i] - count) & mask;
+
+        if (distance != 0 && distance < ahead)
+        {
+            ahead = distance;
+        }
+    }
+    p_timer->match_pending = true;
+    p_timer->match_ticks = ticks + ahead;
+    sim_schedule(tick_time(instance, ticks + ahead), compare_event, (void *)(uintptr_t)instance);
+}
+
+static void timer_irq(void * p_context)
+{
+    int instance = (int)(uintptr_t)p_context;
+    host_timer_t const * p_timer = &m_timers[instance];
+    NRF_TIMER_Type * p_reg = &host_timer_registers[instance];
+
+    for (int i = 0; i < NRF_TIMER_CC_CHANNEL_COUNT; i++)
+    {
+        if (p_reg->EVENTS_COMPARE[i] && (p_reg->INTENSET & (1UL << (16 + i))))
+        {
+            p_reg->EVENTS_COMPARE[i] = 0;
+            if (p_timer->handler != NULL)
+            {
+                p_timer->handler((nrf_timer_event_t)(NRF_TIMER_EVENT_COMPARE0 + 4 * i), p_timer->p_context);
+            }
+        }
+    }
+}
+
+// The counter has just reached count
+static void compare_match(int instance, uint32_t count)
+{
+    host_timer_t * p_timer = &m_timers[instance];
+    NRF_TIMER_Type * p_reg = &host_timer_registers[instance];
+    uint32_t matched = 0;
+
+    for (int i = 0; i < NRF_TIMER_CC_CHANNEL_COUNT; i++)
+    {
+        if ((p_reg->CC[i] & counter_mask(p_reg)) == count)
+        {
+            matched |= 1UL << i;
+            p_reg->EVENTS_COMPARE[i] = 1;
+        }
+    }
+    if (matched == 0)
+    {
+        return;
+    }
+
+    // Shorts act inside the peripheral, before PPI
+    if (p_reg->SHORTS & matched)
+    {
+        counter_set(instance, 0);
+    }
+    if (p_reg->SHORTS & (matched << 8))
+    {
+        p_timer->count = counter_now(instance);
+        p_timer->running = false;
+    }
+
+    for (int i = 0; i < NRF_TIMER_CC_CHANNEL_COUNT; i++)
+    {
+        if (matched & (1UL << i))
+        {
+            host_ppi_event(m_bus_address[instance] + NRF_TIMER_EVENT_COMPARE0 + 4 * i);
+        }
+    }
+    if (p_reg->INTENSET & (matched << 16))
+    {
+        sim_schedule(sim_time_ns(), timer_irq, (void *)(uintptr_t)instance);
+    }
+}
+
+static void compare_event(void * p_context)
+{
+    int instance = (int)(uintptr_t)p_context;
+
+    m_timers[instance].match_pending = false;
+    compare_match(instance, counter_now(instance));
+    schedule(instance);
+}
+
+static void task_run(int instance, uint32_t task)
+{
+    host_timer_t * p_timer = &m_timers[instance];
+    NRF_TIMER_Type * p_reg = &host_timer_registers[instance];
+
+    switch (task)
+    {
+        case NRF_TIMER_TASK_START:
+            if (!p_timer->running)
+            {
+                p_timer->running = true;
+                p_timer->origin_ns = sim_time_ns();
+                p_timer->offset = p_timer->count;
+            }
+            break;
+
+        case NRF_TIMER_TASK_STOP:
+        case NRF_TIMER_TASK_SHUTDOWN:
+            p_timer->count = counter_now(instance);
+            p_timer->running = false;
+            break;
+
+        case NRF_TIMER_TASK_CLEAR:
+            counter_set(instance, 0);
+            break;
+
+        case NRF_TIMER_TASK_COUNT:
+            if (p_timer->running && !counts_time(p_reg))
+            {
+                p_timer->count = (p_timer->count + 1) & counter_mask(p_reg);
+                compare_match(instance, p_timer->count);
+            }
+            break;
+
+        default:
+            if (task >= NRF_TIMER_TASK_CAPTURE0 && task <= NRF_TIMER_TASK_CAPTURE5)
+            {
+                p_reg->CC[(task - NRF_TIMER_TASK_CAPTURE0) / 4] = counter_now(instance);
+            }
+            break;
+    }
+    schedule(instance);
+}
+
+bool host_timer_task(uint32_t address)
+{
+    for (int i = 0; i < NRF_TIMER_INSTANCE_COUNT; i++)
+    {
+        if (address >= m_bus_address[i] && address < m_bus_address[i] + TIMER_BUS_SIZE)
+        {
+            task_run(i, address - m_bus_address[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+nrfx_err_t nrfx_timer_init(nrfx_timer_t const * const  p_instance,
+                           nrfx_timer_config_t const * p_config,
+                           nrfx_timer_event_handler_t  timer_event_handler)
+{
+    NRF_TIMER_Type * p_reg = p_instance->p_reg;
+    host_timer_t * p_timer = &m_timers[p_instance->instance_id];
+
+    p_timer->handler = timer_event_handler;
+    p_timer->p_context = p_config->p_context;
+    for (int i = 0; i < NRF_TIMER_CC_CHANNEL_COUNT; i++)
+    {
+        p_reg->EVENTS_COMPARE[i] = 0;
+    }
+    p_reg->MODE = p_config->mode;
+    p_reg->BITMODE = p_config->bit_width;
+    if (p_config->mode == NRF_TIMER_MODE_TIMER)
+    {
+        p_reg->PRESCALER = p_config->frequency;
+    }
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_timer_enable(nrfx_timer_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_TIMER_TASK_START);
+}
+
+void nrfx_timer_disable(nrfx_timer_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_TIMER_TASK_SHUTDOWN);
+}
+
+void nrfx_timer_clear(nrfx_timer_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_TIMER_TASK_CLEAR);
+}
+
+void nrfx_timer_increment(nrfx_timer_t const * const p_instance)
+{
+    task_run(p_instance->instance_id, NRF_TIMER_TASK_COUNT);
+}
+
+uint32_t nrfx_timer_capture(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    task_run(p_instance->instance_id, NRF_TIMER_TASK_CAPTURE0 + 4 * cc_channel);
+    return p_instance->p_reg->CC[cc_channel];
+}
+
+uint32_t nrfx_timer_capture_get(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    return p_instance->p_reg->CC[cc_channel];
+}
+
+void nrfx_timer_compare_int_enable(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    p_instance->p_reg->EVENTS_COMPARE[channel] = 0;
+    p_instance->p_reg->INTENSET |= 1UL << (16 + channel);
+}
+
+void nrfx_timer_compare_int_disable(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    p_instance->p_reg->INTENSET &= ~(1UL << (16 + channel));
+}
+
+void nrfx_timer_compare(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel,
+                        uint32_t cc_value, bool enable_int)
+{
+    if (enable_int)
+    {
+        nrfx_timer_compare_int_enable(p_instance, cc_channel);
+    }
+    else
+    {
+        nrfx_timer_compare_int_disable(p_instance, cc_channel);
+    }
+    p_instance->p_reg->CC[cc_channel] = cc_value;
+    schedule(p_instance->instance_id);
+}
+
+void nrfx_timer_extended_compare(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel,
+                                 uint32_t cc_value, nrf_timer_short_mask_t timer_short_mask,
+                                 bool enable_int)
+{
+    p_instance->p_reg->SHORTS &= ~(((1UL << 8) | 1UL) << cc_channel);
+    p_instance->p_reg->SHORTS |= timer_short_mask;
+    nrfx_timer_compare(p_instance, cc_channel, cc_value, enable_int);
+}
+
+uint32_t nrfx_timer_task_address_get(nrfx_timer_t const * const p_instance, nrf_timer_task_t timer_task)
+{
+    return m_bus_address[p_instance->instance_id] + timer_task;
+}
+
+uint32_t nrfx_timer_capture_task_address_get(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    return m_bus_address[p_instance->instance_id] + NRF_TIMER_TASK_CAPTURE0 + 4 * channel;
+}
+
+uint32_t nrfx_timer_event_address_get(nrfx_timer_t const * const p_instance, nrf_timer_event_t timer_event)
+{
+    return m_bus_address[p_instance->instance_id] + timer_event;
+}
+
+uint32_t nrfx_timer_compare_event_address_get(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    return m_bus_address[p_instance->instance_id] + NRF_TIMER_EVENT_COMPARE0 + 4 * channel;
+}
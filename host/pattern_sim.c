@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pattern_vm.h"
+#include "patterns.h"
+#include "led_render.h"
+
+// Checks the pattern VM:
+//  - pattern_vm_load() rejects malformed programs,
+//  - the built-in device_id patterns blink every LED its digit per cycle,
+//    in both modes and with digits of 0,
+//  - every pattern compiled from patterns/*.pat loads and takes time,
+//  - event branches, holds, resume after an interrupt, the step budget,
+// and measures the dispatch cost per op of a loop of cheap ops.
+
+#define ARRAY_SIZE(a)  (sizeof(a) / sizeof((a)[0]))
+#define BENCH_STEPS    200000
+
+typedef struct
+{
+    char const *    name;
+    uint8_t const * p_code;
+    uint16_t        length;
+} program_t;
+
+#define PROGRAM(name, ...) {name, (uint8_t const[]){__VA_ARGS__}, sizeof((uint8_t const[]){__VA_ARGS__})}
+
+static const program_t m_malformed[] =
+{
+    PROGRAM("unknown op",          PATTERN_OP_COUNT),
+    PROGRAM("truncated operand",   PATTERN_OP_WAIT, 0x10),
+    PROGRAM("mask too wide",       PATTERN_SET(0x10, 1)),
+    PROGRAM("unknown easing",      PATTERN_FADE(1, 255, 100, LED_EASING_COUNT)),
+    PROGRAM("blink too long",      PATTERN_BLINK(1, 0x8000, 0)),
+    PROGRAM("variable",            PATTERN_LOOP_VAR(PATTERN_VM_VARS), PATTERN_NEXT()),
+    PROGRAM("event",               PATTERN_BRANCH_EVENT(PATTERN_VM_EVENTS, 0)),
+    PROGRAM("NEXT without LOOP",   PATTERN_WAIT(1), PATTERN_NEXT()),
+    PROGRAM("LOOP without NEXT",   PATTERN_LOOP(2), PATTERN_WAIT(1)),
+    PROGRAM("loops too deep",      PATTERN_LOOP(2), PATTERN_LOOP(2), PATTERN_LOOP(2), PATTERN_LOOP(2),
+                                   PATTERN_LOOP(2), PATTERN_WAIT(1), PATTERN_NEXT(), PATTERN_NEXT(),
+                                   PATTERN_NEXT(), PATTERN_NEXT(), PATTERN_NEXT()),
+    PROGRAM("jump into an op",     PATTERN_WAIT(1), PATTERN_JUMP(1)),
+    PROGRAM("jump past the end",   PATTERN_WAIT(1), PATTERN_JUMP(6)),
+    PROGRAM("jump out of a loop",  PATTERN_LOOP(2), PATTERN_JZ(0, 0), PATTERN_NEXT()),
+    PROGRAM("jump into a loop",    PATTERN_JUMP(5), PATTERN_LOOP(2), PATTERN_WAIT(1), PATTERN_NEXT()),
+};
+
+static bool malformed_check(void)
+{
+    static const uint8_t good[] = {PATTERN_LOOP(2), PATTERN_JZ(0, 6), PATTERN_WAIT(1), PATTERN_NEXT(), PATTERN_END()};
+    pattern_vm_t vm = {0};
+    pattern_vm_action_t action;
+    bool ok = pattern_vm_load(&vm, good, sizeof(good));
+
+    if (!ok)
+    {
+        printf("FAIL load: a valid program is rejected\n");
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(m_malformed); i++)
+    {
+        if (pattern_vm_load(&vm, m_malformed[i].p_code, m_malformed[i].length))
+        {
+            printf("FAIL load: %s accepted\n", m_malformed[i].name);
+            ok = false;
+        }
+    }
+
+    // A rejected program leaves nothing to run
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_ERROR;
+
+    printf("%s load         %zu malformed programs rejected\n", ok ? "ok  " : "FAIL", ARRAY_SIZE(m_malformed));
+    return ok;
+}
+
+// One cycle: blinks per LED up to the wait after which all digits are shown
+static bool device_id_check(uint8_t const * p_digits, uint8_t mode)
+{
+    pattern_vm_t vm = {0};
+    pattern_vm_action_t action;
+    uint8_t blinks[PATTERN_VM_CHANNELS] = {0};
+    uint16_t length;
+    uint8_t const * p_code = patterns_device_id(mode, &length);
+    uint32_t fades = 0;
+    uint32_t waits = 0;
+    uint32_t expected_waits = 0;
+    uint32_t largest = 0;
+    bool single = true;
+    bool ok;
+
+    for (uint8_t i = 0; i < PATTERN_VM_CHANNELS; i++)
+    {
+        pattern_vm_var_set(&vm, PATTERNS_VAR_DIGIT(i), p_digits[i]);
+        expected_waits += p_digits[i] != 0;
+        largest = p_digits[i] > largest ? p_digits[i] : largest;
+    }
+    if (mode == LED_RENDER_MODE_CONCURRENT)
+    {
+        expected_waits = 1;
+    }
+    ok = pattern_vm_load(&vm, p_code, length);
+
+    // Two cycles, the second one after the JUMP back to the start
+    for (int cycle = 0; cycle < 2 && ok; cycle++)
+    {
+        memset(blinks, 0, sizeof(blinks));
+        fades = 0;
+        waits = 0;
+        for (int n = 0; n < 1000; n++)
+        {
+            pattern_vm_step(&vm, &action);
+            if (action.type == PATTERN_VM_ACTION_FADE)
+            {
+                fades++;
+                for (int i = 0; i < PATTERN_VM_CHANNELS; i++)
+                {
+                    blinks[i] += (action.lit_mask >> i) & 1;
+                }
+                single &= mode == LED_RENDER_MODE_CONCURRENT ||
+                          (action.lit_mask & (action.lit_mask - 1)) == 0;
+                ok &= action.duration_ms == 2 * BLINK_FADE_MS;
+            }
+            else if (action.type == PATTERN_VM_ACTION_WAIT)
+            {
+                waits++;
+                ok &= action.duration_ms == PATTERNS_PAUSE_MS && action.lit_mask == 0;
+                if (memcmp(blinks, p_digits, sizeof(blinks)) == 0)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                ok = false;
+                break;
+            }
+        }
+        ok &= memcmp(blinks, p_digits, sizeof(blinks)) == 0 && waits == expected_waits && single &&
+              (mode == LED_RENDER_MODE_SEQUENTIAL || fades == largest);
+    }
+
+    printf("%s device_id    %u%u%u%u %s: %u blinks %u %u %u %u, %u waits\n", ok ? "ok  " : "FAIL",
+           p_digits[0], p_digits[1], p_digits[2], p_digits[3],
+           mode == LED_RENDER_MODE_CONCURRENT ? "concurrent" : "sequential",
+           fades, blinks[0], blinks[1], blinks[2], blinks[3], waits);
+    return ok;
+}
+
+// Every shipped pattern, 100 actions or up to its end
+static bool shipped_check(void)
+{
+    bool ok = patterns_count() != 0;
+
+    for (uint16_t i = 0; i < patterns_count(); i++)
+    {
+        patterns_entry_t const * p_entry = patterns_get(i);
+        pattern_vm_t vm = {.vars = {7, 2, 1, 4}};
+        pattern_vm_action_t action = {.type = PATTERN_VM_ACTION_ERROR};
+        uint32_t time_ms = 0;
+        bool pass = pattern_vm_load(&vm, p_entry->p_code, p_entry->length);
+
+        for (int n = 0; n < 100 && pass; n++)
+        {
+            pattern_vm_event_post(&vm, n == 50 ? 0 : PATTERN_VM_EVENTS);
+            pattern_vm_step(&vm, &action);
+            if (action.type == PATTERN_VM_ACTION_END)
+            {
+                break;
+            }
+            pass = action.type != PATTERN_VM_ACTION_ERROR;
+            time_ms += action.duration_ms;
+        }
+
+        printf("%s pattern      %-22s %3u bytes, %u ms in %u ops\n", pass ? "ok  " : "FAIL",
+               p_entry->p_name, p_entry->length, time_ms, vm.ops);
+        ok &= pass;
+    }
+
+    ok &= patterns_get(patterns_count()) == NULL && patterns_find("no such pattern") == NULL &&
+          patterns_find("device_id_sequential") != NULL;
+    return ok;
+}
+
+static bool events_check(void)
+{
+    static const uint8_t program[] =
+    {
+        /* 0 */  PATTERN_BRANCH_EVENT(3, 12),
+        /* 4 */  PATTERN_BLINK(1, 100, 0),
+        /* 9 */  PATTERN_JUMP(0),
+        /* 12 */ PATTERN_BLINK(2, 100, 0),
+        /* 17 */ PATTERN_END(),
+    };
+    pattern_vm_t vm = {0};
+    pattern_vm_action_t action;
+    bool ok = pattern_vm_load(&vm, program, sizeof(program));
+
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_FADE && action.lit_mask == 1;
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_FADE && action.lit_mask == 1;
+    pattern_vm_event_post(&vm, 3);
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_FADE && action.lit_mask == 2;
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_END && vm.events == 0;
+
+    printf("%s events       branch taken once, event cleared\n", ok ? "ok  " : "FAIL");
+    return ok;
+}
+
+static bool interrupt_check(void)
+{
+    static const uint8_t program[] =
+    {
+        PATTERN_SET(1, 200),
+        PATTERN_LOOP(3),
+            PATTERN_FADE(1, 100, 300, LED_EASING_EASE_IN),
+            PATTERN_WAIT(50),
+        PATTERN_NEXT(),
+        PATTERN_END(),
+    };
+    pattern_vm_t vm = {0};
+    pattern_vm_action_t action;
+    uint32_t fades = 0;
+    bool ok = pattern_vm_load(&vm, program, sizeof(program));
+
+    // From the SET level down to 100, then held by the wait
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_FADE && action.timelines[0].count == 2 &&
+          action.keyframes[0][0].level == 200 * 257 + 1 &&
+          action.timelines[1].count == 1 && action.keyframes[1][0].level == 0 && action.lit_mask == 1;
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_WAIT && action.lit_mask == 1 && action.duration_ms == 50 &&
+          action.timelines[0].count == 1 && action.keyframes[0][0].level == 100 * 257;
+
+    // Second fade cut short: played again, from off
+    pattern_vm_step(&vm, &action);
+    pattern_vm_interrupt(&vm);
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_FADE && action.keyframes[0][0].level == 0;
+    fades = 3;
+
+    // A wait cut short is dropped
+    pattern_vm_step(&vm, &action);
+    pattern_vm_interrupt(&vm);
+    while (pattern_vm_step(&vm, &action), action.type == PATTERN_VM_ACTION_FADE ||
+                                          action.type == PATTERN_VM_ACTION_WAIT)
+    {
+        fades += action.type == PATTERN_VM_ACTION_FADE;
+    }
+    ok &= action.type == PATTERN_VM_ACTION_END && fades == 4;
+
+    printf("%s interrupt    fade replayed from off, wait dropped, %u fades\n", ok ? "ok  " : "FAIL", fades);
+    return ok;
+}
+
+static bool budget_check(void)
+{
+    static const uint8_t spin[] = {PATTERN_LOOP(0), PATTERN_SET(1, 1), PATTERN_NEXT()};
+    static const uint8_t skip[] = {PATTERN_LOOP_VAR(0), PATTERN_BLINK(1, 10, 0), PATTERN_NEXT(), PATTERN_WAIT(5)};
+    pattern_vm_t vm = {0};
+    pattern_vm_action_t action;
+    bool ok = pattern_vm_load(&vm, spin, sizeof(spin));
+
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_ERROR && vm.ops == PATTERN_VM_STEP_BUDGET;
+
+    // A loop of a variable 0 runs its body no time, running off the end stops
+    pattern_vm_var_set(&vm, 0, 0);
+    ok &= pattern_vm_load(&vm, skip, sizeof(skip));
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_WAIT && action.duration_ms == 5;
+    pattern_vm_step(&vm, &action);
+    ok &= action.type == PATTERN_VM_ACTION_END;
+
+    printf("%s budget       endless loop stopped after %u ops, empty loop skipped\n",
+           ok ? "ok  " : "FAIL", PATTERN_VM_STEP_BUDGET);
+    return ok;
+}
+
+// 60 iterations of four cheap ops per step, one action (the wait) per step
+static void dispatch_benchmark(void)
+{
+    static const uint8_t program[] =
+    {
+        /* 0 */  PATTERN_LOOP(60),
+        /* 2 */      PATTERN_SET(0x5, 128),
+        /* 5 */      PATTERN_JZ(0, 9),
+        /* 9 */      PATTERN_BRANCH_EVENT(0, 13),
+        /* 13 */ PATTERN_NEXT(),
+        /* 14 */ PATTERN_WAIT(1),
+        /* 17 */ PATTERN_JUMP(0),
+    };
+    static pattern_vm_t vm;
+    static pattern_vm_action_t action;
+    struct timespec start;
+    struct timespec end;
+
+    pattern_vm_load(&vm, program, sizeof(program));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < BENCH_STEPS; i++)
+    {
+        pattern_vm_step(&vm, &action);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("     dispatch     %u ops in %u steps, %.2f ns/op, %.0f ns/step (host)\n",
+           vm.ops, BENCH_STEPS, ns / vm.ops, ns / BENCH_STEPS);
+}
+
+int main(void)
+{
+    static const uint8_t digits[][PATTERN_VM_CHANNELS] = {{7, 2, 1, 4}, {0, 3, 0, 1}, {1, 1, 1, 1}};
+    bool ok = malformed_check();
+
+    for (size_t i = 0; i < ARRAY_SIZE(digits); i++)
+    {
+        ok &= device_id_check(digits[i], LED_RENDER_MODE_SEQUENTIAL);
+        ok &= device_id_check(digits[i], LED_RENDER_MODE_CONCURRENT);
+    }
+    ok &= shipped_check();
+    ok &= events_check();
+    ok &= interrupt_check();
+    ok &= budget_check();
+    dispatch_benchmark();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
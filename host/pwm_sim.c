@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf_gpio.h"
+#include "nrfx_pwm.h"
+#include "pwm_engine.h"
+#include "fade_tables.h"
+#include "sim.h"
+
+// Plays a fade sequence built from the fade tables through pwm_engine on the
+// PWM register model and checks that every step was fetched, held for the
+// requested time (within half a PWM period) and that the table was followed.
+// The PPI backend drives the pin through GPIOTE instead: its steps are the
+// duty of every PWM period measured on the pin, and every period of a frame
+// must hold the step, up to the frame interrupt that ends the sequence.
+
+#define FRAME_US       6000
+#define PLAYBACK_COUNT 3
+
+static pwm_engine_frame_t m_frames[2 * FADE_TABLE_STEPS];
+static uint16_t const * m_table;
+static uint32_t m_steps_seen;
+static uint32_t m_table_errors;
+static uint16_t m_peak[PWM_ENGINE_CHANNELS];
+static uint64_t m_done_ns;
+static bool m_verbose;
+static int m_channel;
+
+static void step_check(uint16_t const * p_levels)
+{
+    // Steps run through the table forwards then backwards, then the idle report
+    uint32_t index = m_steps_seen % (2 * FADE_TABLE_STEPS);
+    uint16_t expected = index < FADE_TABLE_STEPS ? m_table[index] : m_table[2 * FADE_TABLE_STEPS - 1 - index];
+    if (m_steps_seen < 2 * FADE_TABLE_STEPS * PLAYBACK_COUNT && p_levels[m_channel] != expected)
+    {
+        m_table_errors++;
+    }
+
+    m_steps_seen++;
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (p_levels[i] > m_peak[i])
+        {
+            m_peak[i] = p_levels[i];
+        }
+    }
+}
+
+static void observer(uint8_t instance, uint8_t const * p_pins,
+                     uint16_t const * p_levels, uint16_t top)
+{
+    if (m_verbose)
+    {
+        printf("%12.3f ms  pwm%u:", sim_time_ns() / 1e6, instance);
+        for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+        {
+            printf(" P%u.%02u=%4u/%u", p_pins[i] >> 5, p_pins[i] & 31, p_levels[i], top);
+        }
+        printf("\n");
+    }
+    step_check(p_levels);
+}
+
+#if PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_PPI
+
+#define EDGES_MAX (4 * FADE_TABLE_STEPS * PLAYBACK_COUNT * (FRAME_US / 500 + 1))
+
+typedef struct
+{
+    uint64_t time_ns;
+    uint8_t  level;
+} edge_t;
+
+static uint32_t m_pin;
+static edge_t m_edges[EDGES_MAX];
+static size_t m_edge_count;
+static uint32_t m_period_errors;
+
+static void gpio_observer(uint32_t pin_number, uint32_t value, uint64_t time_ns)
+{
+    if (pin_number == m_pin && m_edge_count < EDGES_MAX)
+    {
+        m_edges[m_edge_count++] = (edge_t){time_ns, (uint8_t)value};
+    }
+}
+
+// Time the pin was low (LED on) in [from, to), the pin starts high. Called
+// for periods in time order.
+static uint64_t low_ns(uint64_t from, uint64_t to)
+{
+    static size_t cursor;
+    uint64_t low = 0;
+
+    while (cursor < m_edge_count && m_edges[cursor].time_ns <= from)
+    {
+        cursor++;
+    }
+    uint8_t level = cursor > 0 ? m_edges[cursor - 1].level : 1;
+
+    uint64_t t = from;
+    for (size_t i = cursor; i < m_edge_count && m_edges[i].time_ns < to; i++)
+    {
+        low += level ? 0 : m_edges[i].time_ns - t;
+        t = m_edges[i].time_ns;
+        level = m_edges[i].level;
+    }
+    return low + (level ? 0 : to - t);
+}
+
+// Steps from the pin, frame by frame from the start of the playback at 0
+static void edges_check(uint16_t length, uint64_t frame_ns, uint64_t period_ns)
+{
+    uint64_t periods = frame_ns / period_ns;
+    uint32_t frames = length * PLAYBACK_COUNT;
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        uint16_t levels[PWM_ENGINE_CHANNELS] = {0};
+
+        for (uint64_t period = 0; period < periods; period++)
+        {
+            uint64_t start = frame * frame_ns + period * period_ns;
+            uint16_t level = (low_ns(start, start + period_ns) * PWM_ENGINE_TOP + period_ns / 2) / period_ns;
+
+            if (period == 0)
+            {
+                levels[m_channel] = level;
+                if (m_verbose)
+                {
+                    printf("%12.3f ms  P%u.%02u=%4u/%u\n", start / 1e6, m_pin >> 5, m_pin & 31,
+                           level, PWM_ENGINE_TOP);
+                }
+            }
+            else if ((frame + 1 < frames || period + 1 < periods) && level != levels[m_channel])
+            {
+                m_period_errors++;
+            }
+        }
+        step_check(levels);
+    }
+}
+
+#endif
+
+static void done_handler(void)
+{
+    m_done_ns = sim_time_ns();
+}
+
+int main(int argc, char ** argv)
+{
+    static const uint32_t pins[PWM_ENGINE_CHANNELS] = {6, 8, 32 + 9, 12};
+    fade_curve_t curve = FADE_CURVE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+        {
+            m_verbose = true;
+        }
+        else if (strncmp(argv[i], "--curve=", 8) == 0)
+        {
+            curve = (fade_curve_t)(atoi(argv[i] + 8) % FADE_CURVE_COUNT);
+        }
+        else
+        {
+            m_channel = atoi(argv[i]) % PWM_ENGINE_CHANNELS;
+        }
+    }
+
+    m_table = fade_table_get(curve, PWM_ENGINE_RESOLUTION_BITS);
+    uint16_t length = 0;
+    for (int step = 0; step < FADE_TABLE_STEPS; step++)
+    {
+        m_frames[length++].level[m_channel] = m_table[step];
+    }
+    for (int step = FADE_TABLE_STEPS - 1; step >= 0; step--)
+    {
+        m_frames[length++].level[m_channel] = m_table[step];
+    }
+
+    sim_reset();
+    host_pwm_observer_set(observer);
+#if PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_PPI
+    m_pin = pins[m_channel];
+    host_gpio_observer_set(gpio_observer);
+#endif
+    pwm_engine_init(pins, done_handler);
+    pwm_engine_play(m_frames, length, FRAME_US, PLAYBACK_COUNT);
+    while (sim_run_next())
+    {
+    }
+
+    uint64_t period_ns = pwm_engine_period_ns();
+    uint64_t frame_ns = pwm_engine_frame_ns(FRAME_US);
+    uint64_t end_ns = frame_ns * length * PLAYBACK_COUNT;
+    uint64_t expected_ns = (uint64_t)length * FRAME_US * 1000 * PLAYBACK_COUNT;
+    bool ok = frame_ns + period_ns / 2 >= FRAME_US * 1000ULL &&
+              frame_ns <= FRAME_US * 1000ULL + period_ns / 2 && !pwm_engine_is_busy();
+
+    printf("pwm: %u bit, %.1f Hz, frame %.3f ms (%llu periods)\n", PWM_ENGINE_RESOLUTION_BITS,
+           1e9 / period_ns, frame_ns / 1e6, (unsigned long long)(frame_ns / period_ns));
+    printf("sequence: %u frames x %u us x %u playbacks on channel %d, curve %d\n",
+           length, FRAME_US, PLAYBACK_COUNT, m_channel, curve);
+    printf("finished: %.3f ms (requested %.3f ms)\n", m_done_ns / 1e6, expected_ns / 1e6);
+
+#if PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_PPI
+    // The handler runs from the frame interrupt in the last period, which
+    // ends the sequence there with the LED off
+    edges_check(length, frame_ns, period_ns);
+    ok &= m_done_ns < end_ns && m_done_ns + period_ns >= end_ns &&
+          nrf_gpio_pin_out_read(m_pin) == 1 && m_period_errors == 0;
+    printf("table mismatches: %u, periods off their frame's step: %u\n", m_table_errors, m_period_errors);
+    printf("edges: %zu, steps observed: %u\n", m_edge_count, m_steps_seen);
+#else
+    uint32_t expected_reads = length * PWM_ENGINE_CHANNELS * PLAYBACK_COUNT;
+    ok &= m_done_ns == end_ns && host_pwm_dma_reads(PWM_ENGINE_INSTANCE) == expected_reads;
+    printf("table mismatches: %u\n", m_table_errors);
+    printf("dma reads: %u values (expected %u), steps observed: %u\n",
+           host_pwm_dma_reads(PWM_ENGINE_INSTANCE), expected_reads, m_steps_seen);
+#endif
+    ok &= m_table_errors == 0 && m_peak[m_channel] == PWM_ENGINE_TOP;
+    printf("peak levels: %u %u %u %u of %u\n",
+           m_peak[0], m_peak[1], m_peak[2], m_peak[3], PWM_ENGINE_TOP);
+    printf("%s\n", ok ? "OK" : "MISMATCH");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "led_render.h"
+#include "pattern_vm.h"
+#include "patterns.h"
+#include "pwm_engine.h"
+#include "sim.h"
+
+// Runs one device_id cycle of the built-in patterns in both render modes on
+// the PWM register model and reports how long each cycle takes in virtual
+// time. A cycle ends with the wait after every LED has shown its digit.
+// Before that, a fade longer than LED_RENDER_FRAMES_MAX frames of FRAME_US
+// has to get longer frames and still end at its last level.
+
+#define FRAME_US 6000
+
+static pwm_engine_frame_t m_frames[LED_RENDER_FRAMES_MAX];
+static bool m_done;
+
+static void done_handler(void)
+{
+    m_done = true;
+}
+
+static uint64_t run_cycle(uint8_t const * p_digits, uint8_t mode, uint32_t * p_sequences)
+{
+    static pattern_vm_t vm;
+    pattern_vm_action_t action;
+    uint8_t blinks[LED_RENDER_CHANNELS] = {0};
+    uint64_t start = sim_time_ns();
+    uint16_t length;
+    uint8_t const * p_code = patterns_device_id(mode, &length);
+
+    for (uint8_t i = 0; i < LED_RENDER_CHANNELS; i++)
+    {
+        pattern_vm_var_set(&vm, PATTERNS_VAR_DIGIT(i), p_digits[i]);
+    }
+    pattern_vm_load(&vm, p_code, length);
+
+    *p_sequences = 0;
+    for (;;)
+    {
+        pattern_vm_step(&vm, &action);
+
+        if (action.type == PATTERN_VM_ACTION_FADE)
+        {
+            led_timeline_t const * timelines[LED_RENDER_CHANNELS];
+            uint32_t frame_us = FRAME_US;
+
+            for (int i = 0; i < LED_RENDER_CHANNELS; i++)
+            {
+                timelines[i] = &action.timelines[i];
+                blinks[i] += (action.lit_mask >> i) & 1;
+            }
+            uint16_t frames = led_render_fill(m_frames, timelines, &frame_us);
+            m_done = false;
+            pwm_engine_play(m_frames, frames, frame_us, 1);
+            while (!m_done && sim_run_next())
+            {
+            }
+            (*p_sequences)++;
+        }
+        else if (action.type == PATTERN_VM_ACTION_WAIT)
+        {
+            sim_run_until(sim_time_ns() + action.duration_ms * 1000000ULL);
+            if (memcmp(blinks, p_digits, sizeof(blinks)) == 0)
+            {
+                break;
+            }
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    return sim_time_ns() - start;
+}
+
+// 2 s from full to off, longer than 256 frames of 6 ms
+static bool long_fade_check(void)
+{
+    static const led_keyframe_t keyframes[] =
+    {
+        {0,    LED_EASING_LINEAR, LED_ANIMATION_FULL},
+        {2000, LED_EASING_LINEAR, 0}
+    };
+    static const led_timeline_t timeline = {keyframes, 2};
+    led_timeline_t const * timelines[LED_RENDER_CHANNELS] = {&timeline};
+    uint32_t frame_us = FRAME_US;
+
+    uint16_t frames = led_render_fill(m_frames, timelines, &frame_us);
+    uint64_t covered_ns = (uint64_t)(frames - 1) * pwm_engine_frame_ns(frame_us);
+    bool pass = frames <= LED_RENDER_FRAMES_MAX && m_frames[frames - 1].level[0] == 0 &&
+                covered_ns >= 2000 * 1000000ULL;
+
+    printf("%s long fade: 2000 ms in %u frames of %.3f ms, ends at level %u\n", pass ? "ok  " : "FAIL",
+           frames, pwm_engine_frame_ns(frame_us) / 1e6, m_frames[frames - 1].level[0]);
+    return pass;
+}
+
+int main(int argc, char ** argv)
+{
+    static const uint32_t pins[PWM_ENGINE_CHANNELS] = {6, 8, 32 + 9, 12};
+    uint8_t digits[LED_RENDER_CHANNELS] = {7, 2, 1, 4};
+    static const char * const names[] = {"sequential", "concurrent"};
+
+    for (int i = 1; i < argc && i <= LED_RENDER_CHANNELS; i++)
+    {
+        digits[i - 1] = (uint8_t)atoi(argv[i]);
+    }
+
+    sim_reset();
+    pwm_engine_init(pins, done_handler);
+
+    if (!long_fade_check())
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("device_id %u %u %u %u\n", digits[0], digits[1], digits[2], digits[3]);
+    for (uint8_t mode = LED_RENDER_MODE_SEQUENTIAL; mode <= LED_RENDER_MODE_CONCURRENT; mode++)
+    {
+        uint32_t sequences;
+        uint64_t cycle_ns = run_cycle(digits, mode, &sequences);
+        if (cycle_ns == 0)
+        {
+            printf("FAIL: %s pattern stopped\n", names[mode]);
+            return EXIT_FAILURE;
+        }
+        printf("%-10s: cycle %9.3f ms, %u PWM sequences (CPU wake-ups)\n",
+               names[mode], cycle_ns / 1e6, sequences);
+    }
+
+    return EXIT_SUCCESS;
+}
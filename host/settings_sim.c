@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf_fstorage.h"
+#include "settings.h"
+#include "sim.h"
+
+// Checks the flash settings store (settings.h) on the NOR flash model of
+// nrf_fstorage_host.c, rebooting by running settings_init() again on the
+// image left by the previous run:
+//  - blank flash gives the defaults, with no write,
+//  - a burst of changes applies each one at once and writes one record,
+//    SETTINGS_WRITE_DELAY_MS after the last, none from settings_update(),
+//  - after a reboot the settings are read in place from flash, with a few
+//    probes and no scan,
+//  - the pages are used in turn and wear evenly,
+//  - power lost at every word operation of a write, over a page switch,
+//    leaves the settings before or after that write, and the store keeps
+//    working after the reboot. No bit is ever programmed over a 0.
+
+#define PAGE_SLOTS      128
+#define PROBES_MAX      (SETTINGS_FLASH_PAGES + 7 + 1)
+
+static const settings_t m_defaults =
+{
+    .digits       = {7, 2, 1, 4},
+    .brightness   = 255,
+    .blinking     = 0,
+    .speed        = 100,
+    .click_gap_ms = 300
+};
+
+static uint32_t m_applied;
+static settings_t m_last_applied;
+
+static void settings_handler(settings_t const * p_settings)
+{
+    m_applied++;
+    m_last_applied = *p_settings;
+}
+
+// Settings told apart by one number
+static settings_t settings_of(uint32_t n)
+{
+    settings_t settings = m_defaults;
+
+    settings.click_gap_ms = (uint16_t)n;
+    settings.brightness = (uint8_t)(n * 7);
+    settings.digits[0] = n % 10;
+    return settings;
+}
+
+static void reboot(void)
+{
+    sim_reset();
+    host_flash_power_on();
+    m_applied = 0;
+    settings_init(&m_defaults, settings_handler);
+}
+
+// The main loop for ms of virtual time
+static void run_ms(uint32_t ms)
+{
+    uint64_t end = sim_time_ns() + (uint64_t)ms * 1000000;
+    uint64_t next;
+
+    while (sim_next_time(&next) && next <= end)
+    {
+        sim_run_next();
+        settings_process();
+    }
+    sim_run_until(end);
+    settings_process();
+}
+
+static bool write_now(uint32_t n)
+{
+    settings_t settings = settings_of(n);
+
+    settings_update(&settings);
+    settings_flush();
+    return !host_flash_power_lost();
+}
+
+static bool blank_check(void)
+{
+    settings_info_t info;
+    host_flash_stats_t stats;
+
+    host_flash_blank();
+    reboot();
+    run_ms(5000);
+    settings_info_get(&info);
+    host_flash_stats_get(&stats);
+
+    bool pass = memcmp(settings_get(), &m_defaults, sizeof(settings_t)) == 0 &&
+                info.sequence == 0 && stats.ops == 0 && m_applied == 0;
+    printf("%s blank       defaults, %u probes, %u flash ops\n", pass ? "ok  " : "FAIL",
+           info.probes, stats.ops);
+    return pass;
+}
+
+static bool batch_check(void)
+{
+    settings_info_t info;
+    host_flash_stats_t stats;
+    uint32_t ops_in_updates = 0;
+    bool before = true;
+
+    host_flash_blank();
+    reboot();
+
+    // Five changes 500 ms apart: one write, the delay after the last
+    for (uint32_t n = 1; n <= 5; n++)
+    {
+        settings_t settings = settings_of(n);
+        host_flash_stats_get(&stats);
+        uint32_t ops = stats.ops;
+
+        settings_update(&settings);
+        host_flash_stats_get(&stats);
+        ops_in_updates += stats.ops - ops;
+        before &= m_applied == n && m_last_applied.click_gap_ms == n && settings_get()->click_gap_ms == n;
+        run_ms(500);
+    }
+    run_ms(SETTINGS_WRITE_DELAY_MS - 500 - 10);
+    settings_info_get(&info);
+    before &= info.writes == 0 && info.pending;
+
+    run_ms(20);
+    settings_info_get(&info);
+    host_flash_stats_get(&stats);
+    bool written = info.writes == 1 && info.erases == 1 && !info.pending &&
+                   host_flash_contains(settings_get());
+
+    // The same settings again change nothing
+    settings_t same = settings_of(5);
+    settings_update(&same);
+    run_ms(SETTINGS_WRITE_DELAY_MS * 2);
+    settings_info_get(&info);
+    written &= info.writes == 1 && m_applied == 5;
+    uint32_t writes = info.writes;
+
+    reboot();
+    settings_info_get(&info);
+    bool loaded = settings_get()->click_gap_ms == 5 && host_flash_contains(settings_get()) &&
+                  info.sequence == 1 && info.probes <= PROBES_MAX;
+
+    bool pass = before && written && loaded && ops_in_updates == 0;
+    printf("%s batch       5 changes, %u write, %u ops in settings_update(), reboot: %u probes%s%s%s\n",
+           pass ? "ok  " : "FAIL", writes, ops_in_updates, info.probes,
+           before ? "" : ", written early", written ? "" : ", not written once", loaded ? "" : ", not loaded");
+    return pass;
+}
+
+static bool wear_check(void)
+{
+    const uint32_t writes = 10 * PAGE_SLOTS * SETTINGS_FLASH_PAGES + 37;
+    host_flash_stats_t stats;
+    settings_info_t info;
+    uint32_t probes_max = 0;
+    bool loaded = true;
+
+    host_flash_blank();
+    reboot();
+    for (uint32_t n = 1; n <= writes; n++)
+    {
+        write_now(n);
+        // Reboot now and then, at every position in the pages
+        if (n % 61 == 0)
+        {
+            reboot();
+            settings_info_get(&info);
+            loaded &= settings_get()->click_gap_ms == (uint16_t)n && host_flash_contains(settings_get());
+            probes_max = info.probes > probes_max ? info.probes : probes_max;
+        }
+    }
+    reboot();
+    settings_info_get(&info);
+    loaded &= settings_get()->click_gap_ms == (uint16_t)writes && info.sequence == writes;
+    host_flash_stats_get(&stats);
+
+    uint32_t erases_min = UINT32_MAX;
+    uint32_t erases_max = 0;
+    uint32_t erases = 0;
+    for (uint32_t page = 0; page < SETTINGS_FLASH_PAGES; page++)
+    {
+        erases_min = stats.erases[page] < erases_min ? stats.erases[page] : erases_min;
+        erases_max = stats.erases[page] > erases_max ? stats.erases[page] : erases_max;
+        erases += stats.erases[page];
+    }
+    uint32_t erases_expected = (writes + PAGE_SLOTS - 1) / PAGE_SLOTS;
+
+    bool pass = loaded && erases_max - erases_min <= 1 && erases == erases_expected &&
+                stats.overwrites == 0 && probes_max <= PROBES_MAX;
+    printf("%s wear        %u writes, erases per page %u..%u, %u probes max, %u overwrites\n",
+           pass ? "ok  " : "FAIL", writes, erases_min, erases_max, probes_max, stats.overwrites);
+    return pass;
+}
+
+// Page 0 one record short of full, then three writes: the last record of
+// page 0, the switch to page 1 (erase and first record), one more. Power is
+// lost at every word operation of them in turn.
+static bool power_loss_check(void)
+{
+    host_flash_stats_t stats;
+    uint32_t cuts = 0;
+    uint32_t kept_old = 0;
+    uint32_t got_new = 0;
+    uint32_t overwrites = 0;
+    bool pass = true;
+
+    for (uint32_t op = 1; ; op++)
+    {
+        uint32_t committed = PAGE_SLOTS - 1;
+        uint32_t in_flight = 0;
+
+        host_flash_blank();
+        reboot();
+        for (uint32_t n = 1; n <= committed; n++)
+        {
+            write_now(n);
+        }
+
+        host_flash_power_loss_at(op);
+        for (uint32_t n = PAGE_SLOTS; n < PAGE_SLOTS + 3; n++)
+        {
+            if (!write_now(n))
+            {
+                in_flight = n;
+                break;
+            }
+            committed = n;
+        }
+        if (in_flight == 0)
+        {
+            break;
+        }
+        cuts++;
+
+        // Before or after the write the power failed in
+        reboot();
+        uint32_t loaded = settings_get()->click_gap_ms;
+        bool ok = loaded == committed || loaded == in_flight;
+        kept_old += loaded == committed;
+        got_new += loaded == in_flight;
+
+        // And it goes on from there
+        for (uint32_t n = 1000; n < 1000 + PAGE_SLOTS + 2; n++)
+        {
+            write_now(n);
+        }
+        reboot();
+        ok &= settings_get()->click_gap_ms == 1000 + PAGE_SLOTS + 1;
+
+        host_flash_stats_get(&stats);
+        overwrites += stats.overwrites;
+        if (!ok)
+        {
+            printf("FAIL power loss at op %u: loaded %u, expected %u or %u\n", op, loaded, committed, in_flight);
+            pass = false;
+        }
+    }
+
+    pass &= cuts > HOST_FLASH_PAGE_SIZE / 4 && overwrites == 0 && kept_old > 0 && got_new > 0;
+    printf("%s power loss  %u cuts, %u kept the old settings, %u the new, %u overwrites\n",
+           pass ? "ok  " : "FAIL", cuts, kept_old, got_new, overwrites);
+    return pass;
+}
+
+int main(void)
+{
+    bool ok = blank_check();
+
+    ok &= batch_check();
+    ok &= wear_check();
+    ok &= power_loss_check();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
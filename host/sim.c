@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_MAX_EVENTS 128
+
+typedef struct
+{
+    uint64_t      time_ns;
+    uint64_t      seq;
+    sim_handler_t handler;
+    void *        p_context;
+} sim_event_t;
+
+// Pending events sorted by (time_ns, seq), the next one is last
+static sim_event_t m_events[SIM_MAX_EVENTS];
+static int m_count;
+static uint64_t m_now_ns;
+static uint64_t m_seq;
+
+static bool sim_event_before(sim_event_t const * p_a, sim_event_t const * p_b)
+{
+    return p_a->time_ns < p_b->time_ns ||
+           (p_a->time_ns == p_b->time_ns && p_a->seq < p_b->seq);
+}
+
+void sim_reset(void)
+{
+    m_count = 0;
+    m_now_ns = 0;
+    m_seq = 0;
+}
+
+uint64_t sim_time_ns(void)
+{
+    return m_now_ns;
+}
+
+bool sim_schedule(uint64_t time_ns, sim_handler_t handler, void * p_context)
+{
+    if (m_count == SIM_MAX_EVENTS)
+    {
+        fprintf(stderr, "sim: event queue full\n");
+        abort();
+    }
+
+    sim_event_t event =
+    {
+        .time_ns   = time_ns < m_now_ns ? m_now_ns : time_ns,
+        .seq       = m_seq++,
+        .handler   = handler,
+        .p_context = p_context
+    };
+
+    int i = m_count;
+    while (i > 0 && sim_event_before(&m_events[i - 1], &event))
+    {
+        m_events[i] = m_events[i - 1];
+        i--;
+    }
+    m_events[i] = event;
+    m_count++;
+
+    return true;
+}
+
+void sim_cancel(sim_handler_t handler, void * p_context)
+{
+    int kept = 0;
+    for (int i = 0; i < m_count; i++)
+    {
+        if (m_events[i].handler != handler || m_events[i].p_context != p_context)
+        {
+            m_events[kept++] = m_events[i];
+        }
+    }
+    m_count = kept;
+}
+
+bool sim_next_time(uint64_t * p_time_ns)
+{
+    if (m_count == 0)
+    {
+        return false;
+    }
+
+    *p_time_ns = m_events[m_count - 1].time_ns;
+    return true;
+}
+
+bool sim_run_next(void)
+{
+    if (m_count == 0)
+    {
+        return false;
+    }
+
+    sim_event_t event = m_events[--m_count];
+    m_now_ns = event.time_ns;
+    event.handler(event.p_context);
+
+    return true;
+}
+
+void sim_run_until(uint64_t time_ns)
+{
+    while (m_count > 0 && m_events[m_count - 1].time_ns <= time_ns)
+    {
+        sim_run_next();
+    }
+    if (m_now_ns < time_ns)
+    {
+        m_now_ns = time_ns;
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Discrete-event virtual time for the host build, all times in nanoseconds
+
+typedef void (*sim_handler_t)(void * p_context);
+
+void sim_reset(void);
+
+uint64_t sim_time_ns(void);
+
+// Queue handler(p_context) at time_ns, events at the same time run in FIFO order
+bool sim_schedule(uint64_t time_ns, sim_handler_t handler, void * p_context);
+
+// Remove every pending event with this handler and context
+void sim_cancel(sim_handler_t handler, void * p_context);
+
+// Time of the next pending event, false if nothing is pending
+bool sim_next_time(uint64_t * p_time_ns);
+
+// Advance time to the next pending event and run it, false if nothing is pending
+bool sim_run_next(void);
+
+// Run all events up to time_ns and leave the clock at time_ns
+void sim_run_until(uint64_t time_ns);
+
+#endif
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf_gpio.h"
+#include "nrfx_pwm.h"
+#include "pwm_engine.h"
+#include "led_stream.h"
+#include "sim.h"
+
+// Checks host LED streaming (led_stream.h) on the PWM model. Frames arrive as
+// virtual-time events, with arrival jitter, and every frame has levels of its
+// own so the PWM observer sees when each one is presented. The PWM interrupt
+// runs IRQ_LATENCY_NS after its event, as behind a USB interrupt:
+//  - frame k must start exactly latency + k frame periods after the arrival
+//    of frame 0, whatever the jitter, as long as the jitter is below the latency
+//    less the LOAD_AHEAD_FRAMES the engine takes a frame before it plays it,
+//  - a stall longer than that gives late frames and as many underruns,
+//    frames not sent give underruns only, a frame too far ahead is early,
+//  - frames sent at the reported period for ten minutes, open loop, are all
+//    presented on time: the engine keeps its clock whatever the interrupt
+//    latency, nothing is early, late or missing,
+//  - a stream the host abandons ends after LED_STREAM_TIMEOUT_FRAMES slots,
+//    with the LEDs off and the engine handed back.
+
+#define FRAME_IDS         2000      // frames told apart by their levels, in a row
+#define LOAD_AHEAD_FRAMES 2         // SEQEND comes as a buffer is taken
+#define IRQ_LATENCY_NS    300000ULL
+
+typedef struct
+{
+    char const * p_name;
+    uint32_t     frames;
+    uint32_t     jitter_frames;     // arrival delay up to this, in frame periods
+    uint32_t     stall_from;        // frames delayed by stall_frames
+    uint32_t     stall_count;
+    uint32_t     stall_frames;
+    uint32_t     drop_from;         // frames not sent
+    uint32_t     drop_count;
+    uint32_t     early_at;          // a frame far ahead sent with this one, 0: none
+    bool         abandon;           // no stop after the last frame
+    // Expected
+    uint32_t     underruns;
+    uint32_t     late;
+    uint32_t     early;
+} scenario_t;
+
+#define JITTER_MAX (LED_STREAM_LATENCY_FRAMES - LOAD_AHEAD_FRAMES)
+
+static const scenario_t m_scenarios[] =
+{
+    {"steady",  2000,   JITTER_MAX, 0, 0, 0,   0, 0, 0,   false, 0,  0,  0},
+    // The three frames after the stalled ones queue up behind them and are late too
+    {"stall",   1000,   0, 500, 10, LED_STREAM_LATENCY_FRAMES + 2, 0, 0, 0,   false, 13, 13, 0},
+    {"drops",   1000,   1, 0, 0, 0,   300, 3, 0,   false, 3,  0,  0},
+    {"early",   1000,   1, 0, 0, 0,   0, 0, 100,   false, 0,  0,  1},
+    {"long",    600000, 1, 0, 0, 0,   0, 0, 0,     false, 0,  0,  0},
+    {"abandon", 100,    1, 0, 0, 0,   0, 0, 0,     true,  LED_STREAM_TIMEOUT_FRAMES, 0, 0},
+};
+
+static uint16_t m_levels[PWM_ENGINE_CHANNELS];
+static bool m_streaming;
+static uint32_t m_frame_ns;
+static scenario_t const * m_p_scenario;
+
+// Presentations seen by the observer
+static uint64_t m_first_ns;
+static uint32_t m_last_id;
+static uint32_t m_last_k;
+static uint32_t m_presented;
+static uint32_t m_wrong;
+
+// Arrivals, one event at a time so frames arrive in order
+static uint64_t m_start_ns;
+static uint64_t m_previous_ns;
+static uint32_t m_arrival_k;
+static led_stream_stats_t m_stats;
+
+// Levels of frame k, distinct for every k % FRAME_IDS after scaling to PWM_ENGINE_TOP
+static void frame_levels(uint32_t k, uint16_t * p_levels)
+{
+    uint32_t id = k % FRAME_IDS;
+
+    p_levels[0] = (uint16_t)((id % 1000 + 1) * 65);
+    p_levels[1] = (uint16_t)((id / 1000 + 1) * 65);
+    p_levels[2] = LED_STREAM_LEVEL_FULL;
+    p_levels[3] = 0;
+}
+
+static uint16_t scaled(uint16_t level)
+{
+    return ((uint32_t)level * PWM_ENGINE_TOP + LED_STREAM_LEVEL_FULL / 2) / LED_STREAM_LEVEL_FULL;
+}
+
+// Back from the PWM values to the frame id, FRAME_IDS if none
+static uint32_t frame_id(uint16_t const * p_levels)
+{
+    for (uint32_t id0 = 0; id0 < 1000 && p_levels[0] != 0; id0++)
+    {
+        if (p_levels[0] == scaled((id0 + 1) * 65))
+        {
+            for (uint32_t thousands = 0; thousands * 1000 + id0 < FRAME_IDS; thousands++)
+            {
+                if (p_levels[1] == scaled((thousands + 1) * 65))
+                {
+                    return thousands * 1000 + id0;
+                }
+            }
+        }
+    }
+    return FRAME_IDS;
+}
+
+// A frame with another id than the last one starts a presentation. Far fewer
+// than FRAME_IDS frames go missing in a row, so its number is the next one
+// after the last with that id.
+static void pwm_observer(uint8_t instance, uint8_t const * p_pins,
+                         uint16_t const * p_levels, uint16_t top)
+{
+    uint32_t id = frame_id(p_levels);
+
+    memcpy(m_levels, p_levels, sizeof(m_levels));
+    if (id == FRAME_IDS || id == m_last_id)
+    {
+        return;
+    }
+
+    uint32_t k = m_last_id == FRAME_IDS ? id : m_last_k + (id + FRAME_IDS - m_last_id) % FRAME_IDS;
+    m_presented++;
+    m_wrong += sim_time_ns() != m_first_ns + (uint64_t)(LED_STREAM_LATENCY_FRAMES + k) * m_frame_ns;
+    m_last_id = id;
+    m_last_k = k;
+}
+
+static void streaming_handler(bool streaming)
+{
+    m_streaming = streaming;
+}
+
+// The firmware main loop, as often as it would wake up for the PWM interrupt
+static void main_loop(void * p_context)
+{
+    led_stream_process();
+    if (led_stream_is_running())
+    {
+        sim_schedule(sim_time_ns() + m_frame_ns, main_loop, NULL);
+    }
+}
+
+// Linear congruential, reproducible across hosts
+static uint32_t random_next(void)
+{
+    static uint32_t state = 4711;
+
+    state = state * 1103515245UL + 12345UL;
+    return state >> 16;
+}
+
+static void arrival(void * p_context);
+
+// The host paces its frames to the reported period, each late by up to the
+// jitter but not before the one sent ahead of it. Schedules the next frame
+// that is sent, if any.
+static void arrival_schedule(void)
+{
+    scenario_t const * p_scenario = m_p_scenario;
+
+    for (uint32_t k = m_arrival_k; k < p_scenario->frames; k++)
+    {
+        uint64_t at = m_start_ns + (uint64_t)k * m_frame_ns;
+
+        if (p_scenario->jitter_frames != 0)
+        {
+            at += random_next() % (p_scenario->jitter_frames * m_frame_ns);
+        }
+        if (k >= p_scenario->stall_from && k < p_scenario->stall_from + p_scenario->stall_count)
+        {
+            at += (uint64_t)p_scenario->stall_frames * m_frame_ns;
+        }
+        if (k >= p_scenario->drop_from && k < p_scenario->drop_from + p_scenario->drop_count)
+        {
+            continue;
+        }
+        at = at < m_previous_ns ? m_previous_ns : at;
+        m_previous_ns = at;
+        m_arrival_k = k;
+        sim_schedule(at, arrival, NULL);
+        return;
+    }
+    m_arrival_k = p_scenario->frames;
+}
+
+static void arrival(void * p_context)
+{
+    uint32_t k = m_arrival_k++;
+    uint16_t levels[PWM_ENGINE_CHANNELS];
+
+    if (k == 0)
+    {
+        m_first_ns = sim_time_ns();
+    }
+    frame_levels(k, levels);
+    led_stream_put((uint16_t)k, levels);
+
+    if (m_p_scenario->early_at != 0 && k == m_p_scenario->early_at)
+    {
+        led_stream_put((uint16_t)(k + LED_STREAM_DEPTH + LED_STREAM_LATENCY_FRAMES), levels);
+    }
+    arrival_schedule();
+}
+
+// Just before the slot after the last frame is filled, the following ones
+// would be underruns
+static void stats_take(void * p_context)
+{
+    led_stream_stats_get(&m_stats);
+}
+
+static bool scenario_run(scenario_t const * p_scenario)
+{
+    static const uint32_t pins[PWM_ENGINE_CHANNELS] =
+    {
+        NRF_GPIO_PIN_MAP(0,6), NRF_GPIO_PIN_MAP(0,8), NRF_GPIO_PIN_MAP(1,9), NRF_GPIO_PIN_MAP(0,12)
+    };
+    led_stream_stats_t stats;
+
+    m_p_scenario = p_scenario;
+    sim_reset();
+    host_pwm_observer_set(pwm_observer);
+    pwm_engine_init(pins, NULL);
+    host_pwm_irq_latency_set(PWM_ENGINE_INSTANCE, IRQ_LATENCY_NS);
+    led_stream_init(streaming_handler);
+    led_stream_start(LED_STREAM_FRAME_US);
+    led_stream_stats_get(&stats);
+    m_frame_ns = stats.frame_ns;
+
+    m_start_ns = 1000000;
+    m_previous_ns = 0;
+    m_arrival_k = 0;
+    m_last_id = FRAME_IDS;
+    m_presented = 0;
+    m_wrong = 0;
+    arrival_schedule();
+    sim_schedule(m_start_ns, main_loop, NULL);
+
+    // Frame 0 sets the timeline
+    sim_run_until(m_start_ns + (uint64_t)p_scenario->jitter_frames * m_frame_ns);
+    uint64_t last_ns = m_first_ns + (uint64_t)(LED_STREAM_LATENCY_FRAMES + p_scenario->frames - 1) * m_frame_ns;
+    sim_schedule(last_ns - (LOAD_AHEAD_FRAMES - 1) * (uint64_t)m_frame_ns - 1, stats_take, NULL);
+
+    // Up to the end of the last slot
+    uint64_t end_ns = last_ns + m_frame_ns - 1;
+    if (p_scenario->abandon)
+    {
+        end_ns += (uint64_t)(LED_STREAM_TIMEOUT_FRAMES + 2) * m_frame_ns;
+    }
+    sim_run_until(end_ns);
+
+    if (p_scenario->abandon)
+    {
+        led_stream_stats_get(&m_stats);
+    }
+    else
+    {
+        led_stream_stop();
+    }
+    // The STOPPED interrupt, before the next scenario resets the simulator
+    sim_run_until(sim_time_ns() + IRQ_LATENCY_NS);
+
+    // Every frame presented at its fixed time, all others missing
+    uint32_t missing = p_scenario->abandon ? 0 : p_scenario->underruns;
+    bool pass = m_wrong == 0 && m_presented == p_scenario->frames - missing &&
+                m_stats.presented == m_presented && m_stats.underruns == p_scenario->underruns &&
+                m_stats.late == p_scenario->late && m_stats.early == p_scenario->early;
+    if (p_scenario->abandon)
+    {
+        pass &= !m_stats.running && !m_streaming && !pwm_engine_is_busy() &&
+                m_levels[0] == 0 && m_levels[1] == 0 && m_levels[2] == 0 && m_levels[3] == 0;
+    }
+    else
+    {
+        pass &= !m_streaming && !pwm_engine_is_busy();
+    }
+
+    printf("%s %-8s %6u frames: %u presented (%u at the wrong time), %u underruns, %u late, %u early%s\n",
+           pass ? "ok  " : "FAIL", p_scenario->p_name, p_scenario->frames, m_stats.presented, m_wrong,
+           m_stats.underruns, m_stats.late, m_stats.early, m_stats.running ? "" : ", ended");
+    return pass;
+}
+
+int main(void)
+{
+    bool ok = true;
+    led_stream_stats_t stats;
+
+    for (size_t i = 0; i < sizeof(m_scenarios) / sizeof(m_scenarios[0]); i++)
+    {
+        ok &= scenario_run(&m_scenarios[i]);
+    }
+
+    led_stream_stats_get(&stats);
+    printf("frame %.3f us, latency %.3f us, %u frames buffered, interrupt latency %.3f us\n",
+           stats.frame_ns / 1000.0, stats.latency_ns / 1000.0, LED_STREAM_DEPTH, IRQ_LATENCY_NS / 1000.0);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrfx_pwm.h"
+#include "nrf_gpio.h"
+#include "pwm_engine.h"
+#include "gesture.h"
+#include "trace.h"
+#include "sim.h"
+#include "button_script.h"
+
+// Runs the firmware with a double click on and one off, and drains the trace
+// buffer every few milliseconds like the USB link would. Checks that nothing
+// was dropped, that every blink the PWM model played has its BLINK_BEGIN/END
+// pair at the right time, and writes the raw records for trace_decode.py.
+
+#define BUTTON_PIN   NRF_GPIO_PIN_MAP(1,6)
+#define MS           1000000ULL
+#define S            1000000000ULL
+#define DRAIN_NS     (5 * MS)
+#define MAX_RECORDS  100000
+
+int firmware_main(void);
+
+static trace_record_t m_records[MAX_RECORDS];
+static uint32_t m_count;
+static uint32_t m_pwm_starts;
+static uint16_t m_levels[PWM_ENGINE_CHANNELS];
+
+// A blink is any channel leaving level 0
+static void pwm_observer(uint8_t instance, uint8_t const * p_pins,
+                         uint16_t const * p_levels, uint16_t top)
+{
+    bool was_dark = true;
+    bool dark = true;
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        was_dark &= m_levels[i] == 0;
+        dark &= p_levels[i] == 0;
+        m_levels[i] = p_levels[i];
+    }
+    m_pwm_starts += was_dark && !dark;
+}
+
+static void drain(void)
+{
+    while (m_count < MAX_RECORDS && trace_get(&m_records[m_count]))
+    {
+        m_count++;
+    }
+}
+
+static uint32_t count_of(trace_id_t id, uint16_t arg0)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        count += m_records[i].id == id && m_records[i].arg0 == arg0;
+    }
+    return count;
+}
+
+int main(int argc, char ** argv)
+{
+    uint64_t seconds = argc > 1 ? strtoull(argv[1], NULL, 10) : 60;
+    char const * p_path = argc > 2 ? argv[2] : NULL;
+    uint64_t end_ns = seconds * S;
+    bool ok = true;
+
+    if (seconds < 10)
+    {
+        fprintf(stderr, "usage: trace_sim [seconds >= 10] [records.bin]\n");
+        return 2;
+    }
+
+    sim_reset();
+    host_pwm_observer_set(pwm_observer);
+    host_gpio_input_set(BUTTON_PIN, 1);
+    button_script_double_click(BUTTON_PIN, 1 * S);
+    button_script_double_click(BUTTON_PIN, end_ns - 5 * S);
+
+    host_cpu_run(firmware_main, DRAIN_NS);
+    for (uint64_t t = 2 * DRAIN_NS; t <= end_ns; t += DRAIN_NS)
+    {
+        drain();
+        host_cpu_resume(t);
+    }
+    drain();
+
+    // Nested interrupts may swap neighbours, never by more than one ISR
+    uint32_t out_of_order = 0;
+    for (uint32_t i = 1; i < m_count; i++)
+    {
+        if (m_records[i].timestamp + 1000 < m_records[i - 1].timestamp)
+        {
+            out_of_order++;
+        }
+    }
+
+    uint32_t blinks = count_of(TRACE_BLINK_BEGIN, 0);
+    printf("%u records (%zu bytes) in %llu s, %u dropped, %u button IRQs, %u gestures, "
+           "%u blinks (PWM model %u), %u pauses\n",
+           m_count, m_count * sizeof(trace_record_t), (unsigned long long)seconds,
+           trace_dropped(), count_of(TRACE_BUTTON_IRQ, 0) + count_of(TRACE_BUTTON_IRQ, 1),
+           count_of(TRACE_GESTURE, GESTURE_DOUBLE_CLICK), blinks, m_pwm_starts,
+           count_of(TRACE_PAUSE_BEGIN, 0));
+
+    if (trace_dropped() != 0 || m_count == MAX_RECORDS)
+    {
+        printf("FAIL: records lost\n");
+        ok = false;
+    }
+    if (count_of(TRACE_GESTURE, GESTURE_DOUBLE_CLICK) != 2)
+    {
+        printf("FAIL: expected two double clicks\n");
+        ok = false;
+    }
+    if (blinks == 0 || blinks != m_pwm_starts || blinks != count_of(TRACE_BLINK_END, 0) ||
+        count_of(TRACE_PAUSE_BEGIN, 0) != count_of(TRACE_PAUSE_END, 0))
+    {
+        printf("FAIL: BEGIN/END records do not match the blinks played\n");
+        ok = false;
+    }
+    if (count_of(TRACE_EVENT_BEGIN, 0) != count_of(TRACE_EVENT_END, 0) || out_of_order != 0)
+    {
+        printf("FAIL: %u records out of order\n", out_of_order);
+        ok = false;
+    }
+
+    if (p_path != NULL)
+    {
+        FILE * p_file = fopen(p_path, "wb");
+        if (p_file == NULL || fwrite(m_records, sizeof(trace_record_t), m_count, p_file) != m_count)
+        {
+            perror(p_path);
+            ok = false;
+        }
+        if (p_file != NULL)
+        {
+            fclose(p_file);
+        }
+    }
+
+    return ok ? 0 : 1;
+}
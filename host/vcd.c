@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include "vcd.h"
+
+typedef struct
+{
+    char    name[32];
+    uint8_t value;
+} vcd_signal_t;
+
+static FILE * mp_file;
+static char m_scope[32];
+static vcd_signal_t m_signals[VCD_MAX_SIGNALS];
+static int m_count;
+static bool m_header_done;
+static uint64_t m_time_ns;
+
+// Identifiers are printable characters starting at '!'
+static char id_of(int signal)
+{
+    return (char)('!' + signal);
+}
+
+static void header_write(void)
+{
+    fprintf(mp_file, "$timescale 1ns $end\n");
+    fprintf(mp_file, "$scope module %s $end\n", m_scope);
+    for (int i = 0; i < m_count; i++)
+    {
+        fprintf(mp_file, "$var wire 1 %c %s $end\n", id_of(i), m_signals[i].name);
+    }
+    fprintf(mp_file, "$upscope $end\n$enddefinitions $end\n");
+
+    fprintf(mp_file, "#0\n$dumpvars\n");
+    for (int i = 0; i < m_count; i++)
+    {
+        fprintf(mp_file, "%u%c\n", m_signals[i].value, id_of(i));
+    }
+    fprintf(mp_file, "$end\n");
+
+    m_header_done = true;
+    m_time_ns = 0;
+}
+
+bool vcd_open(char const * p_path, char const * p_scope)
+{
+    mp_file = fopen(p_path, "w");
+    if (mp_file == NULL)
+    {
+        return false;
+    }
+
+    snprintf(m_scope, sizeof(m_scope), "%s", p_scope);
+    m_count = 0;
+    m_header_done = false;
+    return true;
+}
+
+int vcd_signal_add(char const * p_name, uint8_t initial)
+{
+    if (mp_file == NULL || m_header_done || m_count == VCD_MAX_SIGNALS)
+    {
+        return -1;
+    }
+
+    snprintf(m_signals[m_count].name, sizeof(m_signals[m_count].name), "%s", p_name);
+    m_signals[m_count].value = initial;
+    return m_count++;
+}
+
+void vcd_change(int signal, uint8_t value, uint64_t time_ns)
+{
+    if (mp_file == NULL || signal < 0 || signal >= m_count || m_signals[signal].value == value)
+    {
+        return;
+    }
+    if (!m_header_done)
+    {
+        header_write();
+    }
+
+    if (time_ns != m_time_ns)
+    {
+        fprintf(mp_file, "#%llu\n", (unsigned long long)time_ns);
+        m_time_ns = time_ns;
+    }
+    fprintf(mp_file, "%u%c\n", value, id_of(signal));
+    m_signals[signal].value = value;
+}
+
+void vcd_close(uint64_t end_ns)
+{
+    if (mp_file == NULL)
+    {
+        return;
+    }
+    if (!m_header_done)
+    {
+        header_write();
+    }
+
+    // Mark the end so the viewer shows the last values up to it
+    if (end_ns > m_time_ns)
+    {
+        fprintf(mp_file, "#%llu\n", (unsigned long long)end_ns);
+    }
+    fclose(mp_file);
+    mp_file = NULL;
+}
@@ -0,0 +1,23 @@
+#ifndef VCD_H
+#define VCD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Value change dump (IEEE 1364) writer for one-bit signals with a 1 ns
+// timescale, readable by GTKWave. Signals are added before the first change,
+// changes must come in time order.
+
+#define VCD_MAX_SIGNALS 16
+
+bool vcd_open(char const * p_path, char const * p_scope);
+
+// Returns the signal index, initial is the value at time 0
+int vcd_signal_add(char const * p_name, uint8_t initial);
+
+// Only writes anything if the value differs from the last one
+void vcd_change(int signal, uint8_t value, uint64_t time_ns);
+
+void vcd_close(uint64_t end_ns);
+
+#endif
@@ -0,0 +1,476 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "nrfx_pwm.h"
+#include "pwm_engine.h"
+#include "blink_sequencer.h"
+#include "led_render.h"
+#include "vcd.h"
+#include "sim.h"
+#include "button_script.h"
+
+// Runs the firmware main() on the host shim, double-clicks blinking on and
+// records every LED pin transition with its nanosecond time into a VCD file.
+// The software backend drives the pins itself, the TIMER + PPI backend
+// through the GPIOTE model; for the PWM peripheral the waveform is expanded
+// from the steps the register model latches. The
+// recorded edges are then checked for:
+//  - PWM frequency: at least PWM_ENGINE_FREQUENCY, at most twice that (the
+//    EasyDMA backend picks the slowest clock that reaches it), no jitter,
+//  - duty: every period within one LSB of a level of the rendered blink
+//    (BLINK_FADE_MS, BLINK_EASING on the FADE_CURVE table),
+//  - fade timing: a level lasts whole BLINK_SEQUENCER_FRAME_US frames, each
+//    within half a PWM period, and a blink lasts as long as the lit frames
+//    of 2 * BLINK_FADE_MS, whatever the PWM frequency.
+
+#define YELLOW_LED_PIN NRF_GPIO_PIN_MAP(0,6)
+#define RED_LED_PIN    NRF_GPIO_PIN_MAP(0,8)
+#define GREEN_LED_PIN  NRF_GPIO_PIN_MAP(1,9)
+#define BLUE_LED_PIN   NRF_GPIO_PIN_MAP(0,12)
+#define BUTTON_PIN     NRF_GPIO_PIN_MAP(1,6)
+
+#define S  1000000000ULL
+#define MS 1000000ULL
+
+// Dark for longer than this ends a blink. Blinks of one LED follow each
+// other with the dark first and last frames in between, inside a blink the
+// LED is dark for less than a PWM period.
+#define BLINK_GAP_NS (BLINK_SEQUENCER_FRAME_US * 1000ULL)
+
+int firmware_main(void);
+
+typedef struct
+{
+    uint64_t time_ns;
+    uint8_t  level;
+} edge_t;
+
+typedef struct
+{
+    char const * name;
+    uint32_t     pin;
+    int          signal;
+    uint8_t      level;
+    edge_t     * p_edges;
+    size_t       count;
+    size_t       size;
+} led_t;
+
+static led_t m_leds[PWM_ENGINE_CHANNELS] =
+{
+    {"yellow", YELLOW_LED_PIN},
+    {"red",    RED_LED_PIN},
+    {"green",  GREEN_LED_PIN},
+    {"blue",   BLUE_LED_PIN},
+};
+
+// Step the PWM model is holding, expanded into edges when the next one starts
+static uint64_t m_step_start_ns;
+static uint16_t m_step_levels[PWM_ENGINE_CHANNELS];
+static uint16_t m_step_top;
+static uint8_t m_step_instance;
+static led_t * mp_step_leds[PWM_ENGINE_CHANNELS];
+
+static bool m_allowed[PWM_ENGINE_TOP + 1];
+
+static led_t * led_of(uint32_t pin)
+{
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (m_leds[i].pin == pin)
+        {
+            return &m_leds[i];
+        }
+    }
+    return NULL;
+}
+
+static void pin_level(led_t * p_led, uint8_t level, uint64_t time_ns)
+{
+    if (p_led->level == level)
+    {
+        return;
+    }
+    p_led->level = level;
+    vcd_change(p_led->signal, level, time_ns);
+
+    if (p_led->count == p_led->size)
+    {
+        p_led->size = p_led->size ? 2 * p_led->size : 4096;
+        p_led->p_edges = realloc(p_led->p_edges, p_led->size * sizeof(edge_t));
+        if (p_led->p_edges == NULL)
+        {
+            abort();
+        }
+    }
+    p_led->p_edges[p_led->count++] = (edge_t){time_ns, level};
+}
+
+static void gpio_observer(uint32_t pin_number, uint32_t value, uint64_t time_ns)
+{
+    led_t * p_led = led_of(pin_number);
+
+    if (p_led != NULL)
+    {
+        pin_level(p_led, (uint8_t)value, time_ns);
+    }
+}
+
+// The held step up to now, period by period. The pins are inverted (LEDs
+// active low): a level of N keeps the output low for the first N counts.
+static void step_expand(uint64_t end_ns)
+{
+    uint64_t period_ns = host_pwm_period_ns(m_step_instance);
+
+    for (uint64_t start = m_step_start_ns; start < end_ns && m_step_top != 0; start += period_ns)
+    {
+        for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+        {
+            if (m_step_levels[i] != 0 && mp_step_leds[i] != NULL)
+            {
+                pin_level(mp_step_leds[i], 0, start);
+            }
+        }
+
+        // Off edges in time order, lowest level first
+        uint16_t done = 0;
+        while (true)
+        {
+            int next = -1;
+            for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+            {
+                if (m_step_levels[i] > done && m_step_levels[i] < m_step_top &&
+                    (next < 0 || m_step_levels[i] < m_step_levels[next]))
+                {
+                    next = i;
+                }
+            }
+            if (next < 0)
+            {
+                break;
+            }
+
+            uint64_t off_ns = start + (m_step_levels[next] * period_ns) / m_step_top;
+            for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+            {
+                if (m_step_levels[i] == m_step_levels[next] && mp_step_leds[i] != NULL)
+                {
+                    pin_level(mp_step_leds[i], 1, off_ns < end_ns ? off_ns : end_ns);
+                }
+            }
+            done = m_step_levels[next];
+        }
+    }
+}
+
+static void pwm_observer(uint8_t instance, uint8_t const * p_pins,
+                         uint16_t const * p_levels, uint16_t top)
+{
+    uint64_t now = sim_time_ns();
+
+    step_expand(now);
+
+    m_step_start_ns = now;
+    m_step_instance = instance;
+    m_step_top = top;
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        mp_step_leds[i] = led_of(p_pins[i]);
+        m_step_levels[i] = p_levels[i];
+        if (p_levels[i] == 0 && mp_step_leds[i] != NULL)
+        {
+            pin_level(mp_step_leds[i], 1, now);
+        }
+    }
+}
+
+typedef struct
+{
+    uint32_t blinks;
+    uint64_t blink_min_ns;
+    uint64_t blink_max_ns;
+    uint64_t period_ns;      // shortest on to on interval
+    uint64_t jitter_ns;      // largest distance of an interval from whole periods
+    uint32_t periods;        // periods with a duty measurement
+    uint32_t duty_errors;    // periods more than one LSB from every table level
+    uint32_t frames;         // complete runs of one level
+    uint32_t frame_errors;
+    uint64_t frame_min_ns;   // per frame, of the runs
+    uint64_t frame_max_ns;
+} analysis_t;
+
+// Runs of one duty inside a blink, the first and last of a blink are cut
+// short by the dark table entries and not checked
+static void run_check(analysis_t * p_result, uint64_t run_ns, bool complete)
+{
+    if (!complete || run_ns == 0)
+    {
+        return;
+    }
+
+    uint64_t frames = (run_ns + BLINK_SEQUENCER_FRAME_US * 500ULL) / (BLINK_SEQUENCER_FRAME_US * 1000ULL);
+    uint64_t expected = frames * BLINK_SEQUENCER_FRAME_US * 1000ULL;
+    uint64_t error = run_ns > expected ? run_ns - expected : expected - run_ns;
+
+    p_result->frames++;
+    if (frames == 0 || error > frames * p_result->period_ns / 2)
+    {
+        p_result->frame_errors++;
+        return;
+    }
+
+    uint64_t per_frame = run_ns / frames;
+    if (p_result->frame_min_ns == 0 || per_frame < p_result->frame_min_ns)
+    {
+        p_result->frame_min_ns = per_frame;
+    }
+    if (per_frame > p_result->frame_max_ns)
+    {
+        p_result->frame_max_ns = per_frame;
+    }
+}
+
+static void led_analyze(led_t const * p_led, uint64_t end_ns, analysis_t * p_result)
+{
+    memset(p_result, 0, sizeof(*p_result));
+
+    // Period: the shortest interval between two on edges of one blink
+    uint64_t last_on = 0;
+    for (size_t i = 0; i < p_led->count; i++)
+    {
+        edge_t const * p_edge = &p_led->p_edges[i];
+        if (p_edge->level != 0)
+        {
+            continue;
+        }
+        if (last_on != 0 && p_edge->time_ns - last_on < BLINK_GAP_NS &&
+            (p_result->period_ns == 0 || p_edge->time_ns - last_on < p_result->period_ns))
+        {
+            p_result->period_ns = p_edge->time_ns - last_on;
+        }
+        last_on = p_edge->time_ns;
+    }
+    if (p_result->period_ns == 0)
+    {
+        return;
+    }
+
+    uint64_t period = p_result->period_ns;
+    uint64_t blink_start = 0;
+    uint64_t last_off = 0;
+    uint64_t on = 0;
+    uint64_t off = 0;
+    int32_t run_duty = -1;
+    uint64_t run_ns = 0;
+    bool run_complete = false;
+
+    for (size_t i = 0; i < p_led->count; i++)
+    {
+        edge_t const * p_edge = &p_led->p_edges[i];
+        uint64_t t = p_edge->time_ns;
+
+        if (p_edge->level != 0)
+        {
+            off = t;
+            last_off = t;
+            continue;
+        }
+
+        if (blink_start == 0 || t - last_off >= BLINK_GAP_NS)
+        {
+            // New blink, close the previous one
+            if (blink_start != 0)
+            {
+                uint64_t length = last_off - blink_start;
+                p_result->blinks++;
+                if (p_result->blink_min_ns == 0 || length < p_result->blink_min_ns)
+                {
+                    p_result->blink_min_ns = length;
+                }
+                if (length > p_result->blink_max_ns)
+                {
+                    p_result->blink_max_ns = length;
+                }
+            }
+            blink_start = t;
+            run_duty = -1;
+            run_ns = 0;
+            run_complete = false;
+            on = t;
+            continue;
+        }
+
+        // One or more whole periods since the last on edge, more if the
+        // level was full or zero in between
+        uint64_t interval = t - on;
+        uint64_t periods = (interval + period / 2) / period;
+        uint64_t distance = interval > periods * period ? interval - periods * period
+                                                        : periods * period - interval;
+        if (distance > p_result->jitter_ns)
+        {
+            p_result->jitter_ns = distance;
+        }
+
+        int32_t duty = -1;
+        if (periods == 1)
+        {
+            duty = (int32_t)(((off - on) * PWM_ENGINE_TOP + period / 2) / period);
+            p_result->periods++;
+            if (!m_allowed[duty] && (duty == 0 || !m_allowed[duty - 1]) &&
+                (duty == PWM_ENGINE_TOP || !m_allowed[duty + 1]))
+            {
+                p_result->duty_errors++;
+            }
+        }
+
+        if (duty != run_duty)
+        {
+            run_check(p_result, run_ns, run_complete);
+            run_complete = run_duty >= 0 && duty >= 0;
+            run_duty = duty;
+            run_ns = 0;
+        }
+        run_ns += interval;
+        on = t;
+    }
+
+    // The last blink unless the end of the run cut it short
+    if (blink_start != 0 && last_off + BLINK_GAP_NS <= end_ns)
+    {
+        uint64_t length = last_off - blink_start;
+        p_result->blinks++;
+        if (p_result->blink_min_ns == 0 || length < p_result->blink_min_ns)
+        {
+            p_result->blink_min_ns = length;
+        }
+        if (length > p_result->blink_max_ns)
+        {
+            p_result->blink_max_ns = length;
+        }
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    uint64_t seconds = argc > 1 ? strtoull(argv[1], NULL, 10) : 30;
+    char const * p_path = argc > 2 ? argv[2] : "leds.vcd";
+    bool ok = true;
+
+    if (seconds < 5)
+    {
+        fprintf(stderr, "usage: wave_sim [seconds >= 5] [file.vcd]\n");
+        return 2;
+    }
+    if (!vcd_open(p_path, "leds"))
+    {
+        fprintf(stderr, "wave_sim: cannot write %s\n", p_path);
+        return 2;
+    }
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        m_leds[i].signal = vcd_signal_add(m_leds[i].name, 1);
+        m_leds[i].level = 1;
+    }
+
+    sim_reset();
+    host_gpio_observer_set(gpio_observer);
+    host_pwm_observer_set(pwm_observer);
+    host_gpio_input_set(BUTTON_PIN, 1);
+    button_script_double_click(BUTTON_PIN, 1 * S);
+
+    host_cpu_run(firmware_main, seconds * S);
+    step_expand(seconds * S);
+    vcd_close(seconds * S);
+
+    // The blink as blink_sequencer renders it, with the PWM engine the firmware set up
+    static const led_keyframe_t blink_keyframes[] =
+    {
+        {0,                 BLINK_EASING,      0},
+        {BLINK_FADE_MS,     BLINK_EASING,      LED_ANIMATION_FULL},
+        {2 * BLINK_FADE_MS, LED_EASING_LINEAR, 0},
+    };
+    static const led_timeline_t blink = {blink_keyframes, 3};
+    static pwm_engine_frame_t frames[LED_RENDER_FRAMES_MAX];
+    led_timeline_t const * timelines[LED_RENDER_CHANNELS] = {&blink};
+    uint32_t frame_us = BLINK_SEQUENCER_FRAME_US;
+    uint16_t length = led_render_fill(frames, timelines, &frame_us);
+    uint64_t frame_ns = pwm_engine_frame_ns(frame_us);
+
+    int first_lit = -1;
+    int last_lit = -1;
+
+    for (int i = 0; i < length; i++)
+    {
+        m_allowed[frames[i].level[0]] = true;
+        if (frames[i].level[0] != 0)
+        {
+            first_lit = first_lit < 0 ? i : first_lit;
+            last_lit = i;
+        }
+    }
+    // Lit frames of a blink. The last one ends with its last pulse, and the
+    // software backend shows no pulse at all for the dimmest levels.
+    uint64_t blink_ns = (uint64_t)(last_lit - first_lit + 1) * frame_ns;
+
+    printf("%s, %llu s: %s\n", PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_SOFT ? "software PWM" :
+                                PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_PPI ? "TIMER + PPI + GPIOTE" : "PWM peripheral",
+           (unsigned long long)seconds, p_path);
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        analysis_t result;
+
+        led_analyze(&m_leds[i], seconds * S, &result);
+        if (result.blinks == 0)
+        {
+            printf("  %-6s no blinks\n", m_leds[i].name);
+            printf("FAIL: %s never blinked\n", m_leds[i].name);
+            ok = false;
+            continue;
+        }
+
+        double frequency = 1e9 / result.period_ns;
+        printf("  %-6s %u blinks %.3f-%.3f s, %.1f Hz jitter %llu ns, duty %u/%u periods ok, "
+               "frames %.3f-%.3f ms %u/%u ok\n",
+               m_leds[i].name, result.blinks, result.blink_min_ns / 1e9, result.blink_max_ns / 1e9,
+               frequency, (unsigned long long)result.jitter_ns,
+               result.periods - result.duty_errors, result.periods,
+               result.frame_min_ns / 1e6, result.frame_max_ns / 1e6,
+               result.frames - result.frame_errors, result.frames);
+
+        if (frequency < PWM_ENGINE_FREQUENCY * 0.999 || frequency >= 2.0 * PWM_ENGINE_FREQUENCY)
+        {
+            printf("FAIL: %s PWM at %.1f Hz, configured %u Hz\n", m_leds[i].name, frequency,
+                   PWM_ENGINE_FREQUENCY);
+            ok = false;
+        }
+        if (result.jitter_ns > 1000)
+        {
+            printf("FAIL: %s PWM period jitter %llu ns\n", m_leds[i].name,
+                   (unsigned long long)result.jitter_ns);
+            ok = false;
+        }
+        if (result.duty_errors != 0)
+        {
+            printf("FAIL: %s duty off the rendered blink in %u periods\n", m_leds[i].name,
+                   result.duty_errors);
+            ok = false;
+        }
+        if (result.blink_min_ns + 3 * frame_ns < blink_ns || result.blink_max_ns > blink_ns)
+        {
+            printf("FAIL: %s blinks not %.3f s long\n", m_leds[i].name, blink_ns / 1e9);
+            ok = false;
+        }
+        if (result.frame_errors != 0)
+        {
+            printf("FAIL: %s levels not held for whole %u us frames %u times\n", m_leds[i].name,
+                   BLINK_SEQUENCER_FRAME_US, result.frame_errors);
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
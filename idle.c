@@ -0,0 +1,63 @@
+#include <string.h>
+#include "idle.h"
+#include "app_timer.h"
+#include "nrf.h"
+
+#define IDLE_WINDOW_TICKS APP_TIMER_TICKS(1000)
+
+static idle_stats_t m_current;
+static idle_stats_t m_last;
+static uint32_t m_window_start;
+
+void idle_init(void)
+{
+    memset(&m_current, 0, sizeof(m_current));
+    memset(&m_last, 0, sizeof(m_last));
+    m_window_start = app_timer_cnt_get();
+}
+
+void idle_wait(void)
+{
+    uint32_t sleep_start = app_timer_cnt_get();
+
+#if (__FPU_USED == 1)
+    // A pending FPU exception keeps the FPU interrupt pending, which would
+    // wake the CPU at once (nRF52 errata 87)
+    __set_FPSCR(__get_FPSCR() & ~(0x0000009F));
+    (void)__get_FPSCR();
+    NVIC_ClearPendingIRQ(FPU_IRQn);
+#endif
+
+    // Sleep, then clear the event register so the next call sleeps again
+    __WFE();
+    __SEV();
+    __WFE();
+
+    uint32_t now = app_timer_cnt_get();
+    m_current.sleep_ticks += app_timer_cnt_diff_compute(now, sleep_start);
+    m_current.wakeups++;
+
+    uint32_t window = app_timer_cnt_diff_compute(now, m_window_start);
+    if (window >= IDLE_WINDOW_TICKS)
+    {
+        m_current.window_ticks = window;
+        m_last = m_current;
+        memset(&m_current, 0, sizeof(m_current));
+        m_window_start = now;
+    }
+}
+
+void idle_stats_get(idle_stats_t * p_stats)
+{
+    *p_stats = m_last;
+}
+
+uint32_t idle_sleep_permille(void)
+{
+    if (m_last.window_ticks == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)m_last.sleep_ticks * 1000) / m_last.window_ticks);
+}
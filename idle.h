@@ -0,0 +1,28 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdint.h>
+
+// Tickless idle: the main loop calls idle_wait() whenever it has no work, the
+// CPU sleeps until the next interrupt (button, PWM sequence end, app_timer
+// deadline). Time spent asleep is measured with the RTC behind app_timer.
+
+typedef struct
+{
+    uint32_t sleep_ticks;   // RTC ticks spent in idle_wait() during the window
+    uint32_t window_ticks;  // length of the window in RTC ticks
+    uint32_t wakeups;       // number of times the CPU woke up during the window
+} idle_stats_t;
+
+void idle_init(void);
+
+// Sleep until an event, returns at once if an interrupt fired since the last call
+void idle_wait(void);
+
+// Statistics of the last complete one-second window
+void idle_stats_get(idle_stats_t * p_stats);
+
+// Share of the last second spent asleep, in 1/1000
+uint32_t idle_sleep_permille(void);
+
+#endif
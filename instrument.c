@@ -0,0 +1,231 @@
+#include <string.h>
+#include "instrument.h"
+
+uint32_t instrument_bucket(uint32_t cycles)
+{
+    if (cycles < INSTRUMENT_SUB_BUCKETS)
+    {
+        return cycles;
+    }
+
+    // Octave from the top bit, sub-bucket from the bits below it
+    uint32_t msb = 31 - __builtin_clz(cycles);
+    uint32_t bucket = (msb - INSTRUMENT_SUB_BUCKET_BITS + 1) * INSTRUMENT_SUB_BUCKETS +
+                      ((cycles >> (msb - INSTRUMENT_SUB_BUCKET_BITS)) & (INSTRUMENT_SUB_BUCKETS - 1));
+
+    return bucket < INSTRUMENT_BUCKETS ? bucket : INSTRUMENT_BUCKETS - 1;
+}
+
+uint32_t instrument_bucket_floor(uint32_t bucket)
+{
+    if (bucket < INSTRUMENT_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    uint32_t octave = bucket / INSTRUMENT_SUB_BUCKETS;
+    uint32_t sub = bucket % INSTRUMENT_SUB_BUCKETS;
+
+    return (INSTRUMENT_SUB_BUCKETS + sub) << (octave - 1);
+}
+
+#if INSTRUMENT_ENABLED
+
+#include "app_util_platform.h"
+#include "usb_link.h"
+
+#define COUNTS_PER_FRAME ((USB_LINK_MAX_PAYLOAD - sizeof(instrument_hist_t)) / sizeof(uint32_t))
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t histogram[INSTRUMENT_BUCKETS];
+} region_t;
+
+static const char * const m_names[INSTRUMENT_REGION_COUNT] =
+{
+    [INSTRUMENT_REGION_BUTTON_IRQ]       = "button_irq",
+    [INSTRUMENT_REGION_BUTTON_EDGE]      = "button_edge",
+    [INSTRUMENT_REGION_DEBOUNCE_TIMEOUT] = "debounce_timeout",
+    [INSTRUMENT_REGION_GESTURE_TIMEOUT]  = "gesture_timeout",
+    [INSTRUMENT_REGION_FADE_BEGIN]       = "fade_begin",
+    [INSTRUMENT_REGION_PWM_PERIOD]       = "pwm_dimming_led",
+    [INSTRUMENT_REGION_MAIN_LOOP]        = "main_loop",
+};
+
+static region_t m_regions[INSTRUMENT_REGION_COUNT];
+static uint32_t m_overhead;
+
+// Dump in progress: the region being sent is copied first, so its statistics
+// and histogram belong together
+static bool m_dumping;
+static uint8_t m_dump_region;
+static uint32_t m_dump_bucket;    // next bucket to send
+static bool m_stats_sent;
+static instrument_stats_t m_dump_stats;
+static uint32_t m_dump_histogram[INSTRUMENT_BUCKETS];
+
+static void ctrl_handler(uint8_t const * p_payload, uint16_t length)
+{
+    if (length < 1)
+    {
+        return;
+    }
+
+    switch (p_payload[0])
+    {
+        case INSTRUMENT_CMD_RESET:
+            instrument_reset();
+            break;
+
+        case INSTRUMENT_CMD_DUMP:
+            if (!m_dumping)
+            {
+                m_dumping = true;
+                m_dump_region = 0;
+                m_dump_bucket = 0;
+                m_stats_sent = false;
+                instrument_get((instrument_region_t)m_dump_region, &m_dump_stats, m_dump_histogram);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void instrument_init(void)
+{
+    // Not cleared, boot_init() started it and times the boot stages with it
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Cost of an empty region, the same two CYCCNT reads as BEGIN and END
+    uint32_t start = DWT->CYCCNT;
+    m_overhead = DWT->CYCCNT - start;
+
+    instrument_reset();
+    usb_link_handler_set(USB_LINK_MSG_INSTRUMENT_CTRL, ctrl_handler);
+}
+
+void instrument_record(instrument_region_t region, uint32_t cycles)
+{
+    region_t * p = &m_regions[region];
+
+    cycles = cycles > m_overhead ? cycles - m_overhead : 0;
+
+    if (cycles < p->min)
+    {
+        p->min = cycles;
+    }
+    if (cycles > p->max)
+    {
+        p->max = cycles;
+    }
+    p->count++;
+    p->sum += cycles;
+    p->histogram[instrument_bucket(cycles)]++;
+}
+
+void instrument_reset(void)
+{
+    CRITICAL_REGION_ENTER();
+    memset(m_regions, 0, sizeof(m_regions));
+    for (int i = 0; i < INSTRUMENT_REGION_COUNT; i++)
+    {
+        m_regions[i].min = UINT32_MAX;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+void instrument_get(instrument_region_t region, instrument_stats_t * p_stats,
+                    uint32_t * p_histogram)
+{
+    region_t const * p = &m_regions[region];
+
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->region = (uint8_t)region;
+    p_stats->regions = INSTRUMENT_REGION_COUNT;
+    p_stats->buckets = INSTRUMENT_BUCKETS;
+    p_stats->sub_bucket_bits = INSTRUMENT_SUB_BUCKET_BITS;
+    p_stats->cpu_hz = SystemCoreClock;
+    p_stats->overhead = m_overhead;
+    strncpy(p_stats->name, m_names[region], sizeof(p_stats->name) - 1);
+
+    CRITICAL_REGION_ENTER();
+    p_stats->count = p->count;
+    p_stats->min = p->count ? p->min : 0;
+    p_stats->max = p->max;
+    p_stats->sum = p->sum;
+    memcpy(p_histogram, p->histogram, sizeof(p->histogram));
+    CRITICAL_REGION_EXIT();
+}
+
+void instrument_process(void)
+{
+    if (!m_dumping)
+    {
+        return;
+    }
+
+    // Host gone, give up on the dump
+    if (!usb_link_is_open())
+    {
+        m_dumping = false;
+        return;
+    }
+
+    // As many frames as the link takes now, the rest on the next call
+    while (m_dump_region < INSTRUMENT_REGION_COUNT)
+    {
+        if (!m_stats_sent)
+        {
+            if (!usb_link_send(USB_LINK_MSG_INSTRUMENT_STATS, &m_dump_stats, sizeof(m_dump_stats)))
+            {
+                return;
+            }
+            m_stats_sent = true;
+        }
+
+        while (m_dump_bucket < INSTRUMENT_BUCKETS)
+        {
+            struct
+            {
+                instrument_hist_t header;
+                uint32_t          counts[COUNTS_PER_FRAME];
+            } frame;
+            uint32_t count = INSTRUMENT_BUCKETS - m_dump_bucket;
+
+            if (count > COUNTS_PER_FRAME)
+            {
+                count = COUNTS_PER_FRAME;
+            }
+            frame.header.region = m_dump_region;
+            frame.header.first = (uint8_t)m_dump_bucket;
+            frame.header.reserved = 0;
+            memcpy(frame.counts, &m_dump_histogram[m_dump_bucket], count * sizeof(uint32_t));
+
+            if (!usb_link_send(USB_LINK_MSG_INSTRUMENT_HIST, &frame,
+                               sizeof(frame.header) + count * sizeof(uint32_t)))
+            {
+                return;
+            }
+            m_dump_bucket += count;
+        }
+
+        m_dump_region++;
+        m_dump_bucket = 0;
+        m_stats_sent = false;
+        if (m_dump_region < INSTRUMENT_REGION_COUNT)
+        {
+            instrument_get((instrument_region_t)m_dump_region, &m_dump_stats, m_dump_histogram);
+        }
+    }
+
+    m_dumping = false;
+}
+
+#endif // INSTRUMENT_ENABLED
@@ -0,0 +1,111 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Cycle counts of named code regions from the DWT cycle counter (CYCCNT):
+// count, min, max, sum and a log-linear histogram per region, in fixed RAM.
+// The host reads them over the USB link (tools/instrument.py).
+//
+//   INSTRUMENT_BEGIN(BUTTON_IRQ);
+//   ...
+//   INSTRUMENT_END(BUTTON_IRQ);
+//
+// Both macros expand to nothing when INSTRUMENT_ENABLED is 0. A region is
+// recorded from one interrupt priority only; the cost of an empty region is
+// measured at init and subtracted. CYCCNT stops while the CPU sleeps, so a
+// region must not contain idle_wait().
+//
+// Histogram: values below INSTRUMENT_SUB_BUCKETS have a bucket each, every
+// power of two above is split into INSTRUMENT_SUB_BUCKETS equal buckets (at
+// most 25 % wide). The last bucket takes everything beyond.
+
+typedef enum
+{
+    INSTRUMENT_REGION_BUTTON_IRQ,        // button_event_handler
+    INSTRUMENT_REGION_BUTTON_EDGE,       // debounce and gesture work of one edge
+    INSTRUMENT_REGION_DEBOUNCE_TIMEOUT,
+    INSTRUMENT_REGION_GESTURE_TIMEOUT,
+    INSTRUMENT_REGION_FADE_BEGIN,        // render and start the PWM sequence of one blink
+    INSTRUMENT_REGION_PWM_PERIOD,        // pwm_dimming_led from the period interrupt, software PWM backend only
+    INSTRUMENT_REGION_MAIN_LOOP,         // one main loop iteration without the sleep
+    INSTRUMENT_REGION_COUNT
+} instrument_region_t;
+
+#define INSTRUMENT_SUB_BUCKET_BITS 2
+#define INSTRUMENT_SUB_BUCKETS     (1UL << INSTRUMENT_SUB_BUCKET_BITS)
+#define INSTRUMENT_NAME_LENGTH     24
+
+typedef enum
+{
+    INSTRUMENT_CMD_RESET,
+    INSTRUMENT_CMD_DUMP    // answered with STATS and HIST frames for every region
+} instrument_cmd_t;
+
+// USB_LINK_MSG_INSTRUMENT_STATS payload, cycles
+typedef struct
+{
+    uint8_t  region;
+    uint8_t  regions;
+    uint8_t  buckets;
+    uint8_t  sub_bucket_bits;
+    uint32_t cpu_hz;
+    uint32_t overhead;       // subtracted from every sample
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    char     name[INSTRUMENT_NAME_LENGTH];
+} instrument_stats_t;
+
+// USB_LINK_MSG_INSTRUMENT_HIST payload, followed by uint32_t counts of the
+// buckets from first on
+typedef struct
+{
+    uint8_t  region;
+    uint8_t  first;
+    uint16_t reserved;
+} instrument_hist_t;
+
+// Histogram bucket of a cycle count, and the smallest count in a bucket
+uint32_t instrument_bucket(uint32_t cycles);
+uint32_t instrument_bucket_floor(uint32_t bucket);
+
+#if INSTRUMENT_ENABLED
+
+#include "nrf.h"
+
+#define INSTRUMENT_BEGIN(name) \
+    uint32_t const instrument_start_##name = DWT->CYCCNT
+
+#define INSTRUMENT_END(name) \
+    instrument_record(INSTRUMENT_REGION_##name, DWT->CYCCNT - instrument_start_##name)
+
+// Start the cycle counter and take the INSTRUMENT_CTRL messages
+void instrument_init(void);
+
+// Add a sample, cycles including the overhead of INSTRUMENT_BEGIN/END
+void instrument_record(instrument_region_t region, uint32_t cycles);
+
+void instrument_reset(void);
+
+// Consistent copy of one region, p_histogram holds INSTRUMENT_BUCKETS counts
+void instrument_get(instrument_region_t region, instrument_stats_t * p_stats,
+                    uint32_t * p_histogram);
+
+// Send the next part of a requested dump, main loop
+void instrument_process(void);
+
+#else
+
+#define INSTRUMENT_BEGIN(name) (void)0
+#define INSTRUMENT_END(name)   (void)0
+
+static inline void instrument_init(void) {}
+static inline void instrument_reset(void) {}
+static inline void instrument_process(void) {}
+
+#endif // INSTRUMENT_ENABLED
+
+#endif
@@ -0,0 +1,100 @@
+#include <stddef.h>
+#include "led_animation.h"
+
+#define HALF (LED_ANIMATION_FULL / 2)
+
+// Powers of a Q16 value, scaled down by 2^shift
+static uint32_t square(uint32_t a, uint32_t shift)
+{
+    return (uint32_t)(((uint64_t)a * a) >> shift);
+}
+
+static uint32_t cube(uint32_t a, uint32_t shift)
+{
+    return (uint32_t)(((uint64_t)a * a * a) >> shift);
+}
+
+uint32_t led_easing(led_easing_t easing, uint32_t u)
+{
+    uint32_t v = LED_ANIMATION_FULL - u;
+
+    switch (easing)
+    {
+        case LED_EASING_EASE_IN:
+            return square(u, 16);
+
+        case LED_EASING_EASE_OUT:
+            return LED_ANIMATION_FULL - square(v, 16);
+
+        // 2u^2 and 1 - 2(1 - u)^2, meeting in the middle
+        case LED_EASING_EASE_IN_OUT:
+            return u < HALF ? square(u, 15) : LED_ANIMATION_FULL - square(v, 15);
+
+        // 4u^3 and 1 - 4(1 - u)^3
+        case LED_EASING_CUBIC:
+            return u < HALF ? cube(u, 30) : LED_ANIMATION_FULL - cube(v, 30);
+
+        case LED_EASING_STEP:
+            return 0;
+
+        case LED_EASING_LINEAR:
+        default:
+            return u;
+    }
+}
+
+void led_animation_init(led_animation_t * p_animation, led_timeline_t const * p_timeline)
+{
+    led_keyframe_t const * p_keyframes = p_timeline->p_keyframes;
+
+    p_animation->p_timeline = p_timeline;
+    p_animation->segment = 0;
+
+    // Rounded up, so the progress reaches full scale at the end of a segment
+    for (uint8_t i = 0; i + 1 < p_timeline->count; i++)
+    {
+        uint32_t duration = p_keyframes[i + 1].time_ms - p_keyframes[i].time_ms;
+        uint64_t reciprocal = duration ? ((1ULL << 32) + duration - 1) / duration : 0;
+
+        p_animation->reciprocal[i] = reciprocal > UINT32_MAX ? UINT32_MAX : (uint32_t)reciprocal;
+    }
+}
+
+uint32_t led_animation_level(led_animation_t * p_animation, uint32_t time)
+{
+    led_timeline_t const * p_timeline = p_animation->p_timeline;
+    led_keyframe_t const * p_keyframes = p_timeline->p_keyframes;
+    uint8_t segment = p_animation->segment;
+
+    while (segment + 1 < p_timeline->count &&
+           time >= LED_ANIMATION_MS(p_keyframes[segment + 1].time_ms))
+    {
+        segment++;
+    }
+    p_animation->segment = segment;
+
+    led_keyframe_t const * p_from = &p_keyframes[segment];
+    if (segment + 1 == p_timeline->count || time <= LED_ANIMATION_MS(p_from->time_ms))
+    {
+        return p_from->level;
+    }
+
+    // (time - start) / duration as Q16 from the Q16 ms offset and 2^32 / duration
+    uint32_t u = (uint32_t)(((uint64_t)(time - LED_ANIMATION_MS(p_from->time_ms)) *
+                             p_animation->reciprocal[segment] + (1ULL << 31)) >> 32);
+    if (u > LED_ANIMATION_FULL)
+    {
+        u = LED_ANIMATION_FULL;
+    }
+
+    uint32_t e = led_easing((led_easing_t)p_from->easing, u);
+    uint32_t to = p_keyframes[segment + 1].level;
+
+    return (uint32_t)(((uint64_t)p_from->level * (LED_ANIMATION_FULL - e) +
+                       (uint64_t)to * e + HALF) >> 16);
+}
+
+uint16_t led_timeline_duration_ms(led_timeline_t const * p_timeline)
+{
+    return p_timeline->count ? p_timeline->p_keyframes[p_timeline->count - 1].time_ms : 0;
+}
@@ -0,0 +1,64 @@
+#ifndef LED_ANIMATION_H
+#define LED_ANIMATION_H
+
+#include <stdint.h>
+
+// Keyframe animation of one LED channel. A timeline is a list of keyframes
+// (time in ms, level, easing); the easing of a keyframe shapes the segment
+// from it to the next one. Levels and segment progress are Q16 fixed point,
+// LED_ANIMATION_FULL being full brightness on the fade curve.
+//
+// led_animation_init() takes the reciprocal of every segment duration, so
+// led_animation_level() has multiplies and shifts only. Time only runs
+// forward between two inits, the current segment is kept as a cursor.
+
+#define LED_ANIMATION_FULL          (1UL << 16)
+#define LED_ANIMATION_KEYFRAMES_MAX 16
+
+// Q16 milliseconds
+#define LED_ANIMATION_MS(ms) ((uint32_t)(ms) << 16)
+
+typedef enum
+{
+    LED_EASING_LINEAR,
+    LED_EASING_EASE_IN,       // quadratic
+    LED_EASING_EASE_OUT,
+    LED_EASING_EASE_IN_OUT,
+    LED_EASING_CUBIC,         // cubic ease in and out
+    LED_EASING_STEP,          // hold the level until the next keyframe
+    LED_EASING_COUNT
+} led_easing_t;
+
+typedef struct
+{
+    uint16_t time_ms;    // from the start of the timeline, increasing
+    uint8_t  easing;     // led_easing_t towards the next keyframe
+    uint32_t level;      // Q16, 0..LED_ANIMATION_FULL
+} led_keyframe_t;
+
+typedef struct
+{
+    led_keyframe_t const * p_keyframes;
+    uint8_t                count;         // 1..LED_ANIMATION_KEYFRAMES_MAX
+} led_timeline_t;
+
+typedef struct
+{
+    led_timeline_t const * p_timeline;
+    uint32_t               reciprocal[LED_ANIMATION_KEYFRAMES_MAX];   // 2^32 / segment ms
+    uint8_t                segment;
+} led_animation_t;
+
+// Eased progress, u and the result Q16 in [0, LED_ANIMATION_FULL]
+uint32_t led_easing(led_easing_t easing, uint32_t u);
+
+void led_animation_init(led_animation_t * p_animation, led_timeline_t const * p_timeline);
+
+// Level at time (Q16 ms), not before the time of the last call. Before the
+// first keyframe the level is that of the first, after the last that of the last.
+uint32_t led_animation_level(led_animation_t * p_animation, uint32_t time);
+
+// Time of the last keyframe
+uint16_t led_timeline_duration_ms(led_timeline_t const * p_timeline);
+
+#endif
@@ -0,0 +1,182 @@
+#include "led_command.h"
+
+#if USB_LINK_ENABLED
+
+#include <string.h>
+#include "blink_sequencer.h"
+#include "led_stream.h"
+#include "patterns.h"
+#include "settings.h"
+
+static void status_send(uint8_t op, led_command_result_t result)
+{
+    led_command_status_t status = {0};
+    settings_t const * p_settings = settings_get();
+
+    status.op = op;
+    status.result = result;
+    status.running = blink_sequencer_state() != BLINK_SEQUENCER_IDLE;
+    status.brightness = p_settings->brightness;
+    status.speed = p_settings->speed;
+    for (int i = 0; i < 4; i++)
+    {
+        status.digits[i] = p_settings->digits[i];
+    }
+    status.click_gap_ms = p_settings->click_gap_ms;
+    status.rx_errors = usb_link_rx_errors();
+
+    usb_link_send(USB_LINK_MSG_LED_STATUS, &status, sizeof(status));
+}
+
+static led_command_result_t device_id_set(settings_t * p_settings, uint8_t const * p_digits, uint16_t length)
+{
+    if (length != 4)
+    {
+        return LED_COMMAND_BAD_LENGTH;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        if (p_digits[i] > LED_COMMAND_DIGIT_MAX)
+        {
+            return LED_COMMAND_BAD_VALUE;
+        }
+        p_settings->digits[i] = p_digits[i];
+    }
+    return LED_COMMAND_OK;
+}
+
+// A u16 operand within min..max
+static led_command_result_t u16_get(uint8_t const * p_operands, uint16_t length,
+                                    uint16_t min, uint16_t max, uint16_t * p_value)
+{
+    uint16_t value;
+
+    if (length != 2)
+    {
+        return LED_COMMAND_BAD_LENGTH;
+    }
+    value = p_operands[0] | (p_operands[1] << 8);
+    if (value < min || value > max)
+    {
+        return LED_COMMAND_BAD_VALUE;
+    }
+    *p_value = value;
+    return LED_COMMAND_OK;
+}
+
+// One of the patterns in flash by name, from its start. It plays at once if
+// blinking is on, else with the next start.
+static led_command_result_t pattern_set(char const * p_name, uint16_t length)
+{
+    char name[LED_COMMAND_NAME_MAX + 1];
+    patterns_entry_t const * p_entry;
+
+    if (length == 0 || length > LED_COMMAND_NAME_MAX)
+    {
+        return LED_COMMAND_BAD_LENGTH;
+    }
+    memcpy(name, p_name, length);
+    name[length] = '\0';
+
+    p_entry = patterns_find(name);
+    if (p_entry == NULL)
+    {
+        return LED_COMMAND_BAD_VALUE;
+    }
+    // Loading stops the PWM engine, which would end the stream
+    if (led_stream_is_running())
+    {
+        return LED_COMMAND_BUSY;
+    }
+    if (!blink_sequencer_pattern_set(p_entry->p_code, p_entry->length))
+    {
+        return LED_COMMAND_BAD_VALUE;
+    }
+    if (settings_get()->blinking)
+    {
+        blink_sequencer_start();
+    }
+    return LED_COMMAND_OK;
+}
+
+// Operands are read in the receive buffer, only a pattern name is copied out.
+// A command edits a copy of the settings, which replaces them if it is valid.
+static void command_handler(uint8_t const * p_payload, uint16_t length)
+{
+    uint8_t const * p_operands = p_payload + 1;
+    uint16_t size;
+    settings_t settings;
+    led_command_result_t result = LED_COMMAND_OK;
+
+    if (length < 1)
+    {
+        status_send(LED_COMMAND_STATUS, LED_COMMAND_BAD_LENGTH);
+        return;
+    }
+    size = length - 1;
+    settings = *settings_get();
+
+    switch (p_payload[0])
+    {
+        case LED_COMMAND_STATUS:
+        case LED_COMMAND_SAVE:
+            result = size == 0 ? LED_COMMAND_OK : LED_COMMAND_BAD_LENGTH;
+            break;
+
+        case LED_COMMAND_START:
+        case LED_COMMAND_STOP:
+            result = size == 0 ? LED_COMMAND_OK : LED_COMMAND_BAD_LENGTH;
+            settings.blinking = p_payload[0] == LED_COMMAND_START;
+            break;
+
+        case LED_COMMAND_DEVICE_ID:
+            result = device_id_set(&settings, p_operands, size);
+            break;
+
+        case LED_COMMAND_BRIGHTNESS:
+            if (size != 1)
+            {
+                result = LED_COMMAND_BAD_LENGTH;
+            }
+            else
+            {
+                settings.brightness = p_operands[0];
+            }
+            break;
+
+        case LED_COMMAND_FADE_SPEED:
+            result = u16_get(p_operands, size, BLINK_SEQUENCER_SPEED_MIN, BLINK_SEQUENCER_SPEED_MAX,
+                             &settings.speed);
+            break;
+
+        case LED_COMMAND_CLICK_GAP:
+            result = u16_get(p_operands, size, LED_COMMAND_CLICK_GAP_MIN, LED_COMMAND_CLICK_GAP_MAX,
+                             &settings.click_gap_ms);
+            break;
+
+        case LED_COMMAND_PATTERN:
+            result = pattern_set((char const *)p_operands, size);
+            break;
+
+        default:
+            result = LED_COMMAND_UNKNOWN;
+            break;
+    }
+
+    if (result == LED_COMMAND_OK)
+    {
+        settings_update(&settings);
+        if (p_payload[0] == LED_COMMAND_SAVE)
+        {
+            settings_flush();
+        }
+    }
+    status_send(p_payload[0], result);
+}
+
+void led_command_init(void)
+{
+    usb_link_handler_set(USB_LINK_MSG_LED_COMMAND, command_handler);
+}
+
+#endif // USB_LINK_ENABLED
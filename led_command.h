@@ -0,0 +1,80 @@
+#ifndef LED_COMMAND_H
+#define LED_COMMAND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+#include "usb_link.h"
+
+// LED settings from the host over the USB link (tools/led_ctrl.py). A
+// USB_LINK_MSG_LED_COMMAND frame is an opcode byte and its operands, read
+// where the frame was received; every command is answered with one
+// USB_LINK_MSG_LED_STATUS. The frame length and CRC are those of the link.
+// Changes go through settings_update(), so they apply at once and are kept
+// over resets; a pattern chosen with PATTERN is not, the device_id blinks
+// come back after a reset.
+//
+//   op           operands             effect
+//   STATUS                            status only
+//   START                             blinking on, as a double click would
+//   STOP                              blinking off, LEDs off
+//   DEVICE_ID    u8 digits[4]         0..9 blinks per LED, the pattern starts over
+//   BRIGHTNESS   u8                   0..255, from the next fade
+//   FADE_SPEED   u16 percent          BLINK_SEQUENCER_SPEED_MIN..MAX, from the next fade
+//   CLICK_GAP    u16 ms               LED_COMMAND_CLICK_GAP_MIN..MAX, double click window
+//   SAVE                              write changes to flash now, not after the delay
+//   PATTERN      char name[]          play a pattern of patterns/*.pat from its start,
+//                                     the name without terminator, BUSY while streaming
+
+typedef enum
+{
+    LED_COMMAND_STATUS,
+    LED_COMMAND_START,
+    LED_COMMAND_STOP,
+    LED_COMMAND_DEVICE_ID,
+    LED_COMMAND_BRIGHTNESS,
+    LED_COMMAND_FADE_SPEED,
+    LED_COMMAND_CLICK_GAP,
+    LED_COMMAND_SAVE,
+    LED_COMMAND_PATTERN
+} led_command_op_t;
+
+typedef enum
+{
+    LED_COMMAND_OK,
+    LED_COMMAND_BAD_LENGTH,
+    LED_COMMAND_BAD_VALUE,
+    LED_COMMAND_UNKNOWN,
+    LED_COMMAND_BUSY        // the LEDs are taken by a host stream
+} led_command_result_t;
+
+#define LED_COMMAND_DIGIT_MAX     9
+#define LED_COMMAND_CLICK_GAP_MIN 100
+#define LED_COMMAND_CLICK_GAP_MAX 2000
+#define LED_COMMAND_NAME_MAX      31
+
+// USB_LINK_MSG_LED_STATUS payload
+typedef struct
+{
+    uint8_t  op;            // led_command_op_t answered
+    uint8_t  result;        // led_command_result_t
+    uint8_t  running;       // pattern playing
+    uint8_t  brightness;
+    uint16_t speed;         // percent
+    uint8_t  digits[4];
+    uint16_t click_gap_ms;
+    uint32_t rx_errors;     // frames of the link dropped for CRC or length
+} led_command_status_t;
+
+#if USB_LINK_ENABLED
+
+// After settings_init(), blink_sequencer_init() and usb_link_init()
+void led_command_init(void);
+
+#else
+
+static inline void led_command_init(void) {}
+
+#endif // USB_LINK_ENABLED
+
+#endif
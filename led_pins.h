@@ -0,0 +1,77 @@
+#ifndef LED_PINS_H
+#define LED_PINS_H
+
+#include <stdint.h>
+#include "nrf_gpio.h"
+
+// Compile-time map of the LED pins. A set of LEDs, given as a channel mask
+// (bit n: channel n), turns into one OUTSET/OUTCLR mask per GPIO port, so
+// switching any of them takes at most one register write per port and the
+// LEDs of a port change in the same cycle. The LEDs are active low.
+
+// Convert port and pin into pin number
+#define YELLOW_LED_PIN  NRF_GPIO_PIN_MAP(0,6)
+#define RED_LED_PIN     NRF_GPIO_PIN_MAP(0,8)
+#define GREEN_LED_PIN   NRF_GPIO_PIN_MAP(1,9)
+#define BLUE_LED_PIN    NRF_GPIO_PIN_MAP(0,12)
+
+#define LEDS_NUMBER     4
+#define LED_PINS_ALL    ((1U << LEDS_NUMBER) - 1)
+#define LED_PINS_PORTS  2
+
+// Bit of pin in the registers of port, 0 if the pin is on the other port
+#define LED_PINS_BIT(pin, port) (((pin) >> 5) == (port) ? 1UL << ((pin) & 0x1F) : 0)
+
+// Bits of port for the channels in channel_mask, a constant for a constant mask
+#define LED_PINS_PORT_MASK(channel_mask, port)                          \
+    ((((channel_mask) & 1) ? LED_PINS_BIT(YELLOW_LED_PIN, port) : 0) |  \
+     (((channel_mask) & 2) ? LED_PINS_BIT(RED_LED_PIN, port)    : 0) |  \
+     (((channel_mask) & 4) ? LED_PINS_BIT(GREEN_LED_PIN, port)  : 0) |  \
+     (((channel_mask) & 8) ? LED_PINS_BIT(BLUE_LED_PIN, port)   : 0))
+
+// Register masks of a set of pins, by port
+typedef struct
+{
+    uint32_t port[LED_PINS_PORTS];
+} led_pins_masks_t;
+
+#define LED_PINS_MASKS(channel_mask) \
+    ((led_pins_masks_t){{LED_PINS_PORT_MASK(channel_mask, 0), LED_PINS_PORT_MASK(channel_mask, 1)}})
+
+// Drive the pins in the masks high (LEDs off), one OUTSET per port that has any
+static inline void led_pins_set(led_pins_masks_t masks)
+{
+    if (masks.port[0] != 0)
+    {
+        nrf_gpio_port_out_set(NRF_P0, masks.port[0]);
+    }
+    if (masks.port[1] != 0)
+    {
+        nrf_gpio_port_out_set(NRF_P1, masks.port[1]);
+    }
+}
+
+// Drive the pins in the masks low (LEDs on), one OUTCLR per port that has any
+static inline void led_pins_clear(led_pins_masks_t masks)
+{
+    if (masks.port[0] != 0)
+    {
+        nrf_gpio_port_out_clear(NRF_P0, masks.port[0]);
+    }
+    if (masks.port[1] != 0)
+    {
+        nrf_gpio_port_out_clear(NRF_P1, masks.port[1]);
+    }
+}
+
+// Masks of pins only known at run time (pwm_engine_init() takes them), built
+// once so the per-frame path only ORs masks
+static inline led_pins_masks_t led_pins_masks_of(uint32_t pin)
+{
+    led_pins_masks_t masks = {{0}};
+
+    masks.port[(pin >> 5) & 1] = 1UL << (pin & 0x1F);
+    return masks;
+}
+
+#endif
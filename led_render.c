@@ -0,0 +1,75 @@
+#include <stddef.h>
+#include "led_render.h"
+#include "fade_tables.h"
+
+// Q16 brightness to a PWM level, between the two nearest table entries
+static uint16_t curve_level(uint16_t const * p_table, uint32_t level)
+{
+    uint32_t position = level * (FADE_TABLE_STEPS - 1);
+    uint32_t index = position >> 16;
+    int32_t fraction = (int32_t)(position & 0xFFFF);
+
+    if (index >= FADE_TABLE_STEPS - 1)
+    {
+        return p_table[FADE_TABLE_STEPS - 1];
+    }
+
+    int32_t delta = (int32_t)p_table[index + 1] - (int32_t)p_table[index];
+    return (uint16_t)((int32_t)p_table[index] + ((delta * fraction + 0x8000) >> 16));
+}
+
+uint16_t led_render_fill(pwm_engine_frame_t * p_frames,
+                         led_timeline_t const * const * pp_timelines, uint32_t * p_frame_us)
+{
+    uint16_t const * p_table = fade_table_get(FADE_CURVE, PWM_ENGINE_RESOLUTION_BITS);
+    led_animation_t animations[LED_RENDER_CHANNELS];
+    uint32_t duration_ms = 0;
+
+    for (int i = 0; i < LED_RENDER_CHANNELS; i++)
+    {
+        if (pp_timelines[i] != NULL)
+        {
+            led_animation_init(&animations[i], pp_timelines[i]);
+            if (led_timeline_duration_ms(pp_timelines[i]) > duration_ms)
+            {
+                duration_ms = led_timeline_duration_ms(pp_timelines[i]);
+            }
+        }
+    }
+
+    // Divisions once per fill, none per frame. The engine plays whole PWM
+    // periods, so the shortest frame that fits the animation is counted in
+    // periods, rounded up; a frame in microseconds could be rounded down by
+    // the engine and the end cut off.
+    uint32_t period_ns = pwm_engine_period_ns();
+    uint64_t shortest_ns = ((uint64_t)duration_ms * 1000000UL + LED_RENDER_FRAMES_MAX - 2) / (LED_RENDER_FRAMES_MAX - 1);
+    uint32_t shortest_periods = (uint32_t)((shortest_ns + period_ns - 1) / period_ns);
+    if (pwm_engine_frame_ns(*p_frame_us) < shortest_periods * period_ns)
+    {
+        *p_frame_us = (uint32_t)(((uint64_t)shortest_periods * period_ns + 999) / 1000);
+    }
+    // Rounded up as well, so the step rounding cannot add a frame
+    uint64_t frame_ns = pwm_engine_frame_ns(*p_frame_us);
+    uint32_t step = (uint32_t)(((frame_ns << 16) + 999999) / 1000000UL);
+    uint32_t end = LED_ANIMATION_MS(duration_ms);
+    uint32_t time = 0;
+    uint16_t length = 0;
+
+    while (length < LED_RENDER_FRAMES_MAX)
+    {
+        for (int i = 0; i < LED_RENDER_CHANNELS; i++)
+        {
+            p_frames[length].level[i] = pp_timelines[i] != NULL ?
+                curve_level(p_table, led_animation_level(&animations[i], time)) : 0;
+        }
+        length++;
+
+        if (time >= end)
+        {
+            break;
+        }
+        time += step;
+    }
+
+    return length;
+}
@@ -0,0 +1,30 @@
+#ifndef LED_RENDER_H
+#define LED_RENDER_H
+
+#include <stdint.h>
+#include "pwm_engine.h"
+#include "led_animation.h"
+
+// Renders keyframe timelines into frames the PWM engine plays without CPU
+// help. What to render comes from the pattern VM (pattern_vm.h).
+
+#define LED_RENDER_CHANNELS PWM_ENGINE_CHANNELS
+
+// Frames led_render_fill() produces at most
+#define LED_RENDER_FRAMES_MAX 256
+
+// Values of LED_RENDER_MODE (see app_config.h)
+#define LED_RENDER_MODE_SEQUENTIAL 0 // one LED after the other, cycle = sum of the digits
+#define LED_RENDER_MODE_CONCURRENT 1 // all LEDs at once, cycle = largest digit
+
+// Fill p_frames with the keyframe timeline of every channel (NULL: dark),
+// through the FADE_CURVE table. *p_frame_us is the shortest frame on entry
+// and the frame to play on return: longer, by whole PWM periods, when the
+// animation would not fit into LED_RENDER_FRAMES_MAX frames. Time advances by what the PWM engine
+// really holds a frame for, so the timing does not depend on the PWM
+// frequency. Returns the number of frames, the last one shows the end of
+// the longest timeline.
+uint16_t led_render_fill(pwm_engine_frame_t * p_frames,
+                         led_timeline_t const * const * pp_timelines, uint32_t * p_frame_us);
+
+#endif
@@ -0,0 +1,275 @@
+#include "led_stream.h"
+
+#if LED_STREAM_ENABLED
+
+#include <stddef.h>
+#include <string.h>
+#include "app_util_platform.h"
+#include "usb_link.h"
+
+#if (LED_STREAM_DEPTH & (LED_STREAM_DEPTH - 1)) != 0 || LED_STREAM_DEPTH <= LED_STREAM_LATENCY_FRAMES
+#error "LED_STREAM_DEPTH must be a power of 2 larger than LED_STREAM_LATENCY_FRAMES"
+#endif
+
+typedef struct
+{
+    uint16_t sequence;
+    bool     valid;
+    uint16_t level[PWM_ENGINE_CHANNELS];
+} slot_t;
+
+static led_stream_handler_t m_handler;
+static pwm_engine_handler_t m_engine_owner;
+
+// Filled by the main loop, emptied by the PWM interrupt
+static slot_t m_ring[LED_STREAM_DEPTH];
+
+// Played by the engine in turn, the interrupt refills the one taken
+static pwm_engine_frame_t m_frames[2];
+static pwm_engine_frame_t m_held;       // levels of the last slot filled
+
+static uint32_t m_frame_us;
+static volatile bool m_running;         // the engine is ours
+static volatile bool m_playing;         // the first frame is there, slots run
+static volatile bool m_timed_out;
+static uint16_t m_next;                 // sequence of the next slot
+static uint16_t m_preroll;              // slots before m_next is presented
+static uint16_t m_missing;              // underruns in a row
+static bool m_report_requested;
+static led_stream_stats_t m_stats;
+
+// Fill the buffer of the next slot: its frame, or the previous levels again
+static void slot_fill(pwm_engine_frame_t * p_frame)
+{
+    if (m_preroll > 0)
+    {
+        m_preroll--;
+    }
+    else
+    {
+        slot_t * p_slot = &m_ring[m_next & (LED_STREAM_DEPTH - 1)];
+
+        if (p_slot->valid && p_slot->sequence == m_next)
+        {
+            memcpy(m_held.level, p_slot->level, sizeof(m_held.level));
+            p_slot->valid = false;
+            m_stats.presented++;
+            m_missing = 0;
+        }
+        else
+        {
+            m_stats.underruns++;
+            if (++m_missing >= LED_STREAM_TIMEOUT_FRAMES)
+            {
+                m_timed_out = true;
+            }
+        }
+        m_next++;
+    }
+
+    *p_frame = m_held;
+}
+
+// PWM interrupt, a buffer taken
+static void refill_handler(pwm_engine_frame_t * p_frame)
+{
+    if (m_running)
+    {
+        slot_fill(p_frame);
+    }
+}
+
+void led_stream_start(uint32_t frame_us)
+{
+    if (m_running)
+    {
+        m_running = false;
+        pwm_engine_stop();
+    }
+    else
+    {
+        if (m_handler != NULL)
+        {
+            m_handler(true);
+        }
+        m_engine_owner = pwm_engine_handler_set(NULL);
+    }
+
+    memset(m_ring, 0, sizeof(m_ring));
+    memset(&m_held, 0, sizeof(m_held));
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_frame_us = frame_us < LED_STREAM_FRAME_US ? LED_STREAM_FRAME_US : frame_us;
+    m_stats.frame_ns = pwm_engine_frame_ns(m_frame_us);
+    m_stats.latency_ns = LED_STREAM_LATENCY_FRAMES * m_stats.frame_ns;
+    m_missing = 0;
+    m_playing = false;
+    m_timed_out = false;
+    m_running = true;
+}
+
+void led_stream_stop(void)
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    m_running = false;
+    m_playing = false;
+    pwm_engine_stop();
+    pwm_engine_handler_set(m_engine_owner);
+    if (m_handler != NULL)
+    {
+        m_handler(false);
+    }
+}
+
+bool led_stream_is_running(void)
+{
+    return m_running;
+}
+
+void led_stream_put(uint16_t sequence, uint16_t const * p_levels)
+{
+    uint16_t level[PWM_ENGINE_CHANNELS];
+
+    if (!m_running)
+    {
+        return;
+    }
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        level[i] = ((uint32_t)p_levels[i] * PWM_ENGINE_TOP + LED_STREAM_LEVEL_FULL / 2) / LED_STREAM_LEVEL_FULL;
+    }
+
+    CRITICAL_REGION_ENTER();
+    // The first frame fixes the timeline: its slot is now
+    bool first = !m_playing;
+    if (first)
+    {
+        m_playing = true;
+        m_next = sequence;
+        m_preroll = LED_STREAM_LATENCY_FRAMES;
+    }
+
+    int16_t ahead = (int16_t)(sequence - m_next);
+    if (ahead < 0)
+    {
+        m_stats.late++;
+    }
+    else if (ahead >= LED_STREAM_DEPTH)
+    {
+        m_stats.early++;
+    }
+    else
+    {
+        slot_t * p_slot = &m_ring[sequence & (LED_STREAM_DEPTH - 1)];
+
+        memcpy(p_slot->level, level, sizeof(level));
+        p_slot->sequence = sequence;
+        p_slot->valid = true;
+        m_stats.received++;
+    }
+
+    // From here on the engine is the clock, the slots of both buffers follow
+    // without a gap
+    if (first)
+    {
+        slot_fill(&m_frames[0]);
+        slot_fill(&m_frames[1]);
+        pwm_engine_stream(m_frames, m_frame_us, refill_handler);
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+void led_stream_stats_get(led_stream_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    p_stats->next = m_next;
+    p_stats->running = m_running;
+    CRITICAL_REGION_EXIT();
+}
+
+void led_stream_process(void)
+{
+    if (m_timed_out)
+    {
+        m_timed_out = false;
+        led_stream_stop();
+        m_report_requested = true;
+    }
+
+    if (m_report_requested && usb_link_is_open())
+    {
+        led_stream_stats_t stats;
+
+        led_stream_stats_get(&stats);
+        m_report_requested = !usb_link_send(USB_LINK_MSG_LED_STREAM_REPORT, &stats, sizeof(stats));
+    }
+}
+
+#if USB_LINK_ENABLED
+
+static void ctrl_handler(uint8_t const * p_payload, uint16_t length)
+{
+    led_stream_ctrl_t ctrl = {0};
+
+    if (length < 1)
+    {
+        return;
+    }
+    memcpy(&ctrl, p_payload, length < sizeof(ctrl) ? length : sizeof(ctrl));
+
+    switch (ctrl.cmd)
+    {
+        case LED_STREAM_CMD_STOP:
+            led_stream_stop();
+            break;
+
+        case LED_STREAM_CMD_START:
+            led_stream_start(ctrl.frame_us);
+            break;
+
+        default:
+            break;
+    }
+    m_report_requested = true;
+}
+
+// Frames are read where the link received them
+static void data_handler(uint8_t const * p_payload, uint16_t length)
+{
+    uint16_t const frame_size = PWM_ENGINE_CHANNELS * sizeof(uint16_t);
+
+    if (length < LED_STREAM_DATA_HEADER + frame_size || (length - LED_STREAM_DATA_HEADER) % frame_size != 0)
+    {
+        return;
+    }
+
+    uint16_t sequence = p_payload[0] | (p_payload[1] << 8);
+    for (uint8_t const * p = &p_payload[LED_STREAM_DATA_HEADER]; p < &p_payload[length]; p += frame_size)
+    {
+        uint16_t levels[PWM_ENGINE_CHANNELS];
+
+        for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+        {
+            levels[i] = p[2 * i] | (p[2 * i + 1] << 8);
+        }
+        led_stream_put(sequence++, levels);
+    }
+}
+
+#endif // USB_LINK_ENABLED
+
+void led_stream_init(led_stream_handler_t handler)
+{
+    m_handler = handler;
+#if USB_LINK_ENABLED
+    usb_link_handler_set(USB_LINK_MSG_LED_STREAM_CTRL, ctrl_handler);
+    usb_link_handler_set(USB_LINK_MSG_LED_STREAM_DATA, data_handler);
+#endif
+}
+
+#endif // LED_STREAM_ENABLED
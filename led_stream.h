@@ -0,0 +1,103 @@
+#ifndef LED_STREAM_H
+#define LED_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+#include "pwm_engine.h"
+
+// LED levels streamed by the host (tools/led_stream.py), played instead of the
+// blink pattern, up to one frame per LED_STREAM_FRAME_US. Every frame carries
+// a 16-bit sequence number; frame s is presented LED_STREAM_LATENCY_FRAMES
+// frame periods after its slot, the slot of the first frame s0 being its
+// arrival and that of s being s - s0 periods later. The PWM engine is the
+// clock: it plays two frame buffers in turn without a gap
+// (pwm_engine_stream()), its interrupt refills the buffer it has taken with
+// the next frame from a ring of LED_STREAM_DEPTH while the main loop fills
+// the ring from the USB link. The frame on the LEDs is never the one being
+// written, and a late interrupt does not delay the frames.
+//
+// A frame is taken into its buffer before it is presented, two frame periods
+// before with the PWM peripheral, one with the other backends. So a frame may
+// arrive up to the latency less that after its slot. A slot whose frame is
+// not there by then holds the previous levels (underrun); a frame that
+// arrives after it was due in its buffer is dropped (late), as is one more
+// than LED_STREAM_DEPTH ahead (early). After LED_STREAM_TIMEOUT_FRAMES
+// underruns in a row the stream ends by itself.
+//
+// Over the USB link: LED_STREAM_CTRL starts, stops or asks for a report,
+// LED_STREAM_DATA carries frames, LED_STREAM_REPORT answers with
+// led_stream_stats_t (also sent when the stream times out).
+
+typedef enum
+{
+    LED_STREAM_CMD_STOP,
+    LED_STREAM_CMD_START,       // restarts the statistics
+    LED_STREAM_CMD_REPORT
+} led_stream_cmd_t;
+
+// USB_LINK_MSG_LED_STREAM_CTRL payload
+typedef struct
+{
+    uint8_t  cmd;           // led_stream_cmd_t
+    uint8_t  reserved;
+    uint16_t frame_us;      // START only, 0: LED_STREAM_FRAME_US
+} led_stream_ctrl_t;
+
+// USB_LINK_MSG_LED_STREAM_DATA payload: u16 sequence of the first frame, then
+// one or more frames of PWM_ENGINE_CHANNELS u16 levels, 0xFFFF full on
+#define LED_STREAM_DATA_HEADER 2
+#define LED_STREAM_LEVEL_FULL  0xFFFF
+
+// USB_LINK_MSG_LED_STREAM_REPORT payload
+typedef struct
+{
+    uint32_t frame_ns;      // presentation period
+    uint32_t latency_ns;    // slot to presentation
+    uint32_t received;      // frames stored for presentation
+    uint32_t presented;
+    uint32_t underruns;     // slots without their frame
+    uint32_t late;          // dropped, their slot had begun
+    uint32_t early;         // dropped, too far ahead
+    uint16_t next;          // sequence of the next slot
+    uint8_t  running;
+    uint8_t  reserved;
+} led_stream_stats_t;
+
+// The stream takes the LEDs (true) or gives them back (false)
+typedef void (*led_stream_handler_t)(bool streaming);
+
+#if LED_STREAM_ENABLED
+
+// After pwm_engine_init() and usb_link_init()
+void led_stream_init(led_stream_handler_t handler);
+
+// Take the PWM engine over, frames are played once the first one arrives.
+// One frame every frame_us, at least LED_STREAM_FRAME_US.
+void led_stream_start(uint32_t frame_us);
+
+// LEDs off, the engine back to its owner
+void led_stream_stop(void);
+
+bool led_stream_is_running(void);
+
+// Store one frame, levels are PWM_ENGINE_CHANNELS of 0..LED_STREAM_LEVEL_FULL.
+// Main loop.
+void led_stream_put(uint16_t sequence, uint16_t const * p_levels);
+
+void led_stream_stats_get(led_stream_stats_t * p_stats);
+
+// End a timed out stream, send requested reports, main loop
+void led_stream_process(void);
+
+#else
+
+static inline void led_stream_init(led_stream_handler_t handler) {}
+static inline void led_stream_start(uint32_t frame_us) {}
+static inline void led_stream_stop(void) {}
+static inline bool led_stream_is_running(void) { return false; }
+static inline void led_stream_process(void) {}
+
+#endif // LED_STREAM_ENABLED
+
+#endif
@@ -1,156 +1,419 @@
 #include <stdbool.h>
 #include <stdint.h>
-#include "nrfx_systick.h"
+#include <string.h>
 #include "nrf_gpio.h"
-#include "nrf_delay.h"
 #include "nrfx_gpiote.h"
+#include "nrf_drv_clock.h"
 #include "app_timer.h"
+#include "led_pins.h"
+#include "led_render.h"
+#include "blink_sequencer.h"
+#include "idle.h"
+#include "hires_timer.h"
+#include "event_queue.h"
+#include "button_debounce.h"
+#include "gesture.h"
+#include "usb_link.h"
+#include "led_command.h"
+#include "led_stream.h"
+#include "settings.h"
+#include "profiler.h"
+#include "instrument.h"
+#include "trace.h"
+#include "dlog.h"
+#include "pwm_selftest.h"
+#include "boot.h"
 
-// Convert port and pin into pin number
-#define YELLOW_LED_PIN  NRF_GPIO_PIN_MAP(0,6)
-#define RED_LED_PIN  NRF_GPIO_PIN_MAP(0,8)
-#define GREEN_LED_PIN  NRF_GPIO_PIN_MAP(1,9)
-#define BLUE_LED_PIN  NRF_GPIO_PIN_MAP(0,12)
 #define BUTTON_PIN  NRF_GPIO_PIN_MAP(1,6)
 
-#define LEDS_NUMBER 4
+// Gestures the application reacts to. With triple click disabled a double
+// click is reported on its second release.
+#define GESTURES_ENABLED GESTURE_MASK(GESTURE_DOUBLE_CLICK)
 
-// PWM frequency and period calculation
-#define PWM_FREQUENCY 1000            // 1 kHz PWM frequency
-#define PERIOD_US (6000000 / PWM_FREQUENCY)  // Total period in microseconds
+// Timers for gesture and debounce deadlines
+APP_TIMER_DEF(gesture_timer);
+APP_TIMER_DEF(debounce_timer);
+static button_debounce_t debounce;
+static gesture_t gesture;
+static bool is_blinking_active = false;    // Flag to control LED blinking
 
-// Timer for double-click detection
-APP_TIMER_DEF(double_click_timer);
-static volatile bool awaiting_second_click = false; // Flag for double-click detection
-static volatile bool is_blinking_active = false;   // Flag to control LED blinking
+// Settings of a device whose flash has none
+static const settings_t settings_defaults =
+{
+    .digits       = {7, 2, 1, 4},
+    .brightness   = 255,
+    .blinking     = 0,
+    .speed        = 100,
+    .click_gap_ms = GESTURE_CLICK_GAP_MS
+};
 
 // Timer timeout handler
-void double_click_timeout_handler(void* p_context)
+void gesture_timeout_handler(void* p_context)
 {
-    awaiting_second_click = false; // Reset the flag for double-click detection
+    event_queue_put(EVENT_GESTURE_TIMEOUT, 0);
 }
 
-// Button event handler
+void debounce_timeout_handler(void* p_context)
+{
+    event_queue_put(EVENT_DEBOUNCE_TIMEOUT, 0);
+}
+
+// Button event handler, called for both edges. The event queue stamps the
+// edge with the RTC counter, the button is active low.
 void button_event_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
 {
+    INSTRUMENT_BEGIN(BUTTON_IRQ);
+
     if (pin == BUTTON_PIN)
     {
-        if (awaiting_second_click)
-        {
-            // Double-click detected
-            awaiting_second_click = false;
-            app_timer_stop(double_click_timer);
-
-            // Toggle blinking state on double-click
-            is_blinking_active = !is_blinking_active;
+        bool pressed = !nrf_gpio_pin_read(BUTTON_PIN);
 
-            // If blinking is turned off, ensure all LEDs are turned off immediately
-            if (!is_blinking_active)
-            {
-                nrf_gpio_pin_write(YELLOW_LED_PIN, 1);
-                nrf_gpio_pin_write(RED_LED_PIN, 1);
-                nrf_gpio_pin_write(GREEN_LED_PIN, 1);
-                nrf_gpio_pin_write(BLUE_LED_PIN, 1);
-            }
-        }
-        else
-        {
-            awaiting_second_click = true;
-            app_timer_start(double_click_timer, APP_TIMER_TICKS(500), NULL); // 500ms interval for double-click
-        }
+        TRACE(TRACE_BUTTON_IRQ, pressed, 0);
+        event_queue_put(EVENT_BUTTON_EDGE, pressed);
     }
+
+    INSTRUMENT_END(BUTTON_IRQ);
 }
 
-void init_gpiote_double_click()
+// One OUTSET per port, the masks are constants
+void led_off(void)
 {
-    if (!nrfx_gpiote_is_init())
-    {
-        nrfx_gpiote_init();
-    }
+    led_pins_set(LED_PINS_MASKS(LED_PINS_ALL));
+}
 
+// Outputs, off until the settings say otherwise. OUT is set before the pins
+// turn into outputs, the LEDs do not flash on.
+static void leds_init(void)
+{
+    led_off();
     nrf_gpio_cfg_output(YELLOW_LED_PIN);
     nrf_gpio_cfg_output(RED_LED_PIN);
     nrf_gpio_cfg_output(GREEN_LED_PIN);
     nrf_gpio_cfg_output(BLUE_LED_PIN);
+}
+
+static void button_init(void)
+{
+    if (!nrfx_gpiote_is_init())
+    {
+        nrfx_gpiote_init();
+    }
 
-    nrfx_gpiote_in_config_t config = NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(true); // Sense falling edge (press)
+    nrfx_gpiote_in_config_t config = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true); // Sense press and release for the debouncer
     config.pull = NRF_GPIO_PIN_PULLUP;
 
     nrfx_gpiote_in_init(BUTTON_PIN, &config, button_event_handler);
     nrfx_gpiote_in_event_enable(BUTTON_PIN, true);
 }
 
-void systick_delay_us(uint32_t delay_us)
+// Wake up at a debouncer or gesture deadline, a deadline that has already
+// passed fires as soon as possible
+static void timer_deadline_set(app_timer_id_t timer, bool pending, uint32_t deadline)
+{
+    app_timer_stop(timer);
+    if (pending)
+    {
+        uint32_t ticks = app_timer_cnt_diff_compute(deadline, app_timer_cnt_get());
+        if (ticks < APP_TIMER_MIN_TIMEOUT_TICKS || ticks > APP_TIMER_MAX_CNT_VAL / 2)
+        {
+            ticks = APP_TIMER_MIN_TIMEOUT_TICKS;
+        }
+        app_timer_start(timer, ticks, NULL);
+    }
+}
+
+// The blinking state of the settings, a double click or START/STOP from the host
+static void blinking_set(bool active)
 {
-    nrfx_systick_state_t start;
-    nrfx_systick_get(&start);
-    while (!nrfx_systick_test(&start, delay_us));
+    is_blinking_active = active;
+
+    // A host stream has the LEDs, the pattern follows when it ends
+    if (led_stream_is_running())
+    {
+        return;
+    }
+
+    if (is_blinking_active)
+    {
+        blink_sequencer_start();
+    }
+    else
+    {
+        // If blinking is turned off, ensure all LEDs are turned off immediately
+        blink_sequencer_stop();
+        led_off();
+    }
 }
 
-// Simulate PWM for LED dimming
-void pwm_dimming_led(int led_pin, int duty_cycle)
+// The host starts or ends an LED stream
+static void streaming_set(bool streaming)
 {
-    int timeOn = (duty_cycle * PERIOD_US) / 100;   // On time
-    int timeOff = PERIOD_US - timeOn;             // Off time
+    if (streaming)
+    {
+        blink_sequencer_stop();
+    }
+    else
+    {
+        blinking_set(is_blinking_active);
+    }
+}
 
-    nrf_gpio_pin_write(led_pin, 0);
-    systick_delay_us(timeOn);
+// New settings, from a double click or the host: the changed ones take effect
+static void settings_apply(settings_t const * p_settings)
+{
+    blink_sequencer_settings_t current;
 
-    nrf_gpio_pin_write(led_pin, 1);
-    systick_delay_us(timeOff);
+    blink_sequencer_settings_get(&current);
+    if (memcmp(current.digits, p_settings->digits, sizeof(p_settings->digits)) != 0)
+    {
+        blink_sequencer_digits_set(p_settings->digits);
+    }
+    blink_sequencer_brightness_set(p_settings->brightness);
+    blink_sequencer_speed_set(p_settings->speed);
+
+    if (APP_TIMER_TICKS(p_settings->click_gap_ms) != gesture.config.click_gap_ticks)
+    {
+        gesture_config_t config = gesture.config;
+
+        config.click_gap_ticks = APP_TIMER_TICKS(p_settings->click_gap_ms);
+        gesture_config_set(&gesture, &config);
+    }
+
+    if (p_settings->blinking != is_blinking_active)
+    {
+        blinking_set(p_settings->blinking);
+    }
 }
 
-void led_off(void)
+static void gesture_output_process(gesture_event_t const * p_event)
 {
-    nrf_gpio_pin_write(YELLOW_LED_PIN, 1);
-    nrf_gpio_pin_write(RED_LED_PIN, 1);
-    nrf_gpio_pin_write(GREEN_LED_PIN, 1);
-    nrf_gpio_pin_write(BLUE_LED_PIN, 1);
+    TRACE(TRACE_GESTURE, p_event->type, p_event->count);
+
+    if (p_event->type == GESTURE_DOUBLE_CLICK)
+    {
+        // Toggle blinking state on double-click, kept over resets
+        settings_t settings = *settings_get();
+
+        settings.blinking = !is_blinking_active;
+        DLOG_INFO("double click, blinking %u", settings.blinking);
+        settings_update(&settings);
+    }
+    else
+    {
+        // Other gestures are events the pattern can branch on
+        blink_sequencer_event_post(p_event->type);
+    }
+}
+
+static void gesture_timer_update(void)
+{
+    uint32_t deadline;
+    bool pending = gesture_deadline(&gesture, &deadline);
+
+    timer_deadline_set(gesture_timer, pending, deadline);
+}
+
+static void gesture_timeout_process(uint32_t timestamp)
+{
+    INSTRUMENT_BEGIN(GESTURE_TIMEOUT);
+    gesture_event_t output;
+
+    if (gesture_timeout(&gesture, timestamp, &output))
+    {
+        gesture_output_process(&output);
+    }
+    gesture_timer_update();
+
+    INSTRUMENT_END(GESTURE_TIMEOUT);
+}
+
+// Debounced press or release
+static void debounce_output_process(button_debounce_event_t const * p_event)
+{
+    gesture_event_t output;
+
+    if (gesture_timeout(&gesture, p_event->timestamp, &output))
+    {
+        gesture_output_process(&output);
+    }
+    if (gesture_edge(&gesture, p_event->pressed, p_event->timestamp, &output))
+    {
+        gesture_output_process(&output);
+    }
+    gesture_timer_update();
+}
+
+static void debounce_timer_update(void)
+{
+    uint32_t deadline;
+    bool pending = button_debounce_deadline(&debounce, &deadline);
+
+    timer_deadline_set(debounce_timer, pending, deadline);
+}
+
+static void debounce_timeout_process(uint32_t timestamp)
+{
+    INSTRUMENT_BEGIN(DEBOUNCE_TIMEOUT);
+    button_debounce_event_t output;
+
+    if (button_debounce_timeout(&debounce, timestamp, &output))
+    {
+        debounce_output_process(&output);
+    }
+    debounce_timer_update();
+
+    INSTRUMENT_END(DEBOUNCE_TIMEOUT);
+}
+
+static void button_edge_process(uint32_t timestamp, bool pressed)
+{
+    INSTRUMENT_BEGIN(BUTTON_EDGE);
+    button_debounce_event_t output;
+
+    // A window that ended before this edge is closed first
+    if (button_debounce_timeout(&debounce, timestamp, &output))
+    {
+        debounce_output_process(&output);
+    }
+    if (button_debounce_edge(&debounce, pressed, timestamp, &output))
+    {
+        debounce_output_process(&output);
+    }
+    debounce_timer_update();
+
+    INSTRUMENT_END(BUTTON_EDGE);
+}
+
+// USB and the diagnostics, nothing the LEDs or the button need. From the main
+// loop once VBUS is there or it has nothing else to do, see boot.h.
+static void deferred_init(void)
+{
+    settings_t const * p_settings = settings_get();
+
+    usb_link_init();
+    led_command_init();
+    led_stream_init(streaming_set);
+    boot_link_init();
+    boot_stamp(BOOT_STAGE_USB);
+
+    profiler_init();
+    instrument_init();
+    pwm_selftest_init();
+    boot_stamp(BOOT_STAGE_DIAGNOSTICS);
+
+    DLOG_INFO("started, device_id %u%u%u%u", p_settings->digits[0], p_settings->digits[1],
+              p_settings->digits[2], p_settings->digits[3]);
+    DLOG_INFO("boot: first light %u us, usb %u us", boot_stage_us(BOOT_STAGE_FIRST_LIGHT),
+              boot_stage_us(BOOT_STAGE_USB));
 }
 
 int main(void)
 {
-    nrfx_systick_init();
-    init_gpiote_double_click();
+    const uint32_t led_pins[LEDS_NUMBER] = {YELLOW_LED_PIN, RED_LED_PIN, GREEN_LED_PIN, BLUE_LED_PIN};
+    settings_t const * p_settings;
+    gesture_config_t gesture_config =
+    {
+        .long_press_ticks = APP_TIMER_TICKS(GESTURE_LONG_PRESS_MS),
+        .repeat_ticks     = APP_TIMER_TICKS(GESTURE_REPEAT_MS)
+    };
 
-    const int device_id[LEDS_NUMBER] = {7, 2, 1, 4};
-    const int led_pins[LEDS_NUMBER] = {YELLOW_LED_PIN, RED_LED_PIN, GREEN_LED_PIN, BLUE_LED_PIN};
+    // RAM only, anything may trace or log from here on
+    boot_init();
+    trace_init();
+    dlog_init();
 
-    int current_led = 0;
-    int next_blink = 0;
+    // app_timer (RTC1) and hires_timer (RTC2) need the low frequency clock,
+    // the crystal starts while the rest comes up
+    nrf_drv_clock_init();
+    nrf_drv_clock_lfclk_request(NULL);
+    boot_stamp(BOOT_STAGE_CLOCK);
 
-    int duty_cycle = 0;
-    int fade_step = 1;
+    leds_init();
+    boot_stamp(BOOT_STAGE_LEDS);
+
+    app_timer_init();
+    app_timer_create(&gesture_timer, APP_TIMER_MODE_SINGLE_SHOT, gesture_timeout_handler);
+    app_timer_create(&debounce_timer, APP_TIMER_MODE_SINGLE_SHOT, debounce_timeout_handler);
+    settings_init(&settings_defaults, settings_apply);
+    p_settings = settings_get();
+    hires_timer_init();
+    event_queue_init();
+    idle_init();
+    boot_stamp(BOOT_STAGE_TIMERS);
+
+    gesture_config.click_gap_ticks = APP_TIMER_TICKS(p_settings->click_gap_ms);  // GESTURE_CLICK_GAP_MS by default
+    button_debounce_init(&debounce, BUTTON_DEBOUNCE_POLICY, APP_TIMER_TICKS(BUTTON_DEBOUNCE_MS), false);
+    gesture_init(&gesture, &gesture_config, GESTURES_ENABLED);
+    button_init();
+    boot_stamp(BOOT_STAGE_BUTTON);
+
+    // Brightness, speed and the blinking state as they were before the reset
+    blink_sequencer_init(led_pins, p_settings->digits, LED_RENDER_MODE);
     led_off();
+    settings_apply(p_settings);
+    boot_stamp(BOOT_STAGE_FIRST_LIGHT);
 
     while (true)
     {
-        if (is_blinking_active)
+        INSTRUMENT_BEGIN(MAIN_LOOP);
+        event_t event;
+
+        // USB as soon as a host powers the bus
+        if (boot_deferred_due(false))
         {
-            for (int i = current_led; i < LEDS_NUMBER; i++)
+            deferred_init();
+        }
+
+        // Interrupts only queue events, all the work happens here in queue order
+        while (event_queue_get(&event))
+        {
+            TRACE(TRACE_EVENT_BEGIN, event.type, event.timestamp);
+
+            switch (event.type)
             {
-                for (int j = next_blink; j < device_id[i]; j++)
-                {
-                    if (!is_blinking_active) break; // Stop blinking if the flag is toggled off
-
-                    for (duty_cycle = 0; duty_cycle <= 100; duty_cycle += fade_step)
-                    {
-                        pwm_dimming_led(led_pins[i], duty_cycle);
-                        if (!is_blinking_active) break; // Stop smoothly
-                    }
-
-                    for (duty_cycle = 100; duty_cycle >= 0; duty_cycle -= fade_step)
-                    {
-                        pwm_dimming_led(led_pins[i], duty_cycle);
-                        if (!is_blinking_active) break;
-                    }
-                }
-                if (!is_blinking_active) break;
-
-                next_blink = 0;
-                nrf_delay_ms(1000);
+                case EVENT_BUTTON_EDGE:
+                    button_edge_process(event.timestamp, event.arg);
+                    break;
+
+                case EVENT_DEBOUNCE_TIMEOUT:
+                    debounce_timeout_process(event.timestamp);
+                    break;
+
+                case EVENT_GESTURE_TIMEOUT:
+                    gesture_timeout_process(event.timestamp);
+                    break;
+
+                default:
+                    blink_sequencer_event_handle(&event);
+                    break;
             }
-            if (!is_blinking_active) led_off(); // Ensure LEDs are off
+
+            TRACE(TRACE_EVENT_END, event.type, 0);
         }
+
+        if (boot_is_complete())
+        {
+            usb_link_process();
+            profiler_process();
+            instrument_process();
+            pwm_selftest_process();
+        }
+        trace_process();
+        dlog_process();
+        led_stream_process();
+        settings_process();
+
+        INSTRUMENT_END(MAIN_LOOP);
+
+        // The first time there is nothing to do, the deferred stages instead
+        // of sleeping
+        if (boot_deferred_due(true))
+        {
+            deferred_init();
+            continue;
+        }
+
+        // Nothing left to do until the next button, PWM, timer or USB interrupt
+        idle_wait();
     }
 }
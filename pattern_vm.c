@@ -0,0 +1,481 @@
+#include <string.h>
+#include "pattern_vm.h"
+
+#define CHANNEL_MASK ((1U << PATTERN_VM_CHANNELS) - 1)
+
+// Bytes of every op with its operands
+static const uint8_t m_op_size[PATTERN_OP_COUNT] =
+{
+    [PATTERN_OP_END]          = 1,
+    [PATTERN_OP_SET]          = 3,
+    [PATTERN_OP_FADE]         = 6,
+    [PATTERN_OP_BLINK]        = 5,
+    [PATTERN_OP_BLINK_VAR]    = 4,
+    [PATTERN_OP_WAIT]         = 3,
+    [PATTERN_OP_LOOP]         = 2,
+    [PATTERN_OP_LOOP_VAR]     = 2,
+    [PATTERN_OP_LOOP_MAX]     = 1,
+    [PATTERN_OP_NEXT]         = 1,
+    [PATTERN_OP_JUMP]         = 3,
+    [PATTERN_OP_JZ]           = 4,
+    [PATTERN_OP_BRANCH_EVENT] = 4,
+};
+
+static uint16_t u16_at(uint8_t const * p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// 0..255 to Q16, 255 is full scale
+static uint32_t level_q16(uint8_t level)
+{
+    return level * 257UL + (level >> 7);
+}
+
+// Innermost LOOP around addr (0xFFFF at top level), addr an op boundary.
+// false if addr is not the start of an op.
+static bool enclosing_loop(uint8_t const * p_code, uint16_t addr, uint16_t * p_loop)
+{
+    uint16_t stack[PATTERN_VM_LOOP_DEPTH + 1] = {0xFFFF};
+    uint8_t depth = 0;
+    uint16_t pc = 0;
+
+    while (pc < addr)
+    {
+        uint8_t op = p_code[pc];
+
+        if (op == PATTERN_OP_LOOP || op == PATTERN_OP_LOOP_VAR || op == PATTERN_OP_LOOP_MAX)
+        {
+            stack[++depth] = pc;
+        }
+        else if (op == PATTERN_OP_NEXT)
+        {
+            depth--;
+        }
+        pc += m_op_size[op];
+    }
+    *p_loop = stack[depth];
+
+    return pc == addr;
+}
+
+// Operands in range, loops balanced and not too deep
+static bool ops_check(uint8_t const * p_code, uint16_t length)
+{
+    uint8_t depth = 0;
+    uint16_t pc = 0;
+
+    while (pc < length)
+    {
+        uint8_t const * p = &p_code[pc];
+        uint8_t op = p[0];
+
+        if (op >= PATTERN_OP_COUNT || pc + m_op_size[op] > length)
+        {
+            return false;
+        }
+
+        switch (op)
+        {
+            case PATTERN_OP_SET:
+                if (p[1] & ~CHANNEL_MASK)
+                {
+                    return false;
+                }
+                break;
+
+            case PATTERN_OP_FADE:
+                if ((p[1] & ~CHANNEL_MASK) || p[5] >= LED_EASING_COUNT)
+                {
+                    return false;
+                }
+                break;
+
+            // Blinks take twice their time, which has to fit into 16 bits
+            case PATTERN_OP_BLINK:
+                if ((p[1] & ~CHANNEL_MASK) || u16_at(&p[2]) > UINT16_MAX / 2 ||
+                    p[4] >= LED_EASING_COUNT)
+                {
+                    return false;
+                }
+                break;
+
+            case PATTERN_OP_BLINK_VAR:
+                if (u16_at(&p[1]) > UINT16_MAX / 2 || p[3] >= LED_EASING_COUNT)
+                {
+                    return false;
+                }
+                break;
+
+            case PATTERN_OP_LOOP_VAR:
+                if (p[1] >= PATTERN_VM_VARS)
+                {
+                    return false;
+                }
+                // Fall through
+            case PATTERN_OP_LOOP:
+            case PATTERN_OP_LOOP_MAX:
+                if (++depth > PATTERN_VM_LOOP_DEPTH)
+                {
+                    return false;
+                }
+                break;
+
+            case PATTERN_OP_NEXT:
+                if (depth-- == 0)
+                {
+                    return false;
+                }
+                break;
+
+            case PATTERN_OP_JZ:
+                if (p[1] >= PATTERN_VM_VARS)
+                {
+                    return false;
+                }
+                break;
+
+            case PATTERN_OP_BRANCH_EVENT:
+                if (p[1] >= PATTERN_VM_EVENTS)
+                {
+                    return false;
+                }
+                break;
+
+            default:
+                break;
+        }
+        pc += m_op_size[op];
+    }
+
+    return depth == 0;
+}
+
+// Every jump lands on an op inside the same loops, after ops_check()
+static bool jumps_check(uint8_t const * p_code, uint16_t length)
+{
+    for (uint16_t pc = 0; pc < length; pc += m_op_size[p_code[pc]])
+    {
+        uint8_t const * p = &p_code[pc];
+        uint16_t from_loop;
+        uint16_t to_loop;
+        uint16_t target;
+
+        if (p[0] == PATTERN_OP_JUMP)
+        {
+            target = u16_at(&p[1]);
+        }
+        else if (p[0] == PATTERN_OP_JZ || p[0] == PATTERN_OP_BRANCH_EVENT)
+        {
+            target = u16_at(&p[2]);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (target >= length ||
+            !enclosing_loop(p_code, pc, &from_loop) ||
+            !enclosing_loop(p_code, target, &to_loop) ||
+            from_loop != to_loop)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// pc after the NEXT that closes the loop starting at pc
+static uint16_t loop_skip(uint8_t const * p_code, uint16_t pc)
+{
+    uint8_t depth = 0;
+
+    do
+    {
+        uint8_t op = p_code[pc];
+
+        if (op == PATTERN_OP_LOOP || op == PATTERN_OP_LOOP_VAR || op == PATTERN_OP_LOOP_MAX)
+        {
+            depth++;
+        }
+        else if (op == PATTERN_OP_NEXT)
+        {
+            depth--;
+        }
+        pc += m_op_size[op];
+    } while (depth != 0);
+
+    return pc;
+}
+
+static void loop_enter(pattern_vm_t * p_vm, uint16_t pc, uint8_t count, bool forever)
+{
+    if (count == 0 && !forever)
+    {
+        p_vm->pc = loop_skip(p_vm->p_code, pc);
+        return;
+    }
+
+    pattern_vm_loop_t * p_loop = &p_vm->loops[p_vm->depth++];
+    p_loop->start = pc + m_op_size[p_vm->p_code[pc]];
+    p_loop->left = count - 1;
+    p_loop->index = 0;
+    p_loop->forever = forever;
+    p_vm->pc = p_loop->start;
+}
+
+// Keyframes of every channel: the ones in mask go from their level to level
+// (or blink up and down with blink set), the others hold theirs
+static void fade_prepare(pattern_vm_t * p_vm, pattern_vm_action_t * p_action, uint8_t mask,
+                         uint8_t level, uint16_t ms, uint8_t easing, bool blink)
+{
+    p_action->type = PATTERN_VM_ACTION_FADE;
+    p_action->duration_ms = blink ? 2 * ms : ms;
+    p_action->lit_mask = 0;
+    // Unused keyframes zeroed, so equal actions compare equal byte for byte
+    memset(p_action->keyframes, 0, sizeof(p_action->keyframes));
+
+    for (int i = 0; i < PATTERN_VM_CHANNELS; i++)
+    {
+        led_keyframe_t * p_keyframes = p_action->keyframes[i];
+        uint32_t from = level_q16(p_vm->level[i]);
+
+        p_action->timelines[i].p_keyframes = p_keyframes;
+        p_keyframes[0] = (led_keyframe_t){0, easing, from};
+
+        if (!(mask & (1 << i)))
+        {
+            p_action->timelines[i].count = 1;
+        }
+        else if (blink)
+        {
+            p_keyframes[0].level = 0;
+            p_keyframes[1] = (led_keyframe_t){ms, easing, LED_ANIMATION_FULL};
+            p_keyframes[2] = (led_keyframe_t){(uint16_t)(2 * ms), LED_EASING_LINEAR, 0};
+            p_action->timelines[i].count = 3;
+            p_vm->level[i] = 0;
+        }
+        else
+        {
+            p_keyframes[1] = (led_keyframe_t){ms, LED_EASING_LINEAR, level_q16(level)};
+            p_action->timelines[i].count = 2;
+            p_vm->level[i] = level;
+        }
+
+        if (from != 0 || ((mask & (1 << i)) && (blink || level != 0)))
+        {
+            p_action->lit_mask |= 1 << i;
+        }
+    }
+}
+
+bool pattern_vm_load(pattern_vm_t * p_vm, uint8_t const * p_code, uint16_t length)
+{
+    if (length == 0 || !ops_check(p_code, length) || !jumps_check(p_code, length))
+    {
+        p_vm->p_code = NULL;
+        return false;
+    }
+
+    p_vm->p_code = p_code;
+    p_vm->length = length;
+    p_vm->ops = 0;
+    pattern_vm_restart(p_vm);
+
+    return true;
+}
+
+void pattern_vm_restart(pattern_vm_t * p_vm)
+{
+    p_vm->pc = 0;
+    p_vm->depth = 0;
+    p_vm->events = 0;
+    p_vm->action_fade = false;
+    memset(p_vm->level, 0, sizeof(p_vm->level));
+}
+
+void pattern_vm_interrupt(pattern_vm_t * p_vm)
+{
+    if (p_vm->action_fade)
+    {
+        p_vm->pc = p_vm->action_pc;
+    }
+    p_vm->action_fade = false;
+    memset(p_vm->level, 0, sizeof(p_vm->level));
+}
+
+void pattern_vm_var_set(pattern_vm_t * p_vm, uint8_t var, uint8_t value)
+{
+    if (var < PATTERN_VM_VARS)
+    {
+        p_vm->vars[var] = value;
+    }
+}
+
+void pattern_vm_event_post(pattern_vm_t * p_vm, uint8_t event)
+{
+    if (event < PATTERN_VM_EVENTS)
+    {
+        p_vm->events |= 1 << event;
+    }
+}
+
+void pattern_vm_step(pattern_vm_t * p_vm, pattern_vm_action_t * p_action)
+{
+    uint8_t const * p_code = p_vm->p_code;
+
+    p_action->type = PATTERN_VM_ACTION_ERROR;
+    p_action->duration_ms = 0;
+    p_action->lit_mask = 0;
+    if (p_code == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t budget = PATTERN_VM_STEP_BUDGET; budget != 0; budget--)
+    {
+        uint16_t pc = p_vm->pc;
+        uint8_t const * p = &p_code[pc];
+
+        // Ran off the end: stop like END
+        if (pc >= p_vm->length)
+        {
+            p_vm->action_fade = false;
+            p_action->type = PATTERN_VM_ACTION_END;
+            return;
+        }
+
+        p_vm->ops++;
+        switch (p[0])
+        {
+            case PATTERN_OP_END:
+                p_vm->action_fade = false;
+                p_action->type = PATTERN_VM_ACTION_END;
+                return;
+
+            case PATTERN_OP_SET:
+                for (int i = 0; i < PATTERN_VM_CHANNELS; i++)
+                {
+                    if (p[1] & (1 << i))
+                    {
+                        p_vm->level[i] = p[2];
+                    }
+                }
+                p_vm->pc = pc + 3;
+                break;
+
+            case PATTERN_OP_FADE:
+                fade_prepare(p_vm, p_action, p[1], p[2], u16_at(&p[3]), p[5], false);
+                p_vm->action_pc = pc;
+                p_vm->action_fade = true;
+                p_vm->pc = pc + 6;
+                return;
+
+            case PATTERN_OP_BLINK:
+                fade_prepare(p_vm, p_action, p[1], 0, u16_at(&p[2]), p[4], true);
+                p_vm->action_pc = pc;
+                p_vm->action_fade = true;
+                p_vm->pc = pc + 5;
+                return;
+
+            case PATTERN_OP_BLINK_VAR:
+            {
+                uint8_t index = p_vm->depth ? p_vm->loops[p_vm->depth - 1].index : 0;
+                uint8_t mask = 0;
+
+                for (int i = 0; i < PATTERN_VM_CHANNELS; i++)
+                {
+                    if (p_vm->vars[i] > index)
+                    {
+                        mask |= 1 << i;
+                    }
+                }
+                p_vm->pc = pc + 4;
+                if (mask != 0)
+                {
+                    fade_prepare(p_vm, p_action, mask, 0, u16_at(&p[1]), p[3], true);
+                    p_vm->action_pc = pc;
+                    p_vm->action_fade = true;
+                    return;
+                }
+                break;
+            }
+
+            // Every channel holds its level
+            case PATTERN_OP_WAIT:
+                fade_prepare(p_vm, p_action, 0, 0, u16_at(&p[1]), LED_EASING_LINEAR, false);
+                p_action->type = PATTERN_VM_ACTION_WAIT;
+                p_vm->action_fade = false;
+                p_vm->pc = pc + 3;
+                return;
+
+            case PATTERN_OP_LOOP:
+                loop_enter(p_vm, pc, p[1], p[1] == 0);
+                break;
+
+            case PATTERN_OP_LOOP_VAR:
+                loop_enter(p_vm, pc, p_vm->vars[p[1]], false);
+                break;
+
+            case PATTERN_OP_LOOP_MAX:
+            {
+                uint8_t count = 0;
+
+                for (int i = 0; i < PATTERN_VM_CHANNELS; i++)
+                {
+                    if (p_vm->vars[i] > count)
+                    {
+                        count = p_vm->vars[i];
+                    }
+                }
+                loop_enter(p_vm, pc, count, false);
+                break;
+            }
+
+            case PATTERN_OP_NEXT:
+            {
+                pattern_vm_loop_t * p_loop = &p_vm->loops[p_vm->depth - 1];
+
+                if (p_loop->forever || p_loop->left != 0)
+                {
+                    if (!p_loop->forever)
+                    {
+                        p_loop->left--;
+                    }
+                    p_loop->index++;
+                    p_vm->pc = p_loop->start;
+                }
+                else
+                {
+                    p_vm->depth--;
+                    p_vm->pc = pc + 1;
+                }
+                break;
+            }
+
+            case PATTERN_OP_JUMP:
+                p_vm->pc = u16_at(&p[1]);
+                break;
+
+            case PATTERN_OP_JZ:
+                p_vm->pc = p_vm->vars[p[1]] == 0 ? u16_at(&p[2]) : pc + 4;
+                break;
+
+            case PATTERN_OP_BRANCH_EVENT:
+                if (p_vm->events & (1 << p[1]))
+                {
+                    p_vm->events &= ~(1 << p[1]);
+                    p_vm->pc = u16_at(&p[2]);
+                }
+                else
+                {
+                    p_vm->pc = pc + 4;
+                }
+                break;
+
+            default:
+                return;
+        }
+    }
+}
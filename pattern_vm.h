@@ -0,0 +1,143 @@
+#ifndef PATTERN_VM_H
+#define PATTERN_VM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "led_animation.h"
+
+// Interpreter for LED pattern bytecode. A program is a byte string of ops,
+// each an opcode byte followed by its operands (16-bit ones little endian).
+// The VM runs the ops that take no time until it reaches one that does and
+// returns it as an action (fade or wait) for the caller to play; the next
+// pattern_vm_step() continues after it. Everything lives in pattern_vm_t, no
+// heap. Hardware independent.
+//
+// Programs refer to PATTERN_VM_VARS byte variables the firmware sets (the
+// device_id digits for the built-in patterns) and branch on event bits it
+// posts. pattern_vm_load() checks a program once, stepping does not check
+// operands again.
+//
+//   op              operands                  time
+//   END                                       stops the program
+//   SET             mask level                no, levels are 0..255
+//   FADE            mask level ms16 easing    ms, from the current levels
+//   BLINK           mask ms16 easing          2 * ms, up to full and back to 0
+//   BLINK_VAR       ms16 easing               like BLINK, the channels whose variable
+//                                             is above the index of the innermost loop
+//   WAIT            ms16                      ms, levels held
+//   LOOP            count                     body up to NEXT count times, 0: forever
+//   LOOP_VAR        var                       count from a variable
+//   LOOP_MAX                                  count: the largest channel variable
+//   NEXT
+//   JUMP            addr16
+//   JZ              var addr16                jump if the variable is 0
+//   BRANCH_EVENT    event addr16              jump and clear if the event bit is set
+//
+// A loop with a count of 0 (LOOP_VAR, LOOP_MAX) skips its body. Loops nest
+// up to PATTERN_VM_LOOP_DEPTH deep, and a jump stays inside the loops it is
+// in: its target has the same enclosing loops.
+
+#define PATTERN_VM_CHANNELS   4
+#define PATTERN_VM_VARS       8
+#define PATTERN_VM_LOOP_DEPTH 4
+#define PATTERN_VM_EVENTS     8
+
+// Ops run by one pattern_vm_step() at most before it gives up on a program
+// that never takes time
+#define PATTERN_VM_STEP_BUDGET 256
+
+typedef enum
+{
+    PATTERN_OP_END,
+    PATTERN_OP_SET,
+    PATTERN_OP_FADE,
+    PATTERN_OP_BLINK,
+    PATTERN_OP_BLINK_VAR,
+    PATTERN_OP_WAIT,
+    PATTERN_OP_LOOP,
+    PATTERN_OP_LOOP_VAR,
+    PATTERN_OP_LOOP_MAX,
+    PATTERN_OP_NEXT,
+    PATTERN_OP_JUMP,
+    PATTERN_OP_JZ,
+    PATTERN_OP_BRANCH_EVENT,
+    PATTERN_OP_COUNT
+} pattern_op_t;
+
+// Bytecode in C initializers
+#define PATTERN_U16(value)    (uint8_t)((value) & 0xFF), (uint8_t)(((value) >> 8) & 0xFF)
+
+#define PATTERN_END()                          PATTERN_OP_END
+#define PATTERN_SET(mask, level)               PATTERN_OP_SET, (mask), (level)
+#define PATTERN_FADE(mask, level, ms, easing)  PATTERN_OP_FADE, (mask), (level), PATTERN_U16(ms), (easing)
+#define PATTERN_BLINK(mask, ms, easing)        PATTERN_OP_BLINK, (mask), PATTERN_U16(ms), (easing)
+#define PATTERN_BLINK_VAR(ms, easing)          PATTERN_OP_BLINK_VAR, PATTERN_U16(ms), (easing)
+#define PATTERN_WAIT(ms)                       PATTERN_OP_WAIT, PATTERN_U16(ms)
+#define PATTERN_LOOP(count)                    PATTERN_OP_LOOP, (count)
+#define PATTERN_LOOP_VAR(var)                  PATTERN_OP_LOOP_VAR, (var)
+#define PATTERN_LOOP_MAX()                     PATTERN_OP_LOOP_MAX
+#define PATTERN_NEXT()                         PATTERN_OP_NEXT
+#define PATTERN_JUMP(addr)                     PATTERN_OP_JUMP, PATTERN_U16(addr)
+#define PATTERN_JZ(var, addr)                  PATTERN_OP_JZ, (var), PATTERN_U16(addr)
+#define PATTERN_BRANCH_EVENT(event, addr)      PATTERN_OP_BRANCH_EVENT, (event), PATTERN_U16(addr)
+
+typedef enum
+{
+    PATTERN_VM_ACTION_FADE,     // play the timelines
+    PATTERN_VM_ACTION_WAIT,     // hold the levels for duration_ms
+    PATTERN_VM_ACTION_END,
+    PATTERN_VM_ACTION_ERROR     // no program, or no time taken within the step budget
+} pattern_vm_action_type_t;
+
+typedef struct
+{
+    pattern_vm_action_type_t type;
+    uint16_t                 duration_ms;
+    uint8_t                  lit_mask;        // channels not at level 0 at any time of the action
+    // What every channel does, a channel that does not change holds its level
+    led_keyframe_t           keyframes[PATTERN_VM_CHANNELS][3];
+    led_timeline_t           timelines[PATTERN_VM_CHANNELS];
+} pattern_vm_action_t;
+
+typedef struct
+{
+    uint16_t start;      // first op of the body
+    uint8_t  left;       // iterations after this one
+    uint8_t  index;      // iteration, from 0
+    bool     forever;
+} pattern_vm_loop_t;
+
+typedef struct
+{
+    uint8_t const *   p_code;
+    uint16_t          length;
+    uint16_t          pc;
+    uint16_t          action_pc;      // op of the last FADE action, replayed after an interrupt
+    bool              action_fade;
+    uint8_t           depth;
+    pattern_vm_loop_t loops[PATTERN_VM_LOOP_DEPTH];
+    uint8_t           vars[PATTERN_VM_VARS];
+    uint8_t           events;         // PATTERN_VM_EVENTS bits
+    uint8_t           level[PATTERN_VM_CHANNELS];
+    uint32_t          ops;            // executed since load, for benchmarks
+} pattern_vm_t;
+
+// Check the program and start it from its first op, false if it is malformed.
+// The code must stay valid while the VM runs it. Variables are kept.
+bool pattern_vm_load(pattern_vm_t * p_vm, uint8_t const * p_code, uint16_t length);
+
+// Start over from the first op, levels off
+void pattern_vm_restart(pattern_vm_t * p_vm);
+
+// The last action was cut short and the LEDs are off: the next step plays an
+// interrupted fade again, a wait is dropped
+void pattern_vm_interrupt(pattern_vm_t * p_vm);
+
+void pattern_vm_var_set(pattern_vm_t * p_vm, uint8_t var, uint8_t value);
+
+void pattern_vm_event_post(pattern_vm_t * p_vm, uint8_t event);
+
+// Run to the next action
+void pattern_vm_step(pattern_vm_t * p_vm, pattern_vm_action_t * p_action);
+
+#endif
@@ -0,0 +1,40 @@
+#include <stddef.h>
+#include <string.h>
+#include "patterns.h"
+#include "led_render.h"
+
+// Bounds of the led_patterns section, from the linker
+extern patterns_entry_t const __start_led_patterns[];
+extern patterns_entry_t const __stop_led_patterns[];
+
+uint16_t patterns_count(void)
+{
+    return (uint16_t)(__stop_led_patterns - __start_led_patterns);
+}
+
+patterns_entry_t const * patterns_get(uint16_t index)
+{
+    return index < patterns_count() ? &__start_led_patterns[index] : NULL;
+}
+
+patterns_entry_t const * patterns_find(char const * p_name)
+{
+    for (patterns_entry_t const * p_entry = __start_led_patterns; p_entry < __stop_led_patterns; p_entry++)
+    {
+        if (strcmp(p_entry->p_name, p_name) == 0)
+        {
+            return p_entry;
+        }
+    }
+
+    return NULL;
+}
+
+uint8_t const * patterns_device_id(uint8_t mode, uint16_t * p_length)
+{
+    patterns_entry_t const * p_entry = patterns_find(mode == LED_RENDER_MODE_CONCURRENT ?
+                                                     "device_id_concurrent" : "device_id_sequential");
+
+    *p_length = p_entry != NULL ? p_entry->length : 0;
+    return p_entry != NULL ? p_entry->p_code : NULL;
+}
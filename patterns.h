@@ -0,0 +1,38 @@
+#ifndef PATTERNS_H
+#define PATTERNS_H
+
+#include <stdint.h>
+
+// Pattern VM programs (pattern_vm.h) shipped in the image. They are written
+// in patterns/*.pat and compiled by tools/pattern_compile.py into const
+// arrays with a table of them in the led_patterns section. The VM runs them
+// in place in flash: nothing is copied or parsed at boot, and RAM use does
+// not depend on the number of patterns.
+
+// Variable of the device_id digit of channel n
+#define PATTERNS_VAR_DIGIT(n) (n)
+
+// Pause after every LED (sequential) or every cycle (concurrent)
+#define PATTERNS_PAUSE_MS 1000
+
+// Layout of the generated table
+typedef struct
+{
+    char const *    p_name;
+    uint8_t const * p_code;
+    uint16_t        length;
+} patterns_entry_t;
+
+uint16_t patterns_count(void);
+
+// NULL past the end
+patterns_entry_t const * patterns_get(uint16_t index);
+
+// NULL if there is no such pattern
+patterns_entry_t const * patterns_find(char const * p_name);
+
+// The device_id digits as blinks of BLINK_FADE_MS up and down.
+// mode: LED_RENDER_MODE_SEQUENTIAL or _CONCURRENT
+uint8_t const * patterns_device_id(uint8_t mode, uint16_t * p_length);
+
+#endif
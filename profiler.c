@@ -0,0 +1,235 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#include <string.h>
+#include "nrf.h"
+#include "nrf_timer.h"
+#include "usb_link.h"
+
+// TIMER2 is not used through nrfx_timer (NRFX_TIMER2_ENABLED is 0), the
+// interrupt handler below needs the exception frame
+#define PROFILER_TIMER   NRF_TIMER2
+#define TICKS_PER_SAMPLE (1000000UL / PROFILER_RATE_HZ)
+
+#define ENTRIES_PER_FRAME (USB_LINK_MAX_PAYLOAD / sizeof(profiler_entry_t))
+
+// Vector table of the application, start of its code (gcc_startup_nrf52840.S)
+extern uint32_t const __isr_vector[];
+
+static uint32_t m_histogram[PROFILER_BUCKETS];
+static volatile uint32_t m_samples;
+static volatile uint32_t m_outside;
+static uint32_t m_code_start;
+static bool m_running;
+
+// Dump in progress: sampling is paused and resumed when the last entry is out
+static bool m_dumping;
+static bool m_info_sent;
+static bool m_resume;
+static uint32_t m_dump_bucket;
+
+void profiler_sample(uint32_t const * p_frame);
+
+void profiler_sample(uint32_t const * p_frame)
+{
+    nrf_timer_event_clear(PROFILER_TIMER, NRF_TIMER_EVENT_COMPARE0);
+
+    // Stacked r0-r3, r12, lr, pc, xpsr
+    uint32_t bucket = (p_frame[6] - m_code_start) >> PROFILER_BUCKET_SHIFT;
+    if (bucket < PROFILER_BUCKETS)
+    {
+        m_histogram[bucket]++;
+    }
+    else
+    {
+        m_outside++;
+    }
+    m_samples++;
+
+    // Read back so the event is cleared before the interrupt returns
+    (void)nrf_timer_event_check(PROFILER_TIMER, NRF_TIMER_EVENT_COMPARE0);
+}
+
+// Bit 2 of EXC_RETURN tells whether the interrupted code used MSP or PSP
+void TIMER2_IRQHandler(void) __attribute__((naked));
+void TIMER2_IRQHandler(void)
+{
+    __ASM volatile(
+        "tst   lr, #4           \n"
+        "ite   eq               \n"
+        "mrseq r0, msp          \n"
+        "mrsne r0, psp          \n"
+        "b     profiler_sample  \n");
+}
+
+// Sampling runs again if it did before the dump
+static void dump_end(void)
+{
+    m_dumping = false;
+    if (m_resume)
+    {
+        profiler_start();
+    }
+}
+
+static void ctrl_handler(uint8_t const * p_payload, uint16_t length)
+{
+    if (length < 1)
+    {
+        return;
+    }
+
+    switch (p_payload[0])
+    {
+        case PROFILER_CMD_STOP:
+            profiler_stop();
+            break;
+
+        case PROFILER_CMD_START:
+            profiler_start();
+            break;
+
+        case PROFILER_CMD_RESET:
+            profiler_reset();
+            break;
+
+        case PROFILER_CMD_DUMP:
+            if (!m_dumping)
+            {
+                m_resume = m_running;
+                profiler_stop();
+                m_dumping = true;
+                m_info_sent = false;
+                m_dump_bucket = 0;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void profiler_init(void)
+{
+    m_code_start = (uint32_t)__isr_vector;
+
+    nrf_timer_mode_set(PROFILER_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(PROFILER_TIMER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_frequency_set(PROFILER_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_cc_write(PROFILER_TIMER, NRF_TIMER_CC_CHANNEL0, TICKS_PER_SAMPLE);
+    nrf_timer_shorts_enable(PROFILER_TIMER, NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK);
+    nrf_timer_int_enable(PROFILER_TIMER, NRF_TIMER_INT_COMPARE0_MASK);
+
+    NVIC_SetPriority(TIMER2_IRQn, PROFILER_IRQ_PRIORITY);
+    NVIC_ClearPendingIRQ(TIMER2_IRQn);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+
+    usb_link_handler_set(USB_LINK_MSG_PROFILER_CTRL, ctrl_handler);
+}
+
+void profiler_start(void)
+{
+    if (!m_dumping)
+    {
+        m_running = true;
+        nrf_timer_task_trigger(PROFILER_TIMER, NRF_TIMER_TASK_START);
+    }
+}
+
+void profiler_stop(void)
+{
+    nrf_timer_task_trigger(PROFILER_TIMER, NRF_TIMER_TASK_STOP);
+    m_running = false;
+}
+
+void profiler_reset(void)
+{
+    NVIC_DisableIRQ(TIMER2_IRQn);
+    memset(m_histogram, 0, sizeof(m_histogram));
+    m_samples = 0;
+    m_outside = 0;
+    NVIC_EnableIRQ(TIMER2_IRQn);
+
+    // A dump of the old counts is abandoned
+    if (m_dumping)
+    {
+        dump_end();
+    }
+}
+
+static bool info_send(void)
+{
+    profiler_info_t info =
+    {
+        .code_start   = m_code_start,
+        .rate_hz      = PROFILER_RATE_HZ,
+        .samples      = m_samples,
+        .outside      = m_outside,
+        .entries      = 0,
+        .buckets      = PROFILER_BUCKETS,
+        .bucket_shift = PROFILER_BUCKET_SHIFT,
+        .running      = m_resume
+    };
+
+    for (uint32_t i = 0; i < PROFILER_BUCKETS; i++)
+    {
+        info.entries += (m_histogram[i] != 0);
+    }
+
+    return usb_link_send(USB_LINK_MSG_PROFILER_INFO, &info, sizeof(info));
+}
+
+void profiler_process(void)
+{
+    if (!m_dumping)
+    {
+        return;
+    }
+
+    // Host gone, give up on the dump
+    if (!usb_link_is_open())
+    {
+        dump_end();
+        return;
+    }
+
+    if (!m_info_sent)
+    {
+        m_info_sent = info_send();
+        if (!m_info_sent)
+        {
+            return;
+        }
+    }
+
+    // As many frames as the link takes now, the rest on the next call
+    while (m_dump_bucket < PROFILER_BUCKETS)
+    {
+        profiler_entry_t entries[ENTRIES_PER_FRAME];
+        uint32_t count = 0;
+        uint32_t bucket = m_dump_bucket;
+
+        while (bucket < PROFILER_BUCKETS && count < ENTRIES_PER_FRAME)
+        {
+            if (m_histogram[bucket] != 0)
+            {
+                entries[count].bucket = bucket;
+                entries[count].count = m_histogram[bucket];
+                count++;
+            }
+            bucket++;
+        }
+
+        if (count != 0 &&
+            !usb_link_send(USB_LINK_MSG_PROFILER_DATA, entries, count * sizeof(profiler_entry_t)))
+        {
+            return;
+        }
+        m_dump_bucket = bucket;
+    }
+
+    dump_end();
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,67 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Statistical profiler: TIMER2 interrupts PROFILER_RATE_HZ times a second and
+// counts the interrupted PC in a histogram of code addresses. The host starts,
+// stops and reads it over the USB link (tools/profile.py), which also maps the
+// buckets back to functions with the ELF. Samples taken while the CPU sleeps
+// land in idle_wait(). The interrupt runs above every other one, so time in
+// ISRs and the USB stack shows up as well.
+
+typedef enum
+{
+    PROFILER_CMD_STOP,
+    PROFILER_CMD_START,
+    PROFILER_CMD_RESET,
+    PROFILER_CMD_DUMP    // answered with one INFO and then DATA until all entries are sent
+} profiler_cmd_t;
+
+// USB_LINK_MSG_PROFILER_INFO payload
+typedef struct
+{
+    uint32_t code_start;     // address of bucket 0
+    uint32_t rate_hz;
+    uint32_t samples;
+    uint32_t outside;        // samples outside the histogram
+    uint32_t entries;        // non-zero buckets in the DATA frames that follow
+    uint16_t buckets;
+    uint8_t  bucket_shift;
+    uint8_t  running;
+} profiler_info_t;
+
+// USB_LINK_MSG_PROFILER_DATA payload element
+typedef struct
+{
+    uint32_t bucket;
+    uint32_t count;
+} profiler_entry_t;
+
+#if PROFILER_ENABLED
+
+// Set up TIMER2 and take the PROFILER_CTRL messages, sampling starts on request
+void profiler_init(void);
+
+void profiler_start(void);
+
+void profiler_stop(void);
+
+// Clear the counts, a dump in progress ends and sampling runs as it did before it
+void profiler_reset(void);
+
+// Send the next part of a requested dump, main loop
+void profiler_process(void);
+
+#else
+
+static inline void profiler_init(void) {}
+static inline void profiler_start(void) {}
+static inline void profiler_stop(void) {}
+static inline void profiler_reset(void) {}
+static inline void profiler_process(void) {}
+
+#endif // PROFILER_ENABLED
+
+#endif
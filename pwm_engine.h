@@ -0,0 +1,64 @@
+#ifndef PWM_ENGINE_H
+#define PWM_ENGINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Values of PWM_ENGINE_BACKEND (see app_config.h)
+#define PWM_ENGINE_BACKEND_SOFT 0
+#define PWM_ENGINE_BACKEND_HW   1
+#define PWM_ENGINE_BACKEND_PPI  2
+
+#define PWM_ENGINE_CHANNELS 4
+
+// Full-scale channel level, matches the fade tables of the same resolution
+#define PWM_ENGINE_TOP ((1U << PWM_ENGINE_RESOLUTION_BITS) - 1)
+
+// One step of a sequence, a level in [0, PWM_ENGINE_TOP] for every channel.
+// Layout matches nrf_pwm_values_individual_t so EasyDMA can read it as is.
+typedef struct
+{
+    uint16_t level[PWM_ENGINE_CHANNELS];
+} pwm_engine_frame_t;
+
+// Called once when a sequence has been played to the end (not after pwm_engine_stop)
+typedef void (*pwm_engine_handler_t)(void);
+
+// Called from the engine's interrupt while pwm_engine_stream() plays, with the
+// buffer whose frame has been taken: write the frame it plays next. The two
+// buffers alternate, p_frames[0] first.
+typedef void (*pwm_engine_refill_t)(pwm_engine_frame_t * p_frame);
+
+// p_pins: LED pins for channels 0..PWM_ENGINE_CHANNELS-1, all LEDs are active low
+void pwm_engine_init(uint32_t const * p_pins, pwm_engine_handler_t handler);
+
+// Hand the engine to another user, returns the handler it replaces. Only
+// while no sequence plays.
+pwm_engine_handler_t pwm_engine_handler_set(pwm_engine_handler_t handler);
+
+// Play p_frames[0..length-1] playback_count times, holding every frame for frame_us.
+// The frames must stay valid (and in RAM) until the handler is called.
+void pwm_engine_play(pwm_engine_frame_t const * p_frames, uint16_t length,
+                     uint32_t frame_us, uint16_t playback_count);
+
+// Play p_frames[0], p_frames[1], p_frames[0], ... for frame_us each, back to
+// back until pwm_engine_stop(). The frames keep the engine's clock, the
+// interrupt only refills the buffer that has been taken, one frame period or
+// more before it plays again. The handler is not called. Both frames must
+// stay valid (and in RAM) until pwm_engine_stop().
+void pwm_engine_stream(pwm_engine_frame_t * p_frames, uint32_t frame_us, pwm_engine_refill_t refill);
+
+// Abort the current sequence and switch all channels off, safe to call from an ISR
+void pwm_engine_stop(void);
+
+bool pwm_engine_is_busy(void);
+
+// Length of one PWM period as generated, after pwm_engine_init()
+uint32_t pwm_engine_period_ns(void);
+
+// How long pwm_engine_play() really holds a frame of frame_us: a whole number
+// of PWM periods, at least one
+uint32_t pwm_engine_frame_ns(uint32_t frame_us);
+
+#endif
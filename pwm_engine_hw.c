@@ -0,0 +1,169 @@
+#include "pwm_engine.h"
+
+#if PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_HW
+
+#include <stddef.h>
+#include "nrfx_pwm.h"
+
+NRFX_STATIC_ASSERT(sizeof(pwm_engine_frame_t) == sizeof(nrf_pwm_values_individual_t));
+NRFX_STATIC_ASSERT(PWM_ENGINE_TOP <= 0x7FFF);
+
+#define PWM_ENGINE_MAX_CLOCK_HZ 16000000UL
+
+static nrfx_pwm_t m_pwm = NRFX_PWM_INSTANCE(PWM_ENGINE_INSTANCE);
+static pwm_engine_handler_t m_handler;
+static volatile bool m_busy = false;
+static volatile bool m_stopping = false;
+static uint32_t m_period_ns;
+static pwm_engine_frame_t * mp_stream;
+static pwm_engine_refill_t m_refill;
+
+// Slowest base clock (16 MHz >> prescaler) that still gives a PWM frequency of
+// at least PWM_ENGINE_FREQUENCY with a counter top of PWM_ENGINE_TOP
+static nrf_pwm_clk_t base_clock_select(void)
+{
+    nrf_pwm_clk_t clock = NRF_PWM_CLK_16MHz;
+
+    while (clock < NRF_PWM_CLK_125kHz &&
+           ((PWM_ENGINE_MAX_CLOCK_HZ >> (clock + 1)) / PWM_ENGINE_TOP) >= PWM_ENGINE_FREQUENCY)
+    {
+        clock++;
+    }
+
+    return clock;
+}
+
+// Only STOPPED is enabled, so the CPU wakes up once per sequence. A stream
+// has SEQEND of both sequences instead: it comes with the sequence's value
+// loaded, its buffer is free two frame periods before it plays again.
+static void pwm_event_handler(nrfx_pwm_evt_type_t event_type)
+{
+    if (event_type == NRFX_PWM_EVT_END_SEQ0 || event_type == NRFX_PWM_EVT_END_SEQ1)
+    {
+        if (m_busy && !m_stopping && m_refill != NULL)
+        {
+            m_refill(&mp_stream[event_type == NRFX_PWM_EVT_END_SEQ0 ? 0 : 1]);
+        }
+        return;
+    }
+    if (event_type != NRFX_PWM_EVT_STOPPED)
+    {
+        return;
+    }
+
+    m_busy = false;
+    m_refill = NULL;
+    if (!m_stopping && m_handler != NULL)
+    {
+        m_handler();
+    }
+}
+
+void pwm_engine_init(uint32_t const * p_pins, pwm_engine_handler_t handler)
+{
+    nrfx_pwm_config_t config =
+    {
+        .irq_priority = NRFX_PWM_DEFAULT_CONFIG_IRQ_PRIORITY,
+        .base_clock   = base_clock_select(),
+        .count_mode   = NRF_PWM_MODE_UP,
+        .top_value    = PWM_ENGINE_TOP,
+        .load_mode    = NRF_PWM_LOAD_INDIVIDUAL,
+        .step_mode    = NRF_PWM_STEP_AUTO
+    };
+
+    // LEDs are active low: the pins idle high, and a compare value of N keeps
+    // the output low (LED on) for the first N counts of every period
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        config.output_pins[i] = (uint8_t)p_pins[i] | NRFX_PWM_PIN_INVERTED;
+    }
+
+    m_period_ns = (PWM_ENGINE_TOP * 1000000000ULL) / (PWM_ENGINE_MAX_CLOCK_HZ >> config.base_clock);
+    m_handler = handler;
+    nrfx_pwm_init(&m_pwm, &config, pwm_event_handler);
+}
+
+// Nearest whole number of PWM periods
+static uint32_t frame_periods(uint32_t frame_us)
+{
+    uint32_t periods = (frame_us * 1000ULL + m_period_ns / 2) / m_period_ns;
+
+    return periods ? periods : 1;
+}
+
+void pwm_engine_play(pwm_engine_frame_t const * p_frames, uint16_t length,
+                     uint32_t frame_us, uint16_t playback_count)
+{
+    uint32_t periods = frame_periods(frame_us);
+
+    nrf_pwm_sequence_t const seq =
+    {
+        .values.p_individual = (nrf_pwm_values_individual_t const *)p_frames,
+        .length              = length * PWM_ENGINE_CHANNELS,
+        .repeats             = periods - 1,
+        .end_delay           = 0
+    };
+
+    m_stopping = false;
+    m_busy = true;
+    m_refill = NULL;
+    nrfx_pwm_simple_playback(&m_pwm, &seq, playback_count,
+                             NRFX_PWM_FLAG_STOP | NRFX_PWM_FLAG_NO_EVT_FINISHED);
+}
+
+// One step per sequence, seq0 and seq1 looping without a gap
+void pwm_engine_stream(pwm_engine_frame_t * p_frames, uint32_t frame_us, pwm_engine_refill_t refill)
+{
+    uint32_t periods = frame_periods(frame_us);
+    nrf_pwm_sequence_t seq[2];
+
+    for (int i = 0; i < 2; i++)
+    {
+        seq[i].values.p_individual = (nrf_pwm_values_individual_t const *)&p_frames[i];
+        seq[i].length              = PWM_ENGINE_CHANNELS;
+        seq[i].repeats             = periods - 1;
+        seq[i].end_delay           = 0;
+    }
+
+    mp_stream = p_frames;
+    m_refill = refill;
+    m_stopping = false;
+    m_busy = true;
+    nrfx_pwm_complex_playback(&m_pwm, &seq[0], &seq[1], 1,
+                              NRFX_PWM_FLAG_LOOP | NRFX_PWM_FLAG_NO_EVT_FINISHED |
+                              NRFX_PWM_FLAG_SIGNAL_END_SEQ0 | NRFX_PWM_FLAG_SIGNAL_END_SEQ1);
+}
+
+void pwm_engine_stop(void)
+{
+    if (m_busy)
+    {
+        m_stopping = true;
+        nrfx_pwm_stop(&m_pwm, false);
+    }
+}
+
+pwm_engine_handler_t pwm_engine_handler_set(pwm_engine_handler_t handler)
+{
+    pwm_engine_handler_t previous = m_handler;
+
+    m_handler = handler;
+    return previous;
+}
+
+bool pwm_engine_is_busy(void)
+{
+    return m_busy;
+}
+
+uint32_t pwm_engine_period_ns(void)
+{
+    return m_period_ns;
+}
+
+uint32_t pwm_engine_frame_ns(uint32_t frame_us)
+{
+    return frame_periods(frame_us) * m_period_ns;
+}
+
+#endif // PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_HW
@@ -0,0 +1,358 @@
+#include "pwm_engine.h"
+
+#if PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_PPI
+
+#include <stddef.h>
+#include "nrfx_timer.h"
+#include "nrfx_ppi.h"
+#include "nrfx_gpiote.h"
+
+// PWM without the PWM peripheral and without CPU per period:
+//  - the PWM timer counts 0..PWM_ENGINE_TOP, COMPARE5 clears it and, through PPI,
+//    triggers the GPIOTE CLR task of every lit channel (LED on),
+//  - COMPARE0..3 trigger the GPIOTE SET task of channel 0..3 (LED off),
+//  - COMPARE4, a quarter period before the end, is the frame event: the frame timer
+//    counts it through its own PPI channel and interrupts once per frame, in the
+//    last period of the frame, the ISR only loads the next levels into CC0..3.
+// The GPIOTE OUT channels come from the nrfx_gpiote pool shared with the button.
+//
+// CC registers are not buffered: a channel's next level may only be written
+// once its SET edge of the current period has passed, or that period ends at
+// the wrong time. The frame ISR runs in the last quarter of the frame's last
+// period and reads the count:
+//  - a channel already off by then gets its next level at once,
+//  - a lit channel going dark only loses its CLR at the next period start, a
+//    full one gets a SET edge at the period end (CC = PWM_ENGINE_TOP),
+//  - any other lit channel keeps its edge, COMPARE5 interrupts for that one
+//    period and its ISR loads the level right after the frame has ended.
+// The new frame is then exact from its first period, except for a level below
+// the count the period ISR reaches, which turns the LED off at once and shows
+// as that count (a few us) for one period. A frame ISR held off past the end
+// of the frame loads into the new frame's first period instead.
+
+#define PERIOD_CC         NRF_TIMER_CC_CHANNEL5
+#define FRAME_CC          NRF_TIMER_CC_CHANNEL4
+#define FRAME_EVENT_TICKS (PWM_ENGINE_TOP - PWM_ENGINE_TOP / 4)
+#define PWM_MAX_CLOCK_HZ  16000000UL
+
+static const nrfx_timer_t m_pwm_timer = NRFX_TIMER_INSTANCE(PWM_ENGINE_TIMER_INSTANCE);
+static const nrfx_timer_t m_frame_timer = NRFX_TIMER_INSTANCE(PWM_ENGINE_FRAME_TIMER_INSTANCE);
+
+static uint32_t m_pins[PWM_ENGINE_CHANNELS];
+static nrf_ppi_channel_t m_ppi_on[PWM_ENGINE_CHANNELS];   // COMPARE5 -> CLR
+static nrf_ppi_channel_t m_ppi_off[PWM_ENGINE_CHANNELS];  // COMPAREn -> SET
+static uint16_t m_levels[PWM_ENGINE_CHANNELS];            // loaded, all off when stopped
+static uint16_t m_next_levels[PWM_ENGINE_CHANNELS];       // for the period ISR
+static uint8_t m_pending;                                 // channels the period ISR loads
+static pwm_engine_handler_t m_handler;
+static uint32_t m_period_ns;
+
+static pwm_engine_frame_t const * mp_frames;
+static uint16_t m_length;
+static uint16_t m_frame;
+static uint16_t m_playbacks_left;
+static pwm_engine_frame_t * mp_stream;
+static pwm_engine_refill_t m_refill;
+static volatile bool m_busy = false;
+
+// Slowest timer clock that still gives PWM_ENGINE_FREQUENCY with PWM_ENGINE_TOP ticks
+static nrf_timer_frequency_t timer_frequency_select(void)
+{
+    nrf_timer_frequency_t frequency = NRF_TIMER_FREQ_16MHz;
+
+    while (frequency < NRF_TIMER_FREQ_31250Hz &&
+           ((PWM_MAX_CLOCK_HZ >> (frequency + 1)) / PWM_ENGINE_TOP) >= PWM_ENGINE_FREQUENCY)
+    {
+        frequency++;
+    }
+
+    return frequency;
+}
+
+static const nrf_timer_cc_channel_t m_level_cc[PWM_ENGINE_CHANNELS] =
+{
+    NRF_TIMER_CC_CHANNEL0, NRF_TIMER_CC_CHANNEL1, NRF_TIMER_CC_CHANNEL2, NRF_TIMER_CC_CHANNEL3
+};
+
+// The level from the next period start on
+static void channel_level_set(int channel, uint16_t level)
+{
+    // 0 % and 100 % have no edge inside the period, no CLR or no SET
+    if (level == 0)
+    {
+        nrfx_ppi_channel_disable(m_ppi_on[channel]);
+        nrfx_ppi_channel_disable(m_ppi_off[channel]);
+    }
+    else if (level >= PWM_ENGINE_TOP)
+    {
+        nrfx_ppi_channel_enable(m_ppi_on[channel]);
+        nrfx_ppi_channel_disable(m_ppi_off[channel]);
+    }
+    else
+    {
+        nrfx_timer_compare(&m_pwm_timer, m_level_cc[channel], level, false);
+        nrfx_ppi_channel_enable(m_ppi_on[channel]);
+        nrfx_ppi_channel_enable(m_ppi_off[channel]);
+    }
+    m_levels[channel] = level;
+}
+
+// The count through the frame compare, which gets its value back before the
+// counter can come round to it
+static uint32_t count_get(void)
+{
+    uint32_t count = nrfx_timer_capture(&m_pwm_timer, FRAME_CC);
+
+    nrfx_timer_compare(&m_pwm_timer, FRAME_CC, FRAME_EVENT_TICKS, false);
+    return count;
+}
+
+static void frame_load(pwm_engine_frame_t const * p_frame)
+{
+    uint32_t count = count_get();
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        uint16_t level = p_frame->level[i];
+        uint16_t loaded = m_levels[i];
+
+        if (loaded <= count)
+        {
+            // Off for the rest of the period, or dark
+            channel_level_set(i, level);
+        }
+        else if (level == 0)
+        {
+            nrfx_ppi_channel_disable(m_ppi_on[i]);
+            if (loaded >= PWM_ENGINE_TOP)
+            {
+                nrfx_timer_compare(&m_pwm_timer, m_level_cc[i], PWM_ENGINE_TOP, false);
+                nrfx_ppi_channel_enable(m_ppi_off[i]);
+            }
+            m_levels[i] = 0;
+        }
+        else
+        {
+            m_next_levels[i] = level;
+            m_pending |= 1U << i;
+        }
+    }
+    if (m_pending != 0)
+    {
+        nrfx_timer_compare_int_enable(&m_pwm_timer, PERIOD_CC);
+    }
+}
+
+static void timers_stop(void)
+{
+    nrfx_timer_disable(&m_frame_timer);
+    nrfx_timer_disable(&m_pwm_timer);
+    nrfx_timer_compare_int_disable(&m_pwm_timer, PERIOD_CC);
+    m_pending = 0;
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        nrfx_ppi_channel_disable(m_ppi_on[i]);
+        nrfx_ppi_channel_disable(m_ppi_off[i]);
+        nrfx_gpiote_set_task_trigger(m_pins[i]);
+        m_levels[i] = 0;
+    }
+}
+
+// Runs once per frame, in the last quarter of the frame's last period
+static void frame_timer_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    if (!m_busy)
+    {
+        return;
+    }
+
+    if (m_refill != NULL)
+    {
+        // A stream never ends, the frame played out is refilled once the
+        // next one is loaded
+        pwm_engine_frame_t * p_taken = &mp_stream[m_frame];
+
+        m_frame ^= 1;
+        frame_load(&mp_frames[m_frame]);
+        m_refill(p_taken);
+        return;
+    }
+
+    if (++m_frame == m_length)
+    {
+        m_frame = 0;
+        if (--m_playbacks_left == 0)
+        {
+            timers_stop();
+            m_busy = false;
+            if (m_handler != NULL)
+            {
+                m_handler();
+            }
+            return;
+        }
+    }
+
+    frame_load(&mp_frames[m_frame]);
+}
+
+// Right after the period start that begins a frame, only when frame_load()
+// left channels that were still lit
+static void pwm_timer_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    uint8_t pending = m_pending;
+
+    nrfx_timer_compare_int_disable(&m_pwm_timer, PERIOD_CC);
+    m_pending = 0;
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (pending & (1U << i))
+        {
+            channel_level_set(i, m_next_levels[i]);
+        }
+    }
+
+    uint32_t count = count_get();
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        uint16_t level = m_next_levels[i];
+
+        // SET edge passed already, the LED turned on by this period's CLR goes off now
+        if ((pending & (1U << i)) && level < PWM_ENGINE_TOP && level <= count)
+        {
+            nrfx_gpiote_set_task_trigger(m_pins[i]);
+        }
+    }
+}
+
+void pwm_engine_init(uint32_t const * p_pins, pwm_engine_handler_t handler)
+{
+    nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+
+    if (!nrfx_gpiote_is_init())
+    {
+        nrfx_gpiote_init();
+    }
+
+    timer_config.frequency = timer_frequency_select();
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_16;
+    nrfx_timer_init(&m_pwm_timer, &timer_config, pwm_timer_handler);
+    nrfx_timer_extended_compare(&m_pwm_timer, PERIOD_CC, PWM_ENGINE_TOP,
+                                NRF_TIMER_SHORT_COMPARE5_CLEAR_MASK, false);
+    nrfx_timer_compare(&m_pwm_timer, FRAME_CC, FRAME_EVENT_TICKS, false);
+    m_period_ns = (PWM_ENGINE_TOP * 1000000000ULL) / (PWM_MAX_CLOCK_HZ >> timer_config.frequency);
+
+    timer_config.mode = NRF_TIMER_MODE_COUNTER;
+    nrfx_timer_init(&m_frame_timer, &timer_config, frame_timer_handler);
+
+    uint32_t period_event = nrfx_timer_compare_event_address_get(&m_pwm_timer, PERIOD_CC);
+    uint32_t frame_event = nrfx_timer_compare_event_address_get(&m_pwm_timer, FRAME_CC);
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        // Task mode GPIOTE channel, initially high (LED off)
+        nrfx_gpiote_out_config_t out_config = NRFX_GPIOTE_CONFIG_OUT_TASK_TOGGLE(true);
+
+        m_pins[i] = p_pins[i];
+        nrfx_gpiote_out_init(m_pins[i], &out_config);
+        nrfx_gpiote_out_task_enable(m_pins[i]);
+
+        nrfx_ppi_channel_alloc(&m_ppi_on[i]);
+        nrfx_ppi_channel_assign(m_ppi_on[i], period_event, nrfx_gpiote_clr_task_addr_get(m_pins[i]));
+
+        nrfx_ppi_channel_alloc(&m_ppi_off[i]);
+        nrfx_ppi_channel_assign(m_ppi_off[i], nrfx_timer_compare_event_address_get(&m_pwm_timer, i),
+                                nrfx_gpiote_set_task_addr_get(m_pins[i]));
+    }
+
+    // The frame timer counts periods on its own PPI channel, so it keeps
+    // counting while all LED channels are dark
+    nrf_ppi_channel_t count_channel;
+    nrfx_ppi_channel_alloc(&count_channel);
+    nrfx_ppi_channel_assign(count_channel, frame_event,
+                            nrfx_timer_task_address_get(&m_frame_timer, NRF_TIMER_TASK_COUNT));
+    nrfx_ppi_channel_enable(count_channel);
+
+    m_handler = handler;
+}
+
+// Nearest whole number of PWM periods
+static uint32_t frame_periods(uint32_t frame_us)
+{
+    uint32_t periods = (frame_us * 1000ULL + m_period_ns / 2) / m_period_ns;
+
+    return periods ? periods : 1;
+}
+
+void pwm_engine_play(pwm_engine_frame_t const * p_frames, uint16_t length,
+                     uint32_t frame_us, uint16_t playback_count)
+{
+    uint32_t periods = frame_periods(frame_us);
+
+    timers_stop();
+
+    mp_frames = p_frames;
+    m_length = length;
+    m_frame = 0;
+    m_playbacks_left = playback_count;
+    m_refill = NULL;
+    m_busy = true;
+
+    // Count 0 for frame_load(), the first frame is loaded before the first
+    // period, which starts here rather than with a CLR from COMPARE5
+    nrfx_timer_clear(&m_frame_timer);
+    nrfx_timer_clear(&m_pwm_timer);
+    frame_load(&mp_frames[0]);
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (m_levels[i] != 0)
+        {
+            nrfx_gpiote_clr_task_trigger(m_pins[i]);
+        }
+    }
+    nrfx_timer_extended_compare(&m_frame_timer, NRF_TIMER_CC_CHANNEL0, periods,
+                                NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK, true);
+    nrfx_timer_enable(&m_frame_timer);
+    nrfx_timer_enable(&m_pwm_timer);
+}
+
+void pwm_engine_stream(pwm_engine_frame_t * p_frames, uint32_t frame_us, pwm_engine_refill_t refill)
+{
+    pwm_engine_play(p_frames, 2, frame_us, 1);
+    mp_stream = p_frames;
+    m_refill = refill;
+}
+
+void pwm_engine_stop(void)
+{
+    if (m_busy)
+    {
+        m_busy = false;
+        timers_stop();
+    }
+}
+
+pwm_engine_handler_t pwm_engine_handler_set(pwm_engine_handler_t handler)
+{
+    pwm_engine_handler_t previous = m_handler;
+
+    m_handler = handler;
+    return previous;
+}
+
+bool pwm_engine_is_busy(void)
+{
+    return m_busy;
+}
+
+uint32_t pwm_engine_period_ns(void)
+{
+    return m_period_ns;
+}
+
+uint32_t pwm_engine_frame_ns(uint32_t frame_us)
+{
+    return frame_periods(frame_us) * m_period_ns;
+}
+
+#endif // PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_PPI
@@ -0,0 +1,240 @@
+#include "pwm_engine.h"
+
+#if PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_SOFT
+
+#include <stddef.h>
+#include "hires_timer.h"
+#include "nrf_gpio.h"
+#include "led_pins.h"
+#include "instrument.h"
+
+// PWM period calculation
+#define PERIOD_US (1000000 / PWM_ENGINE_FREQUENCY)  // Total period in microseconds
+
+// Every edge is a hires_timer callback: the period start switches the lit
+// channels on, the following callbacks switch them off in the order of their
+// on time. Deadlines are absolute, so periods do not drift, and the CPU
+// sleeps between edges. hires_timer_init() must have been called.
+
+// Port register bits of every channel, all channels switch with one
+// OUTSET/OUTCLR write per port
+static led_pins_masks_t m_pin_masks[PWM_ENGINE_CHANNELS];
+static led_pins_masks_t m_all_masks;
+static pwm_engine_handler_t m_handler;
+static volatile bool m_busy = false;
+
+static hires_timer_t m_edge_timer;
+static uint64_t m_period_start_us;
+static uint32_t m_time_on[PWM_ENGINE_CHANNELS];
+static uint32_t m_elapsed;
+
+static pwm_engine_frame_t const * mp_frames;
+static uint16_t m_length;
+static uint16_t m_frame;
+static uint32_t m_periods;
+static uint32_t m_period;
+static uint16_t m_playbacks_left;
+static pwm_engine_frame_t * mp_stream;
+static pwm_engine_refill_t m_refill;
+
+static void edge_handler(void * p_context);
+static void period_end_handler(void * p_context);
+
+static void masks_add(led_pins_masks_t * p_masks, uint8_t channel)
+{
+    for (int port = 0; port < LED_PINS_PORTS; port++)
+    {
+        p_masks->port[port] |= m_pin_masks[channel].port[port];
+    }
+}
+
+static void pins_off(void)
+{
+    led_pins_set(m_all_masks);
+}
+
+// Next off edge of this period, or the start of the next one
+static void edge_schedule(void)
+{
+    uint32_t next = PERIOD_US;
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (m_time_on[i] > m_elapsed && m_time_on[i] < next)
+        {
+            next = m_time_on[i];
+        }
+    }
+
+    hires_timer_start_at(&m_edge_timer, m_period_start_us + next,
+                         next == PERIOD_US ? period_end_handler : edge_handler,
+                         (void *)(uintptr_t)next);
+}
+
+static void edge_handler(void * p_context)
+{
+    if (!m_busy)
+    {
+        return;
+    }
+
+    led_pins_masks_t off = {{0}};
+
+    m_elapsed = (uint32_t)(uintptr_t)p_context;
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        if (m_time_on[i] == m_elapsed)
+        {
+            masks_add(&off, i);
+        }
+    }
+    led_pins_set(off);
+    edge_schedule();
+}
+
+// Start one PWM period for all channels
+void pwm_dimming_led(pwm_engine_frame_t const * p_frame)
+{
+    led_pins_masks_t on = {{0}};
+    led_pins_masks_t off = {{0}};
+
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        m_time_on[i] = (p_frame->level[i] * PERIOD_US) / PWM_ENGINE_TOP;
+        masks_add(m_time_on[i] != 0 ? &on : &off, i);
+    }
+    led_pins_clear(on);
+    led_pins_set(off);
+
+    m_elapsed = 0;
+    edge_schedule();
+}
+
+static void period_end_handler(void * p_context)
+{
+    pwm_engine_frame_t * p_taken = NULL;
+
+    if (!m_busy)
+    {
+        return;
+    }
+
+    m_period_start_us += PERIOD_US;
+
+    if (++m_period == m_periods)
+    {
+        m_period = 0;
+        if (m_refill != NULL)
+        {
+            // A stream never ends, the frame played out is refilled below
+            p_taken = &mp_stream[m_frame];
+            m_frame ^= 1;
+        }
+        else if (++m_frame == m_length)
+        {
+            m_frame = 0;
+            if (--m_playbacks_left == 0)
+            {
+                pins_off();
+                m_busy = false;
+                if (m_handler != NULL)
+                {
+                    m_handler();
+                }
+                return;
+            }
+        }
+    }
+
+    // Only here, pwm_engine_play() runs it from thread context as well
+    INSTRUMENT_BEGIN(PWM_PERIOD);
+    pwm_dimming_led(&mp_frames[m_frame]);
+    INSTRUMENT_END(PWM_PERIOD);
+
+    // After the period has started, the edges do not wait for it
+    if (p_taken != NULL)
+    {
+        m_refill(p_taken);
+    }
+}
+
+void pwm_engine_init(uint32_t const * p_pins, pwm_engine_handler_t handler)
+{
+    for (int i = 0; i < PWM_ENGINE_CHANNELS; i++)
+    {
+        m_pin_masks[i] = led_pins_masks_of(p_pins[i]);
+        masks_add(&m_all_masks, i);
+        nrf_gpio_pin_write(p_pins[i], 1);
+        nrf_gpio_cfg_output(p_pins[i]);
+    }
+    m_handler = handler;
+}
+
+// Whole PWM periods, rounded down
+static uint32_t frame_periods(uint32_t frame_us)
+{
+    uint32_t periods = frame_us / PERIOD_US;
+
+    return periods ? periods : 1;
+}
+
+void pwm_engine_play(pwm_engine_frame_t const * p_frames, uint16_t length,
+                     uint32_t frame_us, uint16_t playback_count)
+{
+    uint32_t periods = frame_periods(frame_us);
+
+    hires_timer_stop(&m_edge_timer);
+
+    mp_frames = p_frames;
+    m_length = length;
+    m_frame = 0;
+    m_periods = periods;
+    m_period = 0;
+    m_playbacks_left = playback_count;
+    m_refill = NULL;
+    m_busy = true;
+
+    m_period_start_us = hires_timer_now_us();
+    pwm_dimming_led(&mp_frames[0]);
+}
+
+void pwm_engine_stream(pwm_engine_frame_t * p_frames, uint32_t frame_us, pwm_engine_refill_t refill)
+{
+    pwm_engine_play(p_frames, 2, frame_us, 1);
+    mp_stream = p_frames;
+    m_refill = refill;
+}
+
+void pwm_engine_stop(void)
+{
+    if (m_busy)
+    {
+        m_busy = false;
+        hires_timer_stop(&m_edge_timer);
+        pins_off();
+    }
+}
+
+pwm_engine_handler_t pwm_engine_handler_set(pwm_engine_handler_t handler)
+{
+    pwm_engine_handler_t previous = m_handler;
+
+    m_handler = handler;
+    return previous;
+}
+
+bool pwm_engine_is_busy(void)
+{
+    return m_busy;
+}
+
+uint32_t pwm_engine_period_ns(void)
+{
+    return PERIOD_US * 1000UL;
+}
+
+uint32_t pwm_engine_frame_ns(uint32_t frame_us)
+{
+    return frame_periods(frame_us) * PERIOD_US * 1000UL;
+}
+
+#endif // PWM_ENGINE_BACKEND == PWM_ENGINE_BACKEND_SOFT
@@ -0,0 +1,176 @@
+#include "pwm_selftest.h"
+
+#if PWM_SELFTEST_ENABLED
+
+#include <string.h>
+#include "nrf_gpio.h"
+#include "nrfx_timer.h"
+#include "nrfx_ppi.h"
+#include "nrfx_gpiote.h"
+#include "app_util_platform.h"
+#include "pwm_engine.h"
+#include "usb_link.h"
+
+#define TIMER_HZ 16000000UL
+
+static const nrfx_timer_t m_timer = NRFX_TIMER_INSTANCE(PWM_SELFTEST_TIMER_INSTANCE);
+
+static edge_stats_t m_stats;
+static nrf_ppi_channel_t m_ppi;
+static bool m_level_on;         // level after the last edge, to notice lost ones
+static uint8_t m_channel;
+static bool m_running;
+static bool m_report_requested;
+
+// Every edge of the capture pin, CC0 holds its time
+static void capture_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+{
+    uint32_t timestamp = nrfx_timer_capture_get(&m_timer, NRF_TIMER_CC_CHANNEL0);
+    bool on = nrf_gpio_pin_read(PWM_SELFTEST_CAPTURE_PIN) == 0;    // LEDs are active low
+
+    // Back at the level of the last edge: two edges, only the time of the later kept
+    if (on == m_level_on)
+    {
+        edge_stats_lost(&m_stats);
+        return;
+    }
+    m_level_on = on;
+    edge_stats_edge(&m_stats, timestamp, on);
+}
+
+// nrfx_timer needs a handler, the timer never interrupts
+static void timer_handler(nrf_timer_event_t event_type, void * p_context)
+{
+}
+
+static void ctrl_handler(uint8_t const * p_payload, uint16_t length)
+{
+    pwm_selftest_ctrl_t ctrl = {0};
+
+    if (length < 1)
+    {
+        return;
+    }
+    memcpy(&ctrl, p_payload, length < sizeof(ctrl) ? length : sizeof(ctrl));
+
+    switch (ctrl.cmd)
+    {
+        case PWM_SELFTEST_CMD_STOP:
+            pwm_selftest_stop();
+            break;
+
+        case PWM_SELFTEST_CMD_START:
+            pwm_selftest_start(ctrl.channel);
+            break;
+
+        case PWM_SELFTEST_CMD_REPORT:
+            m_report_requested = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+void pwm_selftest_init(void)
+{
+    usb_link_handler_set(USB_LINK_MSG_PWM_SELFTEST_CTRL, ctrl_handler);
+}
+
+void pwm_selftest_start(uint8_t channel)
+{
+    nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+    nrfx_gpiote_in_config_t in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
+
+    pwm_selftest_stop();
+
+    if (!nrfx_gpiote_is_init())
+    {
+        nrfx_gpiote_init();
+    }
+
+    timer_config.frequency = NRF_TIMER_FREQ_16MHz;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+    if (nrfx_timer_init(&m_timer, &timer_config, timer_handler) != NRFX_SUCCESS)
+    {
+        return;
+    }
+
+    in_config.pull = NRF_GPIO_PIN_NOPULL;
+    if (nrfx_gpiote_in_init(PWM_SELFTEST_CAPTURE_PIN, &in_config, capture_handler) != NRFX_SUCCESS)
+    {
+        nrfx_timer_uninit(&m_timer);
+        return;
+    }
+
+    if (nrfx_ppi_channel_alloc(&m_ppi) != NRFX_SUCCESS)
+    {
+        nrfx_gpiote_in_uninit(PWM_SELFTEST_CAPTURE_PIN);
+        nrfx_timer_uninit(&m_timer);
+        return;
+    }
+    nrfx_ppi_channel_assign(m_ppi,
+                            nrfx_gpiote_in_event_addr_get(PWM_SELFTEST_CAPTURE_PIN),
+                            nrfx_timer_capture_task_address_get(&m_timer, NRF_TIMER_CC_CHANNEL0));
+
+    // Nominal period in timer ticks
+    edge_stats_init(&m_stats, TIMER_HZ,
+                    (uint32_t)(((uint64_t)pwm_engine_period_ns() * (TIMER_HZ / 1000000UL)) / 1000UL));
+    m_level_on = nrf_gpio_pin_read(PWM_SELFTEST_CAPTURE_PIN) == 0;
+    m_channel = channel;
+
+    nrfx_timer_enable(&m_timer);
+    nrfx_ppi_channel_enable(m_ppi);
+    nrfx_gpiote_in_event_enable(PWM_SELFTEST_CAPTURE_PIN, true);
+    m_running = true;
+}
+
+void pwm_selftest_stop(void)
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    nrfx_gpiote_in_event_disable(PWM_SELFTEST_CAPTURE_PIN);
+    nrfx_gpiote_in_uninit(PWM_SELFTEST_CAPTURE_PIN);
+    nrfx_ppi_channel_disable(m_ppi);
+    nrfx_ppi_channel_free(m_ppi);
+    nrfx_timer_uninit(&m_timer);
+    m_running = false;
+}
+
+void pwm_selftest_report_get(pwm_selftest_report_t * p_report)
+{
+    memset(p_report, 0, sizeof(*p_report));
+    p_report->channel = m_channel;
+    p_report->running = m_running;
+    p_report->capture_pin = PWM_SELFTEST_CAPTURE_PIN;
+
+    CRITICAL_REGION_ENTER();
+    p_report->result = m_stats.result;
+    CRITICAL_REGION_EXIT();
+}
+
+void pwm_selftest_process(void)
+{
+    pwm_selftest_report_t report;
+
+    if (!m_report_requested)
+    {
+        return;
+    }
+    if (!usb_link_is_open())
+    {
+        m_report_requested = false;
+        return;
+    }
+
+    pwm_selftest_report_get(&report);
+    if (usb_link_send(USB_LINK_MSG_PWM_SELFTEST_REPORT, &report, sizeof(report)))
+    {
+        m_report_requested = false;
+    }
+}
+
+#endif // PWM_SELFTEST_ENABLED
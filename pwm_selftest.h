@@ -0,0 +1,69 @@
+#ifndef PWM_SELFTEST_H
+#define PWM_SELFTEST_H
+
+#include <stdint.h>
+#include "sdk_config.h"
+#include "edge_stats.h"
+
+// PWM edge timing measured in hardware: both edges of the LED output on
+// PWM_SELFTEST_CAPTURE_PIN raise a GPIOTE IN event, PPI turns it into a
+// CAPTURE task of a free-running 16 MHz TIMER, and the GPIOTE interrupt hands
+// the captured time to edge_stats. The timestamp is taken by the hardware, so
+// interrupt latency does not show up in the result; an edge only gets lost
+// when the next one comes before the interrupt has read the capture.
+//
+// A GPIOTE channel in event mode takes its pin as an input, so the LED pin
+// under test is wired to the capture pin instead of being sensed directly.
+// The host starts and stops a measurement and reads the report over the USB
+// link (tools/pwm_jitter.py).
+
+typedef enum
+{
+    PWM_SELFTEST_CMD_STOP,
+    PWM_SELFTEST_CMD_START,     // restarts the statistics
+    PWM_SELFTEST_CMD_REPORT     // answered with one PWM_SELFTEST_REPORT
+} pwm_selftest_cmd_t;
+
+// USB_LINK_MSG_PWM_SELFTEST_CTRL payload
+typedef struct
+{
+    uint8_t cmd;        // pwm_selftest_cmd_t
+    uint8_t channel;    // LED wired to the capture pin, START only
+} pwm_selftest_ctrl_t;
+
+// USB_LINK_MSG_PWM_SELFTEST_REPORT payload, times in TIMER ticks
+typedef struct
+{
+    uint8_t             channel;
+    uint8_t             running;
+    uint16_t            reserved;
+    uint32_t            capture_pin;
+    edge_stats_result_t result;
+} pwm_selftest_report_t;
+
+#if PWM_SELFTEST_ENABLED
+
+// Take the PWM_SELFTEST_CTRL messages, the hardware is set up on start
+void pwm_selftest_init(void);
+
+// After pwm_engine_init(), the nominal period comes from the PWM engine
+void pwm_selftest_start(uint8_t channel);
+
+void pwm_selftest_stop(void);
+
+// Consistent copy of the statistics so far
+void pwm_selftest_report_get(pwm_selftest_report_t * p_report);
+
+// Send a requested report, main loop
+void pwm_selftest_process(void);
+
+#else
+
+static inline void pwm_selftest_init(void) {}
+static inline void pwm_selftest_start(uint8_t channel) {}
+static inline void pwm_selftest_stop(void) {}
+static inline void pwm_selftest_process(void) {}
+
+#endif // PWM_SELFTEST_ENABLED
+
+#endif
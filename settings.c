@@ -0,0 +1,302 @@
+#include <stddef.h>
+#include <string.h>
+#include "settings.h"
+#include "app_timer.h"
+#include "crc16.h"
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_nvmc.h"
+
+#define PAGE_SIZE        4096
+#define RECORD_SIZE      32
+#define PAGE_SLOTS       (PAGE_SIZE / RECORD_SIZE)
+#define SEQUENCE_ERASED  0xFFFFFFFF
+#define SETTINGS_VERSION 1
+
+typedef struct
+{
+    uint32_t   sequence;        // written first, SEQUENCE_ERASED: free slot
+    uint16_t   version;
+    uint16_t   crc;             // of the whole record but this field
+    settings_t settings;
+    uint8_t    padding[RECORD_SIZE - 8 - sizeof(settings_t)];
+} record_t;
+
+_Static_assert(sizeof(record_t) == RECORD_SIZE, "record_t must fill its slot");
+_Static_assert(PAGE_SLOTS <= 256, "slots are counted in a byte");
+
+typedef enum
+{
+    STATE_IDLE,
+    STATE_ERASING,
+    STATE_ERASED,       // the record goes to the first slot next
+    STATE_WRITING
+} state_t;
+
+static void fstorage_evt_handler(nrf_fstorage_evt_t * p_evt);
+
+NRF_FSTORAGE_DEF(nrf_fstorage_t m_fs) =
+{
+    .evt_handler = fstorage_evt_handler,
+    .start_addr  = SETTINGS_FLASH_START,
+    .end_addr    = SETTINGS_FLASH_START + SETTINGS_FLASH_PAGES * PAGE_SIZE
+};
+
+APP_TIMER_DEF(m_write_timer);
+
+static settings_handler_t m_handler;
+static record_t const * m_p_record;         // current record, NULL: defaults
+static settings_t const * m_p_current;      // in m_p_record, or m_ram before it is written
+static settings_t m_ram;
+static record_t m_record;                   // being written, the backend reads it until its event
+static uint8_t m_page;                      // active page
+static uint8_t m_next_slot;                 // first erased slot of the active page
+static uint8_t m_write_page;
+static uint8_t m_write_slot;
+static uint8_t m_probes;
+static uint32_t m_writes;
+static uint32_t m_erases;
+static volatile state_t m_state;
+static volatile bool m_due;                 // the write delay is over
+static bool m_dirty;                        // m_ram has changes not being written
+
+static uintptr_t slot_addr(uint8_t page, uint32_t slot)
+{
+    return m_fs.start_addr + page * PAGE_SIZE + slot * RECORD_SIZE;
+}
+
+static record_t const * slot_record(uint8_t page, uint32_t slot)
+{
+    m_probes++;
+    return (record_t const *)slot_addr(page, slot);
+}
+
+static uint16_t record_crc(record_t const * p_record)
+{
+    uint16_t crc = crc16_compute((uint8_t const *)p_record, offsetof(record_t, crc), NULL);
+
+    return crc16_compute((uint8_t const *)&p_record->settings, RECORD_SIZE - offsetof(record_t, settings), &crc);
+}
+
+static bool record_valid(record_t const * p_record)
+{
+    return p_record->sequence != SEQUENCE_ERASED &&
+           p_record->version == SETTINGS_VERSION &&
+           p_record->crc == record_crc(p_record);
+}
+
+// Active page from the first slots, its first erased slot by binary search
+// (the written slots are a prefix of the page), then back to the newest
+// record that is whole
+static void load(void)
+{
+    uint32_t sequence = 0;
+    uint32_t low = 1;
+    uint32_t high = PAGE_SLOTS;
+
+    m_probes = 0;
+    m_p_record = NULL;
+    m_page = SETTINGS_FLASH_PAGES - 1;      // so the first write goes to page 0
+    m_next_slot = 0;
+
+    for (uint8_t page = 0; page < SETTINGS_FLASH_PAGES; page++)
+    {
+        record_t const * p_first = slot_record(page, 0);
+
+        if (record_valid(p_first) && p_first->sequence > sequence)
+        {
+            sequence = p_first->sequence;
+            m_page = page;
+            m_p_record = p_first;
+        }
+    }
+    if (m_p_record == NULL)
+    {
+        return;
+    }
+
+    while (low < high)
+    {
+        uint32_t middle = (low + high) / 2;
+
+        if (slot_record(m_page, middle)->sequence == SEQUENCE_ERASED)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    m_next_slot = low;
+
+    // A torn record keeps its slot, the next write goes after it. The first
+    // slot is valid, so this stops there at the latest.
+    for (uint32_t slot = low - 1; slot > 0; slot--)
+    {
+        record_t const * p_record = slot_record(m_page, slot);
+
+        if (record_valid(p_record))
+        {
+            m_p_record = p_record;
+            break;
+        }
+    }
+}
+
+static void write_failed(void)
+{
+    // Tried again after the delay, with whatever changed meanwhile
+    m_state = STATE_IDLE;
+    m_dirty = true;
+    app_timer_stop(m_write_timer);
+    app_timer_start(m_write_timer, APP_TIMER_TICKS(SETTINGS_WRITE_DELAY_MS), NULL);
+}
+
+static void record_write(uint8_t page, uint8_t slot)
+{
+    memset(&m_record, 0xFF, sizeof(m_record));
+    m_record.sequence = (m_p_record != NULL ? m_p_record->sequence : 0) + 1;
+    m_record.version = SETTINGS_VERSION;
+    m_record.settings = m_ram;
+    m_record.crc = record_crc(&m_record);
+
+    m_write_page = page;
+    m_write_slot = slot;
+    m_state = STATE_WRITING;
+    if (nrf_fstorage_write(&m_fs, slot_addr(page, slot), &m_record, sizeof(m_record), NULL) != NRF_SUCCESS)
+    {
+        write_failed();
+    }
+}
+
+// Append to the active page, or erase the next one when it is full (or
+// there is none) and start it with the record
+static void write_begin(void)
+{
+    m_dirty = false;
+    m_due = false;
+
+    if (m_p_record != NULL && m_next_slot < PAGE_SLOTS)
+    {
+        record_write(m_page, m_next_slot);
+        return;
+    }
+
+    m_write_page = (m_page + 1) % SETTINGS_FLASH_PAGES;
+    m_state = STATE_ERASING;
+    if (nrf_fstorage_erase(&m_fs, slot_addr(m_write_page, 0), 1, NULL) != NRF_SUCCESS)
+    {
+        write_failed();
+    }
+}
+
+// From the backend: the NVMC one sends it before the operation call returns
+static void fstorage_evt_handler(nrf_fstorage_evt_t * p_evt)
+{
+    if (p_evt->result != NRF_SUCCESS)
+    {
+        write_failed();
+        return;
+    }
+
+    if (p_evt->id == NRF_FSTORAGE_EVT_ERASE_RESULT)
+    {
+        m_erases++;
+        m_state = STATE_ERASED;
+    }
+    else if (p_evt->id == NRF_FSTORAGE_EVT_WRITE_RESULT)
+    {
+        m_writes++;
+        m_page = m_write_page;
+        m_next_slot = m_write_slot + 1;
+        m_p_record = (record_t const *)slot_addr(m_write_page, m_write_slot);
+        if (!m_dirty)
+        {
+            m_p_current = &m_p_record->settings;
+        }
+        m_state = STATE_IDLE;
+    }
+}
+
+static void write_timeout_handler(void * p_context)
+{
+    m_due = true;
+}
+
+void settings_init(settings_t const * p_defaults, settings_handler_t handler)
+{
+    m_handler = handler;
+    m_state = STATE_IDLE;
+    m_due = false;
+    m_dirty = false;
+    m_writes = 0;
+    m_erases = 0;
+
+    nrf_fstorage_init(&m_fs, &nrf_fstorage_nvmc, NULL);
+    app_timer_create(&m_write_timer, APP_TIMER_MODE_SINGLE_SHOT, write_timeout_handler);
+
+    load();
+    m_ram = m_p_record != NULL ? m_p_record->settings : *p_defaults;
+    m_p_current = m_p_record != NULL ? &m_p_record->settings : &m_ram;
+}
+
+settings_t const * settings_get(void)
+{
+    return m_p_current;
+}
+
+void settings_update(settings_t const * p_settings)
+{
+    if (memcmp(p_settings, m_p_current, sizeof(settings_t)) == 0)
+    {
+        return;
+    }
+
+    m_ram = *p_settings;
+    m_p_current = &m_ram;
+    m_dirty = true;
+
+    // The delay starts over with every change
+    m_due = false;
+    app_timer_stop(m_write_timer);
+    app_timer_start(m_write_timer, APP_TIMER_TICKS(SETTINGS_WRITE_DELAY_MS), NULL);
+
+    if (m_handler != NULL)
+    {
+        m_handler(&m_ram);
+    }
+}
+
+void settings_process(void)
+{
+    if (m_state == STATE_IDLE && m_dirty && m_due)
+    {
+        write_begin();
+    }
+    // An erase that completed starts its page with the record
+    if (m_state == STATE_ERASED)
+    {
+        record_write(m_write_page, 0);
+    }
+}
+
+void settings_flush(void)
+{
+    if (m_dirty)
+    {
+        app_timer_stop(m_write_timer);
+        m_due = true;
+    }
+    settings_process();
+}
+
+void settings_info_get(settings_info_t * p_info)
+{
+    p_info->sequence = m_p_record != NULL ? m_p_record->sequence : 0;
+    p_info->page = m_page;
+    p_info->slot = m_p_record != NULL ? (uint8_t)(((uintptr_t)m_p_record - slot_addr(m_page, 0)) / RECORD_SIZE) : 0;
+    p_info->probes = m_probes;
+    p_info->pending = m_dirty || m_state != STATE_IDLE;
+    p_info->writes = m_writes;
+    p_info->erases = m_erases;
+}
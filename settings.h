@@ -0,0 +1,76 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+// User settings kept in internal flash over resets, through nrf_fstorage.
+// The store is a log of fixed size records over SETTINGS_FLASH_PAGES pages
+// used in turn: a change is appended to the next erased slot of the active
+// page, and when that page is full the next one is erased and takes the
+// record in its first slot. Every page is erased once per
+// (SETTINGS_FLASH_PAGES * slots per page) writes, 128 slots of 32 bytes in a
+// 4 kB page.
+//
+// Boot does not scan: the first slot of each page tells the active page
+// (highest sequence), a binary search over the sequence word finds its first
+// erased slot, the record before it is the current one. The settings are read
+// where they are in flash, nothing is copied.
+//
+// Changes apply at once through the handler and are written
+// SETTINGS_WRITE_DELAY_MS after the last one, so a burst of changes costs one
+// record, and the write (and an erase, about 85 ms with the CPU stalled) runs
+// from the main loop, not from the code that made the change.
+//
+// Power loss: a record is written with its sequence word first and carries a
+// CRC. A torn record counts as written and fails its CRC, the one before it
+// is used; a page whose erase or first record was cut short has no valid
+// first slot and is not taken as active. After a power loss the settings are
+// those before or after the interrupted write, never a mix.
+
+typedef struct
+{
+    uint8_t  digits[4];         // device_id, blinks per LED
+    uint8_t  brightness;
+    uint8_t  blinking;          // pattern on after a reset
+    uint16_t speed;             // fade speed, percent
+    uint16_t click_gap_ms;      // double click window
+} settings_t;
+
+// Settings changed, or loaded by settings_init(). Main loop.
+typedef void (*settings_handler_t)(settings_t const * p_settings);
+
+typedef struct
+{
+    uint32_t sequence;          // of the current record, 0: none, defaults
+    uint8_t  page;              // active page
+    uint8_t  slot;              // current record in the page
+    uint8_t  probes;            // slots read by the last load
+    uint8_t  pending;           // a change not in flash yet
+    uint32_t writes;            // records since init
+    uint32_t erases;            // pages since init
+} settings_info_t;
+
+// Load the settings, p_defaults if flash has none. After app_timer_init().
+// The handler is not called for the loaded settings, read them with
+// settings_get().
+void settings_init(settings_t const * p_defaults, settings_handler_t handler);
+
+// Current settings, in flash unless a change is not written yet. Valid until
+// the next settings_update().
+settings_t const * settings_get(void);
+
+// Apply p_settings through the handler and write them after
+// SETTINGS_WRITE_DELAY_MS, nothing happens if they do not change
+void settings_update(settings_t const * p_settings);
+
+// Write a change whose delay is over, main loop
+void settings_process(void);
+
+// Write a pending change now
+void settings_flush(void);
+
+void settings_info_get(settings_info_t * p_info);
+
+#endif
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Print how long the last boot of the device took, stage by stage (boot.h).
+
+  boot_report.py [--port /dev/ttyACM0] [--check-order]
+
+Times are from main() to the end of each stage, taken with the CPU cycle
+counter. --check-order exits with 1 unless every stage was reached with its
+stamp not before the one of the stage ahead of it.
+"""
+
+import argparse
+import struct
+import sys
+
+import usb_link
+
+# boot_stage_t
+STAGES = ("main", "clock", "leds", "timers", "button", "first light", "usb", "diagnostics")
+TRIGGERS = ("none", "vbus", "idle")
+
+REPORT = struct.Struct("<I%dIHBB" % len(STAGES))
+
+
+def report(link):
+    link.send(usb_link.BOOT_CTRL)
+    while True:
+        frame = link.receive()
+        if frame is None:
+            sys.exit("boot_report.py: no answer from the device")
+        if frame[0] == usb_link.BOOT_REPORT:
+            values = REPORT.unpack(frame[1][:REPORT.size])
+            return values[0], values[1:1 + len(STAGES)], values[-3], values[-2]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--check-order", action="store_true")
+    args = parser.parse_args()
+
+    with usb_link.Link(args.port) as link:
+        core_hz, cycles, done, trigger = report(link)
+
+    ok = True
+    previous = 0
+    print("deferred stages started by %s" % TRIGGERS[trigger])
+    for stage, name in enumerate(STAGES):
+        if not done & (1 << stage):
+            print("  %-12s  not reached" % name)
+            ok = False
+            continue
+        print("  %-12s %10.1f us  %+9.1f us" % (name, cycles[stage] * 1e6 / core_hz,
+                                             (cycles[stage] - previous) * 1e6 / core_hz))
+        ok &= cycles[stage] >= previous
+        previous = cycles[stage]
+
+    if args.check_order and not ok:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Print the DLOG messages of the device (dlog.h) with a dictionary.
+
+  dlog.py --port /dev/ttyACM0 [--dict _build/nrf52840_xxaa.dict.json]
+  dlog.py --raw records.bin --dict dict.json
+
+The device sends string offsets and raw 32-bit arguments, the formats come
+from the dictionary that tools/dlog_dict.py made of the same .out file. A
+record whose offset is not in the dictionary was logged by another build.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+import usb_link
+
+HEADER = struct.Struct("<II")
+DATA = struct.Struct("<I")
+NARGS_POS = 24
+ID_MASK = (1 << NARGS_POS) - 1
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+
+SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diouxXcp%])")
+
+
+def format_message(fmt, args):
+    """printf with the subset DLOG supports, arguments are raw uint32."""
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        spec = "%" + flags + width + ("." + precision if precision else "")
+        if conversion in "di":
+            return (spec + "d") % (value - (1 << 32) if value & (1 << 31) else value)
+        if conversion == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conversion == "p":
+            return "0x%08x" % value
+        return (spec + conversion) % value
+
+    return SPEC.sub(convert, fmt)
+
+
+def records(payload, offset=0):
+    """(timestamp, id, args) of the records packed in payload."""
+    while offset + HEADER.size <= len(payload):
+        timestamp, header = HEADER.unpack_from(payload, offset)
+        nargs = header >> NARGS_POS
+        args = struct.unpack_from("<%dI" % nargs, payload, offset + HEADER.size)
+        offset += HEADER.size + 4 * nargs
+        yield timestamp, header & ID_MASK, args
+
+
+def message(entries, record):
+    timestamp, string_id, args = record
+    entry = entries.get(str(string_id))
+    if entry is None:
+        return "%12.6f ?  unknown string %d, args %s" % (timestamp / 1e6, string_id, list(args))
+    return "%12.6f %s  %s:%d  %s" % (timestamp / 1e6, LEVELS.get(entry["level"], "?"),
+                                    entry["file"], entry["line"],
+                                    format_message(entry["format"], args))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="read from the device until interrupted")
+    source.add_argument("--raw", help="read records as sent by the device from a file")
+    parser.add_argument("--dict", default="_build/nrf52840_xxaa.dict.json")
+    args = parser.parse_args()
+
+    with open(args.dict) as dict_file:
+        entries = json.load(dict_file)["entries"]
+
+    if args.raw:
+        with open(args.raw, "rb") as raw:
+            for record in records(raw.read()):
+                print(message(entries, record))
+        return
+
+    dropped = 0
+    with usb_link.Link(args.port) as link:
+        try:
+            while True:
+                frame = link.receive()
+                if frame is None or frame[0] != usb_link.DLOG_DATA:
+                    continue
+                (total,) = DATA.unpack_from(frame[1])
+                if total != dropped:
+                    print("--- %d messages dropped on the device" % (total - dropped))
+                    dropped = total
+                for record in records(frame[1], DATA.size):
+                    print(message(entries, record))
+                sys.stdout.flush()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Extract the DLOG dictionary (dlog.h) from a linked ELF file.
+
+Every DLOG_*() call leaves "level<US>file:line<US>format" in the dlog_str
+section; the device sends the offset of that string. The dictionary maps the
+offsets to level, location and format, as JSON.
+"""
+
+import argparse
+import json
+import struct
+
+SECTION = "dlog_str"
+SEPARATOR = "\x1f"
+
+
+def sections(data):
+    """{name: bytes} of an ELF32/ELF64 little-endian file."""
+    if data[:4] != b"\x7fELF" or data[5] != 1:
+        raise ValueError("not a little-endian ELF file")
+    if data[4] == 1:
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        header = struct.Struct("<IIIIIIIIII")
+    else:
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        header = struct.Struct("<IIQQQQIIQQ")
+
+    headers = [header.unpack_from(data, shoff + i * shentsize) for i in range(shnum)]
+    names_offset, names_size = headers[shstrndx][4], headers[shstrndx][5]
+    names = data[names_offset:names_offset + names_size]
+
+    result = {}
+    for name_index, section_type, _, _, offset, size, *_ in headers:
+        name = names[name_index:names.index(b"\0", name_index)].decode()
+        if section_type != 8:    # SHT_NOBITS has no contents
+            result[name] = data[offset:offset + size]
+    return result
+
+
+def dictionary(contents):
+    entries = {}
+    offset = 0
+    for raw in contents.split(b"\0"):
+        if raw:
+            level, location, fmt = raw.decode("utf-8", "replace").split(SEPARATOR, 2)
+            file, line = location.rsplit(":", 1)
+            entries[str(offset)] = {"level": int(level), "file": file, "line": int(line),
+                                    "format": fmt}
+        offset += len(raw) + 1
+    return entries
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    with open(args.elf, "rb") as elf:
+        contents = sections(elf.read()).get(SECTION, b"")
+    entries = dictionary(contents)
+    with open(args.output, "w") as out:
+        json.dump({"elf": args.elf, "entries": entries}, out, indent=1, sort_keys=True)
+    print("%s: %d format strings, %d bytes kept out of the image" %
+          (args.output, len(entries), len(contents)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Generate the const fade curve tables for the LED engine.
+
+  gen_fade_tables.py [--steps 101] -o fade_tables_gen.c
+
+The output is a C file with the tables declared in fade_tables.h, the
+Makefiles build it into their output directory. Every table maps a fade step
+0..steps-1 to a PWM compare value with full scale 2^bits - 1, so the firmware
+copies values instead of computing them.
+"""
+
+import argparse
+
+CURVES = ("linear", "gamma22", "cie1931")
+RESOLUTIONS = (8, 10, 15)
+
+
+def linear(x):
+    return x
+
+
+def gamma22(x):
+    return x ** 2.2
+
+
+def cie1931(x):
+    # Relative luminance Y for perceived lightness L* = 100 * x
+    lightness = 100.0 * x
+    if lightness <= 8.0:
+        return lightness / 903.3
+    return ((lightness + 16.0) / 116.0) ** 3
+
+
+def table(curve, bits, steps):
+    top = (1 << bits) - 1
+    func = globals()[curve]
+    return [int(round(func(i / (steps - 1)) * top)) for i in range(steps)]
+
+
+def render(steps):
+    out = ["// Generated by tools/gen_fade_tables.py, do not edit",
+           '#include "fade_tables.h"',
+           "",
+           "#if FADE_TABLE_STEPS != %d" % steps,
+           '#error "fade tables were generated for a different FADE_TABLE_STEPS"',
+           "#endif",
+           ""]
+
+    for curve in CURVES:
+        for bits in RESOLUTIONS:
+            values = table(curve, bits, steps)
+            out.append("const uint16_t fade_table_%s_%d[FADE_TABLE_STEPS] =" % (curve, bits))
+            out.append("{")
+            for i in range(0, len(values), 12):
+                out.append("    " + ", ".join("%5d" % v for v in values[i:i + 12]) + ",")
+            out.append("};")
+            out.append("")
+
+    out.append("uint16_t const * const fade_tables[FADE_CURVE_COUNT][FADE_RESOLUTION_COUNT] =")
+    out.append("{")
+    for curve in CURVES:
+        row = ", ".join("fade_table_%s_%d" % (curve, bits) for bits in RESOLUTIONS)
+        out.append("    { %s }," % row)
+    out.append("};")
+
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--steps", type=int, default=101, help="entries per table")
+    parser.add_argument("-o", "--output", required=True, help="generated C file")
+    args = parser.parse_args()
+
+    with open(args.output, "w") as f:
+        f.write(render(args.steps))
+
+
+if __name__ == "__main__":
+    main()
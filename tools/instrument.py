@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Read the cycle counts of the instrumented regions (instrument.h).
+
+  instrument.py dump [--hist] [--port /dev/ttyACM0]
+  instrument.py reset
+
+Prints count, min, mean, percentiles and max per region in microseconds.
+Percentiles come from the histogram and are the lower bound of their bucket.
+"""
+
+import argparse
+import struct
+import sys
+
+import usb_link
+
+COMMANDS = ("reset", "dump")
+
+STATS = struct.Struct("<BBBBIIIIIQ24s")
+HIST = struct.Struct("<BBH")
+
+
+def bucket_floor(bucket, sub_bits):
+    sub_buckets = 1 << sub_bits
+    if bucket < sub_buckets:
+        return bucket
+    octave, sub = divmod(bucket, sub_buckets)
+    return (sub_buckets + sub) << (octave - 1)
+
+
+def dump(link):
+    link.send(usb_link.INSTRUMENT_CTRL, bytes([COMMANDS.index("dump")]))
+    regions = {}
+    expected = None
+    while expected is None or len(regions) < expected or \
+            any(len(r["received"]) < r["buckets"] for r in regions.values()):
+        frame = link.receive()
+        if frame is None:
+            sys.exit("instrument.py: no answer from the device")
+        msg_type, payload = frame
+        if msg_type == usb_link.INSTRUMENT_STATS:
+            fields = STATS.unpack(payload[:STATS.size])
+            stats = dict(zip(("region", "regions", "buckets", "sub_bucket_bits", "cpu_hz",
+                              "overhead", "count", "min", "max", "sum", "name"), fields))
+            stats["name"] = stats["name"].split(b"\0")[0].decode()
+            stats["histogram"] = [0] * stats["buckets"]
+            stats["received"] = set()
+            regions[stats["region"]] = stats
+            expected = stats["regions"]
+        elif msg_type == usb_link.INSTRUMENT_HIST:
+            region, first, _ = HIST.unpack_from(payload)
+            counts = struct.unpack_from("<%dI" % ((len(payload) - HIST.size) // 4),
+                                        payload, HIST.size)
+            stats = regions.get(region)
+            if stats is not None:
+                stats["histogram"][first:first + len(counts)] = counts
+                stats["received"].update(range(first, first + len(counts)))
+    return [regions[r] for r in sorted(regions)]
+
+
+def percentile(stats, fraction):
+    target = fraction * stats["count"]
+    seen = 0
+    for bucket, count in enumerate(stats["histogram"]):
+        seen += count
+        if count and seen >= target:
+            return bucket_floor(bucket, stats["sub_bucket_bits"])
+    return 0
+
+
+def report(regions, show_hist):
+    if not regions:
+        return
+    us = 1e6 / regions[0]["cpu_hz"]
+    print("%d MHz, %d cycles overhead subtracted" % (regions[0]["cpu_hz"] // 1000000,
+                                                    regions[0]["overhead"]))
+    print("%-18s %9s %9s %9s %9s %9s %9s" % ("region [us]", "count", "min", "mean", "p50", "p99",
+                                            "max"))
+    for r in regions:
+        if r["count"] == 0:
+            print("%-18s %9d" % (r["name"], 0))
+            continue
+        print("%-18s %9d %9.2f %9.2f %9.2f %9.2f %9.2f" %
+              (r["name"], r["count"], r["min"] * us, r["sum"] / r["count"] * us,
+               percentile(r, 0.5) * us, percentile(r, 0.99) * us, r["max"] * us))
+        if show_hist:
+            peak = max(r["histogram"])
+            for bucket, count in enumerate(r["histogram"]):
+                if count:
+                    low = bucket_floor(bucket, r["sub_bucket_bits"]) * us
+                    print("    >= %10.2f %9d %s" % (low, count, "#" * max(1, 40 * count // peak)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("command", choices=COMMANDS)
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--hist", action="store_true", help="print the histograms too")
+    args = parser.parse_args()
+
+    with usb_link.Link(args.port) as link:
+        if args.command != "dump":
+            link.send(usb_link.INSTRUMENT_CTRL, bytes([COMMANDS.index(args.command)]))
+            return
+        regions = dump(link)
+
+    report(regions, args.hist)
+
+
+if __name__ == "__main__":
+    main()
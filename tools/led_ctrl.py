@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Set the LEDs of the device over the USB link (led_command.h).
+
+  led_ctrl.py [--port /dev/ttyACM0] command [command ...]
+
+Commands run in the order given, each answered by the device:
+
+  status                   print the state only
+  start, stop              blinking on or off, as a double click
+  device-id DIGITS         four digits 0..9, the blinks per LED
+  brightness LEVEL         0..255
+  speed PERCENT            fade speed, 100 is the pattern as written
+  click-gap MS             double click window, 100..2000
+  save                     write the settings to flash now
+  pattern NAME             play a pattern of patterns/*.pat, such as heartbeat
+
+Changes are kept over resets, written to flash a moment after the last one.
+A pattern is not, the device_id blinks come back after a reset.
+
+--corrupt first sends a command with a broken CRC, which the device drops
+and counts in its rx errors. The exit status is 1 if a command failed.
+"""
+
+import argparse
+import struct
+import sys
+
+import usb_link
+
+# led_command_op_t: name, operand count
+OPS = [("status", 0), ("start", 0), ("stop", 0), ("device-id", 1), ("brightness", 1), ("speed", 1),
+       ("click-gap", 1), ("save", 0), ("pattern", 1)]
+NAMES = [name for name, _ in OPS]
+RESULTS = ("ok", "bad length", "bad value", "unknown command", "busy")
+
+STATUS = struct.Struct("<BBBBH4BHI")
+
+
+def payload(name, args):
+    op = NAMES.index(name)
+    if name == "device-id":
+        if len(args[0]) != 4 or not args[0].isdigit():
+            raise ValueError("device-id takes four digits, not '%s'" % args[0])
+        return bytes([op] + [int(digit) for digit in args[0]])
+    if name == "brightness":
+        return bytes([op, int(args[0], 0) & 0xFF])
+    if name in ("speed", "click-gap"):
+        return bytes([op]) + struct.pack("<H", int(args[0], 0))
+    if name == "pattern":
+        return bytes([op]) + args[0].encode("ascii")
+    return bytes([op])
+
+
+def parse(words):
+    commands = []
+    while words:
+        name = words.pop(0)
+        if name not in NAMES:
+            raise ValueError("unknown command '%s'" % name)
+        count = dict(OPS)[name]
+        if len(words) < count:
+            raise ValueError("%s needs an operand" % name)
+        commands.append((name, payload(name, words[:count])))
+        del words[:count]
+    return commands
+
+
+def status(link):
+    while True:
+        frame = link.receive()
+        if frame is None:
+            sys.exit("led_ctrl.py: no answer from the device")
+        if frame[0] == usb_link.LED_STATUS:
+            values = STATUS.unpack(frame[1][:STATUS.size])
+            return {"op": values[0], "result": values[1], "running": values[2],
+                    "brightness": values[3], "speed": values[4], "digits": values[5:9],
+                    "click_gap": values[9], "rx_errors": values[10]}
+
+
+def describe(s):
+    result = RESULTS[s["result"]] if s["result"] < len(RESULTS) else "result %d" % s["result"]
+    name = NAMES[s["op"]] if s["op"] < len(NAMES) else "op %d" % s["op"]
+    return "%s: %s, %s, device_id %s, brightness %d, speed %d%%, rx errors %d, click gap %d ms" % (
+        name, result, "running" if s["running"] else "stopped",
+        "".join(str(digit) for digit in s["digits"]), s["brightness"], s["speed"], s["rx_errors"],
+        s["click_gap"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--corrupt", action="store_true", help="send a frame with a bad CRC first")
+    parser.add_argument("commands", nargs="+")
+    args = parser.parse_args()
+
+    try:
+        commands = parse(list(args.commands))
+    except ValueError as error:
+        parser.error(str(error))
+
+    failed = False
+    with usb_link.Link(args.port) as link:
+        if args.corrupt:
+            frame = bytearray(usb_link.encode(usb_link.LED_COMMAND, payload("stop", [])))
+            frame[-1] ^= 0xFF
+            link.send_raw(bytes(frame))
+        for name, data in commands:
+            link.send(usb_link.LED_COMMAND, data)
+            s = status(link)
+            print(describe(s))
+            failed |= s["result"] != 0
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
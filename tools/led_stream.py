@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Stream LED levels to the device over the USB link (led_stream.h).
+
+  led_stream.py [--port /dev/ttyACM0] [--rate 1000] [--seconds 5] [--effect wave]
+  led_stream.py report
+  led_stream.py stop
+
+Frames of four 16-bit levels go out at the rate the device reports for the
+requested one (whole PWM periods), numbered so the device plays each at a
+fixed latency after its slot. A frame that falls behind is sent anyway, the
+device counts it late if it missed its buffer, taken up to two frames ahead. At the end the
+device's report shows frames presented, underruns, late and early frames.
+"""
+
+import argparse
+import math
+import struct
+import sys
+import time
+
+import usb_link
+
+COMMANDS = ("stop", "start", "report")
+
+REPORT = struct.Struct("<7IHBB")
+FIELDS = ("frame_ns", "latency_ns", "received", "presented", "underruns", "late", "early",
+          "next", "running", "reserved")
+
+FULL = 0xFFFF
+# Frames per message at most, more only when the host fell behind
+BATCH = 8
+
+
+def effect_levels(effect, t):
+    if effect == "wave":
+        return [int(FULL * (0.5 + 0.5 * math.sin(2 * math.pi * (t - channel / 8.0)))) for channel in range(4)]
+    if effect == "chase":
+        lit = int(t * 8) % 4
+        return [FULL if channel == lit else 0 for channel in range(4)]
+    return [FULL // 2] * 4
+
+
+def command(link, cmd, frame_us=0):
+    link.send(usb_link.LED_STREAM_CTRL, struct.pack("<BBH", COMMANDS.index(cmd), 0, frame_us))
+    while True:
+        frame = link.receive()
+        if frame is None:
+            sys.exit("led_stream.py: no answer from the device")
+        if frame[0] == usb_link.LED_STREAM_REPORT:
+            return dict(zip(FIELDS, REPORT.unpack(frame[1][:REPORT.size])))
+
+
+def print_report(r):
+    print("frame %.3f us, latency %.3f us, %s" % (r["frame_ns"] / 1e3, r["latency_ns"] / 1e3,
+                                                  "running" if r["running"] else "stopped"))
+    print("  %d received, %d presented, %d underruns, %d late, %d early"
+          % (r["received"], r["presented"], r["underruns"], r["late"], r["early"]))
+
+
+def stream(link, rate, seconds, effect):
+    report = command(link, "start", int(1e6 / rate))
+    period = report["frame_ns"] / 1e9
+    frames = int(seconds / period)
+    start = time.perf_counter()
+    sequence = 0
+
+    while sequence < frames:
+        due = int((time.perf_counter() - start) / period) + 1
+        count = min(due - sequence, BATCH, frames - sequence)
+        if count <= 0:
+            time.sleep(max(0, start + sequence * period - time.perf_counter()))
+            continue
+        data = struct.pack("<H", sequence & 0xFFFF)
+        for i in range(count):
+            data += struct.pack("<4H", *effect_levels(effect, (sequence + i) * period))
+        link.send(usb_link.LED_STREAM_DATA, data)
+        sequence += count
+
+    # The last frames are still buffered for the latency
+    time.sleep(report["latency_ns"] / 1e9 + 2 * period)
+    report = command(link, "report")
+    command(link, "stop")
+    return frames, report
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("command", nargs="?", choices=("stream",) + COMMANDS[::2], default="stream")
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--rate", type=float, default=1000, help="frames per second, up to 1000")
+    parser.add_argument("--seconds", type=float, default=5)
+    parser.add_argument("--effect", choices=("wave", "chase", "solid"), default="wave")
+    args = parser.parse_args()
+
+    with usb_link.Link(args.port) as link:
+        if args.command == "stream":
+            frames, report = stream(link, args.rate, args.seconds, args.effect)
+            print("%d frames sent" % frames)
+            print_report(report)
+            return 0 if report["received"] else 1
+        print_report(command(link, args.command))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
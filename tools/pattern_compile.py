@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""Compile LED pattern descriptions (patterns/*.pat) into pattern VM bytecode.
+
+The output is a C file with one const byte array per pattern and a table
+of them placed in the led_patterns section. The firmware runs the arrays
+where they are in flash, nothing is copied or parsed at boot.
+
+A description has one op per line, '#' starts a comment:
+
+    pattern heartbeat          # starts a pattern, a C identifier
+        loop 0                 # 0: forever
+            fade 0xF 255 120 ease_out
+            fade 0xF 0 200 ease_in
+            wait 400
+        next
+    top:                       # label, for jump, jz and branch
+        blink 1 BLINK_FADE_MS BLINK_EASING
+        jump top
+
+Ops and operands are those of pattern_vm.h, lower case. Easings are
+given by name (linear, ease_in, ease_out, ease_in_out, cubic, step) or
+value. A numeric operand is range checked here; an identifier is passed
+to the C compiler, so config macros such as BLINK_FADE_MS can be used.
+Loops must be balanced and a jump target must be inside the same loops
+as the jump, the same rules pattern_vm_load() applies.
+"""
+
+import argparse
+import re
+import sys
+
+# name: (operand kinds), in opcode order. Kinds: mask, level, ms, easing,
+# count, var, event, label
+OPS = [
+    ("end",          ()),
+    ("set",          ("mask", "level")),
+    ("fade",         ("mask", "level", "ms", "easing")),
+    ("blink",        ("mask", "blink_ms", "easing")),
+    ("blink_var",    ("blink_ms", "easing")),
+    ("wait",         ("ms",)),
+    ("loop",         ("count",)),
+    ("loop_var",     ("var",)),
+    ("loop_max",     ()),
+    ("next",         ()),
+    ("jump",         ("label",)),
+    ("jz",           ("var", "label")),
+    ("branch_event", ("event", "label")),
+]
+
+EASINGS = ["linear", "ease_in", "ease_out", "ease_in_out", "cubic", "step"]
+
+# Limits of pattern_vm.h
+CHANNELS = 4
+VARS = 8
+EVENTS = 8
+LOOP_DEPTH = 4
+
+RANGES = {
+    "mask":     (0, (1 << CHANNELS) - 1),
+    "level":    (0, 255),
+    "ms":       (0, 0xFFFF),
+    "blink_ms": (0, 0x7FFF),
+    "easing":   (0, len(EASINGS) - 1),
+    "count":    (0, 255),
+    "var":      (0, VARS - 1),
+    "event":    (0, EVENTS - 1),
+}
+
+WIDE = ("ms", "blink_ms", "label")
+
+IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+
+
+class PatternError(Exception):
+    pass
+
+
+def op_size(kinds):
+    return 1 + sum(2 if kind in WIDE else 1 for kind in kinds)
+
+
+class Pattern:
+    def __init__(self, name, source):
+        self.name = name
+        self.source = source
+        self.ops = []           # (address, op name, operands, loop id, line)
+        self.labels = {}        # name: (address, loop id)
+        self.length = 0
+
+
+def operand(kind, text, where):
+    if kind == "easing" and text in EASINGS:
+        return EASINGS.index(text)
+    try:
+        value = int(text, 0)
+    except ValueError:
+        if IDENTIFIER.match(text):
+            return text
+        raise PatternError("%s: bad %s operand '%s'" % (where, kind, text))
+
+    low, high = RANGES[kind]
+    if not low <= value <= high:
+        raise PatternError("%s: %s %d out of range %d..%d" % (where, kind, value, low, high))
+    return value
+
+
+def parse(path):
+    patterns = []
+    pattern = None
+    loops = []
+    loop_ids = 0
+
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            where = "%s:%d" % (path, number)
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+
+            if words[0] == "pattern":
+                if len(words) != 2 or not IDENTIFIER.match(words[1]):
+                    raise PatternError("%s: pattern needs a name" % where)
+                if loops:
+                    raise PatternError("%s: loop without next" % where)
+                pattern = Pattern(words[1], where)
+                patterns.append(pattern)
+                continue
+            if pattern is None:
+                raise PatternError("%s: op before the first pattern" % where)
+
+            loop = loops[-1] if loops else None
+
+            if len(words) == 1 and words[0].endswith(":"):
+                label = words[0][:-1]
+                if not IDENTIFIER.match(label) or label in pattern.labels:
+                    raise PatternError("%s: bad or repeated label '%s'" % (where, label))
+                pattern.labels[label] = (pattern.length, loop)
+                continue
+
+            names = [name for name, _ in OPS]
+            if words[0] not in names:
+                raise PatternError("%s: unknown op '%s'" % (where, words[0]))
+            name = words[0]
+            kinds = OPS[names.index(name)][1]
+            if len(words) - 1 != len(kinds):
+                raise PatternError("%s: %s takes %d operands" % (where, name, len(kinds)))
+
+            operands = [text if kind == "label" else operand(kind, text, where)
+                        for kind, text in zip(kinds, words[1:])]
+
+            if name.startswith("loop"):
+                if len(loops) == LOOP_DEPTH:
+                    raise PatternError("%s: loops nested deeper than %d" % (where, LOOP_DEPTH))
+                pattern.ops.append((pattern.length, name, operands, loop, where))
+                loop_ids += 1
+                loops.append(loop_ids)
+            elif name == "next":
+                if not loops:
+                    raise PatternError("%s: next without loop" % where)
+                loops.pop()
+                pattern.ops.append((pattern.length, name, operands, loops[-1] if loops else None, where))
+            else:
+                pattern.ops.append((pattern.length, name, operands, loop, where))
+            pattern.length += op_size(kinds)
+
+    if loops:
+        raise PatternError("%s: loop without next" % path)
+
+    return patterns
+
+
+def resolve(pattern):
+    if pattern.length == 0:
+        raise PatternError("%s: pattern %s is empty" % (pattern.source, pattern.name))
+    if pattern.length > 0xFFFF:
+        raise PatternError("%s: pattern %s is too long" % (pattern.source, pattern.name))
+
+    for address, name, operands, loop, where in pattern.ops:
+        kinds = dict(OPS)[name]
+        for i, kind in enumerate(kinds):
+            if kind != "label":
+                continue
+            label = operands[i]
+            if label not in pattern.labels:
+                raise PatternError("%s: unknown label '%s'" % (where, label))
+            target, target_loop = pattern.labels[label]
+            if target >= pattern.length:
+                raise PatternError("%s: label '%s' is past the last op" % (where, label))
+            if target_loop != loop:
+                raise PatternError("%s: jump to '%s' leaves or enters a loop" % (where, label))
+            operands[i] = target
+
+
+def c_operand(value):
+    return str(value) if isinstance(value, int) else value
+
+
+def render(patterns, sources):
+    out = ["// Generated by tools/pattern_compile.py from %s, do not edit" % ", ".join(sources),
+           '#include "patterns.h"',
+           '#include "pattern_vm.h"',
+           '#include "sdk_config.h"',
+           ""]
+
+    for pattern in patterns:
+        out.append("// %s, %d bytes" % (pattern.source, pattern.length))
+        out.append("static const uint8_t m_%s[] =" % pattern.name)
+        out.append("{")
+        for address, name, operands, _, _ in pattern.ops:
+            args = ", ".join(c_operand(value) for value in operands)
+            out.append("    /* %4d */ PATTERN_%s(%s)," % (address, name.upper(), args))
+        out.append("};")
+        out.append("")
+
+    out.append("// In flash, found by patterns_find() through the section bounds")
+    out.append("static const patterns_entry_t m_patterns[] __attribute__((section(\"led_patterns\"), used)) =")
+    out.append("{")
+    for pattern in patterns:
+        out.append('    {"%s", m_%s, sizeof(m_%s)},' % (pattern.name, pattern.name, pattern.name))
+    out.append("};")
+
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("sources", nargs="+", help="pattern descriptions")
+    parser.add_argument("-o", "--output", required=True, help="generated C file")
+    args = parser.parse_args()
+
+    patterns = []
+    try:
+        for path in args.sources:
+            patterns += parse(path)
+        names = set()
+        for pattern in patterns:
+            if pattern.name in names:
+                raise PatternError("%s: pattern %s defined twice" % (pattern.source, pattern.name))
+            names.add(pattern.name)
+            resolve(pattern)
+    except (OSError, PatternError) as error:
+        print("pattern_compile: %s" % error, file=sys.stderr)
+        return 1
+
+    with open(args.output, "w") as f:
+        f.write(render(patterns, args.sources))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
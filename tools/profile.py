@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Control the sampling profiler (profiler.h) and print where the time went.
+
+  profile.py start | stop | reset
+  profile.py dump [--elf _build/nrf52840_xxaa.out] [--top 30]
+
+The dump maps every histogram bucket to the function that contains its start
+address, taken from the ELF with nm. A bucket straddling two functions is
+counted for the first one, PROFILER_BUCKET_SHIFT sets how often that happens.
+"""
+
+import argparse
+import bisect
+import struct
+import subprocess
+import sys
+
+import usb_link
+
+COMMANDS = ("stop", "start", "reset", "dump")
+
+INFO = struct.Struct("<IIIIIHBB")
+ENTRY = struct.Struct("<II")
+
+
+def dump(link):
+    link.send(usb_link.PROFILER_CTRL, bytes([COMMANDS.index("dump")]))
+    info = None
+    entries = []
+    while info is None or len(entries) < info["entries"]:
+        frame = link.receive()
+        if frame is None:
+            sys.exit("profile.py: no answer from the device")
+        msg_type, payload = frame
+        if msg_type == usb_link.PROFILER_INFO:
+            fields = INFO.unpack(payload[:INFO.size])
+            info = dict(zip(("code_start", "rate_hz", "samples", "outside", "entries",
+                             "buckets", "bucket_shift", "running"), fields))
+            entries = []
+        elif msg_type == usb_link.PROFILER_DATA and info is not None:
+            entries += [ENTRY.unpack_from(payload, i)
+                        for i in range(0, len(payload) - ENTRY.size + 1, ENTRY.size)]
+    return info, entries
+
+
+def symbols(nm, elf):
+    out = subprocess.run([nm, "--defined-only", "-S", "-n", elf],
+                         check=True, capture_output=True, text=True).stdout
+    table = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "tTwW":
+            # Thumb addresses have bit 0 set
+            table.append((int(parts[0], 16) & ~1, int(parts[1], 16), parts[3]))
+    return table
+
+
+def symbolize(table, address):
+    i = bisect.bisect_right([start for start, _, _ in table], address) - 1
+    if i >= 0:
+        start, size, name = table[i]
+        if address < start + max(size, 1):
+            return name
+    return "0x%08x" % address
+
+
+def report(info, entries, table, top):
+    samples = info["samples"]
+    per_function = {}
+    for bucket, count in entries:
+        address = info["code_start"] + (bucket << info["bucket_shift"])
+        name = symbolize(table, address) if table else "0x%08x" % address
+        per_function[name] = per_function.get(name, 0) + count
+
+    print("%d samples at %d Hz (%.1f s), %s" %
+          (samples, info["rate_hz"], samples / max(info["rate_hz"], 1),
+           "running" if info["running"] else "stopped"))
+    if samples == 0:
+        return
+    if info["outside"]:
+        per_function["<outside code>"] = info["outside"]
+
+    ranked = sorted(per_function.items(), key=lambda item: item[1], reverse=True)
+    for name, count in ranked[:top]:
+        print("%8d %6.2f%%  %s" % (count, 100.0 * count / samples, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("command", choices=COMMANDS)
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--elf", default="_build/nrf52840_xxaa.out")
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--top", type=int, default=30)
+    args = parser.parse_args()
+
+    with usb_link.Link(args.port) as link:
+        if args.command != "dump":
+            link.send(usb_link.PROFILER_CTRL, bytes([COMMANDS.index(args.command)]))
+            return
+        info, entries = dump(link)
+
+    try:
+        table = symbols(args.nm, args.elf)
+    except (OSError, subprocess.CalledProcessError) as error:
+        print("profile.py: no symbols (%s), printing addresses" % error, file=sys.stderr)
+        table = []
+    report(info, entries, table, args.top)
+
+
+if __name__ == "__main__":
+    main()
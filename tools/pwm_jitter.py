@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Measure the PWM edge timing of one LED with the self-test (pwm_selftest.h).
+
+  pwm_jitter.py start --channel 0 [--port /dev/ttyACM0]
+  pwm_jitter.py report
+  pwm_jitter.py stop
+
+The LED pin of the channel has to be wired to the capture pin of the device.
+start restarts the statistics, report prints period, pulse width and jitter
+so far, in microseconds, with the jitter histogram.
+"""
+
+import argparse
+import math
+import struct
+import sys
+
+import usb_link
+
+COMMANDS = ("stop", "start", "report")
+
+BUCKETS = 16
+REPORT = struct.Struct("<BBHI8IQQII%dI" % BUCKETS)
+FIELDS = ("channel", "running", "reserved", "capture_pin",
+          "tick_hz", "nominal", "periods", "pulses", "gaps", "lost", "period_min", "period_max",
+          "period_sum", "jitter_square_sum", "pulse_min", "pulse_max")
+
+
+def report(link):
+    link.send(usb_link.PWM_SELFTEST_CTRL, bytes([COMMANDS.index("report"), 0]))
+    while True:
+        frame = link.receive()
+        if frame is None:
+            sys.exit("pwm_jitter.py: no answer from the device")
+        if frame[0] == usb_link.PWM_SELFTEST_REPORT:
+            values = REPORT.unpack(frame[1][:REPORT.size])
+            result = dict(zip(FIELDS, values))
+            result["histogram"] = values[len(FIELDS):]
+            return result
+
+
+def print_report(r):
+    us = 1e6 / r["tick_hz"]
+    print("channel %d on P%d.%02d, %s" % (r["channel"], r["capture_pin"] >> 5, r["capture_pin"] & 31,
+                                          "running" if r["running"] else "stopped"))
+    print("  nominal period %.3f us, %d periods, %d pulses, %d gaps, %d lost"
+          % (r["nominal"] * us, r["periods"], r["pulses"], r["gaps"], r["lost"]))
+    if r["periods"]:
+        jitter_max = max(r["nominal"] - r["period_min"], r["period_max"] - r["nominal"], 0)
+        rms = math.sqrt(r["jitter_square_sum"] / r["periods"])
+        print("  period %.3f / %.3f / %.3f us (min / mean / max)"
+              % (r["period_min"] * us, r["period_sum"] / r["periods"] * us, r["period_max"] * us))
+        print("  jitter %.3f us rms, %.3f us max" % (rms * us, jitter_max * us))
+    if r["pulses"]:
+        print("  pulse  %.3f .. %.3f us" % (r["pulse_min"] * us, r["pulse_max"] * us))
+    for bucket, count in enumerate(r["histogram"]):
+        if count:
+            low = 0 if bucket == 0 else 1 << (bucket - 1)
+            high = 1 if bucket == 0 else 1 << bucket
+            print("  |jitter| %8.3f .. %8.3f us  %d" % (low * us, high * us, count))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("command", choices=COMMANDS)
+    parser.add_argument("--channel", type=int, default=0, help="LED wired to the capture pin")
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    args = parser.parse_args()
+
+    with usb_link.Link(args.port) as link:
+        if args.command == "report":
+            print_report(report(link))
+        else:
+            link.send(usb_link.PWM_SELFTEST_CTRL,
+                      bytes([COMMANDS.index(args.command), args.channel]))
+
+
+if __name__ == "__main__":
+    main()
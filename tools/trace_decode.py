@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Decode binary trace records (trace.h) into a timeline and Chrome JSON.
+
+  trace_decode.py --port /dev/ttyACM0 [--seconds 10] [--save trace.bin]
+  trace_decode.py --raw trace.bin [--json trace.json] [--summary]
+
+Records come live from the USB link or from a file of raw records (as
+written by --save or host/trace_sim). The record names are read from the
+trace_id_t enum in trace.h. --json writes Chrome trace-event JSON for
+chrome://tracing or ui.perfetto.dev, one track per BEGIN/END pair.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+import time
+
+import usb_link
+
+RECORD = struct.Struct("<IHHI")
+DATA = struct.Struct("<I")
+TRACE_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "trace.h")
+
+
+def names(path):
+    text = open(path).read()
+    body = re.search(r"typedef enum\s*{(.*?)}\s*trace_id_t;", text, re.S).group(1)
+    return [name for name in re.findall(r"^\s*TRACE_(\w+)\s*[,=]", body, re.M)]
+
+
+def read_raw(path):
+    data = open(path, "rb").read()
+    return [RECORD.unpack_from(data, i) for i in range(0, len(data) - RECORD.size + 1, RECORD.size)]
+
+
+def read_port(port, seconds, save):
+    records = []
+    dropped = 0
+    end = time.monotonic() + seconds
+    with usb_link.Link(port, timeout=0.2) as link:
+        while time.monotonic() < end:
+            frame = link.receive()
+            if frame is None or frame[0] != usb_link.TRACE_DATA:
+                continue
+            msg_type, payload = frame
+            (dropped,) = DATA.unpack_from(payload)
+            records += [RECORD.unpack_from(payload, i)
+                        for i in range(DATA.size, len(payload) - RECORD.size + 1, RECORD.size)]
+    if save:
+        with open(save, "wb") as out:
+            for record in records:
+                out.write(RECORD.pack(*record))
+    if dropped:
+        print("%d records dropped on the device" % dropped, file=sys.stderr)
+    return records
+
+
+def unwrap(records):
+    """Extend the 32-bit microsecond timestamps and sort by time."""
+    events = []
+    base = 0
+    previous = None
+    for timestamp, record_id, arg0, arg1 in records:
+        if previous is not None and timestamp < previous and previous - timestamp > 1 << 31:
+            base += 1 << 32
+        elif previous is not None and timestamp > previous and timestamp - previous > 1 << 31:
+            # A late record from before the last wrap
+            events.append((base - (1 << 32) + timestamp, record_id, arg0, arg1))
+            continue
+        previous = timestamp
+        events.append((base + timestamp, record_id, arg0, arg1))
+    events.sort(key=lambda event: event[0])
+    return events
+
+
+def split(name):
+    for suffix, phase in (("_BEGIN", "B"), ("_END", "E")):
+        if name.endswith(suffix):
+            return name[:-len(suffix)], phase
+    return name, "i"
+
+
+def decode(events, id_names):
+    """(time_us, base name, phase, arg0, arg1, duration_us or None)"""
+    decoded = []
+    open_at = {}
+    for time_us, record_id, arg0, arg1 in events:
+        name = id_names[record_id] if record_id < len(id_names) else "ID_%d" % record_id
+        base, phase = split(name)
+        duration = None
+        if phase == "B":
+            open_at[(base, arg0)] = time_us
+        elif phase == "E" and (base, arg0) in open_at:
+            duration = time_us - open_at.pop((base, arg0))
+        decoded.append((time_us, base, phase, arg0, arg1, duration))
+    return decoded
+
+
+def timeline(decoded, out):
+    start = decoded[0][0] if decoded else 0
+    for time_us, base, phase, arg0, arg1, duration in decoded:
+        label = base + {"B": " begin", "E": " end", "i": ""}[phase]
+        extra = "  (%d us)" % duration if duration is not None else ""
+        out.write("%14.6f  %-16s %5d %10d%s\n" % ((time_us - start) / 1e6, label, arg0, arg1, extra))
+
+
+def summary(decoded):
+    counts = {}
+    durations = {}
+    for _, base, phase, _, _, duration in decoded:
+        if phase != "E":
+            counts[base] = counts.get(base, 0) + 1
+        if duration is not None:
+            durations.setdefault(base, []).append(duration)
+    span = (decoded[-1][0] - decoded[0][0]) / 1e6 if decoded else 0
+    print("%d records over %.3f s" % (len(decoded), span))
+    for base in sorted(counts):
+        line = "  %-16s %7d" % (base, counts[base])
+        if base in durations:
+            d = durations[base]
+            line += "  min %d us, mean %d us, max %d us" % (min(d), sum(d) // len(d), max(d))
+        print(line)
+
+
+def chrome(decoded):
+    tracks = {}
+    trace_events = []
+    for time_us, base, phase, arg0, arg1, _ in decoded:
+        track = base if phase != "i" else "events"
+        tid = tracks.setdefault(track, len(tracks) + 1)
+        event = {"name": base, "ph": phase, "ts": time_us, "pid": 1, "tid": tid}
+        if phase == "i":
+            event["s"] = "t"
+        if phase != "E":
+            event["args"] = {"arg0": arg0, "arg1": arg1}
+        trace_events.append(event)
+    for track, tid in tracks.items():
+        trace_events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                             "args": {"name": track}})
+    return {"traceEvents": trace_events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="read from the device")
+    source.add_argument("--raw", help="read raw records from a file")
+    parser.add_argument("--seconds", type=float, default=10, help="how long to read the port")
+    parser.add_argument("--save", help="also write the raw records read from the port")
+    parser.add_argument("--header", default=TRACE_H, help="trace.h with the record names")
+    parser.add_argument("--json", help="write Chrome trace-event JSON")
+    parser.add_argument("--summary", action="store_true", help="counts and durations only")
+    args = parser.parse_args()
+
+    id_names = names(args.header)
+    records = read_raw(args.raw) if args.raw else read_port(args.port, args.seconds, args.save)
+    decoded = decode(unwrap(records), id_names)
+
+    if args.summary:
+        summary(decoded)
+    else:
+        timeline(decoded, sys.stdout)
+    if args.json:
+        with open(args.json, "w") as out:
+            json.dump(chrome(decoded), out)
+
+
+if __name__ == "__main__":
+    main()
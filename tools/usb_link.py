@@ -0,0 +1,127 @@
+"""Host side of the framed USB link (usb_link.h).
+
+Every frame is 0xA5 | type | length (16 bit LE) | payload | CRC-16 (LE), the
+CRC being the nRF5 SDK crc16_compute() over type, length and payload.
+"""
+
+import os
+import struct
+import termios
+
+SYNC = 0xA5
+MAX_PAYLOAD = 256
+
+# usb_link_msg_t
+PROFILER_CTRL = 0x01
+INSTRUMENT_CTRL = 0x02
+PWM_SELFTEST_CTRL = 0x03
+LED_COMMAND = 0x04
+LED_STREAM_CTRL = 0x05
+LED_STREAM_DATA = 0x06
+BOOT_CTRL = 0x07
+PROFILER_INFO = 0x81
+PROFILER_DATA = 0x82
+INSTRUMENT_STATS = 0x83
+INSTRUMENT_HIST = 0x84
+TRACE_DATA = 0x85
+DLOG_DATA = 0x86
+PWM_SELFTEST_REPORT = 0x87
+LED_STATUS = 0x88
+LED_STREAM_REPORT = 0x89
+BOOT_REPORT = 0x8A
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc = ((crc >> 8) & 0xFF) | ((crc << 8) & 0xFFFF)
+        crc ^= byte
+        crc ^= (crc & 0xFF) >> 4
+        crc ^= (crc << 12) & 0xFFFF
+        crc ^= ((crc & 0xFF) << 5) & 0xFFFF
+    return crc
+
+
+def encode(msg_type, payload=b""):
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError("payload of %d bytes" % len(payload))
+    header = struct.pack("<BH", msg_type, len(payload))
+    return bytes([SYNC]) + header + payload + struct.pack("<H", crc16(header + payload))
+
+
+class Decoder:
+    """Splits a byte stream into (type, payload), skipping bad frames."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.errors = 0
+
+    def feed(self, data):
+        self.buffer += data
+        frames = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                self.buffer.clear()
+                return frames
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                return frames
+            msg_type, length = struct.unpack_from("<BH", self.buffer, 1)
+            if length > MAX_PAYLOAD:
+                self.errors += 1
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < 6 + length:
+                return frames
+            payload = bytes(self.buffer[4:4 + length])
+            (crc,) = struct.unpack_from("<H", self.buffer, 4 + length)
+            if crc != crc16(self.buffer[1:4 + length]):
+                # Resynchronise on the next sync byte
+                self.errors += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:6 + length]
+            frames.append((msg_type, payload))
+
+
+class Link:
+    """Raw serial port to the device, CDC ACM ignores the baud rate."""
+
+    def __init__(self, port, timeout=1.0):
+        self.fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[0] = 0                                  # iflag
+        attrs[1] = 0                                  # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                  # lflag
+        attrs[6][termios.VMIN] = 0
+        attrs[6][termios.VTIME] = max(1, int(timeout * 10))
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.decoder = Decoder()
+        self.pending = []
+
+    def close(self):
+        os.close(self.fd)
+
+    def send(self, msg_type, payload=b""):
+        os.write(self.fd, encode(msg_type, payload))
+
+    def send_raw(self, data):
+        """Bytes as they are, for framing tests."""
+        os.write(self.fd, data)
+
+    def receive(self):
+        """Next frame, None after the timeout."""
+        while not self.pending:
+            data = os.read(self.fd, 4096)
+            if not data:
+                return None
+            self.pending += self.decoder.feed(data)
+        return self.pending.pop(0)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
@@ -0,0 +1,82 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#include "nrf_atfifo.h"
+#include "nrf_atomic.h"
+#include "hires_timer.h"
+#include "usb_link.h"
+
+#define RECORDS_PER_FRAME ((USB_LINK_MAX_PAYLOAD - sizeof(trace_data_t)) / sizeof(trace_record_t))
+
+NRF_ATFIFO_DEF(m_fifo, trace_record_t, TRACE_BUFFER_RECORDS);
+
+static nrf_atomic_u32_t m_dropped;
+
+void trace_init(void)
+{
+    NRF_ATFIFO_INIT(m_fifo);
+    m_dropped = 0;
+}
+
+void trace_put(trace_id_t id, uint16_t arg0, uint32_t arg1)
+{
+    // Records of nested interrupts can be queued out of timestamp order, the
+    // decoder sorts them
+    trace_record_t const record =
+    {
+        .timestamp = (uint32_t)hires_timer_now_us(),
+        .id        = (uint16_t)id,
+        .arg0      = arg0,
+        .arg1      = arg1
+    };
+
+    if (nrf_atfifo_alloc_put(m_fifo, &record, sizeof(record), NULL) != NRF_SUCCESS)
+    {
+        nrf_atomic_u32_add(&m_dropped, 1);
+    }
+}
+
+bool trace_get(trace_record_t * p_record)
+{
+    return nrf_atfifo_get_free(m_fifo, p_record, sizeof(*p_record), NULL) == NRF_SUCCESS;
+}
+
+uint32_t trace_dropped(void)
+{
+    return m_dropped;
+}
+
+void trace_process(void)
+{
+    if (!usb_link_is_open())
+    {
+        return;
+    }
+
+    // Whole frames only while the link has room, the rest stays queued
+    while (usb_link_send_space() >= sizeof(trace_data_t) + RECORDS_PER_FRAME * sizeof(trace_record_t))
+    {
+        struct
+        {
+            trace_data_t   header;
+            trace_record_t records[RECORDS_PER_FRAME];
+        } frame;
+        uint32_t count = 0;
+
+        while (count < RECORDS_PER_FRAME && trace_get(&frame.records[count]))
+        {
+            count++;
+        }
+        if (count == 0)
+        {
+            return;
+        }
+
+        frame.header.dropped = m_dropped;
+        usb_link_send(USB_LINK_MSG_TRACE_DATA, &frame,
+                      sizeof(frame.header) + count * sizeof(trace_record_t));
+    }
+}
+
+#endif // TRACE_ENABLED
@@ -0,0 +1,73 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Binary trace: fixed 12-byte records (ID, microsecond timestamp, two
+// arguments) queued from any context into an nrf_atfifo, without formatting
+// or locks. The main loop sends them to the host over the USB link while it
+// has nothing else to do; tools/trace_decode.py turns them into a timeline and
+// Chrome trace-event JSON. A full buffer drops new records and counts them.
+//
+// IDs ending in _BEGIN and _END bracket a duration, the decoder pairs them by
+// name and arg0. The decoder reads the names from this enum, keep one per line.
+
+typedef enum
+{
+    TRACE_NONE,
+    TRACE_BUTTON_IRQ,         // arg0: 1 pressed, 0 released (raw)
+    TRACE_EVENT_BEGIN,        // arg0: event_type_t, arg1: event timestamp (RTC ticks)
+    TRACE_EVENT_END,          // arg0: event_type_t
+    TRACE_GESTURE,            // arg0: gesture_type_t, arg1: count
+    TRACE_BLINK_BEGIN,        // arg0: 0, arg1: LED channel mask
+    TRACE_BLINK_END,          // arg0: 0
+    TRACE_PAUSE_BEGIN,        // arg0: 0
+    TRACE_PAUSE_END,          // arg0: 0
+    TRACE_ID_COUNT
+} trace_id_t;
+
+typedef struct
+{
+    uint32_t timestamp;   // hires_timer_now_us(), low 32 bits
+    uint16_t id;          // trace_id_t
+    uint16_t arg0;
+    uint32_t arg1;
+} trace_record_t;
+
+// USB_LINK_MSG_TRACE_DATA payload, followed by trace_record_t[]
+typedef struct
+{
+    uint32_t dropped;     // records lost since init, so the host sees gaps
+} trace_data_t;
+
+#if TRACE_ENABLED
+
+#define TRACE(id, arg0, arg1) trace_put((id), (arg0), (arg1))
+
+void trace_init(void);
+
+// Any context
+void trace_put(trace_id_t id, uint16_t arg0, uint32_t arg1);
+
+// Oldest record, false if there is none. Main loop only.
+bool trace_get(trace_record_t * p_record);
+
+uint32_t trace_dropped(void);
+
+// Send queued records while the host has the port open, main loop
+void trace_process(void);
+
+#else
+
+#define TRACE(id, arg0, arg1) (void)0
+
+static inline void trace_init(void) {}
+static inline bool trace_get(trace_record_t * p_record) { return false; }
+static inline uint32_t trace_dropped(void) { return 0; }
+static inline void trace_process(void) {}
+
+#endif // TRACE_ENABLED
+
+#endif
@@ -0,0 +1,147 @@
+#include <string.h>
+#include "usb_frame.h"
+#include "crc16.h"
+
+typedef enum
+{
+    RX_SYNC,
+    RX_TYPE,
+    RX_LENGTH_LOW,
+    RX_LENGTH_HIGH,
+    RX_PAYLOAD,
+    RX_CRC_LOW,
+    RX_CRC_HIGH
+} rx_state_t;
+
+void usb_frame_rx_init(usb_frame_rx_t * p_rx)
+{
+    memset(p_rx, 0, sizeof(*p_rx));
+    usb_frame_rx_reset(p_rx);
+}
+
+void usb_frame_rx_reset(usb_frame_rx_t * p_rx)
+{
+    p_rx->state = RX_SYNC;
+}
+
+uint16_t usb_frame_crc(uint8_t type, void const * p_payload, uint16_t length)
+{
+    uint8_t header[3] = {type, (uint8_t)length, (uint8_t)(length >> 8)};
+    uint16_t crc = crc16_compute(header, sizeof(header), NULL);
+
+    return crc16_compute(p_payload, length, &crc);
+}
+
+static void rx_byte(usb_frame_rx_t * p_rx, uint8_t byte, usb_frame_handler_t handler)
+{
+    switch (p_rx->state)
+    {
+        case RX_SYNC:
+            if (byte == USB_LINK_SYNC)
+            {
+                p_rx->state = RX_TYPE;
+            }
+            break;
+
+        case RX_TYPE:
+            p_rx->header[0] = byte;
+            p_rx->state = RX_LENGTH_LOW;
+            break;
+
+        case RX_LENGTH_LOW:
+            p_rx->header[1] = byte;
+            p_rx->state = RX_LENGTH_HIGH;
+            break;
+
+        case RX_LENGTH_HIGH:
+            p_rx->header[2] = byte;
+            p_rx->length = p_rx->header[1] | (byte << 8);
+            p_rx->received = 0;
+            if (p_rx->length > USB_LINK_MAX_PAYLOAD)
+            {
+                p_rx->errors++;
+                p_rx->state = RX_SYNC;
+            }
+            else
+            {
+                p_rx->state = p_rx->length == 0 ? RX_CRC_LOW : RX_PAYLOAD;
+            }
+            break;
+
+        case RX_PAYLOAD:
+            p_rx->payload[p_rx->received++] = byte;
+            if (p_rx->received == p_rx->length)
+            {
+                p_rx->state = RX_CRC_LOW;
+            }
+            break;
+
+        case RX_CRC_LOW:
+            p_rx->crc = byte;
+            p_rx->state = RX_CRC_HIGH;
+            break;
+
+        case RX_CRC_HIGH:
+            p_rx->crc |= byte << 8;
+            if (p_rx->crc == usb_frame_crc(p_rx->header[0], p_rx->payload, p_rx->length))
+            {
+                p_rx->frames++;
+                handler(p_rx->header[0], p_rx->payload, p_rx->length);
+            }
+            else
+            {
+                p_rx->errors++;
+            }
+            p_rx->state = RX_SYNC;
+            break;
+    }
+}
+
+// A whole frame at p, false if it is not all there or bad
+static bool frame_in_place(usb_frame_rx_t * p_rx, uint8_t const * p, size_t left,
+                           usb_frame_handler_t handler, size_t * p_size)
+{
+    if (left < USB_LINK_OVERHEAD)
+    {
+        return false;
+    }
+
+    uint16_t length = p[2] | (p[3] << 8);
+    if (length > USB_LINK_MAX_PAYLOAD || left < (size_t)USB_LINK_OVERHEAD + length)
+    {
+        return false;
+    }
+
+    uint16_t crc = p[4 + length] | (p[5 + length] << 8);
+    if (crc != usb_frame_crc(p[1], &p[4], length))
+    {
+        return false;
+    }
+
+    p_rx->frames++;
+    p_rx->in_place++;
+    handler(p[1], &p[4], length);
+    *p_size = USB_LINK_OVERHEAD + length;
+    return true;
+}
+
+void usb_frame_rx(usb_frame_rx_t * p_rx, uint8_t const * p_data, size_t size,
+                  usb_frame_handler_t handler)
+{
+    size_t i = 0;
+
+    while (i < size)
+    {
+        size_t frame_size;
+
+        // Between frames, a frame that is all in this packet needs no copy.
+        // Anything else (split or bad) goes byte by byte.
+        if (p_rx->state == RX_SYNC && p_data[i] == USB_LINK_SYNC &&
+            frame_in_place(p_rx, &p_data[i], size - i, handler, &frame_size))
+        {
+            i += frame_size;
+            continue;
+        }
+        rx_byte(p_rx, p_data[i++], handler);
+    }
+}
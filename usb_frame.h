@@ -0,0 +1,41 @@
+#ifndef USB_FRAME_H
+#define USB_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "usb_link.h"
+
+// Framing of the USB link (see usb_link.h), hardware independent. A frame
+// that lies entirely in one received packet is checked and handed over where
+// it is, in the endpoint buffer; only a frame split across packets is put
+// together in usb_frame_rx_t first. Either way the payload is only valid
+// during the handler call.
+
+typedef void (*usb_frame_handler_t)(uint8_t type, uint8_t const * p_payload, uint16_t length);
+
+typedef struct
+{
+    uint8_t  state;
+    uint8_t  header[3];                       // type, length
+    uint8_t  payload[USB_LINK_MAX_PAYLOAD];
+    uint16_t length;
+    uint16_t received;
+    uint16_t crc;
+    uint32_t frames;                          // good frames
+    uint32_t in_place;                        // of them handed over without a copy
+    uint32_t errors;                          // bad CRC or length
+} usb_frame_rx_t;
+
+void usb_frame_rx_init(usb_frame_rx_t * p_rx);
+
+// Drop a partly received frame, wait for the next sync byte
+void usb_frame_rx_reset(usb_frame_rx_t * p_rx);
+
+// Parse the bytes of one received packet, handler gets every good frame
+void usb_frame_rx(usb_frame_rx_t * p_rx, uint8_t const * p_data, size_t size,
+                  usb_frame_handler_t handler);
+
+// CRC of a frame: over type, length and payload
+uint16_t usb_frame_crc(uint8_t type, void const * p_payload, uint16_t length);
+
+#endif
@@ -0,0 +1,275 @@
+#include "usb_link.h"
+
+#if USB_LINK_ENABLED
+
+#include <stddef.h>
+#include <string.h>
+#include "app_usbd.h"
+#include "app_usbd_core.h"
+#include "app_usbd_cdc_acm.h"
+#include "app_usbd_serial_num.h"
+#include "nrf_drv_usbd.h"
+#include "usb_frame.h"
+
+// The log backend brings the USB stack up itself when it is enabled
+#define STACK_SHARED (NRF_LOG_ENABLED && LOG_BACKEND_USB_ENABLED && LOG_BACKEND_USB_INIT_STACK)
+
+typedef struct
+{
+    uint8_t            type;
+    usb_link_handler_t handler;
+} handler_entry_t;
+
+static void cdc_acm_event_handler(app_usbd_class_inst_t const * p_inst,
+                                  app_usbd_cdc_acm_user_event_t event);
+
+APP_USBD_CDC_ACM_GLOBAL_DEF(m_cdc_acm,
+                            cdc_acm_event_handler,
+                            USB_LINK_CDC_ACM_COMM_INTERFACE,
+                            USB_LINK_CDC_ACM_DATA_INTERFACE,
+                            NRF_DRV_USBD_EPIN(USB_LINK_CDC_ACM_COMM_EPIN),
+                            NRF_DRV_USBD_EPIN(USB_LINK_CDC_ACM_DATA_EPIN),
+                            NRF_DRV_USBD_EPOUT(USB_LINK_CDC_ACM_DATA_EPOUT),
+                            APP_USBD_CDC_COMM_PROTOCOL_NONE);
+
+static handler_entry_t m_handlers[USB_LINK_HANDLERS];
+static bool m_open;
+
+// TX ring of complete frames, the part from m_tx_tail is being sent while m_tx_busy
+static uint8_t m_tx[USB_LINK_TX_BUFFER_SIZE];
+static uint16_t m_tx_head;
+static uint16_t m_tx_tail;
+static uint16_t m_tx_used;
+static uint16_t m_tx_in_flight;
+static bool m_tx_busy;
+
+// Packet from the OUT endpoint, frames in it are handled in place
+static uint8_t m_rx_packet[NRF_DRV_USBD_EPSIZE];
+static usb_frame_rx_t m_rx;
+
+static void tx_kick(void)
+{
+    if (m_tx_busy || m_tx_used == 0 || !m_open)
+    {
+        return;
+    }
+
+    // Contiguous part only, the rest follows on TX_DONE
+    uint16_t length = m_tx_used;
+    if (m_tx_tail + length > USB_LINK_TX_BUFFER_SIZE)
+    {
+        length = USB_LINK_TX_BUFFER_SIZE - m_tx_tail;
+    }
+
+    if (app_usbd_cdc_acm_write(&m_cdc_acm, &m_tx[m_tx_tail], length) == NRF_SUCCESS)
+    {
+        m_tx_busy = true;
+        m_tx_in_flight = length;
+    }
+}
+
+static void tx_put(void const * p_data, uint16_t length)
+{
+    uint8_t const * p_bytes = p_data;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        m_tx[m_tx_head] = p_bytes[i];
+        m_tx_head = (m_tx_head + 1) % USB_LINK_TX_BUFFER_SIZE;
+    }
+    m_tx_used += length;
+}
+
+// Drop the queued frames. A transfer in flight cannot be taken back: its
+// TX_DONE still comes and must find its bytes where they were sent from.
+static void tx_flush(void)
+{
+    if (m_tx_busy)
+    {
+        m_tx_head = (m_tx_tail + m_tx_in_flight) % USB_LINK_TX_BUFFER_SIZE;
+        m_tx_used = m_tx_in_flight;
+    }
+    else
+    {
+        m_tx_head = 0;
+        m_tx_tail = 0;
+        m_tx_used = 0;
+    }
+}
+
+static void frame_dispatch(uint8_t type, uint8_t const * p_payload, uint16_t length)
+{
+    for (int i = 0; i < USB_LINK_HANDLERS; i++)
+    {
+        if (m_handlers[i].handler != NULL && m_handlers[i].type == type)
+        {
+            m_handlers[i].handler(p_payload, length);
+            return;
+        }
+    }
+}
+
+static void rx_start(app_usbd_cdc_acm_t const * p_cdc_acm)
+{
+    // Data that is already there completes at once, the rest with RX_DONE
+    while (app_usbd_cdc_acm_read_any(p_cdc_acm, m_rx_packet, sizeof(m_rx_packet)) == NRF_SUCCESS)
+    {
+        usb_frame_rx(&m_rx, m_rx_packet, app_usbd_cdc_acm_rx_size(p_cdc_acm), frame_dispatch);
+    }
+}
+
+static void cdc_acm_event_handler(app_usbd_class_inst_t const * p_inst,
+                                  app_usbd_cdc_acm_user_event_t event)
+{
+    app_usbd_cdc_acm_t const * p_cdc_acm = app_usbd_cdc_acm_class_get(p_inst);
+
+    switch (event)
+    {
+        case APP_USBD_CDC_ACM_USER_EVT_PORT_OPEN:
+            m_open = true;
+            usb_frame_rx_reset(&m_rx);
+            tx_flush();
+            rx_start(p_cdc_acm);
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_PORT_CLOSE:
+            m_open = false;
+            tx_flush();
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_TX_DONE:
+            // Only for the transfer tx_kick() started, a stray one changes nothing
+            if (m_tx_busy)
+            {
+                uint16_t done = m_tx_in_flight < m_tx_used ? m_tx_in_flight : m_tx_used;
+
+                m_tx_tail = (m_tx_tail + done) % USB_LINK_TX_BUFFER_SIZE;
+                m_tx_used -= done;
+                m_tx_in_flight = 0;
+                m_tx_busy = false;
+            }
+            tx_kick();
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_RX_DONE:
+            usb_frame_rx(&m_rx, m_rx_packet, app_usbd_cdc_acm_rx_size(p_cdc_acm), frame_dispatch);
+            rx_start(p_cdc_acm);
+            break;
+
+        default:
+            break;
+    }
+}
+
+#if !STACK_SHARED
+static void usbd_event_handler(app_usbd_event_type_t event)
+{
+    switch (event)
+    {
+        case APP_USBD_EVT_POWER_DETECTED:
+            if (!nrf_drv_usbd_is_enabled())
+            {
+                app_usbd_enable();
+            }
+            break;
+
+        case APP_USBD_EVT_POWER_REMOVED:
+            app_usbd_stop();
+            break;
+
+        case APP_USBD_EVT_POWER_READY:
+            app_usbd_start();
+            break;
+
+        default:
+            break;
+    }
+}
+#endif
+
+void usb_link_init(void)
+{
+    usb_frame_rx_init(&m_rx);
+
+#if !STACK_SHARED
+    static const app_usbd_config_t config =
+    {
+        .ev_state_proc = usbd_event_handler
+    };
+
+    app_usbd_serial_num_generate();
+    app_usbd_init(&config);
+#endif
+
+    app_usbd_class_append(app_usbd_cdc_acm_class_inst_get(&m_cdc_acm));
+
+#if !STACK_SHARED
+    // The stack is enabled and started once VBUS is there
+    app_usbd_power_events_enable();
+#endif
+}
+
+void usb_link_process(void)
+{
+    while (app_usbd_event_queue_process())
+    {
+    }
+    tx_kick();
+}
+
+void usb_link_handler_set(usb_link_msg_t type, usb_link_handler_t handler)
+{
+    for (int i = 0; i < USB_LINK_HANDLERS; i++)
+    {
+        if (m_handlers[i].handler == NULL || m_handlers[i].type == type)
+        {
+            m_handlers[i].type = (uint8_t)type;
+            m_handlers[i].handler = handler;
+            return;
+        }
+    }
+}
+
+uint16_t usb_link_send_space(void)
+{
+    uint16_t free = USB_LINK_TX_BUFFER_SIZE - m_tx_used;
+
+    if (free <= USB_LINK_OVERHEAD)
+    {
+        return 0;
+    }
+    free -= USB_LINK_OVERHEAD;
+    return free < USB_LINK_MAX_PAYLOAD ? free : USB_LINK_MAX_PAYLOAD;
+}
+
+bool usb_link_send(usb_link_msg_t type, void const * p_payload, uint16_t length)
+{
+    if (!m_open || length > usb_link_send_space())
+    {
+        return false;
+    }
+
+    uint8_t header[4] = {USB_LINK_SYNC, (uint8_t)type, (uint8_t)length, (uint8_t)(length >> 8)};
+    uint16_t crc = usb_frame_crc((uint8_t)type, p_payload, length);
+    uint8_t trailer[2] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+
+    tx_put(header, sizeof(header));
+    tx_put(p_payload, length);
+    tx_put(trailer, sizeof(trailer));
+
+    // Out now if the port is idle, a sender may be the last thing before sleep
+    tx_kick();
+    return true;
+}
+
+bool usb_link_is_open(void)
+{
+    return m_open;
+}
+
+uint32_t usb_link_rx_errors(void)
+{
+    return m_rx.errors;
+}
+
+#endif // USB_LINK_ENABLED
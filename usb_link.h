@@ -0,0 +1,90 @@
+#ifndef USB_LINK_H
+#define USB_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_config.h"
+
+// Framed binary messages to and from the host over a CDC ACM port of its own.
+// Every frame is
+//
+//   0xA5 | type | length (16 bit LE) | payload | CRC-16/CCITT (LE)
+//
+// with the CRC (crc16_compute, initial 0xFFFF) over type, length and payload.
+// Types with the top bit set go from the device to the host. The receiver
+// resynchronises on the next 0xA5 after a bad frame. tools/usb_link.py is the
+// host side. Parsing is in usb_frame.c: frames are handed to the handlers
+// where they are in the endpoint buffer, without a copy.
+//
+// All functions are for the main loop only, the USB stack runs its events
+// from usb_link_process().
+
+#define USB_LINK_SYNC        0xA5
+#define USB_LINK_MAX_PAYLOAD 256
+#define USB_LINK_OVERHEAD    6      // sync, type, length, CRC
+
+typedef enum
+{
+    // Host to device
+    USB_LINK_MSG_PROFILER_CTRL       = 0x01,   // u8 profiler_cmd_t
+    USB_LINK_MSG_INSTRUMENT_CTRL     = 0x02,   // u8 instrument_cmd_t
+    USB_LINK_MSG_PWM_SELFTEST_CTRL   = 0x03,   // pwm_selftest_ctrl_t
+    USB_LINK_MSG_LED_COMMAND         = 0x04,   // u8 led_command_op_t, operands
+    USB_LINK_MSG_LED_STREAM_CTRL     = 0x05,   // led_stream_ctrl_t
+    USB_LINK_MSG_LED_STREAM_DATA     = 0x06,   // u16 sequence, u16 levels[4][]
+    USB_LINK_MSG_BOOT_CTRL           = 0x07,   // empty, answered with BOOT_REPORT
+
+    // Device to host
+    USB_LINK_MSG_PROFILER_INFO       = 0x81,   // profiler_info_t
+    USB_LINK_MSG_PROFILER_DATA       = 0x82,   // profiler_entry_t[]
+    USB_LINK_MSG_INSTRUMENT_STATS    = 0x83,   // instrument_stats_t
+    USB_LINK_MSG_INSTRUMENT_HIST     = 0x84,   // instrument_hist_t, uint32_t[]
+    USB_LINK_MSG_TRACE_DATA          = 0x85,   // trace_data_t, trace_record_t[]
+    USB_LINK_MSG_DLOG_DATA           = 0x86,   // dlog_data_t, records
+    USB_LINK_MSG_PWM_SELFTEST_REPORT = 0x87,   // pwm_selftest_report_t
+    USB_LINK_MSG_LED_STATUS          = 0x88,   // led_command_status_t
+    USB_LINK_MSG_LED_STREAM_REPORT   = 0x89,   // led_stream_stats_t
+    USB_LINK_MSG_BOOT_REPORT         = 0x8A,   // boot_report_t
+} usb_link_msg_t;
+
+// Receive handlers that can be set at the same time
+#define USB_LINK_HANDLERS 8
+
+// The payload is in the receive buffer and only valid during the call
+typedef void (*usb_link_handler_t)(uint8_t const * p_payload, uint16_t length);
+
+#if USB_LINK_ENABLED
+
+void usb_link_init(void);
+
+// Run queued USB events, receive frames and send what is waiting
+void usb_link_process(void);
+
+// Called from usb_link_process() for every received frame of this type
+void usb_link_handler_set(usb_link_msg_t type, usb_link_handler_t handler);
+
+// Queue a frame, false if it does not fit into the TX buffer or no host has
+// the port open. The payload is copied.
+bool usb_link_send(usb_link_msg_t type, void const * p_payload, uint16_t length);
+
+// Room in the TX buffer for the payload of one more frame
+uint16_t usb_link_send_space(void);
+
+bool usb_link_is_open(void);
+
+// Frames dropped for a bad CRC or length since init
+uint32_t usb_link_rx_errors(void);
+
+#else
+
+static inline void usb_link_init(void) {}
+static inline void usb_link_process(void) {}
+static inline void usb_link_handler_set(usb_link_msg_t type, usb_link_handler_t handler) {}
+static inline bool usb_link_send(usb_link_msg_t type, void const * p_payload, uint16_t length) { return false; }
+static inline uint16_t usb_link_send_space(void) { return 0; }
+static inline bool usb_link_is_open(void) { return false; }
+static inline uint32_t usb_link_rx_errors(void) { return 0; }
+
+#endif // USB_LINK_ENABLED
+
+#endif